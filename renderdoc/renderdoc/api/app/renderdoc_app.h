@@ -163,6 +163,64 @@ typedef enum
 	// 0 - API debugging is displayed as normal
 	eRENDERDOC_Option_DebugOutputMute = 11,
 
+	// Automatically capture a frame every N frames, for unattended capturing of
+	// long sessions. Can be combined with PeriodicCaptureMS, in which case a
+	// capture is taken when either interval elapses.
+	//
+	// Default - 0
+	//
+	// 0 - No periodic captures are taken
+	// N - A capture is taken every N frames
+	eRENDERDOC_Option_PeriodicCaptureFrames = 12,
+
+	// Automatically capture a frame every N milliseconds. See PeriodicCaptureFrames.
+	//
+	// Default - 0
+	//
+	// 0 - No periodic captures are taken
+	// N - A capture is taken on the first frame after N milliseconds have elapsed
+	eRENDERDOC_Option_PeriodicCaptureMS = 13,
+
+	// The maximum number of captures that can be waiting to be written to disk
+	// at once. Periodic captures are skipped while this many are outstanding,
+	// other captures will wait for a write to complete.
+	//
+	// Default - 2
+	//
+	// N - Up to N captures are held in memory while being written
+	eRENDERDOC_Option_MaxPendingCaptures = 14,
+
+	// Skip periodic captures if the disk the captures are written to has less
+	// than this much space free, in megabytes.
+	//
+	// Default - 0
+	//
+	// 0 - Free disk space is not checked
+	// N - Periodic captures are skipped with less than N MB free
+	eRENDERDOC_Option_MinFreeDiskMB = 15,
+
+	// Store large initial contents in a content-addressed store next to the
+	// capture, shared between captures. Consecutive captures then only write
+	// initial contents that changed, and reference the rest by hash. The
+	// store directory must be kept alongside the captures for them to replay.
+	//
+	// Default - disabled
+	//
+	// 1 - Initial contents are written to a shared store and deduplicated
+	// 0 - Each capture is fully self-contained
+	eRENDERDOC_Option_SharedInitialContents = 16,
+
+	// Collect CPU callstacks by following the chain of frame pointers, instead of
+	// a full unwind. This is much cheaper, but callstacks will be cut short at
+	// any function built without frame pointers (e.g. -fomit-frame-pointer).
+	// This option does nothing without callstack capturing enabled.
+	//
+	// Default - disabled
+	//
+	// 1 - Callstacks are collected by walking frame pointers
+	// 0 - Callstacks are collected with a full unwind
+	eRENDERDOC_Option_FramePointerCallstacks = 17,
+
 } RENDERDOC_CaptureOption;
 
 // Sets an option that controls how RenderDoc behaves on capture.
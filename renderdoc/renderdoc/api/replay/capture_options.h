@@ -47,4 +47,11 @@ struct CaptureOptions
 	bool32 SaveAllInitials;
 	bool32 CaptureAllCmdLists;
 	bool32 DebugOutputMute;
+	uint32_t PeriodicCaptureFrames;
+	uint32_t PeriodicCaptureMS;
+	uint32_t MaxPendingCaptures;
+	uint32_t MinFreeDiskMB;
+	bool32 SharedInitialContents;
+	bool32 FramePointerCallstacks;
+	char PeriodicCaptureFilename[256];
 };
\ No newline at end of file
@@ -192,6 +192,41 @@ struct TextureSave
 	int jpegQuality;
 };
 
+struct RepackOptions
+{
+	// LZ4 compress each section, otherwise sections are stored uncompressed
+	bool32 compress;
+
+	// LZ4 block size in bytes, between 4KB and 4MB. Larger blocks compress
+	// better but need more memory to read back.
+	uint32_t blockSize;
+
+	// number of captures to repack at once. 0 is treated as 1
+	uint32_t numThreads;
+
+	// memory captures being repacked at once may use, in megabytes. A capture
+	// is always allowed to start if nothing else is in progress. 0 is unlimited
+	uint32_t memoryBudgetMB;
+
+	// re-read each repacked capture and check its chunks and sections
+	// match the original
+	bool32 verify;
+};
+
+struct RepackResult
+{
+	bool32 success;
+	bool32 verified;
+
+	uint64_t originalSize;
+	uint64_t repackedSize;
+
+	// bytes of initial contents referenced from the store, and how many of
+	// those bytes were newly added to it by this capture
+	uint64_t storeReferenced;
+	uint64_t storeWritten;
+};
+
 struct RemoteMessage
 {
 	RemoteMessage() {}
@@ -247,6 +247,78 @@ struct FetchDrawcall
 	rdctype::array<FetchDrawcall> children;
 };
 
+// one entry in a frame's flattened, immutable drawcall table. Entries are stored in
+// pre-order, so the descendants of entry i are entries [i+1, i+numDescendants].
+struct FetchFlatDrawcall
+{
+	uint32_t eventID, drawcallID;
+
+	// byte offset of the NULL-terminated UTF-8 name in the table's string pool
+	uint32_t nameOffset;
+
+	uint32_t flags;
+
+	uint32_t numIndices;
+	uint32_t numInstances;
+	uint32_t indexOffset;
+	uint32_t vertexOffset;
+	uint32_t instanceOffset;
+
+	uint32_t dispatchDimension[3];
+	uint32_t dispatchThreadsDimension[3];
+	
+	uint32_t indexByteWidth;
+	PrimitiveTopology topology;
+
+	ResourceId copySource;
+	ResourceId copyDestination;
+
+	ResourceId context;
+
+	// table indices, -1 if there is none
+	int32_t parent;
+	int32_t nextSibling;
+
+	uint32_t numChildren;
+	uint32_t numDescendants;
+
+	// event IDs as in FetchDrawcall
+	uint32_t previous;
+	uint32_t next;
+
+	ResourceId outputs[8];
+	ResourceId depthOut;
+};
+
+// a run of consecutive draws on the immediate context with identical output bindings,
+// built from the drawcall list when the log is loaded.
+struct FetchRenderPass
+{
+	FetchRenderPass()
+	{
+		passID = 0;
+		firstEventID = lastEventID = 0;
+		numDraws = 0;
+		numOutputs = 0;
+		for(int i=0; i < 8; i++)
+			outputs[i] = ResourceId();
+		depthOut = ResourceId();
+	}
+
+	uint32_t passID;
+
+	uint32_t firstEventID;
+	uint32_t lastEventID;
+	uint32_t numDraws;
+
+	uint32_t numOutputs;
+	ResourceId outputs[8];
+	ResourceId depthOut;
+
+	ResourceFormat outputFormats[8];
+	ResourceFormat depthFormat;
+};
+
 struct APIProperties
 {
 	APIPipelineStateType pipelineType;
@@ -321,3 +393,50 @@ struct PixelModification
 	bool32 depthTestFailed;
 	bool32 stencilTestFailed;
 };
+
+struct ReplayCheckpointStats
+{
+	uint32_t checkpoints;
+	uint32_t hits;
+	uint32_t misses;
+	uint32_t dropped;
+	uint64_t memoryUsed;
+	uint64_t memoryBudget;
+};
+
+struct ReplayStats
+{
+	uint32_t fullReplays;
+	uint32_t forwardReplays;
+	uint64_t eventsReplayed;
+	ReplayCheckpointStats checkpoints;
+};
+
+struct LoadChunkStats
+{
+	rdctype::str name;
+	uint32_t count;
+	uint64_t totalSize;
+	double loadMS;
+	double maxMS;
+	double applyMS;
+};
+
+struct LoadEventTiming
+{
+	uint32_t startEventID;
+	uint32_t endEventID;
+	double replayMS;
+};
+
+struct LoadProfile
+{
+	double totalMS;
+	double chunkReadMS;
+	double initialContentsApplyMS;
+	double frameReplayMS;
+
+	rdctype::array<LoadChunkStats> chunks;
+	rdctype::array<LoadChunkStats> resources;
+	rdctype::array<LoadEventTiming> events;
+};
@@ -176,6 +176,7 @@ struct IReplayRenderer
 
 	virtual bool SetContextFilter(ResourceId id, uint32_t firstDefEv, uint32_t lastDefEv) = 0;
 	virtual bool SetFrameEvent(uint32_t frameID, uint32_t eventID) = 0;
+	virtual bool SetReplayCheckpoints(uint32_t eventInterval, uint32_t memoryBudgetMB) = 0;
 	
 	/* Added by Stephan Richter | BEGIN */
 	virtual void SetIDRenderingEvents(uint32_t frameID, uint32_t startEventID, uint32_t endEventID) = 0;
@@ -195,6 +196,9 @@ struct IReplayRenderer
 
 	virtual bool GetFrameInfo(rdctype::array<FetchFrameInfo> *frame) = 0;
 	virtual bool GetDrawcalls(uint32_t frameID, rdctype::array<FetchDrawcall> *draws) = 0;
+	virtual bool GetDrawcallTable(uint32_t frameID, const FetchFlatDrawcall **draws, uint32_t *count, const char **strings) = 0;
+	virtual bool GetRenderPasses(uint32_t frameID, rdctype::array<FetchRenderPass> *passes) = 0;
+	virtual bool FindRenderPasses(uint32_t frameID, uint32_t numOutputs, bool32 hasDepth, rdctype::array<FetchRenderPass> *passes) = 0;
 	virtual bool FetchCounters(uint32_t frameID, uint32_t minEventID, uint32_t maxEventID, uint32_t *counters, uint32_t numCounters, rdctype::array<CounterResult> *results) = 0;
 	virtual bool EnumerateCounters(rdctype::array<uint32_t> *counters) = 0;
 	virtual bool DescribeCounter(uint32_t counterID, CounterDescription *desc) = 0;
@@ -203,11 +207,15 @@ struct IReplayRenderer
 	virtual bool GetResolve(uint64_t *callstack, uint32_t callstackLen, rdctype::array<rdctype::str> *trace) = 0;
 	virtual ShaderReflection* GetShaderDetails(ResourceId shader) = 0;
 	virtual bool GetDebugMessages(rdctype::array<DebugMessage> *msgs) = 0;
+	virtual bool GetLoadProfile(LoadProfile *profile) = 0;
+	virtual bool GetReplayStats(ReplayStats *stats) = 0;
 
 	virtual bool PixelHistory(ResourceId target, uint32_t x, uint32_t y, uint32_t slice, uint32_t mip, uint32_t sampleIdx, rdctype::array<PixelModification> *history) = 0;
 	virtual bool DebugVertex(uint32_t vertid, uint32_t instid, uint32_t idx, uint32_t instOffset, uint32_t vertOffset, ShaderDebugTrace *trace) = 0;
 	virtual bool DebugPixel(uint32_t x, uint32_t y, uint32_t sample, uint32_t primitive, ShaderDebugTrace *trace) = 0;
 	virtual bool DebugThread(uint32_t groupid[3], uint32_t threadid[3], ShaderDebugTrace *trace) = 0;
+	virtual bool GetDebugState(uint32_t traceID, uint32_t step, ShaderDebugState *state) = 0;
+	virtual bool FreeDebugTrace(uint32_t traceID) = 0;
 
 	virtual bool GetUsage(ResourceId id, rdctype::array<EventUsage> *usage) = 0;
 
@@ -249,6 +257,7 @@ extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_InitResolver(ReplayR
  
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_SetContextFilter(ReplayRenderer *rend, ResourceId id, uint32_t firstDefEv, uint32_t lastDefEv);
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_SetFrameEvent(ReplayRenderer *rend, uint32_t frameID, uint32_t eventID);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_SetReplayCheckpoints(ReplayRenderer *rend, uint32_t eventInterval, uint32_t memoryBudgetMB);
 
 /* Added by Stephan Richter | BEGIN */
 extern "C" RENDERDOC_API void RENDERDOC_CC ReplayRenderer_SetIDRenderingEvents(ReplayRenderer *rend, uint32_t frameID, uint32_t startEventID, uint32_t endEventID);
@@ -268,6 +277,10 @@ extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_FreeTargetResource(R
 
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetFrameInfo(ReplayRenderer *rend, rdctype::array<FetchFrameInfo> *frame);
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetDrawcalls(ReplayRenderer *rend, uint32_t frameID, rdctype::array<FetchDrawcall> *draws);
+// the returned pointers are owned by the renderer and stay valid and unchanged until it's shut down
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetDrawcallTable(ReplayRenderer *rend, uint32_t frameID, const FetchFlatDrawcall **draws, uint32_t *count, const char **strings);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetRenderPasses(ReplayRenderer *rend, uint32_t frameID, rdctype::array<FetchRenderPass> *passes);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_FindRenderPasses(ReplayRenderer *rend, uint32_t frameID, uint32_t numOutputs, bool32 hasDepth, rdctype::array<FetchRenderPass> *passes);
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_FetchCounters(ReplayRenderer *rend, uint32_t frameID, uint32_t minEventID, uint32_t maxEventID, uint32_t *counters, uint32_t numCounters, rdctype::array<CounterResult> *results);
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_EnumerateCounters(ReplayRenderer *rend, rdctype::array<uint32_t> *counters);
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_DescribeCounter(ReplayRenderer *rend, uint32_t counterID, CounterDescription *desc);
@@ -281,11 +294,15 @@ extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetPixelShaders(Repl
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetResolve(ReplayRenderer *rend, uint64_t *callstack, uint32_t callstackLen, rdctype::array<rdctype::str> *trace);
 extern "C" RENDERDOC_API ShaderReflection* RENDERDOC_CC ReplayRenderer_GetShaderDetails(ReplayRenderer *rend, ResourceId shader);
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetDebugMessages(ReplayRenderer *rend, rdctype::array<DebugMessage> *msgs);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetLoadProfile(ReplayRenderer *rend, LoadProfile *profile);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetReplayStats(ReplayRenderer *rend, ReplayStats *stats);
 
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_PixelHistory(ReplayRenderer *rend, ResourceId target, uint32_t x, uint32_t y, uint32_t slice, uint32_t mip, uint32_t sampleIdx, rdctype::array<PixelModification> *history);
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_DebugVertex(ReplayRenderer *rend, uint32_t vertid, uint32_t instid, uint32_t idx, uint32_t instOffset, uint32_t vertOffset, ShaderDebugTrace *trace);
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_DebugPixel(ReplayRenderer *rend, uint32_t x, uint32_t y, uint32_t sample, uint32_t primitive, ShaderDebugTrace *trace);
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_DebugThread(ReplayRenderer *rend, uint32_t groupid[3], uint32_t threadid[3], ShaderDebugTrace *trace);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetDebugState(ReplayRenderer *rend, uint32_t traceID, uint32_t step, ShaderDebugState *state);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_FreeDebugTrace(ReplayRenderer *rend, uint32_t traceID);
 
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetUsage(ReplayRenderer *rend, ResourceId id, rdctype::array<EventUsage> *usage);
 
@@ -296,6 +313,7 @@ extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_SaveTexture(ReplayRe
 /* Added by Stephan Richter | BEGIN */
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_HashTexture(ReplayRenderer *rend, const TextureSave &saveData, const char *path);
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_HashBufferData(ReplayRenderer *rend, ResourceId buffer, const char *path);
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_HashBuffers(ReplayRenderer *rend, ResourceId *buffers, uint32_t numBuffers, const char *path);
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_HashShader(ReplayRenderer *rend, ResourceId buffer, const char *path);
 /* Added by Stephan Richter | END */
 
@@ -426,6 +444,10 @@ extern "C" RENDERDOC_API uint32_t RENDERDOC_CC Topology_VertexOffset(PrimitiveTo
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC RENDERDOC_SupportLocalReplay(const char *logfile, rdctype::str *driverName);
 extern "C" RENDERDOC_API ReplayCreateStatus RENDERDOC_CC RENDERDOC_CreateReplayRenderer(const char *logfile, float *progress, ReplayRenderer **rend);
 
+// For logs opened after this, keep at most budgetMB of initial contents in memory and page
+// the rest in from disk as the frame is replayed. 0 (the default) keeps them all in memory.
+extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_SetInitialContentsBudget(uint32_t budgetMB);
+
 //////////////////////////////////////////////////////////////////////////
 // Remote access and control
 //////////////////////////////////////////////////////////////////////////
@@ -452,3 +474,11 @@ extern "C" RENDERDOC_API uint32_t RENDERDOC_CC RENDERDOC_InjectIntoProcess(uint3
 extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_TriggerExceptionHandler(void *exceptionPtrs, bool32 crashed);
 extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_LogText(const char *text);
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC RENDERDOC_GetThumbnail(const char *filename, byte *buf, uint32_t &len);
+
+// Rewrite captures with different compression settings, without replaying them. logfiles[i] is
+// written to outfiles[i], and results[i] is filled out. If storeDir is not NULL or empty, large
+// initial contents are moved into a shared store in storeDir/rdcstore - storeDir should be a parent
+// of all the output captures so that they can find it.
+// Returns 1 if every capture was repacked (and verified, if requested).
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC RENDERDOC_RepackLogFiles(const char **logfiles, const char **outfiles, uint32_t numFiles,
+																	const char *storeDir, const RepackOptions *opts, RepackResult *results);
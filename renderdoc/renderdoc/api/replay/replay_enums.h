@@ -34,6 +34,13 @@ enum VarType
 	eVar_Double,
 };
 
+enum ShaderDebugRegType
+{
+	eDebugReg_Temp = 0,
+	eDebugReg_Output,
+	eDebugReg_IndexableTemp,
+};
+
 enum FormatComponentType
 {
 	eCompType_None = 0,
@@ -106,12 +106,44 @@ struct ShaderDebugState
 	uint32_t nextInstruction;
 };
 
+// a single register write made by one step of the trace. Only the
+// value changes, the name/type/size of the register are as in the
+// previous state.
+struct ShaderDebugChange
+{
+	ShaderDebugRegType type;
+	uint32_t index;   // register index, or indexable temp array index
+	uint32_t element; // element within the indexable temp array
+	uint32_t value[4];
+};
+
+struct ShaderDebugStep
+{
+	uint32_t nextInstruction;
+	uint32_t firstChange;
+	uint32_t numChanges;
+};
+
+// rather than one full state per step, the trace stores a full state every
+// keyframeInterval steps and the register writes of every step in between.
+// steps[i] takes state i to state i+1, so there are steps.count+1 states.
+//
+// The replay renderer keeps the full trace and only returns the first
+// keyframe and the steps, with no changes. Any other state is fetched with
+// GetDebugState(traceID, step), and the trace freed with FreeDebugTrace.
 struct ShaderDebugTrace
 {
+	ShaderDebugTrace() : keyframeInterval(0), traceID(0) {}
+
 	rdctype::array<ShaderVariable> inputs;
 	rdctype::array< rdctype::array<ShaderVariable> > cbuffers;
 
-	rdctype::array<ShaderDebugState> states;
+	uint32_t keyframeInterval;
+	rdctype::array<ShaderDebugState> keyframes;
+	rdctype::array<ShaderDebugStep> steps;
+	rdctype::array<ShaderDebugChange> changes;
+
+	uint32_t traceID;
 };
 
 struct SigParameter
@@ -86,141 +86,275 @@ void rdcassert(const char *condition, const char *file, unsigned int line, const
 	rdclog_int(RDCLog_Error, file, line, "Assertion failed: '%s'", condition, file, line);
 }
 
-#if 0
-static __m128 zero = {0};
+// x86 builds always have SSE2 available. AVX2 is detected at runtime so that
+// captures still work on older CPUs.
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define DIFF_SSE2
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__)
+#define DIFF_AVX2_FUNC __attribute__((target("avx2")))
+#else
+#define DIFF_AVX2_FUNC
 #endif
 
-// assumes a and b both point to 16-byte aligned 16-byte chunks of memory.
-// Returns if they're equal or different
-bool Vec16NotEqual(void *a, void *b)
+static inline uint32_t LowestBit(uint32_t mask)
 {
-	// disabled SSE version as it's acting dodgy
-#if 0
-	__m128 avec = _mm_load_ps(aflt);
-	__m128 bvec = _mm_load_ps(bflt);
+#if defined(_MSC_VER)
+	unsigned long idx = 0;
+	_BitScanForward(&idx, mask);
+	return (uint32_t)idx;
+#else
+	return (uint32_t)__builtin_ctz(mask);
+#endif
+}
 
-	__m128 diff = _mm_xor_ps(avec, bvec);
+static inline uint32_t HighestBit(uint32_t mask)
+{
+#if defined(_MSC_VER)
+	unsigned long idx = 0;
+	_BitScanReverse(&idx, mask);
+	return (uint32_t)idx;
+#else
+	return 31 - (uint32_t)__builtin_clz(mask);
+#endif
+}
 
-	__m128 eq = _mm_cmpeq_ps(diff, zero);
-	int mask = _mm_movemask_ps(eq);
-	int signMask = _mm_movemask_ps(diff);
+// accumulates differing bytes (always in increasing order) into ranges,
+// starting a new range whenever the gap since the last difference is at
+// least mergeGap bytes.
+struct DiffRangeBuilder
+{
+	DiffRangeBuilder(size_t gap, std::vector<DiffRange> &out)
+		: mergeGap(gap), ranges(out), open(false), start(0), end(0)
+	{
+	}
 
-	// first check ensures that diff is floatequal to zero (ie. avec bitwise equal to bvec).
-	// HOWEVER -0 is floatequal to 0, so we ensure no sign bits are set on diff
-	if((mask^0xf) || signMask != 0)
+	// bytes first and last (inclusive) differ, anything between may or may not
+	void Add(size_t first, size_t last)
 	{
-		return true;
+		if(open && first - end >= mergeGap)
+		{
+			DiffRange r = { start, end };
+			ranges.push_back(r);
+			open = false;
+		}
+
+		if(!open)
+		{
+			start = first;
+			open = true;
+		}
+
+		end = last+1;
 	}
-	
-	return false;
-#elif defined(WIN64)
-	uint64_t *a64 = (uint64_t *)a;
-	uint64_t *b64 = (uint64_t *)b;
 
-	return a64[0] != b64[0] ||
-		   a64[1] != b64[1];
-#else
-	uint32_t *a32 = (uint32_t *)a;
-	uint32_t *b32 = (uint32_t *)b;
+	// a mask of differing bytes in the block starting at base
+	void AddMask(size_t base, uint32_t mask)
+	{
+		Add(base + LowestBit(mask), base + HighestBit(mask));
+	}
 
-	return a32[0] != b32[0] ||
-		   a32[1] != b32[1] ||
-		   a32[2] != b32[2] ||
-		   a32[3] != b32[3];
-#endif
-}
+	void Finish()
+	{
+		if(open)
+		{
+			DiffRange r = { start, end };
+			ranges.push_back(r);
+			open = false;
+		}
+	}
 
-bool FindDiffRange(void *a, void *b, size_t bufSize, size_t &diffStart, size_t &diffEnd)
-{
-	RDCASSERT(uintptr_t(a)%16 == 0);
-	RDCASSERT(uintptr_t(b)%16 == 0);
+	size_t mergeGap;
+	std::vector<DiffRange> &ranges;
+
+	bool open;
+	size_t start, end;
+};
 
-	diffStart = bufSize+1;
-	diffEnd = 0;
+// each of these handles the whole blocks in [0, size) and returns how many
+// bytes were processed, leaving any tail to be compared bytewise.
 
-	size_t alignedSize = bufSize&(~0xf);
-	size_t numVecs = alignedSize/16;
+#if defined(DIFF_SSE2)
 
+static size_t DiffBlocksSSE2(const byte *a, const byte *b, size_t size, DiffRangeBuilder &builder)
+{
 	size_t offs = 0;
 
-	float *aflt = (float *)a;
-	float *bflt = (float *)b;
+	for(; offs+64 <= size; offs += 64)
+	{
+		__m128i eq0 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a+offs+ 0)), _mm_loadu_si128((const __m128i *)(b+offs+ 0)));
+		__m128i eq1 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a+offs+16)), _mm_loadu_si128((const __m128i *)(b+offs+16)));
+		__m128i eq2 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a+offs+32)), _mm_loadu_si128((const __m128i *)(b+offs+32)));
+		__m128i eq3 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a+offs+48)), _mm_loadu_si128((const __m128i *)(b+offs+48)));
+
+		// the common case is a completely unchanged 64 bytes, check that first
+		__m128i all = _mm_and_si128(_mm_and_si128(eq0, eq1), _mm_and_si128(eq2, eq3));
+		if(_mm_movemask_epi8(all) == 0xffff)
+			continue;
 
-	// sweep to find the start of differences
-	for(size_t v=0; v < numVecs; v++)
+		uint32_t lo = ~((uint32_t)_mm_movemask_epi8(eq0) | ((uint32_t)_mm_movemask_epi8(eq1) << 16));
+		uint32_t hi = ~((uint32_t)_mm_movemask_epi8(eq2) | ((uint32_t)_mm_movemask_epi8(eq3) << 16));
+
+		if(lo) builder.AddMask(offs, lo);
+		if(hi) builder.AddMask(offs+32, hi);
+	}
+
+	for(; offs+16 <= size; offs += 16)
 	{
-		if(Vec16NotEqual(aflt, bflt))
-		{
-			diffStart = offs;
-			break;
-		}
+		__m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a+offs)), _mm_loadu_si128((const __m128i *)(b+offs)));
 
-		aflt+=4;bflt+=4;offs+=4*sizeof(float);
+		uint32_t mask = ~(uint32_t)_mm_movemask_epi8(eq) & 0xffff;
+		if(mask) builder.AddMask(offs, mask);
 	}
 
-	// make sure we're byte-accurate, to comply with WRITE_NO_OVERWRITE
-	while(diffStart < bufSize && *((byte *)a + diffStart) == *((byte *)b + diffStart)) diffStart++;
+	return offs;
+}
+
+DIFF_AVX2_FUNC
+static size_t DiffBlocksAVX2(const byte *a, const byte *b, size_t size, DiffRangeBuilder &builder)
+{
+	size_t offs = 0;
 
-	// do we have some unaligned bytes at the end of the buffer?
-	if(bufSize > alignedSize)
+	for(; offs+128 <= size; offs += 128)
 	{
-		size_t numBytes = alignedSize-bufSize;
+		__m256i eq0 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a+offs+ 0)), _mm256_loadu_si256((const __m256i *)(b+offs+ 0)));
+		__m256i eq1 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a+offs+32)), _mm256_loadu_si256((const __m256i *)(b+offs+32)));
+		__m256i eq2 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a+offs+64)), _mm256_loadu_si256((const __m256i *)(b+offs+64)));
+		__m256i eq3 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a+offs+96)), _mm256_loadu_si256((const __m256i *)(b+offs+96)));
+
+		__m256i all = _mm256_and_si256(_mm256_and_si256(eq0, eq1), _mm256_and_si256(eq2, eq3));
+		if((uint32_t)_mm256_movemask_epi8(all) == 0xffffffff)
+			continue;
+
+		uint32_t m0 = ~(uint32_t)_mm256_movemask_epi8(eq0);
+		uint32_t m1 = ~(uint32_t)_mm256_movemask_epi8(eq1);
+		uint32_t m2 = ~(uint32_t)_mm256_movemask_epi8(eq2);
+		uint32_t m3 = ~(uint32_t)_mm256_movemask_epi8(eq3);
+
+		if(m0) builder.AddMask(offs+ 0, m0);
+		if(m1) builder.AddMask(offs+32, m1);
+		if(m2) builder.AddMask(offs+64, m2);
+		if(m3) builder.AddMask(offs+96, m3);
+	}
 
-		// if we haven't even found a start, check in these bytes
-		if(diffStart > bufSize)
-		{
-			offs = bufSize;
-
-			for(size_t by=0; by < numBytes; by++)
-			{
-				if(*((byte *)a + alignedSize + by) != *((byte *)b + alignedSize + by))
-				{
-					diffStart = offs;
-					break;
-				}
-
-				offs++;
-			}
-		}
-		
-		// sweep from the last byte to find the end
-		for(size_t by=0; by < numBytes; by++)
-		{
-			if(*((byte *)a + bufSize-1 - by) != *((byte *)b + bufSize-1 - by))
-			{
-				diffEnd = bufSize-by;
-				break;
-			}
-		}
+	for(; offs+32 <= size; offs += 32)
+	{
+		__m256i eq = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a+offs)), _mm256_loadu_si256((const __m256i *)(b+offs)));
+
+		uint32_t mask = ~(uint32_t)_mm256_movemask_epi8(eq);
+		if(mask) builder.AddMask(offs, mask);
 	}
 
-	// if we haven't found a start, or we've found a start AND and end,
-	// then we're done.
-	if(diffStart > bufSize || diffEnd > 0)
-		return diffStart < bufSize;
-	
-	offs = alignedSize;
+	// avoid SSE/AVX transition penalties in whatever runs next
+	_mm256_zeroupper();
 
-	// sweep from the last __m128
-	aflt = (float *)a + offs/sizeof(float) - 4;
-	bflt = (float *)b + offs/sizeof(float) - 4;
+	return offs;
+}
 
-	for(size_t v=0; v < numVecs; v++)
+static bool CPUHasAVX2()
+{
+#if defined(_MSC_VER)
+	int info[4] = {0};
+
+	__cpuid(info, 0);
+	if(info[0] < 7)
+		return false;
+
+	// the OS must also save the upper halves of the ymm registers
+	__cpuid(info, 1);
+	const int osxsaveAVX = (1<<27) | (1<<28);
+	if((info[2] & osxsaveAVX) != osxsaveAVX || (_xgetbv(0) & 0x6) != 0x6)
+		return false;
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1<<5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#else
+
+static size_t DiffBlocksGeneric(const byte *a, const byte *b, size_t size, DiffRangeBuilder &builder)
+{
+	size_t offs = 0;
+
+	for(; offs+8 <= size; offs += 8)
 	{
-		if(Vec16NotEqual(aflt, bflt))
-		{
-			diffEnd = offs;
-			break;
-		}
+		uint64_t a64, b64;
+		memcpy(&a64, a+offs, sizeof(a64));
+		memcpy(&b64, b+offs, sizeof(b64));
+
+		if(a64 == b64)
+			continue;
 
-		aflt-=4;bflt-=4;offs-=16;
+		uint32_t mask = 0;
+		for(uint32_t i=0; i < 8; i++)
+			if(a[offs+i] != b[offs+i])
+				mask |= 1U<<i;
+
+		builder.AddMask(offs, mask);
 	}
-	
-	// make sure we're byte-accurate, to comply with WRITE_NO_OVERWRITE
-	while(diffEnd > 0 && *((byte *)a + diffEnd - 1) == *((byte *)b + diffEnd - 1)) diffEnd--;
-	
-	// if we found a start then we necessarily found an end
-	return diffStart < bufSize;
+
+	return offs;
+}
+
+#endif // defined(DIFF_SSE2)
+
+void FindDiffRanges(const void *a, const void *b, size_t bufSize, size_t mergeGap, std::vector<DiffRange> &ranges)
+{
+	const byte *abyte = (const byte *)a;
+	const byte *bbyte = (const byte *)b;
+
+	ranges.clear();
+
+	DiffRangeBuilder builder(RDCMAX(mergeGap, (size_t)1), ranges);
+
+	size_t offs = 0;
+
+#if defined(DIFF_SSE2)
+	static const bool avx2 = CPUHasAVX2();
+
+	if(avx2)
+		offs = DiffBlocksAVX2(abyte, bbyte, bufSize, builder);
+	else
+		offs = DiffBlocksSSE2(abyte, bbyte, bufSize, builder);
+#else
+	offs = DiffBlocksGeneric(abyte, bbyte, bufSize, builder);
+#endif
+
+	// bytes left over after the last whole block
+	for(; offs < bufSize; offs++)
+		if(abyte[offs] != bbyte[offs])
+			builder.Add(offs, offs);
+
+	builder.Finish();
+}
+
+bool FindDiffRange(void *a, void *b, size_t bufSize, size_t &diffStart, size_t &diffEnd)
+{
+	std::vector<DiffRange> ranges;
+
+	// a gap larger than the buffer merges everything into one range
+	FindDiffRanges(a, b, bufSize, bufSize+1, ranges);
+
+	if(ranges.empty())
+	{
+		diffStart = bufSize+1;
+		diffEnd = 0;
+		return false;
+	}
+
+	diffStart = ranges[0].start;
+	diffEnd = ranges[0].end;
+	return true;
 }
 
 uint32_t CalcNumMips(int w, int h, int d)
@@ -28,6 +28,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <vector>
+
 #include "globalconfig.h"
 
 /////////////////////////////////////////////////
@@ -90,7 +92,24 @@ inline T AlignUpPtr(T x, A a) { return (T)AlignUp<uintptr_t>( (uintptr_t)x, (uin
 
 #define MAKE_FOURCC(a, b, c, d) (((uint32_t)(d) << 24) | ((uint32_t)(c) << 16) | ((uint32_t)(b) << 8) | (uint32_t)(a))
 
+// a [start, end) range of bytes that differ between two buffers
+struct DiffRange
+{
+	size_t start;
+	size_t end;
+};
+
 bool FindDiffRange(void *a, void *b, size_t bufSize, size_t &diffStart, size_t &diffEnd);
+
+// finds all the ranges of bytes that differ between a and b. Ranges separated by
+// fewer than mergeGap identical bytes are merged, so scattered small writes don't
+// produce a range each. The start and end of each range are byte-accurate, but
+// gaps shorter than the vector width are always merged.
+void FindDiffRanges(const void *a, const void *b, size_t bufSize, size_t mergeGap, std::vector<DiffRange> &ranges);
+
+// the gap the capture drivers use when diffing map writes. Each extra range costs
+// a few bytes in the chunk and a separate copy on replay.
+static const size_t MapDiffMergeGap = 256;
 uint32_t CalcNumMips(int Width, int Height, int Depth);
 
 /////////////////////////////////////////////////
@@ -0,0 +1,174 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2014 Crytek
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+// Standalone benchmark for FindDiffRanges, built with 'make diff_bench'. Runs
+// the diff over the kinds of writes games make to mapped dynamic buffers and
+// reports throughput and how many bytes would be serialised with a single
+// range versus the merged range list. Every result is also checked against a
+// bytewise reference.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/common.h"
+#include "common/timing.h"
+
+static const size_t BufferSize = 4*1024*1024;
+static const uint32_t Iterations = 50;
+
+typedef void (*WritePattern)(byte *buf, size_t size);
+
+static void NoWrites(byte *buf, size_t size)
+{
+}
+
+// one contiguous update, e.g. a streamed vertex range in a ring buffer
+static void SingleBlock(byte *buf, size_t size)
+{
+	memset(buf + size/2, 0xcd, 16*1024);
+}
+
+// per-draw constants: a few hundred bytes every few KB across the buffer
+static void ScatteredConstants(byte *buf, size_t size)
+{
+	srand(1234);
+
+	for(size_t offs = 0; offs + 4096 <= size; offs += 4096*(1 + rand()%8))
+		memset(buf + offs + (rand()%16)*16, rand()&0xff, 64 + (rand()%4)*64);
+}
+
+// particle positions updated in place, 12 bytes of every 32 byte vertex
+static void StridedVertices(byte *buf, size_t size)
+{
+	for(size_t offs = 0; offs + 32 <= size/4; offs += 32)
+		memset(buf + offs, 0x3f, 12);
+}
+
+// a handful of small sparse writes (e.g. indirect args) in a huge buffer
+static void SparseSmall(byte *buf, size_t size)
+{
+	for(size_t offs = 1000; offs + 20 < size; offs += size/7)
+		memset(buf + offs, 0x01, 20);
+}
+
+static void FullRewrite(byte *buf, size_t size)
+{
+	for(size_t i=0; i < size; i++)
+		buf[i] = (byte)(i*7 + 3);
+}
+
+static bool Verify(const byte *a, const byte *b, size_t size, const std::vector<DiffRange> &ranges)
+{
+	size_t r = 0;
+
+	for(size_t i=0; i < size; i++)
+	{
+		while(r < ranges.size() && ranges[r].end <= i)
+			r++;
+
+		bool inRange = r < ranges.size() && ranges[r].start <= i;
+
+		if(a[i] != b[i] && !inRange)
+			return false;
+	}
+
+	for(size_t i=0; i < ranges.size(); i++)
+	{
+		const DiffRange &range = ranges[i];
+
+		// byte-accurate ends
+		if(range.start >= range.end || a[range.start] == b[range.start] || a[range.end-1] == b[range.end-1])
+			return false;
+
+		if(i > 0 && range.start - ranges[i-1].end < MapDiffMergeGap)
+			return false;
+	}
+
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	struct
+	{
+		const char *name;
+		WritePattern func;
+	} patterns[] = {
+		{ "no writes", &NoWrites },
+		{ "single block", &SingleBlock },
+		{ "scattered constants", &ScatteredConstants },
+		{ "strided vertices", &StridedVertices },
+		{ "sparse small", &SparseSmall },
+		{ "full rewrite", &FullRewrite },
+	};
+
+	byte *shadow = new byte[BufferSize];
+	byte *app = new byte[BufferSize];
+
+	int failures = 0;
+
+	for(size_t p=0; p < ARRAY_COUNT(patterns); p++)
+	{
+		for(size_t i=0; i < BufferSize; i++)
+			shadow[i] = (byte)(i*13);
+
+		memcpy(app, shadow, BufferSize);
+		patterns[p].func(app, BufferSize);
+
+		std::vector<DiffRange> ranges;
+		size_t diffStart = 0, diffEnd = 0;
+
+		PerformanceTimer timer;
+		for(uint32_t i=0; i < Iterations; i++)
+			FindDiffRange(app, shadow, BufferSize, diffStart, diffEnd);
+		double singleMS = timer.GetMilliseconds()/Iterations;
+
+		timer.Restart();
+		for(uint32_t i=0; i < Iterations; i++)
+			FindDiffRanges(app, shadow, BufferSize, MapDiffMergeGap, ranges);
+		double multiMS = timer.GetMilliseconds()/Iterations;
+
+		size_t singleBytes = diffEnd > diffStart ? diffEnd - diffStart : 0;
+		size_t multiBytes = 0;
+		for(size_t i=0; i < ranges.size(); i++)
+			multiBytes += ranges[i].end - ranges[i].start;
+
+		bool ok = Verify(app, shadow, BufferSize, ranges) &&
+			(ranges.empty() ? singleBytes == 0 : (diffStart == ranges.front().start && diffEnd == ranges.back().end));
+
+		if(!ok)
+			failures++;
+
+		printf("%-20s %8.3f ms single, %8.3f ms ranges (%.2f GB/s), %9zu -> %9zu bytes in %zu ranges%s\n",
+		       patterns[p].name, singleMS, multiMS, multiMS > 0.0 ? double(BufferSize)/(multiMS*1.0e6) : 0.0,
+		       singleBytes, multiBytes, ranges.size(), ok ? "" : " MISMATCH");
+	}
+
+	delete[] shadow;
+	delete[] app;
+
+	return failures > 0 ? 1 : 0;
+}
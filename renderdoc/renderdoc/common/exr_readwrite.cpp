@@ -0,0 +1,371 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2014 Baldur Karlsson
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "common/common.h"
+#include "common/threading.h"
+#include "os/os_specific.h"
+
+#include "exr_readwrite.h"
+
+#include <ImfInputFile.h>
+#include <ImfOutputFile.h>
+#include <ImfChannelList.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
+#include <ImfThreading.h>
+#include <ImfNamespace.h>
+
+#include <vector>
+
+namespace IMF = OPENEXR_IMF_NAMESPACE;
+
+using std::string;
+using std::vector;
+
+static const uint32_t exr_magic = MAKE_FOURCC(0x76, 0x2f, 0x31, 0x01);
+
+static Threading::CriticalSection exr_pool_lock;
+
+// IMF's worker threads all come from one global pool. Size it for the machine the first time
+// it's needed, then numThreads only limits how many lines a file has in flight.
+static int exr_thread_count(uint32_t numThreads)
+{
+	numThreads = RDCMIN(numThreads, Threading::GetProcessorCount());
+
+	// 0 makes IMF do all the work on the calling thread
+	if(numThreads <= 1)
+		return 0;
+
+	{
+		SCOPED_LOCK(exr_pool_lock);
+
+		if(IMF::globalThreadCount() < (int)Threading::GetProcessorCount())
+			IMF::setGlobalThreadCount((int)Threading::GetProcessorCount());
+	}
+
+	return (int)numThreads;
+}
+
+static const char *exr_channel_suffix(const char *name)
+{
+	// layered files have channels like "diffuse.R", only the last part says what it is
+	const char *c = strrchr(name, '.');
+	return c ? c+1 : name;
+}
+
+// the component a channel goes in going by its name, or -1 if the name doesn't say
+static int exr_channel_component(const char *name)
+{
+	const char *c = exr_channel_suffix(name);
+
+	if(!strcmp(c, "R") || !strcmp(c, "r")) return 0;
+	if(!strcmp(c, "G") || !strcmp(c, "g")) return 1;
+	if(!strcmp(c, "B") || !strcmp(c, "b")) return 2;
+	if(!strcmp(c, "A") || !strcmp(c, "a")) return 3;
+
+	// luminance, or depth
+	if(!strcmp(c, "Y") || !strcmp(c, "D") || !strcmp(c, "Z")) return 0;
+
+	return -1;
+}
+
+static const char *exr_default_channel(const ResourceFormat &fmt, uint32_t comp)
+{
+	const char *rgba[] = { "R", "G", "B", "A" };
+
+	if(fmt.special)
+		return comp == 0 ? "D" : "S";
+
+	if(fmt.compType == eCompType_Depth && fmt.compCount == 1)
+		return "D";
+
+	return rgba[comp];
+}
+
+static IMF::PixelType exr_pixel_type(const ResourceFormat &fmt)
+{
+	if(fmt.compType == eCompType_UInt)
+		return IMF::UINT;
+
+	return fmt.compByteWidth == 2 ? IMF::HALF : IMF::FLOAT;
+}
+
+bool is_exr_file(FILE *f)
+{
+	FileIO::fseek64(f, 0, SEEK_SET);
+
+	uint32_t magic = 0;
+	FileIO::fread(&magic, sizeof(magic), 1, f);
+
+	FileIO::fseek64(f, 0, SEEK_SET);
+
+	return magic == exr_magic;
+}
+
+bool is_exr_format(const ResourceFormat &fmt)
+{
+	if(fmt.special)
+		return fmt.specialFormat == eSpecial_D32S8;
+
+	if(fmt.compCount < 1 || fmt.compCount > 4)
+		return false;
+
+	if(fmt.compType == eCompType_Float)
+		return fmt.compByteWidth == 2 || fmt.compByteWidth == 4;
+
+	// D32 is a float, the 16 and 24 bit depth formats are normalised
+	if(fmt.compType == eCompType_Depth || fmt.compType == eCompType_UInt)
+		return fmt.compByteWidth == 4;
+
+	return false;
+}
+
+exr_data load_exr_from_file(const char *filename, uint32_t numThreads)
+{
+	exr_data ret;
+	ret.width = ret.height = 0;
+	ret.compression = exr_compress_none;
+	ret.data = NULL;
+
+	try
+	{
+		IMF::InputFile file(filename, exr_thread_count(numThreads));
+
+		const IMF::Header &header = file.header();
+
+		int minX = header.dataWindow().min.x;
+		int minY = header.dataWindow().min.y;
+
+		ret.width = header.dataWindow().max.x - minX + 1;
+		ret.height = header.dataWindow().max.y - minY + 1;
+
+		if(header.compression() <= IMF::PIZ_COMPRESSION)
+			ret.compression = (exr_compression)header.compression();
+
+		struct channel
+		{
+			const char *name;
+			IMF::PixelType type;
+		};
+
+		vector<channel> channels;
+
+		for(IMF::ChannelList::ConstIterator it = header.channels().begin(); it != header.channels().end(); ++it)
+		{
+			if(it.channel().xSampling != 1 || it.channel().ySampling != 1)
+			{
+				RDCWARN("Skipping subsampled channel '%s' in %s", it.name(), filename);
+				continue;
+			}
+
+			channel c = { it.name(), it.channel().type };
+			channels.push_back(c);
+		}
+
+		if(channels.empty())
+		{
+			RDCERR("No channels to read in EXR file %s", filename);
+			return ret;
+		}
+
+		// the component each channel is read into, with the type it's read as
+		const char *compNames[4] = { NULL, NULL, NULL, NULL };
+		IMF::PixelType type = channels[0].type;
+
+		// channels are listed sorted by name, so a depth-stencil pair is always D then S
+		if(channels.size() == 2 && channels[1].type == IMF::UINT &&
+		   !strcmp(exr_channel_suffix(channels[0].name), "D") &&
+		   !strcmp(exr_channel_suffix(channels[1].name), "S"))
+		{
+			ret.format.special = true;
+			ret.format.specialFormat = eSpecial_D32S8;
+			ret.format.compCount = 2;
+			ret.format.compByteWidth = 4;
+			ret.format.compType = eCompType_Depth;
+
+			compNames[0] = channels[0].name;
+			compNames[1] = channels[1].name;
+		}
+		else
+		{
+			// named R/G/B/A channels go where they say, anything else (e.g. a single depth
+			// channel) fills the remaining components in order
+			vector<const char *> unplaced;
+
+			for(size_t i=0; i < channels.size(); i++)
+			{
+				int comp = exr_channel_component(channels[i].name);
+
+				if(comp >= 0 && compNames[comp] == NULL)
+					compNames[comp] = channels[i].name;
+				else
+					unplaced.push_back(channels[i].name);
+
+				// mixed types are all read as float, IMF converts
+				if(channels[i].type != type)
+					type = IMF::FLOAT;
+			}
+
+			for(size_t i=0; i < unplaced.size(); i++)
+			{
+				int comp = 0;
+				while(comp < 4 && compNames[comp] != NULL)
+					comp++;
+
+				if(comp < 4)
+					compNames[comp] = unplaced[i];
+				else
+					RDCWARN("Dropping channel '%s' of %s, no free component", unplaced[i], filename);
+			}
+
+			uint32_t compCount = 0;
+			for(uint32_t c=0; c < 4; c++)
+				if(compNames[c])
+					compCount = c+1;
+
+			// there are no 3-component textures for most types, so RGB gets an opaque alpha
+			if(compCount == 3)
+				compCount = 4;
+
+			ret.format.special = false;
+			ret.format.specialFormat = eSpecial_Unknown;
+			ret.format.compCount = compCount;
+			ret.format.compByteWidth = (type == IMF::HALF) ? 2 : 4;
+			ret.format.compType = (type == IMF::UINT) ? eCompType_UInt : eCompType_Float;
+		}
+
+		size_t compSize = ret.format.compByteWidth;
+		size_t pixelSize = ret.format.special ? 8 : compSize*ret.format.compCount;
+		size_t rowPitch = pixelSize*ret.width;
+
+		ret.data = new byte[rowPitch*ret.height];
+		memset(ret.data, 0, rowPitch*ret.height);
+
+		if(!ret.format.special && ret.format.compCount == 4 && compNames[3] == NULL && type != IMF::UINT)
+		{
+			for(size_t p=0; p < size_t(ret.width)*size_t(ret.height); p++)
+			{
+				byte *alpha = ret.data + p*pixelSize + 3*compSize;
+
+				if(type == IMF::HALF)
+					*(uint16_t *)alpha = 0x3c00; // 1.0
+				else
+					*(float *)alpha = 1.0f;
+			}
+		}
+
+		IMF::FrameBuffer frameBuffer;
+
+		for(uint32_t c=0; c < 4; c++)
+		{
+			if(compNames[c] == NULL)
+				continue;
+
+			ret.channels[c] = compNames[c];
+
+			IMF::PixelType compType = type;
+			if(ret.format.special)
+				compType = (c == 0) ? IMF::FLOAT : IMF::UINT;
+
+			// slices are addressed by absolute pixel position, so offset by the data window origin
+			char *base = (char *)ret.data + c*compSize - minX*pixelSize - minY*rowPitch;
+
+			frameBuffer.insert(compNames[c], IMF::Slice(compType, base, pixelSize, rowPitch));
+		}
+
+		file.setFrameBuffer(frameBuffer);
+		file.readPixels(header.dataWindow().min.y, header.dataWindow().max.y);
+	}
+	catch(const std::exception &e)
+	{
+		RDCERR("Error loading EXR file %s: '%s'", filename, e.what());
+
+		SAFE_DELETE_ARRAY(ret.data);
+	}
+
+	return ret;
+}
+
+bool write_exr_to_file(const char *filename, const exr_data &data, uint32_t numThreads)
+{
+	if(!is_exr_format(data.format))
+	{
+		RDCERR("Format can't be written to EXR directly, it must be converted first");
+		return false;
+	}
+
+	// D32S8 is a 4-byte depth then the stencil, padded to 8 bytes
+	uint32_t compCount = data.format.special ? 2 : data.format.compCount;
+	size_t compSize = data.format.special ? 4 : data.format.compByteWidth;
+	size_t pixelSize = data.format.special ? 8 : compSize*compCount;
+	size_t rowPitch = pixelSize*data.width;
+
+	byte *pixels = data.data;
+
+	// the 24 bits after the stencil aren't defined, mask them off so S is just the stencil value
+	if(data.format.special)
+	{
+		pixels = new byte[rowPitch*data.height];
+		memcpy(pixels, data.data, rowPitch*data.height);
+
+		for(size_t p=0; p < size_t(data.width)*size_t(data.height); p++)
+			*(uint32_t *)(pixels + p*pixelSize + 4) &= 0xff;
+	}
+
+	bool success = true;
+
+	try
+	{
+		IMF::Header header(data.width, data.height);
+		header.compression() = (IMF::Compression)data.compression;
+
+		IMF::FrameBuffer frameBuffer;
+
+		for(uint32_t c=0; c < compCount; c++)
+		{
+			const char *name = data.channels[c].empty() ? exr_default_channel(data.format, c) : data.channels[c].c_str();
+
+			IMF::PixelType type = exr_pixel_type(data.format);
+			if(data.format.special)
+				type = (c == 0) ? IMF::FLOAT : IMF::UINT;
+
+			header.channels().insert(name, IMF::Channel(type));
+			frameBuffer.insert(name, IMF::Slice(type, (char *)pixels + c*compSize, pixelSize, rowPitch));
+		}
+
+		IMF::OutputFile file(filename, header, exr_thread_count(numThreads));
+		file.setFrameBuffer(frameBuffer);
+		file.writePixels(data.height);
+	}
+	catch(const std::exception &e)
+	{
+		RDCERR("Error saving EXR file %s: '%s'", filename, e.what());
+		success = false;
+	}
+
+	if(pixels != data.data)
+		delete[] pixels;
+
+	return success;
+}
@@ -0,0 +1,65 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2014 Baldur Karlsson
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include "api/replay/renderdoc_replay.h"
+
+#include <string>
+
+// same values as OpenEXR's Imf::Compression, only the lossless ones
+enum exr_compression
+{
+	exr_compress_none = 0,
+	exr_compress_rle = 1,
+	exr_compress_zips = 2,
+	exr_compress_zip = 3,
+	exr_compress_piz = 4,
+};
+
+struct exr_data
+{
+	int width;
+	int height;
+
+	// half, float or 32-bit uint components (1, 2 or 4 of them), or eSpecial_D32S8 which is
+	// stored as a float "D" channel and uint "S" channel.
+	ResourceFormat format;
+
+	// name of the channel for each component. Empty names are written as R/G/B/A, or D for a
+	// single depth component. Filled in with the file's channel names on load.
+	std::string channels[4];
+
+	exr_compression compression;
+
+	// width*height tightly packed pixels in the above format
+	byte *data;
+};
+
+extern bool is_exr_file(FILE *f);
+// whether format can be written directly, without converting to float first
+extern bool is_exr_format(const ResourceFormat &format);
+// numThreads includes the calling thread - 1 reads or writes entirely on this thread
+extern exr_data load_exr_from_file(const char *filename, uint32_t numThreads);
+extern bool write_exr_to_file(const char *filename, const exr_data &data, uint32_t numThreads);
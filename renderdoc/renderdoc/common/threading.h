@@ -43,6 +43,32 @@ class ScopedLock
 		CriticalSection *m_CS;
 };
 
+class ScopedReadLock
+{
+	public:
+		ScopedReadLock(RWLock &rw)
+			: m_RW(&rw)
+		{ m_RW->ReadLock(); }
+		~ScopedReadLock()
+		{ m_RW->ReadUnlock(); }
+
+	private:
+		RWLock *m_RW;
+};
+
+class ScopedWriteLock
+{
+	public:
+		ScopedWriteLock(RWLock &rw)
+			: m_RW(&rw)
+		{ m_RW->WriteLock(); }
+		~ScopedWriteLock()
+		{ m_RW->WriteUnlock(); }
+
+	private:
+		RWLock *m_RW;
+};
+
 class TryScopedLock
 {
 	public:
@@ -65,3 +91,5 @@ class TryScopedLock
 };
 
 #define SCOPED_LOCK(cs) Threading::ScopedLock CONCAT(scopedlock, __LINE__)(cs);
+#define SCOPED_READLOCK(rw) Threading::ScopedReadLock CONCAT(scopedreadlock, __LINE__)(rw);
+#define SCOPED_WRITELOCK(rw) Threading::ScopedWriteLock CONCAT(scopedwritelock, __LINE__)(rw);
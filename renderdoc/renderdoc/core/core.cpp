@@ -37,21 +37,7 @@
 
 #include "stb/stb_image.h"
 #include "common/dds_readwrite.h"
-
-// not provided by tinyexr, just do by hand
-bool is_exr_file(FILE *f)
-{
-	FileIO::fseek64(f, 0, SEEK_SET);
-
-	const uint32_t openexr_magic = MAKE_FOURCC(0x76, 0x2f, 0x31, 0x01);
-
-	uint32_t magic = 0;
-	FileIO::fread(&magic, sizeof(magic), 1, f);
-
-	FileIO::fseek64(f, 0, SEEK_SET);
-
-	return magic == openexr_magic;
-}
+#include "common/exr_readwrite.h"
 
 template<>
 string ToStrHelper<false, RDCDriver>::Get(const RDCDriver &el)
@@ -163,6 +149,7 @@ RenderDoc::RenderDoc()
 	m_CapturesActive = 0;
 
 	m_Replay = false;
+	m_InitialContentsBudget = 0;
 
 	m_Cap = false;
 
@@ -181,6 +168,13 @@ RenderDoc::RenderDoc()
 	
 	m_RemoteServerThreadShutdown = false;
 	m_RemoteClientThreadShutdown = false;
+
+	m_WritesInFlight = 0;
+	m_WriterThread = 0;
+	m_WriterThreadShutdown = false;
+
+	m_PeriodicLastFrame = 0;
+	m_CaptureIndex = 0;
 }
 
 void RenderDoc::Initialise()
@@ -273,6 +267,30 @@ RenderDoc::~RenderDoc()
 	for(auto it=m_ShutdownFunctions.begin(); it != m_ShutdownFunctions.end(); ++it)
 		(*it)();
 
+	if(m_WriterThread)
+	{
+		m_WriterThreadShutdown = true;
+		// can't join while module unloading, so write anything still queued on this thread
+		// instead. A capture the writer thread is in the middle of may be lost.
+		while(true)
+		{
+			Serialiser *fileSerialiser = NULL;
+
+			{
+				SCOPED_LOCK(m_WriterLock);
+				if(m_PendingWrites.empty())
+					break;
+				fileSerialiser = m_PendingWrites.front();
+				m_PendingWrites.erase(m_PendingWrites.begin());
+			}
+
+			WriteCapture(fileSerialiser);
+		}
+
+		Threading::CloseThread(m_WriterThread);
+		m_WriterThread = 0;
+	}
+
 	for(size_t i=0; i < m_Captures.size(); i++)
 	{
 		if(m_Captures[i].retrieved)
@@ -307,6 +325,16 @@ void RenderDoc::Shutdown()
 	{
 		UnloadCrashHandler();
 	}
+
+	if(m_WriterThread)
+	{
+		// the writer thread only exits once its queue is empty, so joining
+		// guarantees every pending capture has made it to disk
+		m_WriterThreadShutdown = true;
+		Threading::JoinThread(m_WriterThread);
+		Threading::CloseThread(m_WriterThread);
+		m_WriterThread = 0;
+	}
 	
 	if(m_RemoteThread)
 	{
@@ -439,6 +467,9 @@ void RenderDoc::Tick()
 		TriggerCapture();
 	}
 
+	if(!IsPeriodicCapturing())
+		m_PeriodicTimer.Restart();
+
 	prev_focus = cur_focus;
 	prev_cap = cur_cap;
 }
@@ -449,6 +480,9 @@ bool RenderDoc::ShouldTriggerCapture(uint32_t frameNumber)
 
 	m_Cap = false;
 
+	if(PeriodicCaptureDue(frameNumber))
+		ret = true;
+
 	set<uint32_t> frames;
 	frames.swap(m_QueuedFrameCaptures);
 	for(auto it=frames.begin(); it != frames.end(); ++it)
@@ -472,6 +506,119 @@ bool RenderDoc::ShouldTriggerCapture(uint32_t frameNumber)
 	return ret;
 }
 
+bool RenderDoc::PeriodicCaptureDue(uint32_t frameNumber)
+{
+	if(!IsPeriodicCapturing())
+		return false;
+
+	// frame counter could have been reset e.g. by a new device
+	if(frameNumber < m_PeriodicLastFrame)
+		m_PeriodicLastFrame = frameNumber;
+
+	const uint32_t frames = m_Options.PeriodicCaptureFrames;
+	const uint32_t ms = m_Options.PeriodicCaptureMS;
+
+	bool due = false;
+
+	if(frames > 0 && frameNumber - m_PeriodicLastFrame >= frames)
+		due = true;
+
+	if(ms > 0 && m_PeriodicTimer.GetMilliseconds() >= double(ms))
+		due = true;
+
+	if(!due)
+		return false;
+
+	// whether or not we capture, the next capture is scheduled a full interval from
+	// now. Catching up on skipped captures would only produce bursts of captures
+	// once the writer frees up.
+	m_PeriodicLastFrame = frameNumber;
+	m_PeriodicTimer.Restart();
+
+	// never stall the application waiting for the writer, just skip this one
+	if(GetPendingCaptureWrites() >= RDCMAX(m_Options.MaxPendingCaptures, 1U))
+	{
+		SCOPED_LOCK(m_WriterLock);
+		m_CaptureStats.skippedBusy++;
+
+		RDCLOG("Skipping periodic capture at frame %u, %u captures still being written", frameNumber, m_WritesInFlight);
+		return false;
+	}
+
+	if(m_Options.MinFreeDiskMB > 0)
+	{
+		// check where this capture will actually go. Its directory might not have been
+		// created yet, so walk up to the nearest one that exists
+		string dir = dirname(GetCaptureFilename(frameNumber));
+		uint64_t freeBytes = FileIO::GetFreeDiskSpace(dir);
+
+		while(freeBytes == UINT64_MAX)
+		{
+			string parent = dirname(dir);
+			if(parent.empty() || parent == dir)
+				break;
+
+			dir = parent;
+			freeBytes = FileIO::GetFreeDiskSpace(dir);
+		}
+
+		// if we can't tell how much space there is, don't skip
+		if(freeBytes < uint64_t(m_Options.MinFreeDiskMB)*1024*1024)
+		{
+			SCOPED_LOCK(m_WriterLock);
+			m_CaptureStats.skippedDiskSpace++;
+
+			RDCWARN("Skipping periodic capture at frame %u, only %llu MB free on disk", frameNumber, freeBytes/(1024*1024));
+			return false;
+		}
+	}
+
+	return true;
+}
+
+string RenderDoc::GetCaptureFilename(uint32_t frameNum)
+{
+	string pattern = m_Options.PeriodicCaptureFilename;
+
+	if(pattern.empty())
+		return StringFormat::Fmt("%s_frame%u.rdc", m_LogFile.c_str(), frameNum);
+
+	// without either token every capture would get the same name and overwrite the
+	// previous one, so number them before the extension
+	if(pattern.find("{frame}") == string::npos && pattern.find("{index}") == string::npos)
+	{
+		if(pattern.length() >= 4 && pattern.substr(pattern.length()-4) == ".rdc")
+			pattern.insert(pattern.length()-4, "_{index}");
+		else
+			pattern += "_{index}";
+	}
+
+	// substitute {frame} with the frame number and {index} with the zero-padded
+	// count of captures made so far, so that names sort in capture order
+	const char *tokens[] = { "{frame}", "{index}" };
+	string values[] = { StringFormat::Fmt("%u", frameNum), StringFormat::Fmt("%06u", m_CaptureIndex) };
+
+	for(size_t i=0; i < ARRAY_COUNT(tokens); i++)
+	{
+		size_t offs = pattern.find(tokens[i]);
+		while(offs != string::npos)
+		{
+			pattern.replace(offs, strlen(tokens[i]), values[i]);
+			offs = pattern.find(tokens[i], offs + values[i].length());
+		}
+	}
+
+	// relative patterns are placed alongside the log file
+	bool absolute = (pattern[0] == '/' || pattern[0] == '\\' || (pattern.length() > 1 && pattern[1] == ':'));
+	if(!absolute)
+		pattern = dirname(m_LogFile) + "/" + pattern;
+
+	if(pattern.length() < 4 || pattern.substr(pattern.length()-4) != ".rdc")
+		pattern += ".rdc";
+
+	return pattern;
+}
+
 Serialiser *RenderDoc::OpenWriteSerialiser(uint32_t frameNum, RDCInitParams *params, void *thpixels, size_t thlen, uint32_t thwidth, uint32_t thheight)
 {
 	RDCASSERT(m_CurrentDriver != RDC_Unknown);
@@ -482,10 +629,15 @@ Serialiser *RenderDoc::OpenWriteSerialiser(uint32_t frameNum, RDCInitParams *par
 	const bool debugSerialiser = true;
 #endif
 
-	m_CurrentLogFile = StringFormat::Fmt("%s_frame%u.rdc", m_LogFile.c_str(), frameNum);
+	string logFile = GetCaptureFilename(frameNum);
+	m_CaptureIndex++;
 
-	Serialiser *fileSerialiser = new Serialiser(m_CurrentLogFile.c_str(), Serialiser::WRITING, debugSerialiser);
-	
+	FileIO::CreateParentDirectory(logFile);
+
+	Serialiser *fileSerialiser = new Serialiser(logFile.c_str(), Serialiser::WRITING, debugSerialiser);
+
+	if(m_Options.SharedInitialContents)
+		fileSerialiser->SetExternalChunkStore(dirname(logFile) + "/" + Serialiser::ExternalStoreName);
 	
 	Serialiser *chunkSerialiser = new Serialiser(NULL, Serialiser::WRITING, debugSerialiser);
 
@@ -528,6 +680,133 @@ Serialiser *RenderDoc::OpenWriteSerialiser(uint32_t frameNum, RDCInitParams *par
 	return fileSerialiser;
 }
 
+void RenderDoc::FinishWriteSerialiser(Serialiser *fileSerialiser)
+{
+	// resource records can be modified or freed as soon as we return, so the
+	// serialiser must own everything it's going to write
+	fileSerialiser->DetachChunks();
+
+	const uint32_t maxInFlight = RDCMAX(m_Options.MaxPendingCaptures, 1U);
+
+	{
+		SCOPED_LOCK(m_WriterLock);
+
+		if(m_WriterThread == 0)
+		{
+			m_WriterThreadShutdown = false;
+			m_WriterThread = Threading::CreateThread(CaptureWriterThread, NULL);
+		}
+	}
+
+	if(m_WriterThread == 0)
+	{
+		RDCWARN("Couldn't create capture writer thread, writing synchronously");
+
+		{
+			SCOPED_LOCK(m_WriterLock);
+			m_WritesInFlight++;
+		}
+
+		WriteCapture(fileSerialiser);
+		return;
+	}
+
+	// each capture waiting to be written holds all of its chunk data in memory, so
+	// bound how many we allow. If the writer has fallen that far behind we have no
+	// option but to stall here until it catches up.
+	bool waited = false;
+
+	while(true)
+	{
+		{
+			SCOPED_LOCK(m_WriterLock);
+
+			if(m_WritesInFlight < maxInFlight)
+			{
+				m_PendingWrites.push_back(fileSerialiser);
+				m_WritesInFlight++;
+				break;
+			}
+		}
+
+		if(!waited)
+			RDCLOG("Waiting for %u pending capture(s) to finish writing", maxInFlight);
+		waited = true;
+
+		Threading::Sleep(1);
+	}
+}
+
+uint32_t RenderDoc::GetPendingCaptureWrites()
+{
+	SCOPED_LOCK(m_WriterLock);
+	return m_WritesInFlight;
+}
+
+void RenderDoc::CaptureWriterThread(void *s)
+{
+	Threading::KeepModuleAlive();
+
+	RenderDoc &rdoc = RenderDoc::Inst();
+
+	while(true)
+	{
+		Serialiser *fileSerialiser = NULL;
+
+		{
+			SCOPED_LOCK(rdoc.m_WriterLock);
+
+			if(!rdoc.m_PendingWrites.empty())
+			{
+				fileSerialiser = rdoc.m_PendingWrites.front();
+				rdoc.m_PendingWrites.erase(rdoc.m_PendingWrites.begin());
+			}
+		}
+
+		if(fileSerialiser == NULL)
+		{
+			// only exit once the queue is drained
+			if(rdoc.m_WriterThreadShutdown)
+				break;
+
+			Threading::Sleep(5);
+			continue;
+		}
+
+		rdoc.WriteCapture(fileSerialiser);
+	}
+
+	Threading::ReleaseModuleExitThread();
+}
+
+void RenderDoc::WriteCapture(Serialiser *fileSerialiser)
+{
+	string logfile = fileSerialiser->GetFilename();
+
+	fileSerialiser->FlushToDisk();
+
+	bool success = !fileSerialiser->HasError();
+	uint64_t written = fileSerialiser->GetWrittenSize();
+	uint64_t shared = fileSerialiser->GetExternalReferencedSize() - fileSerialiser->GetExternalWrittenSize();
+
+	SAFE_DELETE(fileSerialiser);
+
+	if(success)
+		SuccessfullyWrittenLog(logfile);
+	else
+		RDCERR("Failed to write capture to %s", logfile.c_str());
+
+	SCOPED_LOCK(m_WriterLock);
+	m_WritesInFlight--;
+
+	if(success)
+	{
+		m_CaptureStats.captured++;
+		m_CaptureStats.bytesWritten += written;
+		m_CaptureStats.bytesShared += shared;
+	}
+}
+
 ReplayCreateStatus RenderDoc::FillInitParams(const char *logFile, RDCDriver &driverType, string &driverName, RDCInitParams *params)
 {
 	Serialiser ser(logFile, Serialiser::READING, true);
@@ -738,6 +1017,14 @@ void RenderDoc::SetCaptureOptions(const CaptureOptions &opts)
 	m_Options = opts;
 }
 
+Callstack::Stackwalk *RenderDoc::CollectCallstack() const
+{
+	if(m_Options.FramePointerCallstacks)
+		return Callstack::CollectFramePointers();
+
+	return Callstack::Collect();
+}
+
 void RenderDoc::SetLogFile(const char *logFile)
 {
 	m_LogFile = logFile;
@@ -771,11 +1058,11 @@ void RenderDoc::SetProgress(LoadProgressSection section, float delta)
 	*m_ProgressPtr = progress;
 }
 
-void RenderDoc::SuccessfullyWrittenLog()
+void RenderDoc::SuccessfullyWrittenLog(const string &logfile)
 {
-	RDCLOG("Written to disk: %s", m_CurrentLogFile.c_str());	
+	RDCLOG("Written to disk: %s", logfile.c_str());	
 
-	CaptureData cap(m_CurrentLogFile, Timing::GetUnixTimestamp());
+	CaptureData cap(logfile, Timing::GetUnixTimestamp());
 	{
 		SCOPED_LOCK(m_CaptureLock);
 		m_Captures.push_back(cap);
@@ -46,9 +46,7 @@ class Chunk;
 #include "api/replay/replay_enums.h"
 #include "os/os_specific.h"
 #include "common/threading.h"
-
-// not provided by tinyexr, just do by hand
-bool is_exr_file(FILE *f);
+#include "common/timing.h"
 
 struct ICrashHandler
 {
@@ -143,6 +141,21 @@ struct CaptureData
 	bool retrieved;
 };
 
+struct CaptureStats
+{
+	CaptureStats() : captured(0), skippedBusy(0), skippedDiskSpace(0), bytesWritten(0), bytesShared(0) {}
+
+	// captures successfully written to disk
+	uint32_t captured;
+	// periodic captures skipped because too many captures were still being written
+	uint32_t skippedBusy;
+	// periodic captures skipped because the capture disk was below MinFreeDiskMB
+	uint32_t skippedDiskSpace;
+	uint64_t bytesWritten;
+	// initial contents that were already in the shared store and didn't need to be written
+	uint64_t bytesShared;
+};
+
 enum LoadProgressSection
 {
 	DebugManagerInit,
@@ -185,17 +198,40 @@ class RenderDoc
 		void SetReplayApp(bool replay) { m_Replay = replay; }
 		bool IsReplayApp() const { return m_Replay; }
 
+		// bytes of initial contents to keep in memory while replaying logs opened from now on,
+		// 0 to keep them all. See ResourceManager::SetInitialContentsBudget
+		void SetInitialContentsBudget(uint64_t budget) { m_InitialContentsBudget = budget; }
+		uint64_t GetInitialContentsBudget() const { return m_InitialContentsBudget; }
+
 		void BecomeReplayHost(volatile uint32_t &killReplay);
 
 		void SetCaptureOptions(const CaptureOptions &opts);
 		const CaptureOptions &GetCaptureOptions() const { return m_Options; }
 
+		// collects a callstack for the current thread, using whichever walk the
+		// capture options ask for
+		Callstack::Stackwalk *CollectCallstack() const;
+
 		void RecreateCrashHandler();
 		void UnloadCrashHandler();
 		ICrashHandler *GetCrashHandler() const { return m_ExHandler; }
 
 		Serialiser *OpenWriteSerialiser(uint32_t frameNum, RDCInitParams *params, void *thpixels, size_t thlen, uint32_t thwidth, uint32_t thheight);
-		void SuccessfullyWrittenLog();
+
+		// takes ownership of a serialiser returned from OpenWriteSerialiser once all chunks have
+		// been inserted. The compression and disk write happens on a background thread, and the
+		// capture is added to GetCaptures() when it has been written. If too many captures are
+		// still waiting to be written this will block until one completes.
+		void FinishWriteSerialiser(Serialiser *fileSerialiser);
+		uint32_t GetPendingCaptureWrites();
+
+		CaptureStats GetCaptureStats()
+		{
+			SCOPED_LOCK(m_WriterLock);
+			return m_CaptureStats;
+		}
+
+		bool IsPeriodicCapturing() const { return m_Options.PeriodicCaptureFrames > 0 || m_Options.PeriodicCaptureMS > 0; }
 
 		void AddChildProcess(uint32_t pid, uint32_t ident)
 		{
@@ -291,6 +327,7 @@ class RenderDoc
 		static RenderDoc *m_Inst;
 
 		bool m_Replay;
+		uint64_t m_InitialContentsBudget;
 
 		bool m_Cap;
 
@@ -301,12 +338,18 @@ class RenderDoc
 
 		string m_Target;
 		string m_LogFile;
-		string m_CurrentLogFile;
 		CaptureOptions m_Options;
 		uint32_t m_Overlay;
 
 		set<uint32_t> m_QueuedFrameCaptures;
 
+		uint32_t m_PeriodicLastFrame;
+		PerformanceTimer m_PeriodicTimer;
+		uint32_t m_CaptureIndex;
+
+		bool PeriodicCaptureDue(uint32_t frameNumber);
+		string GetCaptureFilename(uint32_t frameNum);
+
 		uint32_t m_RemoteIdent;
 		Threading::ThreadHandle m_RemoteThread;
 
@@ -322,6 +365,17 @@ class RenderDoc
 		Threading::CriticalSection m_ChildLock;
 		vector< pair<uint32_t, uint32_t> > m_Children;
 
+		Threading::CriticalSection m_WriterLock;
+		vector<Serialiser *> m_PendingWrites;
+		uint32_t m_WritesInFlight;
+		Threading::ThreadHandle m_WriterThread;
+		volatile bool m_WriterThreadShutdown;
+		CaptureStats m_CaptureStats;
+
+		static void CaptureWriterThread(void *s);
+		void WriteCapture(Serialiser *fileSerialiser);
+		void SuccessfullyWrittenLog(const string &logfile);
+
 		map<RDCDriver, string> m_DriverNames;
 		map<RDCDriver, ReplayDriverProvider> m_ReplayDriverProviders;
 		map<RDCDriver, RemoteDriverProvider> m_RemoteDriverProviders;
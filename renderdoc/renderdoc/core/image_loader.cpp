@@ -0,0 +1,674 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2014 Baldur Karlsson
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#include "core/core.h"
+#include "core/image_loader.h"
+#include "serialise/string_utils.h"
+
+#include "maths/half_convert.h"
+
+#include "stb/stb_image.h"
+#include "common/dds_readwrite.h"
+#include "common/exr_readwrite.h"
+
+#include <algorithm>
+#include <deque>
+
+// rows of the image handed to a worker at a time, when converting or building mips
+static const uint32_t RowsPerBlock = 64;
+
+// decoded neighbours kept around waiting to be viewed
+static const size_t MaxPrefetchedImages = 4;
+
+LoadedImage::LoadedImage()
+{
+	width = height = depth = 1;
+	slices = mips = 1;
+	cubemap = false;
+}
+
+LoadedImage::~LoadedImage()
+{
+	for(size_t i=0; i < subdata.size(); i++)
+		delete[] subdata[i];
+}
+
+uint64_t LoadedImage::GetByteSize() const
+{
+	uint64_t ret = 0;
+	for(size_t i=0; i < subsizes.size(); i++)
+		ret += subsizes[i];
+	return ret;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Worker threads
+
+struct ParallelJob
+{
+	void (*func)(void *param, uint32_t idx);
+	void *param;
+	int32_t count;
+	volatile int32_t next;
+};
+
+static void ParallelWorker(void *p)
+{
+	ParallelJob *job = (ParallelJob *)p;
+
+	for(;;)
+	{
+		int32_t idx = Atomic::Inc32(&job->next) - 1;
+
+		if(idx >= job->count)
+			break;
+
+		job->func(job->param, (uint32_t)idx);
+	}
+}
+
+// calls func(param, i) for every i < count, spread over up to maxThreads threads (including
+// this one) and returns when they're all done.
+static void ParallelFor(uint32_t count, uint32_t maxThreads, void (*func)(void *param, uint32_t idx), void *param)
+{
+	ParallelJob job;
+	job.func = func;
+	job.param = param;
+	job.count = (int32_t)count;
+	job.next = 0;
+
+	uint32_t numThreads = RDCMAX(1U, RDCMIN(RDCMIN(Threading::GetProcessorCount(), maxThreads), count));
+
+	vector<Threading::ThreadHandle> threads;
+	for(uint32_t i=1; i < numThreads; i++)
+		threads.push_back(Threading::CreateThread(&ParallelWorker, &job));
+
+	ParallelWorker(&job);
+
+	for(size_t i=0; i < threads.size(); i++)
+	{
+		Threading::JoinThread(threads[i]);
+		Threading::CloseThread(threads[i]);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Format conversion and mip generation
+
+static ResourceFormat MakeFormat(uint32_t compCount, uint32_t compByteWidth, FormatComponentType compType)
+{
+	ResourceFormat ret;
+	ret.special = false;
+	ret.compCount = compCount;
+	ret.compByteWidth = compByteWidth;
+	ret.compType = compType;
+	return ret;
+}
+
+struct BuildMip
+{
+	const byte *src;
+	uint32_t srcWidth, srcHeight;
+	byte *dst;
+	uint32_t dstWidth, dstHeight;
+	uint32_t compCount;
+	uint32_t compByteWidth;
+	FormatComponentType compType;
+};
+
+static void BuildMipRows(void *param, uint32_t block)
+{
+	BuildMip *job = (BuildMip *)param;
+
+	uint32_t rowStart = block*RowsPerBlock;
+	uint32_t rowEnd = RDCMIN(rowStart + RowsPerBlock, job->dstHeight);
+
+	uint32_t n = job->compCount;
+
+	for(uint32_t y=rowStart; y < rowEnd; y++)
+	{
+		// odd dimensions just repeat the last row/column
+		uint32_t y0 = RDCMIN(y*2, job->srcHeight-1);
+		uint32_t y1 = RDCMIN(y*2+1, job->srcHeight-1);
+
+		for(uint32_t x=0; x < job->dstWidth; x++)
+		{
+			uint32_t x0 = RDCMIN(x*2, job->srcWidth-1);
+			uint32_t x1 = RDCMIN(x*2+1, job->srcWidth-1);
+
+			if(job->compType == eCompType_UInt)
+			{
+				// integer data like IDs can't be averaged, take the top-left texel
+				const uint32_t *src = (const uint32_t *)job->src;
+				uint32_t *dst = (uint32_t *)job->dst;
+
+				for(uint32_t c=0; c < n; c++)
+					dst[(y*job->dstWidth + x)*n + c] = src[(y0*job->srcWidth + x0)*n + c];
+			}
+			else if(job->compType == eCompType_Float && job->compByteWidth == 2)
+			{
+				const uint16_t *src = (const uint16_t *)job->src;
+				uint16_t *dst = (uint16_t *)job->dst;
+
+				for(uint32_t c=0; c < n; c++)
+					dst[(y*job->dstWidth + x)*n + c] = ConvertToHalf(0.25f*(ConvertFromHalf(src[(y0*job->srcWidth + x0)*n + c]) + ConvertFromHalf(src[(y0*job->srcWidth + x1)*n + c]) +
+					                                                        ConvertFromHalf(src[(y1*job->srcWidth + x0)*n + c]) + ConvertFromHalf(src[(y1*job->srcWidth + x1)*n + c])));
+			}
+			else if(job->compType == eCompType_Float)
+			{
+				const float *src = (const float *)job->src;
+				float *dst = (float *)job->dst;
+
+				for(uint32_t c=0; c < n; c++)
+					dst[(y*job->dstWidth + x)*n + c] = 0.25f*(src[(y0*job->srcWidth + x0)*n + c] + src[(y0*job->srcWidth + x1)*n + c] +
+					                                          src[(y1*job->srcWidth + x0)*n + c] + src[(y1*job->srcWidth + x1)*n + c]);
+			}
+			else
+			{
+				const byte *src = job->src;
+				byte *dst = job->dst;
+
+				for(uint32_t c=0; c < n; c++)
+					dst[(y*job->dstWidth + x)*n + c] = byte((src[(y0*job->srcWidth + x0)*n + c] + src[(y0*job->srcWidth + x1)*n + c] +
+					                                         src[(y1*job->srcWidth + x0)*n + c] + src[(y1*job->srcWidth + x1)*n + c] + 2) / 4);
+			}
+		}
+	}
+}
+
+// the formats BuildMipRows knows how to filter. Anything else (e.g. 16-bit unorm or signed
+// DDS files) is shown with just the one mip it came with.
+static bool CanBuildMips(const ResourceFormat &fmt)
+{
+	if(fmt.special)
+		return false;
+
+	if(fmt.compType == eCompType_UNorm)
+		return fmt.compByteWidth == 1;
+	if(fmt.compType == eCompType_Float)
+		return fmt.compByteWidth == 2 || fmt.compByteWidth == 4;
+	if(fmt.compType == eCompType_UInt)
+		return fmt.compByteWidth == 4;
+
+	return false;
+}
+
+// img has just mip 0 of a single 2D slice, in a format CanBuildMips accepts
+static void BuildMipChain(LoadedImage *img, uint32_t maxThreads)
+{
+	uint32_t pixelSize = img->format.compCount*img->format.compByteWidth;
+
+	uint32_t w = img->width, h = img->height;
+
+	while(w > 1 || h > 1)
+	{
+		BuildMip job;
+		job.src = img->subdata.back();
+		job.srcWidth = w;
+		job.srcHeight = h;
+
+		w = RDCMAX(1U, w/2);
+		h = RDCMAX(1U, h/2);
+
+		size_t size = size_t(w)*size_t(h)*pixelSize;
+
+		job.dst = new byte[size];
+		job.dstWidth = w;
+		job.dstHeight = h;
+		job.compCount = img->format.compCount;
+		job.compByteWidth = img->format.compByteWidth;
+		job.compType = img->format.compType;
+
+		ParallelFor((h + RowsPerBlock - 1)/RowsPerBlock, maxThreads, &BuildMipRows, &job);
+
+		img->subdata.push_back(job.dst);
+		img->subsizes.push_back(size);
+	}
+
+	img->mips = (uint32_t)img->subdata.size();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Decoding
+
+static FILE *OpenImage(const string &filename)
+{
+	FILE *f = NULL;
+
+	// the file might still be being written, or locked by whatever wrote it
+	for(int attempt=0; attempt < 10 && f == NULL; attempt++)
+	{
+		f = FileIO::fopen(filename.c_str(), "rb");
+		if(f)
+			break;
+		Threading::Sleep(40);
+	}
+
+	if(!f)
+		RDCERR("Couldn't open %s! Exclusive lock elsewhere?", filename.c_str());
+
+	return f;
+}
+
+static LoadedImage *DecodeEXR(const string &filename, uint32_t maxThreads)
+{
+	exr_data read_data = load_exr_from_file(filename.c_str(), maxThreads);
+
+	if(!read_data.data)
+	{
+		RDCERR("EXR file recognised, but couldn't load");
+		return NULL;
+	}
+
+	size_t pixelSize = read_data.format.special ? 8 : read_data.format.compCount*read_data.format.compByteWidth;
+
+	LoadedImage *img = new LoadedImage();
+	img->width = (uint32_t)read_data.width;
+	img->height = (uint32_t)read_data.height;
+	img->format = read_data.format;
+
+	img->subdata.push_back(read_data.data);
+	img->subsizes.push_back(size_t(read_data.width)*size_t(read_data.height)*pixelSize);
+
+	return img;
+}
+
+static LoadedImage *DecodeImage(const string &filename, uint32_t maxThreads)
+{
+	FILE *f = OpenImage(filename);
+
+	if(!f)
+		return NULL;
+
+	LoadedImage *img = NULL;
+
+	if(is_exr_file(f))
+	{
+		FileIO::fclose(f);
+		f = NULL;
+
+		img = DecodeEXR(filename, maxThreads);
+	}
+	else if(stbi_is_hdr_from_file(f))
+	{
+		FileIO::fseek64(f, 0, SEEK_SET);
+
+		int width = 0, height = 0, ignore = 0;
+		float *data = stbi_loadf_from_file(f, &width, &height, &ignore, 4);
+
+		if(data)
+		{
+			img = new LoadedImage();
+			img->width = (uint32_t)width;
+			img->height = (uint32_t)height;
+			img->format = MakeFormat(4, sizeof(float), eCompType_Float);
+
+			size_t size = size_t(width)*size_t(height)*4*sizeof(float);
+			img->subdata.push_back(new byte[size]);
+			img->subsizes.push_back(size);
+			memcpy(img->subdata[0], data, size);
+
+			free(data);
+		}
+		else
+		{
+			RDCERR("HDR file recognised, but couldn't load with stbi_loadf_from_file");
+		}
+	}
+	else if(is_dds_file(f))
+	{
+		FileIO::fseek64(f, 0, SEEK_SET);
+		dds_data read_data = load_dds_from_file(f);
+
+		if(read_data.subdata)
+		{
+			img = new LoadedImage();
+			img->width = (uint32_t)read_data.width;
+			img->height = (uint32_t)read_data.height;
+			img->depth = (uint32_t)read_data.depth;
+			img->slices = (uint32_t)read_data.slices;
+			img->mips = (uint32_t)read_data.mips;
+			img->cubemap = read_data.cubemap;
+			img->format = read_data.format;
+
+			for(int i=0; i < read_data.slices*read_data.mips; i++)
+			{
+				img->subdata.push_back(read_data.subdata[i]);
+				img->subsizes.push_back((size_t)read_data.subsizes[i]);
+			}
+
+			delete[] read_data.subdata;
+			delete[] read_data.subsizes;
+		}
+		else
+		{
+			RDCERR("DDS file recognised, but couldn't load");
+		}
+	}
+	else
+	{
+		int width = 0, height = 0, comp = 0;
+		int ret = stbi_info_from_file(f, &width, &height, &comp);
+
+		if(ret != 0 && width > 0 && height > 0 && comp > 0)
+		{
+			// no 3-component texture formats, so RGB is padded out
+			int loadComp = (comp == 3) ? 4 : comp;
+
+			byte *data = stbi_load_from_file(f, &width, &height, &comp, loadComp);
+
+			if(data)
+			{
+				img = new LoadedImage();
+				img->width = (uint32_t)width;
+				img->height = (uint32_t)height;
+				img->format = MakeFormat((uint32_t)loadComp, 1, eCompType_UNorm);
+
+				size_t size = size_t(width)*size_t(height)*loadComp;
+				img->subdata.push_back(new byte[size]);
+				img->subsizes.push_back(size);
+				memcpy(img->subdata[0], data, size);
+
+				free(data);
+			}
+			else
+			{
+				RDCERR("File recognised, but couldn't load with stbi_load_from_file");
+			}
+		}
+	}
+
+	if(f)
+		FileIO::fclose(f);
+
+	if(img && img->mips == 1 && img->slices == 1 && img->depth == 1 && CanBuildMips(img->format))
+		BuildMipChain(img, maxThreads);
+
+	return img;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Prefetching
+
+struct PrefetchedImage
+{
+	string filename;
+	uint64_t timestamp;
+	LoadedImage *image;
+};
+
+static Threading::CriticalSection prefetchLock;
+
+// oldest first
+static std::deque<PrefetchedImage> prefetched;
+static std::deque<string> prefetchQueue;
+static string prefetchCurrent;
+
+static Threading::ThreadHandle prefetchThread = 0;
+static bool prefetchRunning = false;
+static volatile int32_t prefetchKill = 0;
+
+static bool IsPrefetched(const string &filename)
+{
+	for(size_t i=0; i < prefetched.size(); i++)
+		if(prefetched[i].filename == filename)
+			return true;
+
+	return false;
+}
+
+static void PrefetchThreadEntry(void *)
+{
+	for(;;)
+	{
+		string filename;
+
+		{
+			SCOPED_LOCK(prefetchLock);
+
+			if(prefetchQueue.empty() || prefetchKill)
+			{
+				prefetchRunning = false;
+				prefetchCurrent = "";
+				return;
+			}
+
+			filename = prefetchQueue.front();
+			prefetchQueue.pop_front();
+			prefetchCurrent = filename;
+		}
+
+		uint64_t timestamp = FileIO::GetModifiedTimestamp(filename);
+
+		// leave the other cores for the image being viewed
+		LoadedImage *img = DecodeImage(filename, 1);
+
+		SCOPED_LOCK(prefetchLock);
+
+		prefetchCurrent = "";
+
+		if(!img)
+			continue;
+
+		PrefetchedImage p;
+		p.filename = filename;
+		p.timestamp = timestamp;
+		p.image = img;
+		prefetched.push_back(p);
+
+		while(prefetched.size() > MaxPrefetchedImages)
+		{
+			delete prefetched.front().image;
+			prefetched.pop_front();
+		}
+	}
+}
+
+static void ShutdownPrefetch()
+{
+	Threading::ThreadHandle thread = 0;
+
+	{
+		SCOPED_LOCK(prefetchLock);
+		prefetchKill = 1;
+		prefetchQueue.clear();
+		thread = prefetchThread;
+		prefetchThread = 0;
+	}
+
+	if(thread)
+	{
+		Threading::JoinThread(thread);
+		Threading::CloseThread(thread);
+	}
+
+	SCOPED_LOCK(prefetchLock);
+
+	for(size_t i=0; i < prefetched.size(); i++)
+		delete prefetched[i].image;
+	prefetched.clear();
+}
+
+namespace ImageLoader
+{
+
+ReplayCreateStatus Probe(const char *filename)
+{
+	FILE *f = FileIO::fopen(filename, "rb");
+
+	if(!f)
+		return eReplayCreate_FileIOFailed;
+
+	ReplayCreateStatus ret = eReplayCreate_Success;
+
+	if(is_exr_file(f))
+	{
+		// scanline and tiled images can be read (the first part, for multi-part files) but
+		// deep data can't be shown as a texture
+		byte version[8] = {0};
+		FileIO::fread(version, 1, sizeof(version), f);
+
+		if(version[4] != 2 || (version[5] & 0x08))
+		{
+			RDCERR("EXR file detected, but it's deep data or an unknown version (%u, flags %02x)", version[4], version[5]);
+			ret = eReplayCreate_APIUnsupported;
+		}
+	}
+	else if(stbi_is_hdr_from_file(f))
+	{
+		FileIO::fseek64(f, 0, SEEK_SET);
+
+		int ignore = 0;
+		if(stbi_info_from_file(f, &ignore, &ignore, &ignore) == 0)
+		{
+			RDCERR("HDR file recognised, but couldn't read its header");
+			ret = eReplayCreate_FileCorrupted;
+		}
+	}
+	else if(is_dds_file(f))
+	{
+		// nothing more to check without reading it
+	}
+	else
+	{
+		int width = 0, height = 0, ignore = 0;
+		int res = stbi_info_from_file(f, &width, &height, &ignore);
+
+		// just in case (we shouldn't have come in here if this weren't true), make sure
+		// the format is supported
+		if(res == 0 || width <= 0 || height <= 0)
+			ret = eReplayCreate_APIUnsupported;
+	}
+
+	FileIO::fclose(f);
+
+	return ret;
+}
+
+LoadedImage *Load(const string &filename)
+{
+	uint64_t timestamp = FileIO::GetModifiedTimestamp(filename);
+
+	for(;;)
+	{
+		{
+			SCOPED_LOCK(prefetchLock);
+
+			for(auto it=prefetched.begin(); it != prefetched.end(); ++it)
+			{
+				if(it->filename == filename)
+				{
+					LoadedImage *img = it->image;
+					bool valid = (it->timestamp == timestamp);
+
+					prefetched.erase(it);
+
+					if(valid)
+						return img;
+
+					delete img;
+					break;
+				}
+			}
+
+			// don't decode it twice if the prefetch is already on it, wait for that instead
+			if(prefetchCurrent != filename)
+				break;
+		}
+
+		Threading::Sleep(5);
+	}
+
+	return DecodeImage(filename, ~0U);
+}
+
+void PrefetchNeighbours(const string &filename)
+{
+	string dir = dirname(filename);
+	string base = basename(filename);
+
+	// keep whatever path separator filename uses, so the neighbours' names match exactly
+	// when they're loaded later
+	string prefix = filename.substr(0, filename.length() - base.length());
+
+	size_t dot = base.find_last_of('.');
+	string ext = strlower(dot == string::npos ? "" : base.substr(dot));
+
+	vector<string> files;
+	FileIO::GetFilesInDirectory(dir, files);
+
+	vector<string> siblings;
+	for(size_t i=0; i < files.size(); i++)
+	{
+		size_t d = files[i].find_last_of('.');
+		if(strlower(d == string::npos ? "" : files[i].substr(d)) == ext)
+			siblings.push_back(files[i]);
+	}
+
+	std::sort(siblings.begin(), siblings.end());
+
+	vector<string>::iterator self = std::lower_bound(siblings.begin(), siblings.end(), base);
+
+	if(self == siblings.end() || *self != base)
+		return;
+
+	size_t idx = self - siblings.begin();
+
+	// most likely to step forward, so the next image goes first
+	vector<string> neighbours;
+	if(idx+1 < siblings.size()) neighbours.push_back(prefix + siblings[idx+1]);
+	if(idx > 0)                 neighbours.push_back(prefix + siblings[idx-1]);
+
+	SCOPED_LOCK(prefetchLock);
+
+	if(prefetchKill)
+		return;
+
+	prefetchQueue.clear();
+
+	for(size_t i=0; i < neighbours.size(); i++)
+		if(!IsPrefetched(neighbours[i]) && prefetchCurrent != neighbours[i])
+			prefetchQueue.push_back(neighbours[i]);
+
+	if(prefetchQueue.empty() || prefetchRunning)
+		return;
+
+	// a previous thread that ran out of work has already returned or is about to, without
+	// taking the lock again
+	if(prefetchThread)
+	{
+		Threading::JoinThread(prefetchThread);
+		Threading::CloseThread(prefetchThread);
+	}
+	else
+	{
+		RenderDoc::Inst().RegisterShutdownFunction(&ShutdownPrefetch);
+	}
+
+	prefetchRunning = true;
+	prefetchThread = Threading::CreateThread(&PrefetchThreadEntry, NULL);
+}
+
+};
@@ -0,0 +1,72 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2014 Baldur Karlsson
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#pragma once
+
+#include "api/replay/renderdoc_replay.h"
+
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+// an image decoded in its native format, ready to upload. Subresources are ordered the same
+// as a DDS - subdata[slice*mips + mip].
+struct LoadedImage
+{
+	LoadedImage();
+	~LoadedImage();
+
+	uint32_t width, height, depth;
+	uint32_t slices, mips;
+	bool cubemap;
+
+	ResourceFormat format;
+
+	vector<byte *> subdata;
+	vector<size_t> subsizes;
+
+	uint64_t GetByteSize() const;
+};
+
+// loading for the image viewer. Images keep their native channel count and format (except
+// 3-channel images, which are padded to 4 as there are no 3-channel texture formats), and
+// anything without mips of its own gets a full box-filtered chain built on worker threads
+// so zoomed out views don't alias.
+//
+// Once an image is shown its neighbours in the same directory are decoded in the background,
+// so stepping through a folder of images doesn't wait on the decode each time.
+namespace ImageLoader
+{
+	// checks just the header of filename to see if it's an image we can load
+	ReplayCreateStatus Probe(const char *filename);
+
+	// decodes filename, or takes it from the prefetched images if it was decoded there and hasn't
+	// changed since. Returns NULL if it couldn't be loaded, otherwise the caller must delete it.
+	LoadedImage *Load(const string &filename);
+
+	// queue the images either side of filename (sorted by name, same extension) to be decoded
+	void PrefetchNeighbours(const string &filename);
+};
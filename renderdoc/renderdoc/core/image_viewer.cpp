@@ -26,9 +26,7 @@
 #include "replay/replay_driver.h"
 #include "replay/type_helpers.h"
 
-#include "stb/stb_image.h"
-#include "tinyexr/tinyexr.h"
-#include "common/dds_readwrite.h"
+#include "core/image_loader.h"
 
 class ImageViewer : public IReplayDriver
 {
@@ -116,6 +114,8 @@ class ImageViewer : public IReplayDriver
 		// handle a couple of operations ourselves to return a simple fake log
 		APIProperties GetAPIProperties() { return m_Props; }
 		vector<FetchFrameRecord> GetFrameRecord() { return m_FrameRecord; }
+		LoadProfile GetLoadProfile() { return LoadProfile(); }
+		ReplayCheckpointStats GetReplayCheckpointStats() { ReplayCheckpointStats ret; RDCEraseEl(ret); return ret; }
 		D3D11PipelineState GetD3D11PipelineState() { return m_PipelineState; }
 		
 		// other operations are dropped/ignored, to avoid confusion
@@ -132,6 +132,7 @@ class ImageViewer : public IReplayDriver
 		void SavePipelineState() {}
 		GLPipelineState GetGLPipelineState() { return GLPipelineState(); }
 		void SetContextFilter(ResourceId id, uint32_t firstDefEv, uint32_t lastDefEv) {}
+		void SetReplayCheckpoints(uint32_t eventInterval, uint64_t memoryBudget) {}
 		void ReplayLog(uint32_t frameID, uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType) {}
 		vector<EventUsage> GetUsage(ResourceId id) { return vector<EventUsage>(); }
 		bool IsRenderOutput(ResourceId id) { return false; }
@@ -171,6 +172,12 @@ class ImageViewer : public IReplayDriver
 		void SetIDRenderingEvents(uint32_t frameID, uint32_t startEvent, uint32_t endEvent) {}
 		/* Added by Stephan Richter | END */
 
+		// no batched readback, callers fall back to GetBufferData/GetTextureData
+		uint32_t QueueBufferReadback(ResourceId buff, uint32_t offset, uint32_t len) { return 0; }
+		uint32_t QueueTextureReadback(ResourceId tex, uint32_t arrayIdx, uint32_t mip) { return 0; }
+		bool FetchReadback(uint32_t ticket, bool wait, vector<byte> &data) { return false; }
+		void FreeReadbacks() {}
+
 		// these are proxy functions, and will never be used
 		ResourceId CreateProxyTexture(FetchTexture templateTex)
 		{
@@ -213,97 +220,12 @@ class ImageViewer : public IReplayDriver
 
 ReplayCreateStatus IMG_CreateReplayDevice(const char *logfile, IReplayDriver **driver)
 {
-	FILE *f = FileIO::fopen(logfile, "rb");
-
-	if(!f)
-		return eReplayCreate_FileIOFailed;
-
-	// make sure the file is a type we recognise before going further
-	if(is_exr_file(f))
-	{
-		FileIO::fseek64(f, 0, SEEK_SET);
-
-		const char *err = NULL;
-
-		float *data = NULL;
-		int dummy;
-
-		int ret = LoadEXRFP(&data, &dummy, &dummy, f, &err);
-
-		if(data) free(data);
-
-		// could be an unsupported form of EXR, like deep image or other
-		if(ret != 0)
-		{
-			FileIO::fclose(f);
-
-			RDCERR("EXR file detected, but couldn't load with LoadEXR %d: '%s'", ret, err);
-			return eReplayCreate_APIUnsupported;
-		}
-	}
-	else if(stbi_is_hdr_from_file(f))
-	{
-		FileIO::fseek64(f, 0, SEEK_SET);
+	// make sure the file is a type we recognise before going further. Only the header is
+	// read here, the image itself is decoded once when the viewer is created
+	ReplayCreateStatus probe = ImageLoader::Probe(logfile);
 
-		int ignore = 0;
-		float *data = stbi_loadf_from_file(f, &ignore, &ignore, &ignore, 4);
-
-		if(!data)
-		{
-			FileIO::fclose(f);
-			RDCERR("HDR file recognised, but couldn't load with stbi_loadf_from_file");
-			return eReplayCreate_FileCorrupted;
-		}
-
-		free(data);
-	}
-	else if(is_dds_file(f))
-	{
-		FileIO::fseek64(f, 0, SEEK_SET);
-		dds_data read_data = load_dds_from_file(f);
-
-		if(read_data.subdata == NULL)
-		{
-			FileIO::fclose(f);
-			RDCERR("DDS file recognised, but couldn't load");
-			return eReplayCreate_FileCorrupted;
-		}
-
-		for(int i=0; i < read_data.slices*read_data.mips; i++)
-			delete[] read_data.subdata[i];
-
-		delete[] read_data.subdata;
-		delete[] read_data.subsizes;
-	}
-	else
-	{
-		int width = 0, height = 0;
-		int ignore = 0;
-		int ret = stbi_info_from_file(f, &width, &height, &ignore);
-
-		// just in case (we shouldn't have come in here if this weren't true), make sure
-		// the format is supported
-		if(ret == 0 ||
-			 width == 0 || width == ~0U ||
-			 height == 0 || height == ~0U)
-		{
-			FileIO::fclose(f);
-			return eReplayCreate_APIUnsupported;
-		}
-
-		byte *data = stbi_load_from_file(f, &ignore, &ignore, &ignore, 4);
-
-		if(!data)
-		{
-			FileIO::fclose(f);
-			RDCERR("File recognised, but couldn't load with stbi_load_from_file");
-			return eReplayCreate_FileCorrupted;
-		}
-		
-		free(data);
-	}
-
-	FileIO::fclose(f);
+	if(probe != eReplayCreate_Success)
+		return probe;
 
 	IReplayDriver *proxy = NULL;
 	auto status = RenderDoc::Inst().CreateReplayDriver(RDC_Unknown, NULL, &proxy);
@@ -321,146 +243,32 @@ ReplayCreateStatus IMG_CreateReplayDevice(const char *logfile, IReplayDriver **d
 
 void ImageViewer::RefreshFile()
 {
-	FILE *f = NULL;
-
-	for(int attempt=0; attempt < 10 && f == NULL; attempt++)
-	{
-		f = FileIO::fopen(m_Filename.c_str(), "rb");
-		if(f)
-			break;
-		Threading::Sleep(40);
-	}
+	LoadedImage *img = ImageLoader::Load(m_Filename);
 
-	if(!f)
-	{
-		RDCERR("Couldn't open %s! Exclusive lock elsewhere?", m_Filename.c_str());
+	if(!img)
 		return;
-	}
 
 	FetchTexture texDetails;
 
-	ResourceFormat rgba8_unorm;
-	rgba8_unorm.compByteWidth = 1;
-	rgba8_unorm.compCount = 4;
-	rgba8_unorm.compType = eCompType_UNorm;
-	rgba8_unorm.special = false;
-
-	ResourceFormat rgba32_float = rgba8_unorm;
-	rgba32_float.compByteWidth = 4;
-	rgba32_float.compType = eCompType_Float;
-
 	texDetails.creationFlags = eTextureCreate_SwapBuffer|eTextureCreate_RTV;
-	texDetails.cubemap = false;
 	texDetails.customName = true;
 	texDetails.name = m_Filename;
 	texDetails.ID = m_TextureID;
-	texDetails.byteSize = 0;
+	texDetails.byteSize = img->GetByteSize();
 	texDetails.msQual = 0;
 	texDetails.msSamp = 1;
-	texDetails.format = rgba8_unorm;
-
-	// reasonable defaults
-	texDetails.numSubresources = 1;
-	texDetails.dimension = 2;
-	texDetails.arraysize = 1;
-	texDetails.width = 1;
-	texDetails.height = 1;
-	texDetails.depth = 1;
-	texDetails.mips = 1;
-
-	byte *data = NULL;
-	size_t datasize = 0;
-
-	bool dds = false;
-
-	if(is_exr_file(f))
-	{
-		texDetails.format = rgba32_float;
-		
-		FileIO::fseek64(f, 0, SEEK_SET);
-
-		const char *err = NULL;
-
-		int ret = LoadEXRFP((float **)&data, (int *)&texDetails.width, (int *)&texDetails.height, f, &err);
-		datasize = texDetails.width*texDetails.height*4*sizeof(float);
-
-		// could be an unsupported form of EXR, like deep image or other
-		if(ret != 0)
-		{
-			if(data) free(data);
-			RDCERR("EXR file detected, but couldn't load with LoadEXR %d: '%s'", ret, err);
-			FileIO::fclose(f);
-			return;
-		}
-	}
-	else if(stbi_is_hdr_from_file(f))
-	{
-		texDetails.format = rgba32_float;
-
-		FileIO::fseek64(f, 0, SEEK_SET);
-
-		int ignore = 0;
-		data = (byte *)stbi_loadf_from_file(f, (int *)&texDetails.width, (int *)&texDetails.height, &ignore, 4);
-		datasize = texDetails.width*texDetails.height*4*sizeof(float);
-	}
-	else if(is_dds_file(f))
-	{
-		dds = true;
-	}
-	else
-	{
-		int ignore = 0;
-		int ret = stbi_info_from_file(f, (int *)&texDetails.width, (int *)&texDetails.height, &ignore);
-
-		// just in case (we shouldn't have come in here if this weren't true), make sure
-		// the format is supported
-		if(ret == 0 ||
-			 texDetails.width == 0 || texDetails.width == ~0U ||
-			 texDetails.height == 0 || texDetails.height == ~0U)
-		{
-			FileIO::fclose(f);
-			return;
-		}
-
-		texDetails.format = rgba8_unorm;
-
-		data = stbi_load_from_file(f, (int *)&texDetails.width, (int *)&texDetails.height, &ignore, 4);
-		datasize = texDetails.width*texDetails.height*4*sizeof(byte);
-	}
-	
-	// if we don't have data at this point (and we're not a dds file) then the
-	// file was corrupted and we failed to load it
-	if(!dds && data == NULL)
-	{
-		FileIO::fclose(f);
-		return;
-	}
-
-	dds_data read_data = {0};
-
-	if(dds)
-	{
-		FileIO::fseek64(f, 0, SEEK_SET);
-		read_data = load_dds_from_file(f);
-		
-		if(read_data.subdata == NULL)
-		{
-			FileIO::fclose(f);
-			return;
-		}
-
-		texDetails.cubemap = read_data.cubemap;
-		texDetails.arraysize = read_data.slices;
-		texDetails.width = read_data.width;
-		texDetails.height = read_data.height;
-		texDetails.depth = read_data.depth;
-		texDetails.mips = read_data.mips;
-		texDetails.numSubresources = texDetails.arraysize*texDetails.mips;
-		texDetails.format = read_data.format;
-		                         texDetails.dimension = 1;
-		if(texDetails.width > 1) texDetails.dimension = 2;
-		if(texDetails.depth > 1) texDetails.dimension = 3;
-	}
+	texDetails.format = img->format;
+
+	texDetails.cubemap = img->cubemap;
+	texDetails.arraysize = img->slices;
+	texDetails.width = img->width;
+	texDetails.height = img->height;
+	texDetails.depth = img->depth;
+	texDetails.mips = img->mips;
+	texDetails.numSubresources = texDetails.arraysize*texDetails.mips;
+	                         texDetails.dimension = 1;
+	if(texDetails.width > 1) texDetails.dimension = 2;
+	if(texDetails.depth > 1) texDetails.dimension = 3;
 
 	// recreate proxy texture if necessary.
 	// we rewrite the texture IDs so that the
@@ -486,25 +294,16 @@ void ImageViewer::RefreshFile()
 	if(m_TextureID == ResourceId())
 		m_TextureID = m_Proxy->CreateProxyTexture(texDetails);
 
-	if(!dds)
-	{
-		m_Proxy->SetProxyTextureData(m_TextureID, 0, 0, data, datasize);
-		free(data);
-	}
-	else
-	{
-		for(uint32_t i=0; i < texDetails.numSubresources; i++)
-		{
-			m_Proxy->SetProxyTextureData(m_TextureID, i/texDetails.mips, i%texDetails.mips, read_data.subdata[i], (size_t)read_data.subsizes[i]);
+	texDetails.ID = m_TextureID;
+	m_TexDetails = texDetails;
 
-			delete[] read_data.subdata[i];
-		}
+	for(uint32_t i=0; i < texDetails.numSubresources; i++)
+		m_Proxy->SetProxyTextureData(m_TextureID, i/texDetails.mips, i%texDetails.mips, img->subdata[i], img->subsizes[i]);
 
-		delete[] read_data.subdata;
-		delete[] read_data.subsizes;
-	}
+	delete img;
 
-	FileIO::fclose(f);
+	// get the next and previous images in the folder ready, in case they're looked at next
+	ImageLoader::PrefetchNeighbours(m_Filename);
 }
 
 static DriverRegistration IMGDriverRegistration(RDC_Image, "Image", &IMG_CreateReplayDevice);
@@ -0,0 +1,151 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2014 Crytek
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+
+#include "core/load_profile.h"
+#include "common/common.h"
+
+void LoadProfiler::Reset()
+{
+	m_Chunks.clear();
+	m_Resources.clear();
+	m_Events.clear();
+
+	m_ApplyMS = m_ReplayMS = m_TotalMS = 0.0;
+}
+
+void LoadProfiler::AddChunk(uint32_t chunkType, const char *name, uint64_t size, double ms)
+{
+	Stats &s = m_Chunks[chunkType];
+
+	if(s.count == 0 && name)
+		s.name = name;
+
+	s.count++;
+	s.totalSize += size;
+	s.loadMS += ms;
+	if(ms > s.maxMS)
+		s.maxMS = ms;
+}
+
+void LoadProfiler::AddInitialContents(const string &resourceType, uint64_t size, double ms)
+{
+	Stats &s = m_Resources[resourceType];
+
+	s.name = resourceType;
+	s.count++;
+	s.totalSize += size;
+	s.loadMS += ms;
+	if(ms > s.maxMS)
+		s.maxMS = ms;
+}
+
+void LoadProfiler::AddInitialContentsApply(const string &resourceType, double ms)
+{
+	Stats &s = m_Resources[resourceType];
+
+	s.name = resourceType;
+	s.applyMS += ms;
+}
+
+void LoadProfiler::AddEvent(uint32_t eventID, double ms)
+{
+	// consecutive chunks in the same event (e.g. a drawcall and its markers) are merged
+	if(!m_Events.empty() && m_Events.back().endEventID == eventID)
+	{
+		m_Events.back().replayMS += ms;
+		return;
+	}
+
+	LoadEventTiming t;
+	t.startEventID = t.endEventID = eventID;
+	t.replayMS = ms;
+	m_Events.push_back(t);
+}
+
+void LoadProfiler::Dump() const
+{
+	for(auto it=m_Chunks.begin(); it != m_Chunks.end(); ++it)
+	{
+		double dcount = double(it->second.count);
+
+		RDCDEBUG("% 5d chunks - Time: %9.3fms total/%9.3fms avg - Size: %8.3fMB total/%7.3fMB avg - %s (%u)",
+				it->second.count,
+				it->second.loadMS, it->second.loadMS/dcount,
+				double(it->second.totalSize)/(1024.0*1024.0),
+				double(it->second.totalSize)/(dcount*1024.0*1024.0),
+				it->second.name.c_str(), it->first
+				);
+	}
+
+	for(auto it=m_Resources.begin(); it != m_Resources.end(); ++it)
+	{
+		RDCDEBUG("% 5d initial contents - Load: %9.3fms - Apply: %9.3fms - Size: %8.3fMB - %s",
+				it->second.count,
+				it->second.loadMS, it->second.applyMS,
+				double(it->second.totalSize)/(1024.0*1024.0),
+				it->first.c_str()
+				);
+	}
+
+	RDCDEBUG("Applying initial contents took %.3fms, initial frame replay took %.3fms of %.3fms total",
+			m_ApplyMS, m_ReplayMS, m_TotalMS);
+}
+
+LoadChunkStats LoadProfiler::Stats::Bake() const
+{
+	LoadChunkStats ret;
+	ret.name = name;
+	ret.count = count;
+	ret.totalSize = totalSize;
+	ret.loadMS = loadMS;
+	ret.maxMS = maxMS;
+	ret.applyMS = applyMS;
+	return ret;
+}
+
+LoadProfile LoadProfiler::Bake() const
+{
+	LoadProfile ret;
+
+	ret.totalMS = m_TotalMS;
+	ret.initialContentsApplyMS = m_ApplyMS;
+	ret.frameReplayMS = m_ReplayMS;
+	ret.chunkReadMS = m_TotalMS - m_ApplyMS - m_ReplayMS;
+
+	vector<LoadChunkStats> chunks, resources;
+
+	for(auto it=m_Chunks.begin(); it != m_Chunks.end(); ++it)
+		chunks.push_back(it->second.Bake());
+
+	for(auto it=m_Resources.begin(); it != m_Resources.end(); ++it)
+		resources.push_back(it->second.Bake());
+
+	ret.chunks = chunks;
+	ret.resources = resources;
+	ret.events = m_Events;
+
+	return ret;
+}
@@ -0,0 +1,81 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2014 Crytek
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+
+#pragma once
+
+#include "api/replay/renderdoc_replay.h"
+
+#include <string>
+#include <vector>
+#include <map>
+using std::string;
+using std::vector;
+using std::map;
+
+// collects timings while a log is loaded in ReadLogInitialisation, so that slow
+// loads can be broken down by chunk type, resource type and event without
+// instrumenting the drivers by hand.
+class LoadProfiler
+{
+	public:
+		LoadProfiler() { Reset(); }
+
+		void Reset();
+
+		void AddChunk(uint32_t chunkType, const char *name, uint64_t size, double ms);
+		void AddInitialContents(const string &resourceType, uint64_t size, double ms);
+		void AddInitialContentsApply(const string &resourceType, double ms);
+		void AddEvent(uint32_t eventID, double ms);
+
+		void SetApplyTime(double ms) { m_ApplyMS = ms; }
+		void SetFrameReplayTime(double ms) { m_ReplayMS = ms; }
+		void SetTotalTime(double ms) { m_TotalMS = ms; }
+
+		// prints the per-chunk and per-resource breakdown to the log
+		void Dump() const;
+
+		LoadProfile Bake() const;
+	private:
+		struct Stats
+		{
+			Stats() : count(0), totalSize(0), loadMS(0.0), maxMS(0.0), applyMS(0.0) {}
+			LoadChunkStats Bake() const;
+			string name;
+			uint32_t count;
+			uint64_t totalSize;
+			double loadMS;
+			double maxMS;
+			double applyMS;
+		};
+
+		map<uint32_t, Stats> m_Chunks;
+		map<string, Stats> m_Resources;
+		vector<LoadEventTiming> m_Events;
+
+		double m_ApplyMS;
+		double m_ReplayMS;
+		double m_TotalMS;
+};
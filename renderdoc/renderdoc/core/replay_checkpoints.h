@@ -0,0 +1,276 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2014 Crytek
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#pragma once
+
+#include "common/common.h"
+#include "api/replay/renderdoc_replay.h"
+
+#include <vector>
+#include <map>
+#include <set>
+using std::vector;
+using std::map;
+using std::set;
+
+// snapshots taken every N API events during a replay from the start of the frame, so later
+// replays can jump in at the nearest one instead. The resources are snapshotted through the
+// resource manager, the driver only provides the pipeline state and the replay itself.
+template<typename ManagerType, typename StateType>
+class ReplayCheckpoints
+{
+	public:
+		class Driver
+		{
+			public:
+				virtual ~Driver() {}
+
+				// false if replay can't continue from the current point, e.g. during a query
+				virtual bool CanCreateCheckpoint() = 0;
+
+				// adds the original IDs of resources the frame writes beyond what the resource
+				// manager knows of (see GetCheckpointResources), e.g. through the pipeline
+				virtual void GetCheckpointWrittenResources(set<ResourceId> &ids) = 0;
+
+				virtual StateType *FetchCheckpointState() = 0;
+				virtual void ApplyCheckpointState(StateType *state) = 0;
+
+				// replays a range of the frame's events, with the serialiser just past the frame header
+				virtual void ReplayCheckpointRange(uint32_t startEventID, uint32_t endEventID, bool partial) = 0;
+
+				// puts the serialiser back just past the frame header
+				virtual void RewindCheckpointFrame(uint32_t frameID) = 0;
+		};
+
+		ReplayCheckpoints() : m_Interval(0), m_Budget(0), m_Memory(0), m_Full(false)
+		{ RDCEraseEl(m_Stats); }
+
+		static bool IsWriteUsage(ResourceUsage usage)
+		{
+			return usage == eUsage_SO ||
+				(usage >= eUsage_VS_RWResource && usage <= eUsage_CS_RWResource) ||
+				usage == eUsage_ColourTarget || usage == eUsage_DepthStencilTarget ||
+				usage == eUsage_Clear || usage == eUsage_GenMips ||
+				usage == eUsage_Resolve || usage == eUsage_ResolveDst ||
+				usage == eUsage_Copy || usage == eUsage_CopyDst;
+		}
+
+		// adds the original IDs of the live resources with a write among uses (keyed by live ID)
+		static void AddWrittenUses(ManagerType *rm, const map<ResourceId, vector<EventUsage> > &uses, set<ResourceId> &ids)
+		{
+			for(auto it = uses.begin(); it != uses.end(); ++it)
+			{
+				ResourceId id = rm->GetOriginalID(it->first);
+
+				if(!rm->HasLiveResource(id))
+					continue;
+
+				for(size_t i=0; i < it->second.size(); i++)
+				{
+					if(IsWriteUsage(it->second[i].usage))
+					{
+						ids.insert(id);
+						break;
+					}
+				}
+			}
+		}
+
+		void Set(ManagerType *rm, uint32_t eventInterval, uint64_t memoryBudget)
+		{
+			Free(rm);
+
+			m_Interval = eventInterval;
+			m_Budget = memoryBudget;
+		}
+
+		void Free(ManagerType *rm)
+		{
+			for(size_t i=0; i < m_Checkpoints.size(); i++)
+			{
+				rm->FreeCheckpoint(m_Checkpoints[i].resources);
+				SAFE_DELETE(m_Checkpoints[i].state);
+			}
+
+			m_Checkpoints.clear();
+			m_Memory = 0;
+			m_Full = false;
+		}
+
+		bool Enabled() const { return m_Interval > 0; }
+
+		ReplayCheckpointStats GetStats() const
+		{
+			ReplayCheckpointStats ret = m_Stats;
+			ret.checkpoints = (uint32_t)m_Checkpoints.size();
+			ret.memoryUsed = m_Memory;
+			ret.memoryBudget = m_Budget;
+			return ret;
+		}
+
+		// applies the nearest checkpoint at or before lastEventID, if there is one. On success
+		// startEventID is moved to the event after it and replay is partial from there.
+		bool Restore(Driver *driver, ManagerType *rm, uint32_t frameID, const vector<FetchAPIEvent> &events, uint32_t lastEventID, uint32_t &startEventID);
+
+		// replays from startEventID to lastEventID, stopping to create any checkpoints along
+		// the way that we don't have yet if create is set
+		void Replay(Driver *driver, ManagerType *rm, uint32_t frameID, const vector<FetchAPIEvent> &events, uint32_t startEventID, uint32_t lastEventID, bool partial, bool create);
+
+	private:
+		struct Checkpoint
+		{
+			uint32_t frameID;
+			typename ManagerType::Checkpoint resources;
+			StateType *state;
+		};
+
+		Checkpoint *Find(uint32_t frameID, uint32_t eventID);
+		void Create(Driver *driver, ManagerType *rm, uint32_t frameID, uint32_t eventID);
+
+		vector<Checkpoint> m_Checkpoints;
+		set<ResourceId> m_WrittenResources;
+		uint32_t m_Interval;
+		uint64_t m_Budget;
+		uint64_t m_Memory;
+		bool m_Full;
+		ReplayCheckpointStats m_Stats;
+};
+
+template<typename ManagerType, typename StateType>
+typename ReplayCheckpoints<ManagerType, StateType>::Checkpoint *ReplayCheckpoints<ManagerType, StateType>::Find(uint32_t frameID, uint32_t eventID)
+{
+	Checkpoint *ret = NULL;
+
+	// sorted by event, return the last one at or before eventID
+	for(size_t i=0; i < m_Checkpoints.size(); i++)
+	{
+		if(m_Checkpoints[i].frameID != frameID)
+			continue;
+		if(m_Checkpoints[i].resources.eventID > eventID)
+			break;
+		ret = &m_Checkpoints[i];
+	}
+
+	return ret;
+}
+
+template<typename ManagerType, typename StateType>
+void ReplayCheckpoints<ManagerType, StateType>::Create(Driver *driver, ManagerType *rm, uint32_t frameID, uint32_t eventID)
+{
+	if(!driver->CanCreateCheckpoint())
+		return;
+
+	if(m_WrittenResources.empty())
+		driver->GetCheckpointWrittenResources(m_WrittenResources);
+
+	set<ResourceId> ids = m_WrittenResources;
+	rm->GetCheckpointResources(ids);
+
+	Checkpoint checkpoint;
+	checkpoint.frameID = frameID;
+	checkpoint.resources.eventID = eventID;
+
+	rm->CreateCheckpoint(ids, checkpoint.resources);
+
+	if(m_Memory + checkpoint.resources.byteSize > m_Budget)
+	{
+		RDCDEBUG("Replay checkpoint at %u needs %llu bytes, over budget - no more checkpoints will be made",
+		         eventID, checkpoint.resources.byteSize);
+
+		rm->FreeCheckpoint(checkpoint.resources);
+		m_Stats.dropped++;
+		m_Full = true;
+		return;
+	}
+
+	checkpoint.state = driver->FetchCheckpointState();
+
+	m_Memory += checkpoint.resources.byteSize;
+
+	size_t idx = 0;
+	while(idx < m_Checkpoints.size() && m_Checkpoints[idx].resources.eventID < eventID)
+		idx++;
+
+	m_Checkpoints.insert(m_Checkpoints.begin()+idx, checkpoint);
+}
+
+template<typename ManagerType, typename StateType>
+bool ReplayCheckpoints<ManagerType, StateType>::Restore(Driver *driver, ManagerType *rm, uint32_t frameID, const vector<FetchAPIEvent> &events, uint32_t lastEventID, uint32_t &startEventID)
+{
+	Checkpoint *checkpoint = Find(frameID, lastEventID);
+
+	if(checkpoint == NULL || !rm->ApplyCheckpoint(checkpoint->resources))
+	{
+		m_Stats.misses++;
+		return false;
+	}
+
+	driver->ApplyCheckpointState(checkpoint->state);
+
+	// checkpoints are never made on the last event, so there's always a next one
+	for(size_t i=0; i+1 < events.size(); i++)
+	{
+		if(events[i].eventID == checkpoint->resources.eventID)
+		{
+			startEventID = events[i+1].eventID;
+			break;
+		}
+	}
+
+	m_Stats.hits++;
+
+	return true;
+}
+
+template<typename ManagerType, typename StateType>
+void ReplayCheckpoints<ManagerType, StateType>::Replay(Driver *driver, ManagerType *rm, uint32_t frameID, const vector<FetchAPIEvent> &events, uint32_t startEventID, uint32_t lastEventID, bool partial, bool create)
+{
+	// stop at any checkpoint positions along the way that we don't have yet
+	for(size_t i=m_Interval; create && m_Interval > 0 && !m_Full && i+1 < events.size(); i += m_Interval)
+	{
+		uint32_t eventID = events[i].eventID;
+
+		if(eventID < startEventID)
+			continue;
+		if(eventID >= lastEventID)
+			break;
+
+		Checkpoint *existing = Find(frameID, eventID);
+		if(existing && existing->resources.eventID == eventID)
+			continue;
+
+		driver->ReplayCheckpointRange(startEventID, eventID, partial);
+
+		Create(driver, rm, frameID, eventID);
+
+		startEventID = events[i+1].eventID;
+		partial = true;
+
+		// rewind to the frame header for the next segment
+		driver->RewindCheckpointFrame(frameID);
+	}
+
+	driver->ReplayCheckpointRange(startEventID, lastEventID, partial);
+}
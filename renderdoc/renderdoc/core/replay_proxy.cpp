@@ -268,9 +268,13 @@ void Serialiser::Serialise(const char *name, ShaderDebugTrace &el)
 	for(int32_t i=0; i < numcbuffers; i++)
 		Serialise("", el.cbuffers[i]);
 
-	Serialise("", el.states);
+	Serialise("", el.keyframeInterval);
+	Serialise("", el.keyframes);
+	Serialise("", el.steps);
+	Serialise("", el.changes);
+	Serialise("", el.traceID);
 
-	SIZE_CHECK(ShaderDebugTrace, 24);
+	SIZE_CHECK(ShaderDebugTrace, 48);
 }
 
 #pragma endregion General Shader/State
@@ -824,6 +828,56 @@ void Serialiser::Serialise(const char *name, FetchFrameRecord &el)
 	SIZE_CHECK(FetchFrameRecord, 56);
 }
 
+template<>
+void Serialiser::Serialise(const char *name, ReplayCheckpointStats &el)
+{
+	Serialise("", el.checkpoints);
+	Serialise("", el.hits);
+	Serialise("", el.misses);
+	Serialise("", el.dropped);
+	Serialise("", el.memoryUsed);
+	Serialise("", el.memoryBudget);
+
+	SIZE_CHECK(ReplayCheckpointStats, 32);
+}
+
+template<>
+void Serialiser::Serialise(const char *name, LoadChunkStats &el)
+{
+	Serialise("", el.name);
+	Serialise("", el.count);
+	Serialise("", el.totalSize);
+	Serialise("", el.loadMS);
+	Serialise("", el.maxMS);
+	Serialise("", el.applyMS);
+
+	SIZE_CHECK(LoadChunkStats, 56);
+}
+
+template<>
+void Serialiser::Serialise(const char *name, LoadEventTiming &el)
+{
+	Serialise("", el.startEventID);
+	Serialise("", el.endEventID);
+	Serialise("", el.replayMS);
+
+	SIZE_CHECK(LoadEventTiming, 16);
+}
+
+template<>
+void Serialiser::Serialise(const char *name, LoadProfile &el)
+{
+	Serialise("", el.totalMS);
+	Serialise("", el.chunkReadMS);
+	Serialise("", el.initialContentsApplyMS);
+	Serialise("", el.frameReplayMS);
+	Serialise("", el.chunks);
+	Serialise("", el.resources);
+	Serialise("", el.events);
+
+	SIZE_CHECK(LoadProfile, 80);
+}
+
 template<>
 void Serialiser::Serialise(const char *name, MeshFormat &el)
 {
@@ -962,6 +1016,10 @@ string ToStrHelper<false, EventUsage>::Get(const EventUsage &el) { return "<...>
 template<>
 string ToStrHelper<false, CounterResult>::Get(const CounterResult &el) { return "<...>"; }
 template<>
+string ToStrHelper<false, ShaderDebugStep>::Get(const ShaderDebugStep &el) { return "<...>"; }
+template<>
+string ToStrHelper<false, ShaderDebugChange>::Get(const ShaderDebugChange &el) { return "<...>"; }
+template<>
 string ToStrHelper<false, ReplayLogType>::Get(const ReplayLogType &el) { return "<...>"; }
 
 #pragma endregion Plain-old data structures
@@ -1061,6 +1119,12 @@ bool ProxySerialiser::Tick()
 		case eCommand_SetCtxFilter:
 			SetContextFilter(ResourceId(), 0, 0);
 			break;
+		case eCommand_SetReplayCheckpoints:
+			SetReplayCheckpoints(0, 0);
+			break;
+		case eCommand_GetReplayCheckpointStats:
+			GetReplayCheckpointStats();
+			break;
 		case eCommand_ReplayLog:
 			ReplayLog(0, 0, 0, (ReplayLogType)0);
 			break;
@@ -1097,6 +1161,9 @@ bool ProxySerialiser::Tick()
 		case eCommand_GetFrameRecord:
 			GetFrameRecord();
 			break;
+		case eCommand_GetLoadProfile:
+			GetLoadProfile();
+			break;
 		case eCommand_HasResolver:
 			HasCallstacks();
 			break;
@@ -1390,6 +1457,42 @@ void ProxySerialiser::SetContextFilter(ResourceId id, uint32_t firstDefEv, uint3
 	}
 }
 
+void ProxySerialiser::SetReplayCheckpoints(uint32_t eventInterval, uint64_t memoryBudget)
+{
+	m_ToReplaySerialiser->Serialise("", eventInterval);
+	m_ToReplaySerialiser->Serialise("", memoryBudget);
+	
+	if(m_ReplayHost)
+	{
+		m_Remote->SetReplayCheckpoints(eventInterval, memoryBudget);
+	}
+	else
+	{
+		if(!SendReplayCommand(eCommand_SetReplayCheckpoints))
+			return;
+	}
+}
+
+ReplayCheckpointStats ProxySerialiser::GetReplayCheckpointStats()
+{
+	ReplayCheckpointStats ret;
+	RDCEraseEl(ret);
+
+	if(m_ReplayHost)
+	{
+		ret = m_Remote->GetReplayCheckpointStats();
+	}
+	else
+	{
+		if(!SendReplayCommand(eCommand_GetReplayCheckpointStats))
+			return ret;
+	}
+
+	m_FromReplaySerialiser->Serialise("", ret);
+
+	return ret;
+}
+
 void ProxySerialiser::ReplayLog(uint32_t frameID, uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType)
 {
 	m_ToReplaySerialiser->Serialise("", frameID);
@@ -1451,6 +1554,25 @@ vector<FetchFrameRecord> ProxySerialiser::GetFrameRecord()
 	return ret;
 }
 
+LoadProfile ProxySerialiser::GetLoadProfile()
+{
+	LoadProfile ret;
+
+	if(m_ReplayHost)
+	{
+		ret = m_Remote->GetLoadProfile();
+	}
+	else
+	{
+		if(!SendReplayCommand(eCommand_GetLoadProfile))
+			return ret;
+	}
+
+	m_FromReplaySerialiser->Serialise("", ret);
+
+	return ret;
+}
+
 bool ProxySerialiser::HasCallstacks()
 {
 	bool ret = false;
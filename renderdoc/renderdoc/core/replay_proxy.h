@@ -88,6 +88,11 @@ enum CommandPacketType
 	eCommand_GetAPIProperties,
 	
 	eCommand_PixelHistory,
+
+	eCommand_GetLoadProfile,
+
+	eCommand_SetReplayCheckpoints,
+	eCommand_GetReplayCheckpointStats,
 };
 
 // This class implements IReplayDriver and StackResolver. On the local machine where the UI
@@ -329,6 +334,12 @@ class ProxySerialiser : public IReplayDriver, Callstack::StackResolver
 		void SetIDRenderingEvents(uint32_t frameID, uint32_t startEvent, uint32_t endEvent) {}
 		/* Added by Stephan Richter | END */
 
+		// readbacks aren't batched across the proxy, callers fall back to GetBufferData/GetTextureData
+		uint32_t QueueBufferReadback(ResourceId buff, uint32_t offset, uint32_t len) { return 0; }
+		uint32_t QueueTextureReadback(ResourceId tex, uint32_t arrayIdx, uint32_t mip) { return 0; }
+		bool FetchReadback(uint32_t ticket, bool wait, vector<byte> &data) { return false; }
+		void FreeReadbacks() {}
+
 		bool Tick();
 
 		vector<ResourceId> GetBuffers();
@@ -350,10 +361,13 @@ class ProxySerialiser : public IReplayDriver, Callstack::StackResolver
 		GLPipelineState GetGLPipelineState() { return m_GLPipelineState; }
 		
 		void SetContextFilter(ResourceId id, uint32_t firstDefEv, uint32_t lastDefEv);
+		void SetReplayCheckpoints(uint32_t eventInterval, uint64_t memoryBudget);
+		ReplayCheckpointStats GetReplayCheckpointStats();
 		void ReplayLog(uint32_t frameID, uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType);
 		
 		vector<EventUsage> GetUsage(ResourceId id);
 		vector<FetchFrameRecord> GetFrameRecord();
+		LoadProfile GetLoadProfile();
 		
 		bool IsRenderOutput(ResourceId id);
 		
@@ -33,11 +33,16 @@
 
 #include "serialise/serialiser.h"
 #include "common/threading.h"
+#include "common/timing.h"
+
+#include "core/load_profile.h"
 
 #include <set>
 #include <map>
+#include <list>
 using std::set;
 using std::map;
+using std::list;
 
 // in what way (read, write, etc) was a resource referenced in a frame -
 // used to determine if initial contents are needed and to what degree
@@ -410,6 +415,61 @@ class ResourceManager : public ResourceRecordHandler
 		// Apply the initial contents for the resources that need them, used at the start of a frame
 		void ApplyInitialContents();
 
+		// when set, ApplyInitialContents records per-resource-type timings in the profiler
+		void SetLoadProfiler(LoadProfiler *profiler) { m_LoadProfiler = profiler; }
+
+		// type name of the resource whose initial contents were last set, for attributing
+		// INITIAL_CONTENTS chunks while profiling a load. Resets until the next SetInitialContents.
+		string TakeLastInitialContentsType();
+
+		// when non-zero, INITIAL_CONTENTS chunks aren't serialised in as they're read but moved out
+		// to a spill file, and only paged back in by ApplyInitialContents. At most budget bytes of
+		// serialised contents are kept resident, least recently applied are evicted first. Must be
+		// set before the log is read.
+		void SetInitialContentsBudget(uint64_t budget);
+		bool IsDeferringInitialContents() { return m_InitialContentsBudget > 0; }
+
+		// move the INITIAL_CONTENTS chunk the serialiser is sitting in to the spill file, in place
+		// of Serialise_InitialState
+		void DeferInitialContentsChunk();
+
+		struct InitialContentsStats
+		{
+			InitialContentsStats() : hits(0), misses(0), evictions(0), bytesPagedIn(0), peakResident(0) {}
+			uint32_t hits;
+			uint32_t misses;
+			uint32_t evictions;
+			uint64_t bytesPagedIn;
+			uint64_t peakResident;
+		};
+
+		const InitialContentsStats &GetInitialContentsStats() { return m_InitialContentsStats; }
+
+		// contents of a set of resources snapshotted part-way through a frame. Applying it puts
+		// those resources back as they were at eventID, so replay can continue from the next
+		// event instead of from the start of the frame.
+		struct Checkpoint
+		{
+			Checkpoint() : eventID(0), byteSize(0) {}
+			uint32_t eventID;
+			uint64_t byteSize;
+			map<ResourceId, InitialContentData> contents;
+		};
+
+		// adds the resources a checkpoint must cover regardless of how the frame uses them - anything
+		// the capture recorded as written in the frame (which covers CPU-side updates like maps and
+		// sub-data uploads), and anything created during the frame. Resources the frame only reads
+		// keep their contents throughout, so don't need snapshotting even if they have initial
+		// contents.
+		void GetCheckpointResources(set<ResourceId> &ids);
+
+		// snapshot the current contents of each live resource in ids (original IDs)
+		void CreateCheckpoint(const set<ResourceId> &ids, Checkpoint &checkpoint);
+
+		// returns false without applying anything if a resource in the checkpoint is no longer live
+		bool ApplyCheckpoint(const Checkpoint &checkpoint);
+		void FreeCheckpoint(Checkpoint &checkpoint);
+
 		// Resource wrapping, allows for querying and adding/removing of wrapper layers around resources
 		bool AddWrapper(ResourceType wrap, ResourceType real);
 		bool HasWrapper(ResourceType real);
@@ -430,18 +490,69 @@ class ResourceManager : public ResourceRecordHandler
 		virtual void Create_InitialState(ResourceId id, ResourceType live, bool hasData) = 0;
 		virtual void Apply_InitialState(ResourceType live, InitialContentData initial) = 0;
 
+		// only used for profiling output
+		virtual string GetResourceTypeName(ResourceType live) { return "Unknown"; }
+
+		// replay checkpoints. Snapshot_State returns false if the resource has no mutable
+		// contents worth keeping, otherwise fills data in a form Apply_InitialState accepts
+		// and its approximate size in bytes.
+		virtual bool Snapshot_State(ResourceType live, InitialContentData &data, uint64_t &byteSize) { return false; }
+		virtual void Free_Snapshot(InitialContentData data) {}
+
+		// deferred initial contents. Peek_InitialStateID reads just the ID from the start of a
+		// serialised initial state, and SetSerialiser must point everything Serialise_InitialState
+		// reads from at ser while a deferred chunk is paged in.
+		virtual ResourceId Peek_InitialStateID(Serialiser *ser) = 0;
+		virtual void SetSerialiser(Serialiser *ser) { m_pSerialiser = ser; }
+
 		LogState m_State;
 		Serialiser *m_pSerialiser;
 
-	private:
-		bool m_InFrame;
-
 		// very coarse lock, protects EVERYTHING. This could certainly be improved and it may be a bottleneck
 		// for performance. Given that the main use cases are write-rarely read-often the lock should be optimised
 		// for that as we only want to make sure we're not modifying the objects together, by far the most common
 		// operation is looking up data.
+		// Derived managers take it too around any lookup tables of their own.
 		Threading::CriticalSection m_Lock;
 
+	private:
+		bool m_InFrame;
+
+		LoadProfiler *m_LoadProfiler;
+		ResourceId m_LastInitialContents;
+
+		// where a deferred INITIAL_CONTENTS chunk lives in the spill file. It's preceded by enough
+		// padding to sit at the same buffer alignment it had in the log.
+		struct DeferredInitialContents
+		{
+			uint64_t spillOffset;
+			uint32_t padding;
+			uint32_t length;
+			bool resident;
+			list<ResourceId>::iterator lru;
+		};
+
+		void ApplyInitialState(ResourceType live, InitialContentData data);
+		bool PageInInitialContents(ResourceId id, DeferredInitialContents &deferred);
+		void EvictInitialContents(ResourceId id, DeferredInitialContents &deferred);
+
+		uint64_t m_InitialContentsBudget;
+		uint64_t m_ResidentInitialContents;
+		InitialContentsStats m_InitialContentsStats;
+
+		// used during replay - deferred initial contents, and which of those are resident in
+		// m_InitialContents from least to most recently applied
+		map<ResourceId, DeferredInitialContents> m_DeferredInitialContents;
+		list<ResourceId> m_ResidentLRU;
+
+		// used during replay - resources the capture recorded as written or dirty, from
+		// Serialise_InitialContentsNeeded. Not all of them have initial contents.
+		set<ResourceId> m_WrittenResources;
+
+		string m_SpillFilename;
+		FILE *m_SpillFile;
+		uint64_t m_SpillSize;
+
 		// easy optimisation win - don't use maps everywhere. It's convenient but not optimal, and profiling will
 		// likely prove that some or all of these could be a problem
 		
@@ -488,6 +599,13 @@ ResourceManager<ResourceType, RecordType>::ResourceManager(LogState state, Seria
 	m_pSerialiser = ser;
 	
 	m_InFrame = false;
+
+	m_LoadProfiler = NULL;
+
+	m_InitialContentsBudget = 0;
+	m_ResidentInitialContents = 0;
+	m_SpillFile = NULL;
+	m_SpillSize = 0;
 }
 
 template<typename ResourceType, typename RecordType>
@@ -518,6 +636,21 @@ void ResourceManager<ResourceType, RecordType>::Shutdown()
 			m_InitialContents.erase(m_InitialContents.begin());
 	}
 
+	if(m_SpillFile)
+	{
+		RDCLOG("Initial contents: %u hits, %u misses, %u evictions, %llu bytes paged in, peak %llu of %llu bytes resident",
+		       m_InitialContentsStats.hits, m_InitialContentsStats.misses, m_InitialContentsStats.evictions,
+		       m_InitialContentsStats.bytesPagedIn, m_InitialContentsStats.peakResident, m_InitialContentsBudget);
+
+		FileIO::fclose(m_SpillFile);
+		FileIO::Delete(m_SpillFilename.c_str());
+		m_SpillFile = NULL;
+	}
+
+	m_DeferredInitialContents.clear();
+	m_ResidentLRU.clear();
+	m_ResidentInitialContents = 0;
+
 	RDCASSERT(m_ResourceRecords.empty());
 }
 
@@ -679,6 +812,166 @@ void ResourceManager<ResourceType, RecordType>::SetInitialContents(ResourceId id
 	}
 	
 	m_InitialContents[id] = contents;
+
+	m_LastInitialContents = id;
+}
+
+template<typename ResourceType, typename RecordType>
+string ResourceManager<ResourceType, RecordType>::TakeLastInitialContentsType()
+{
+	ResourceId id = m_LastInitialContents;
+	m_LastInitialContents = ResourceId();
+
+	if(id == ResourceId() || !HasLiveResource(id))
+		return "Unknown";
+
+	return GetResourceTypeName(GetLiveResource(id));
+}
+
+template<typename ResourceType, typename RecordType>
+void ResourceManager<ResourceType, RecordType>::SetInitialContentsBudget(uint64_t budget)
+{
+	// logs before 0x32 pad buffers in-stream relative to the whole log, which a chunk
+	// read back on its own can't reproduce
+	if(budget > 0 && m_pSerialiser->GetSerialiseVersion() < 0x00000032)
+	{
+		RDCWARN("Log is too old to defer initial contents, keeping them all in memory");
+		budget = 0;
+	}
+
+	m_InitialContentsBudget = budget;
+}
+
+template<typename ResourceType, typename RecordType>
+void ResourceManager<ResourceType, RecordType>::DeferInitialContentsChunk()
+{
+	uint64_t offset = m_pSerialiser->GetOffset();
+	size_t length = m_pSerialiser->GetCurrentChunkLength();
+	const byte *data = (const byte *)m_pSerialiser->RawReadBytes(length);
+
+	ResourceId id;
+
+	{
+		// the ID is right at the start, no need to copy the whole chunk to find it
+		Serialiser peek(RDCMIN(length, (size_t)64), data, false);
+		id = Peek_InitialStateID(&peek);
+	}
+
+	m_LastInitialContents = id;
+
+	if(m_SpillFile == NULL)
+	{
+		m_SpillFilename = FileIO::GetAppFolderFilename(StringFormat::Fmt("initialcontents_%u_%p.tmp", Process::GetCurrentPID(), this));
+		m_SpillFile = FileIO::fopen(m_SpillFilename.c_str(), "w+b");
+
+		if(m_SpillFile == NULL)
+		{
+			RDCERR("Couldn't open '%s' to spill initial contents, keeping them all in memory", m_SpillFilename.c_str());
+			m_InitialContentsBudget = 0;
+		}
+	}
+
+	uint32_t padding = uint32_t(offset % Serialiser::BufferAlignment);
+
+	if(m_SpillFile == NULL || id == ResourceId())
+	{
+		// serialise it in now, as if it had never been deferred
+		byte *buf = new byte[padding + length];
+		memcpy(buf + padding, data, length);
+
+		Serialiser ser(padding + length, buf, false);
+		ser.SetOffset(padding);
+
+		SAFE_DELETE_ARRAY(buf);
+
+		Serialiser *prev = m_pSerialiser;
+		SetSerialiser(&ser);
+		Serialise_InitialState((ResourceType)RecordType::NullResource);
+		SetSerialiser(prev);
+		return;
+	}
+
+	static const byte zeroes[64] = {0};
+	RDCASSERT(padding < sizeof(zeroes));
+
+	FileIO::fseek64(m_SpillFile, m_SpillSize, SEEK_SET);
+	FileIO::fwrite(zeroes, 1, padding, m_SpillFile);
+	FileIO::fwrite(data, 1, length, m_SpillFile);
+
+	DeferredInitialContents &deferred = m_DeferredInitialContents[id];
+	deferred.spillOffset = m_SpillSize;
+	deferred.padding = padding;
+	deferred.length = (uint32_t)length;
+	deferred.resident = false;
+	deferred.lru = m_ResidentLRU.end();
+
+	m_SpillSize += padding + length;
+}
+
+template<typename ResourceType, typename RecordType>
+bool ResourceManager<ResourceType, RecordType>::PageInInitialContents(ResourceId id, DeferredInitialContents &deferred)
+{
+	if(deferred.resident)
+	{
+		m_InitialContentsStats.hits++;
+		m_ResidentLRU.splice(m_ResidentLRU.end(), m_ResidentLRU, deferred.lru);
+		return m_InitialContents.find(id) != m_InitialContents.end();
+	}
+
+	m_InitialContentsStats.misses++;
+
+	size_t size = deferred.padding + deferred.length;
+	byte *buf = new byte[size];
+
+	FileIO::fseek64(m_SpillFile, deferred.spillOffset, SEEK_SET);
+	if(FileIO::fread(buf, 1, size, m_SpillFile) != size)
+	{
+		RDCERR("Couldn't read initial contents for %llu back from spill file", id);
+		SAFE_DELETE_ARRAY(buf);
+		return false;
+	}
+
+	Serialiser ser(size, buf, false);
+	ser.SetOffset(deferred.padding);
+
+	SAFE_DELETE_ARRAY(buf);
+
+	Serialiser *prev = m_pSerialiser;
+	SetSerialiser(&ser);
+	Serialise_InitialState((ResourceType)RecordType::NullResource);
+	SetSerialiser(prev);
+
+	deferred.resident = true;
+	deferred.lru = m_ResidentLRU.insert(m_ResidentLRU.end(), id);
+
+	m_ResidentInitialContents += deferred.length;
+	m_InitialContentsStats.bytesPagedIn += deferred.length;
+	m_InitialContentsStats.peakResident = RDCMAX(m_InitialContentsStats.peakResident, m_ResidentInitialContents);
+
+	return m_InitialContents.find(id) != m_InitialContents.end();
+}
+
+template<typename ResourceType, typename RecordType>
+void ResourceManager<ResourceType, RecordType>::EvictInitialContents(ResourceId id, DeferredInitialContents &deferred)
+{
+	if(!deferred.resident)
+		return;
+
+	auto it = m_InitialContents.find(id);
+
+	if(it != m_InitialContents.end())
+	{
+		ResourceTypeRelease(it->second.resource);
+		Serialiser::FreeAlignedBuffer(it->second.blob);
+		m_InitialContents.erase(it);
+	}
+
+	m_ResidentLRU.erase(deferred.lru);
+	deferred.lru = m_ResidentLRU.end();
+	deferred.resident = false;
+
+	m_ResidentInitialContents -= deferred.length;
+	m_InitialContentsStats.evictions++;
 }
 
 template<typename ResourceType, typename RecordType>
@@ -779,10 +1072,29 @@ void ResourceManager<ResourceType, RecordType>::CreateInitialContents()
 
 		neededInitials.insert(id);
 
-		if(HasLiveResource(id) && m_InitialContents.find(id) == m_InitialContents.end())
+		if(HasLiveResource(id) && m_InitialContents.find(id) == m_InitialContents.end() &&
+		   m_DeferredInitialContents.find(id) == m_DeferredInitialContents.end())
 			Create_InitialState(id, GetLiveResource(id), WrittenData);
 	}
 
+	m_WrittenResources = neededInitials;
+
+	for(auto it=m_DeferredInitialContents.begin(); it != m_DeferredInitialContents.end(); )
+	{
+		ResourceId id = it->first;
+
+		if(neededInitials.find(id) == neededInitials.end())
+		{
+			EvictInitialContents(id, it->second);
+			++it;
+			m_DeferredInitialContents.erase(id);
+		}
+		else
+		{
+			++it;
+		}
+	}
+
 	for(auto it=m_InitialContents.begin(); it != m_InitialContents.end(); )
 	{
 		ResourceId id = it->first;
@@ -809,17 +1121,117 @@ void ResourceManager<ResourceType, RecordType>::ApplyInitialContents()
 	for(auto it=m_InitialContents.begin(); it != m_InitialContents.end(); ++it)
 	{
 		ResourceId id = it->first;
+
+		// paged in below
+		if(m_DeferredInitialContents.find(id) != m_DeferredInitialContents.end())
+			continue;
 		
 		if(HasLiveResource(id))
 		{
-			ResourceType live = GetLiveResource(id);
+			numContents++;
+			ApplyInitialState(GetLiveResource(id), it->second);
+		}
+	}
+
+	for(auto it=m_DeferredInitialContents.begin(); it != m_DeferredInitialContents.end(); ++it)
+	{
+		ResourceId id = it->first;
+
+		if(!HasLiveResource(id))
+			continue;
 
+		if(PageInInitialContents(id, it->second))
+		{
 			numContents++;
+			ApplyInitialState(GetLiveResource(id), m_InitialContents[id]);
+		}
 
-			Apply_InitialState(live, it->second);
+		// the one just applied is most recent, so it's only evicted if it alone is over budget
+		while(m_ResidentInitialContents > m_InitialContentsBudget && !m_ResidentLRU.empty())
+		{
+			ResourceId lru = m_ResidentLRU.front();
+			EvictInitialContents(lru, m_DeferredInitialContents[lru]);
 		}
 	}
+
 	RDCDEBUG("Applied %d", numContents);
+
+	if(!m_DeferredInitialContents.empty())
+		RDCDEBUG("%llu of %llu budgeted bytes of initial contents resident, %u hits %u misses %u evictions so far",
+		         m_ResidentInitialContents, m_InitialContentsBudget, m_InitialContentsStats.hits,
+		         m_InitialContentsStats.misses, m_InitialContentsStats.evictions);
+}
+
+template<typename ResourceType, typename RecordType>
+void ResourceManager<ResourceType, RecordType>::ApplyInitialState(ResourceType live, InitialContentData data)
+{
+	if(m_LoadProfiler)
+	{
+		PerformanceTimer timer;
+
+		Apply_InitialState(live, data);
+
+		m_LoadProfiler->AddInitialContentsApply(GetResourceTypeName(live), timer.GetMilliseconds());
+	}
+	else
+	{
+		Apply_InitialState(live, data);
+	}
+}
+
+template<typename ResourceType, typename RecordType>
+void ResourceManager<ResourceType, RecordType>::GetCheckpointResources(set<ResourceId> &ids)
+{
+	SCOPED_LOCK(m_Lock);
+
+	ids.insert(m_WrittenResources.begin(), m_WrittenResources.end());
+
+	for(auto it=m_InframeResourceMap.begin(); it != m_InframeResourceMap.end(); ++it)
+		ids.insert(it->first);
+}
+
+template<typename ResourceType, typename RecordType>
+void ResourceManager<ResourceType, RecordType>::CreateCheckpoint(const set<ResourceId> &ids, Checkpoint &checkpoint)
+{
+	for(auto it=ids.begin(); it != ids.end(); ++it)
+	{
+		if(!HasLiveResource(*it))
+			continue;
+
+		InitialContentData data;
+		uint64_t size = 0;
+
+		if(Snapshot_State(GetLiveResource(*it), data, size))
+		{
+			checkpoint.contents[*it] = data;
+			checkpoint.byteSize += size;
+		}
+	}
+}
+
+template<typename ResourceType, typename RecordType>
+bool ResourceManager<ResourceType, RecordType>::ApplyCheckpoint(const Checkpoint &checkpoint)
+{
+	// resources created in the frame after a full replay stopped short of their
+	// creation won't exist yet, in which case this checkpoint can't be used.
+	for(auto it=checkpoint.contents.begin(); it != checkpoint.contents.end(); ++it)
+		if(!HasLiveResource(it->first))
+			return false;
+
+	for(auto it=checkpoint.contents.begin(); it != checkpoint.contents.end(); ++it)
+		Apply_InitialState(GetLiveResource(it->first), it->second);
+
+	return true;
+}
+
+template<typename ResourceType, typename RecordType>
+void ResourceManager<ResourceType, RecordType>::FreeCheckpoint(Checkpoint &checkpoint)
+{
+	for(auto it=checkpoint.contents.begin(); it != checkpoint.contents.end(); ++it)
+		Free_Snapshot(it->second);
+
+	checkpoint.contents.clear();
+	checkpoint.byteSize = 0;
 }
 
 template<typename ResourceType, typename RecordType>
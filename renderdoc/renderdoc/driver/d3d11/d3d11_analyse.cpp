@@ -1144,21 +1144,19 @@ ShaderDebugTrace D3D11DebugManager::DebugVertex(uint32_t frameID, uint32_t event
 
 	State last;
 
-	vector<ShaderDebugState> states;
-
-	states.push_back((State)initialState);
+	TraceRecorder recorder(initialState);
 	
 	while(true)
 	{
 		if(initialState.Finished())
 			break;
 
-		initialState = initialState.GetNext(global, NULL);
+		initialState.Step(global, NULL);
 
-		states.push_back((State)initialState);
+		recorder.AddStep(initialState);
 	}
 
-	ret.states = states;
+	recorder.Fill(ret);
 
 	return ret;
 }
@@ -1906,9 +1904,7 @@ ShaderDebugTrace D3D11DebugManager::DebugPixel(uint32_t frameID, uint32_t eventI
 		}
 	}
 	
-	vector<ShaderDebugState> states;
-
-	states.push_back((State)quad[destIdx]);
+	TraceRecorder recorder(quad[destIdx]);
 	
 	// ping pong between so that we can have 'current' quad to update into new one
 	State quad2[4];
@@ -1927,13 +1923,13 @@ ShaderDebugTrace D3D11DebugManager::DebugPixel(uint32_t frameID, uint32_t eventI
 		curquad = newquad;
 		newquad = a;
 		
-		states.push_back((State)curquad[destIdx]);
+		recorder.AddStep(curquad[destIdx]);
 
 		finished = curquad[destIdx].Finished();
 	}
 	while(!finished);
 
-	traces[destIdx].states = states;
+	recorder.Fill(traces[destIdx]);
 
 	return traces[destIdx];
 }
@@ -1982,21 +1978,19 @@ ShaderDebugTrace D3D11DebugManager::DebugThread(uint32_t frameID, uint32_t event
 		initialState.semantics.ThreadID[i] = threadid[i];
 	}
 
-	vector<ShaderDebugState> states;
-
-	states.push_back((State)initialState);
+	TraceRecorder recorder(initialState);
 	
 	while(true)
 	{
 		if(initialState.Finished())
 			break;
 
-		initialState = initialState.GetNext(global, NULL);
+		initialState.Step(global, NULL);
 
-		states.push_back((State)initialState);
+		recorder.AddStep(initialState);
 	}
 
-	ret.states = states;
+	recorder.Fill(ret);
 
 	return ret;
 }
@@ -29,6 +29,10 @@
 
 #include "serialise/serialiser.h"
 
+#include "replay/MurmurHash3.h"
+
+#include <algorithm>
+
 #include "d3d11_common.h"
 #include "driver/d3d11/d3d11_resources.h"
 #include "driver/d3d11/d3d11_renderstate.h"
@@ -1102,6 +1106,213 @@ ShaderReflection *MakeShaderReflection(DXBC::DXBCFile *dxbc)
 	return ret;
 }
 
+// defined in replay_proxy.cpp
+template<> void Serialiser::Serialise(const char *name, ShaderReflection &el);
+
+// The cache is one .rdsc file per shader in the shadercache folder under the app folder.
+// Deleting the folder clears it, and it's trimmed to MaxShaderCacheEntries as it grows.
+
+// bump whenever MakeShaderReflection changes what it produces, to invalidate
+// anything already in the cache
+static const uint32_t ShaderCacheVersion = 2;
+
+static const uint32_t ShaderCacheMagic = MAKE_FOURCC('R', 'D', 'S', 'C');
+
+// each entry is a few KB, so this keeps the cache to tens of MB
+static const size_t MaxShaderCacheEntries = 8192;
+
+// written raw in front of the serialised reflection, and checked before any of it is read
+struct ShaderCacheHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t bytecodeHash[2];
+	uint64_t payloadLength;
+	uint64_t payloadHash[2];
+};
+
+static string ShaderCacheDir()
+{
+	return FileIO::GetAppFolderFilename("shadercache");
+}
+
+static string ShaderCacheFilename(const vector<byte> &bytecode, uint64_t hash[2])
+{
+	MurmurHash3_x64_128(&bytecode[0], (int)bytecode.size(), 0, hash);
+
+	return ShaderCacheDir() + StringFormat::Fmt("/%016llx%016llx.rdsc", (unsigned long long)hash[0], (unsigned long long)hash[1]);
+}
+
+struct ShaderCacheEntry
+{
+	string filename;
+	uint64_t timestamp;
+
+	bool operator <(const ShaderCacheEntry &o) const { return timestamp < o.timestamp; }
+};
+
+// once per process, before the first store, delete the oldest entries if the cache is over
+// budget. Trims to 3/4 so it doesn't have to happen again straight away.
+static void TrimShaderCache()
+{
+	static volatile int32_t trimmed = 0;
+	if(Atomic::Inc32(&trimmed) != 1)
+		return;
+
+	string dir = ShaderCacheDir();
+
+	vector<string> files;
+	FileIO::GetFilesInDirectory(dir, files);
+
+
+	vector<ShaderCacheEntry> entries;
+	for(size_t i=0; i < files.size(); i++)
+	{
+		// leave other processes' in-progress writes alone
+		if(files[i].size() < 5 || files[i].compare(files[i].size()-5, 5, ".rdsc") != 0)
+			continue;
+
+		ShaderCacheEntry e;
+		e.filename = dir + "/" + files[i];
+		e.timestamp = FileIO::GetModifiedTimestamp(e.filename);
+		entries.push_back(e);
+	}
+
+	if(entries.size() <= MaxShaderCacheEntries)
+		return;
+
+	std::sort(entries.begin(), entries.end());
+
+	size_t numDelete = entries.size() - MaxShaderCacheEntries*3/4;
+
+	RDCLOG("Shader cache has %u entries, deleting the oldest %u", (uint32_t)entries.size(), (uint32_t)numDelete);
+
+	for(size_t i=0; i < numDelete; i++)
+		FileIO::Delete(entries[i].filename.c_str());
+}
+
+ShaderReflection *LoadCachedShaderReflection(const vector<byte> &bytecode)
+{
+	if(bytecode.empty() || !RenderDoc::Inst().IsReplayApp())
+		return NULL;
+
+	uint64_t hash[2];
+	string filename = ShaderCacheFilename(bytecode, hash);
+
+	FILE *f = FileIO::fopen(filename.c_str(), "rb");
+
+	if(f == NULL)
+		return NULL;
+
+	FileIO::fseek64(f, 0, SEEK_END);
+	uint64_t len = FileIO::ftell64(f);
+	FileIO::fseek64(f, 0, SEEK_SET);
+
+	if(len <= sizeof(ShaderCacheHeader))
+	{
+		FileIO::fclose(f);
+		return NULL;
+	}
+
+	vector<byte> data((size_t)len);
+	size_t read = FileIO::fread(&data[0], 1, data.size(), f);
+
+	FileIO::fclose(f);
+
+	if(read != data.size())
+		return NULL;
+
+	ShaderCacheHeader header;
+	memcpy(&header, &data[0], sizeof(header));
+
+	byte *payload = &data[sizeof(header)];
+	uint64_t payloadLength = data.size() - sizeof(header);
+
+	// stale entry from an older build, or a hash collision. Either way it'll be
+	// overwritten with a fresh reflection
+	if(header.magic != ShaderCacheMagic || header.version != ShaderCacheVersion ||
+	   header.bytecodeHash[0] != hash[0] || header.bytecodeHash[1] != hash[1])
+		return NULL;
+
+	// truncated or otherwise damaged, don't let the serialiser near it
+	uint64_t payloadHash[2] = { 0, 0 };
+	if(header.payloadLength == payloadLength)
+		MurmurHash3_x64_128(payload, (int)payloadLength, 0, payloadHash);
+
+	if(header.payloadLength != payloadLength || payloadHash[0] != header.payloadHash[0] || payloadHash[1] != header.payloadHash[1])
+	{
+		RDCWARN("Corrupt shader cache entry '%s'", filename.c_str());
+		return NULL;
+	}
+
+	Serialiser ser((size_t)payloadLength, payload, false);
+
+	ShaderReflection *ret = new ShaderReflection();
+
+	ser.Serialise("", *ret);
+	ser.Serialise("", ret->DebugInfo.entryFile);
+
+	if(ser.HasError())
+	{
+		RDCWARN("Corrupt shader cache entry '%s'", filename.c_str());
+		SAFE_DELETE(ret);
+	}
+
+	return ret;
+}
+
+void StoreCachedShaderReflection(const vector<byte> &bytecode, ShaderReflection *refl)
+{
+	if(bytecode.empty() || refl == NULL)
+		return;
+
+	uint64_t hash[2];
+	string filename = ShaderCacheFilename(bytecode, hash);
+
+	Serialiser ser("", Serialiser::WRITING, false);
+
+	ser.Rewind();
+
+	ser.Serialise("", *refl);
+	ser.Serialise("", refl->DebugInfo.entryFile);
+
+	ShaderCacheHeader header;
+	header.magic = ShaderCacheMagic;
+	header.version = ShaderCacheVersion;
+	header.bytecodeHash[0] = hash[0];
+	header.bytecodeHash[1] = hash[1];
+	header.payloadLength = ser.GetOffset();
+	MurmurHash3_x64_128(ser.GetRawPtr(0), (int)header.payloadLength, 0, header.payloadHash);
+
+	FileIO::CreateParentDirectory(filename);
+
+	TrimShaderCache();
+
+	// written under a name no other process or thread is using then moved into place, so a
+	// reader never sees a partly written entry
+	string tmpname = filename + StringFormat::Fmt(".%u.%llu.tmp", Process::GetCurrentPID(), Threading::GetCurrentID());
+
+	FILE *f = FileIO::fopen(tmpname.c_str(), "wb");
+
+	if(f == NULL)
+	{
+		RDCWARN("Couldn't write shader cache entry '%s'", tmpname.c_str());
+		return;
+	}
+
+	size_t written = FileIO::fwrite(&header, 1, sizeof(header), f);
+	written += FileIO::fwrite(ser.GetRawPtr(0), 1, (size_t)header.payloadLength, f);
+
+	FileIO::fclose(f);
+
+	// replacing is fine, anything already there is either the same or stale
+	if(written != sizeof(header) + header.payloadLength || !FileIO::Move(tmpname.c_str(), filename.c_str(), true))
+	{
+		RDCWARN("Couldn't write shader cache entry '%s'", filename.c_str());
+		FileIO::Delete(tmpname.c_str());
+	}
+}
+
 /////////////////////////////////////////////////////////////
 // Structures/descriptors. Serialise members separately
 // instead of ToStrInternal separately. Mostly for convenience of
@@ -55,6 +55,12 @@ D3D11_PRIMITIVE_TOPOLOGY MakeD3D11PrimitiveTopology(PrimitiveTopology Topo);
 
 ShaderReflection *MakeShaderReflection(DXBC::DXBCFile *dxbc);
 
+// on-disk cache of MakeShaderReflection results keyed by a hash of the bytecode,
+// so re-opening captures doesn't re-parse and disassemble every shader.
+// Load returns NULL on a miss.
+ShaderReflection *LoadCachedShaderReflection(const vector<byte> &bytecode);
+void StoreCachedShaderReflection(const vector<byte> &bytecode, ShaderReflection *refl);
+
 template<class T>
 inline void SetDebugName( T* pObj, const char* name )
 {
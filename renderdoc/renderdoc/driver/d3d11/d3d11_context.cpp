@@ -462,7 +462,7 @@ void WrappedID3D11DeviceContext::EndCaptureFrame()
 
 	if(HasCallstack)
 	{
-		Callstack::Stackwalk *call = Callstack::Collect();
+		Callstack::Stackwalk *call = RenderDoc::Inst().CollectCallstack();
 
 		RDCASSERT(call->NumLevels() < 0xff);
 
@@ -1236,7 +1236,12 @@ void WrappedID3D11DeviceContext::ReplayLog(LogState readType, uint32_t startEven
 
 		D3D11ChunkType chunktype = (D3D11ChunkType)m_pSerialiser->PushContext(NULL, 1, false);
 
+		PerformanceTimer timer;
+
 		ProcessChunk(offset, chunktype, false);
+
+		if(m_State == READING)
+			m_pDevice->GetLoadProfiler().AddEvent(m_CurEventID, timer.GetMilliseconds());
 		
 		RenderDoc::Inst().SetProgress(FrameEventsRead, float(offset - startOffset)/float(m_pSerialiser->GetSize()));
 		
@@ -168,6 +168,10 @@ private:
 
 	map<ResourceId, vector<EventUsage> > m_ResourceUses;
 
+	// resources the frame writes outside of the pipeline - Unmap, UpdateSubresource and
+	// CopyStructureCount - which aren't in m_ResourceUses. Original IDs, filled when reading.
+	set<ResourceId> m_UpdatedResources;
+
 	WrappedID3D11Device* m_pDevice;
 	ID3D11DeviceContext* m_pRealContext;
 #if defined(INCLUDE_D3D_11_1)
@@ -312,6 +316,11 @@ public:
 	vector<EventUsage> GetUsage(ResourceId id) { return m_ResourceUses[id]; }
 
 	void ClearMaps();
+	bool HasOpenMaps() { return !m_OpenMaps.empty(); }
+
+	const vector<FetchAPIEvent> &GetEvents() { return m_Events; }
+	const map<ResourceId, vector<EventUsage> > &GetResourceUses() { return m_ResourceUses; }
+	const set<ResourceId> &GetUpdatedResources() { return m_UpdatedResources; }
 
 	uint32_t GetEventID() { return m_CurEventID; }
 	FetchAPIEvent GetEvent(uint32_t eventID);
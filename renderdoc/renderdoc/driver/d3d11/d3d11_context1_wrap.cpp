@@ -52,6 +52,9 @@ bool WrappedID3D11DeviceContext::Serialise_UpdateSubresource1(ID3D11Resource *pD
 			DestResource = (ID3D11Resource *)m_pDevice->GetResourceManager()->GetLiveResource(idx);
 	}
 
+	if(m_State == READING)
+		m_UpdatedResources.insert(idx);
+
 	if(isUpdate)
 	{
 		SERIALISE_ELEMENT(uint8_t, HasDestBox, pDstBox != NULL);
@@ -3552,7 +3552,7 @@ void WrappedID3D11DeviceContext::Serialise_DebugMessages()
 	{
 		if(m_State >= WRITING)
 		{
-			Callstack::Stackwalk *call = Callstack::Collect();
+			Callstack::Stackwalk *call = RenderDoc::Inst().CollectCallstack();
 
 			RDCASSERT(call->NumLevels() < 0xff);
 
@@ -5545,6 +5545,9 @@ bool WrappedID3D11DeviceContext::Serialise_CopyStructureCount(ID3D11Buffer *pDst
 	SERIALISE_ELEMENT(uint32_t, DestAlignedByteOffset, DstAlignedByteOffset);
 	SERIALISE_ELEMENT(ResourceId, SourceView, GetIDForResource(pSrcView));
 
+	if(m_State == READING)
+		m_UpdatedResources.insert(DestBuffer);
+
 	if(m_State <= EXECUTING &&
 		 m_pDevice->GetResourceManager()->HasLiveResource(DestBuffer) &&
 		 m_pDevice->GetResourceManager()->HasLiveResource(SourceView))
@@ -7118,6 +7121,9 @@ bool WrappedID3D11DeviceContext::Serialise_Unmap(ID3D11Resource *pResource, UINT
 		}
 	}
 
+	if(m_State == READING)
+		m_UpdatedResources.insert(mapIdx.resource);
+
 	if(m_State < WRITING || m_State == WRITING_CAPFRAME)
 	{
 		size_t len = record ? record->Length : 0;
@@ -7128,20 +7134,44 @@ bool WrappedID3D11DeviceContext::Serialise_Unmap(ID3D11Resource *pResource, UINT
 
 		size_t diffStart = 0;
 		size_t diffEnd = len;
+
+		// when the app wrote to several separate parts of the resource, only those
+		// ranges are serialised, packed together one after the other. Otherwise
+		// this is empty and the data covers all of [diffStart, diffEnd)
+		vector<DiffRange> ranges;
+		vector<byte> packed;
 		
 		if(m_State == WRITING_CAPFRAME && len > 512 && intercept.MapType != D3D11_MAP_WRITE_DISCARD)
 		{
-			bool found = FindDiffRange(appWritePtr, record->GetShadowPtr(ctxMapID, 1), len, diffStart, diffEnd);
-			if(found)
+			FindDiffRanges(appWritePtr, record->GetShadowPtr(ctxMapID, 1), len, MapDiffMergeGap, ranges);
+			if(!ranges.empty())
 			{
+				diffStart = ranges.front().start;
+				diffEnd = ranges.back().end;
+
+				size_t written = 0;
+				for(size_t i=0; i < ranges.size(); i++)
+					written += ranges[i].end - ranges[i].start;
+
 				static size_t saved = 0;
 
-				saved += len - (diffEnd-diffStart);
+				saved += len - written;
 
-				RDCDEBUG("Mapped resource size %u, difference: %u -> %u. Total bytes saved so far: %u",
-								(uint32_t)len, (uint32_t)diffStart, (uint32_t)diffEnd, (uint32_t)saved);
+				RDCDEBUG("Mapped resource size %u, difference: %u -> %u in %u ranges. Total bytes saved so far: %u",
+								(uint32_t)len, (uint32_t)diffStart, (uint32_t)diffEnd, (uint32_t)ranges.size(), (uint32_t)saved);
 
-				len = diffEnd-diffStart;
+				if(ranges.size() > 1)
+				{
+					packed.reserve(written);
+					for(size_t i=0; i < ranges.size(); i++)
+						packed.insert(packed.end(), appWritePtr+ranges[i].start, appWritePtr+ranges[i].end);
+				}
+				else
+				{
+					ranges.clear();
+				}
+
+				len = written;
 			}
 			else
 			{
@@ -7155,8 +7185,12 @@ bool WrappedID3D11DeviceContext::Serialise_Unmap(ID3D11Resource *pResource, UINT
 		appWritePtr += diffStart;
 		if(m_State == WRITING_CAPFRAME && record->GetShadowPtr(ctxMapID, 1))
 		{
+			// bytes between the ranges are unchanged, so this is still correct
 			memcpy(record->GetShadowPtr(ctxMapID, 1)+diffStart, appWritePtr, diffEnd-diffStart);
 		}
+
+		if(!packed.empty())
+			appWritePtr = &packed[0];
 		
 		SERIALISE_ELEMENT(D3D11_MAP, MapType, intercept.MapType);
 		SERIALISE_ELEMENT(uint32_t, MapFlags, intercept.MapFlags);
@@ -7164,6 +7198,35 @@ bool WrappedID3D11DeviceContext::Serialise_Unmap(ID3D11Resource *pResource, UINT
 		SERIALISE_ELEMENT(uint32_t, DiffStart, (uint32_t)diffStart);
 		SERIALISE_ELEMENT(uint32_t, DiffEnd, (uint32_t)diffEnd);
 
+		// from 0x9 the written ranges inside [DiffStart, DiffEnd) are listed,
+		// if there's more than one
+		if(m_State >= WRITING || m_pDevice->GetLogVersion() >= 0x000009)
+		{
+			uint32_t numRanges = (uint32_t)ranges.size();
+			m_pSerialiser->Serialise("NumRanges", numRanges);
+
+			if(m_State < WRITING)
+				ranges.resize(numRanges);
+
+			for(uint32_t i=0; i < numRanges; i++)
+			{
+				uint32_t rangeStart = (uint32_t)ranges[i].start;
+				uint32_t rangeEnd = (uint32_t)ranges[i].end;
+
+				m_pSerialiser->Serialise("RangeStart", rangeStart);
+				m_pSerialiser->Serialise("RangeEnd", rangeEnd);
+
+				ranges[i].start = rangeStart;
+				ranges[i].end = rangeEnd;
+			}
+		}
+
+		if(m_State < WRITING && ranges.empty())
+		{
+			DiffRange whole = { DiffStart, DiffEnd };
+			ranges.push_back(whole);
+		}
+
 		if(m_State >= WRITING || m_pDevice->GetLogVersion() >= 0x000007)
 			m_pSerialiser->AlignNextBuffer(32);
 
@@ -7186,7 +7249,7 @@ bool WrappedID3D11DeviceContext::Serialise_Unmap(ID3D11Resource *pResource, UINT
 
 				D3D11_BUFFER_DESC bdesc;
 				bdesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-				bdesc.ByteWidth = DiffEnd-DiffStart;
+				bdesc.ByteWidth = (UINT)len;
 				bdesc.CPUAccessFlags = 0;
 				bdesc.MiscFlags = 0;
 				bdesc.StructureByteStride = 0;
@@ -7205,9 +7268,21 @@ bool WrappedID3D11DeviceContext::Serialise_Unmap(ID3D11Resource *pResource, UINT
 				}
 				else
 				{
-					m_pRealContext->CopySubresourceRegion(m_pDevice->GetResourceManager()->UnwrapResource(res), mapIdx.subresource,
-															DiffStart, 0, 0,
-															mapContents, 0, NULL);
+					// copy each range out of the packed data to where it belongs
+					UINT packedOffs = 0;
+
+					for(size_t i=0; i < ranges.size(); i++)
+					{
+						UINT rangeLen = UINT(ranges[i].end - ranges[i].start);
+
+						D3D11_BOX box = { packedOffs, 0, 0, packedOffs + rangeLen, 1, 1 };
+
+						m_pRealContext->CopySubresourceRegion(m_pDevice->GetResourceManager()->UnwrapResource(res), mapIdx.subresource,
+																(UINT)ranges[i].start, 0, 0,
+																mapContents, 0, &box);
+
+						packedOffs += rangeLen;
+					}
 
 					SAFE_RELEASE(mapContents);
 				}
@@ -7230,9 +7305,16 @@ bool WrappedID3D11DeviceContext::Serialise_Unmap(ID3D11Resource *pResource, UINT
 				else
 				{
 					intercept.SetD3D(mappedResource);
-					intercept.InitWrappedResource(res, mapIdx.subresource, appWritePtr);
 
-					intercept.CopyToD3D(DiffStart, DiffEnd);
+					size_t packedOffs = 0;
+
+					for(size_t i=0; i < ranges.size(); i++)
+					{
+						intercept.InitWrappedResource(res, mapIdx.subresource, appWritePtr + packedOffs);
+						intercept.CopyToD3D(ranges[i].start, ranges[i].end);
+
+						packedOffs += ranges[i].end - ranges[i].start;
+					}
 
 					m_pRealContext->Unmap(m_pDevice->GetResourceManager()->UnwrapResource(res), mapIdx.subresource);
 				}
@@ -106,6 +106,8 @@ D3D11DebugManager::D3D11DebugManager(WrappedID3D11Device *wrapper)
 
 	m_OutputWindowID = 1;
 
+	m_ReadbackTicket = 1;
+
 	m_supersamplingX = 1.0f;
 	m_supersamplingY = 1.0f;
 
@@ -331,6 +333,8 @@ D3D11DebugManager::~D3D11DebugManager()
 
 	SAFE_RELEASE(m_pFactory);
 
+	FreeReadbacks();
+
 	while(!m_ShaderItemCache.empty())
 	{
 		CacheElem &elem = m_ShaderItemCache.back();
@@ -2208,6 +2212,285 @@ vector<byte> D3D11DebugManager::GetBufferData(ID3D11Buffer *buffer, uint32_t off
 
 
 
+uint32_t D3D11DebugManager::QueueBufferReadback(ResourceId buff, uint32_t offset, uint32_t len)
+{
+	auto it = WrappedID3D11Buffer::m_BufferList.find(buff);
+
+	if(it == WrappedID3D11Buffer::m_BufferList.end())
+		return 0;
+
+	ID3D11Buffer *buffer = it->second.m_Buffer;
+
+	D3D11_BUFFER_DESC desc;
+	buffer->GetDesc(&desc);
+
+	if(offset >= desc.ByteWidth)
+		return 0;
+
+	// same clamping as GetBufferData
+	if(len == 0 || offset+len > desc.ByteWidth)
+		len = desc.ByteWidth-offset;
+
+	ID3D11Buffer *stage = NULL;
+
+	for(size_t i=0; i < m_ReadbackBuffers.size(); i++)
+	{
+		D3D11_BUFFER_DESC stagedesc;
+		m_ReadbackBuffers[i]->GetDesc(&stagedesc);
+
+		if(stagedesc.ByteWidth >= len)
+		{
+			stage = m_ReadbackBuffers[i];
+			m_ReadbackBuffers.erase(m_ReadbackBuffers.begin()+i);
+			break;
+		}
+	}
+
+	if(stage == NULL)
+	{
+		D3D11_BUFFER_DESC stagedesc;
+		stagedesc.StructureByteStride = 0;
+		stagedesc.ByteWidth = AlignUp(len, READBACK_BUFFER_ALIGN);
+		stagedesc.BindFlags = 0;
+		stagedesc.MiscFlags = 0;
+		stagedesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+		stagedesc.Usage = D3D11_USAGE_STAGING;
+
+		HRESULT hr = m_pDevice->CreateBuffer(&stagedesc, NULL, &stage);
+
+		if(FAILED(hr))
+		{
+			RDCERR("Failed to create readback staging buffer %08x", hr);
+			return 0;
+		}
+	}
+
+	D3D11_BOX box;
+	box.left = offset;
+	box.right = offset+len;
+	box.top = 0;
+	box.bottom = 1;
+	box.front = 0;
+	box.back = 1;
+
+	m_pImmediateContext->CopySubresourceRegion(stage, 0, 0, 0, 0, UNWRAP(WrappedID3D11Buffer, buffer), 0, &box);
+
+	PendingReadback rb;
+	rb.staging = stage;
+	rb.subresource = 0;
+	rb.size = len;
+	rb.buffer = true;
+
+	uint32_t ticket = m_ReadbackTicket++;
+	m_Readbacks[ticket] = rb;
+
+	return ticket;
+}
+
+uint32_t D3D11DebugManager::QueueTextureReadback(ResourceId id, uint32_t arrayIdx, uint32_t mip)
+{
+	ID3D11Resource *stage = NULL;
+	ID3D11Resource *src = NULL;
+
+	uint32_t srcSub = 0;
+	size_t bytesize = 0;
+
+	// the staging texture keeps the source mip chain but only one array slice,
+	// and the requested subresource is copied into slice 0 of the same mip.
+	if(WrappedID3D11Texture1D::m_TextureList.find(id) != WrappedID3D11Texture1D::m_TextureList.end())
+	{
+		WrappedID3D11Texture1D *wrapTex = (WrappedID3D11Texture1D *)WrappedID3D11Texture1D::m_TextureList[id].m_Texture;
+
+		D3D11_TEXTURE1D_DESC desc = {0};
+		wrapTex->GetDesc(&desc);
+
+		uint32_t mips = desc.MipLevels ? desc.MipLevels : CalcNumMips(desc.Width, 1, 1);
+
+		if(mip >= mips || arrayIdx >= desc.ArraySize) return 0;
+
+		srcSub = arrayIdx*mips + mip;
+
+		desc.ArraySize = 1;
+		desc.BindFlags = 0;
+		desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+		desc.MiscFlags = 0;
+		desc.Usage = D3D11_USAGE_STAGING;
+
+		ID3D11Texture1D *d = NULL;
+		HRESULT hr = m_WrappedDevice->CreateTexture1D(&desc, NULL, &d);
+
+		if(FAILED(hr))
+		{
+			RDCERR("Couldn't create staging texture for readback. %08x", hr);
+			return 0;
+		}
+
+		stage = d;
+		src = wrapTex->GetReal();
+		bytesize = GetByteSize(desc.Width, 1, 1, desc.Format, mip);
+		
+		m_pImmediateContext->CopySubresourceRegion(UNWRAP(WrappedID3D11Texture1D, d), mip, 0, 0, 0, src, srcSub, NULL);
+	}
+	else if(WrappedID3D11Texture2D::m_TextureList.find(id) != WrappedID3D11Texture2D::m_TextureList.end())
+	{
+		WrappedID3D11Texture2D *wrapTex = (WrappedID3D11Texture2D *)WrappedID3D11Texture2D::m_TextureList[id].m_Texture;
+
+		D3D11_TEXTURE2D_DESC desc = {0};
+		wrapTex->GetDesc(&desc);
+
+		// multisampled textures need a copy to an array first, use GetTextureData
+		if(desc.SampleDesc.Count > 1) return 0;
+
+		uint32_t mips = desc.MipLevels ? desc.MipLevels : CalcNumMips(desc.Width, desc.Height, 1);
+
+		if(mip >= mips || arrayIdx >= desc.ArraySize) return 0;
+
+		srcSub = arrayIdx*mips + mip;
+
+		desc.ArraySize = 1;
+		desc.BindFlags = 0;
+		desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+		desc.MiscFlags = 0;
+		desc.Usage = D3D11_USAGE_STAGING;
+
+		ID3D11Texture2D *d = NULL;
+		HRESULT hr = m_WrappedDevice->CreateTexture2D(&desc, NULL, &d);
+
+		if(FAILED(hr))
+		{
+			RDCERR("Couldn't create staging texture for readback. %08x", hr);
+			return 0;
+		}
+
+		stage = d;
+		src = wrapTex->GetReal();
+		bytesize = GetByteSize(desc.Width, desc.Height, 1, desc.Format, mip);
+		
+		m_pImmediateContext->CopySubresourceRegion(UNWRAP(WrappedID3D11Texture2D, d), mip, 0, 0, 0, src, srcSub, NULL);
+	}
+	else if(WrappedID3D11Texture3D::m_TextureList.find(id) != WrappedID3D11Texture3D::m_TextureList.end())
+	{
+		WrappedID3D11Texture3D *wrapTex = (WrappedID3D11Texture3D *)WrappedID3D11Texture3D::m_TextureList[id].m_Texture;
+
+		D3D11_TEXTURE3D_DESC desc = {0};
+		wrapTex->GetDesc(&desc);
+
+		uint32_t mips = desc.MipLevels ? desc.MipLevels : CalcNumMips(desc.Width, desc.Height, desc.Depth);
+
+		if(mip >= mips) return 0;
+
+		srcSub = mip;
+
+		desc.BindFlags = 0;
+		desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+		desc.MiscFlags = 0;
+		desc.Usage = D3D11_USAGE_STAGING;
+
+		ID3D11Texture3D *d = NULL;
+		HRESULT hr = m_WrappedDevice->CreateTexture3D(&desc, NULL, &d);
+
+		if(FAILED(hr))
+		{
+			RDCERR("Couldn't create staging texture for readback. %08x", hr);
+			return 0;
+		}
+
+		stage = d;
+		src = wrapTex->GetReal();
+		bytesize = GetByteSize(desc.Width, desc.Height, desc.Depth, desc.Format, mip);
+		
+		m_pImmediateContext->CopySubresourceRegion(UNWRAP(WrappedID3D11Texture3D, d), mip, 0, 0, 0, src, srcSub, NULL);
+	}
+	else
+	{
+		return 0;
+	}
+
+	PendingReadback rb;
+	rb.staging = stage;
+	rb.subresource = mip;
+	rb.size = (uint32_t)bytesize;
+	rb.buffer = false;
+
+	uint32_t ticket = m_ReadbackTicket++;
+	m_Readbacks[ticket] = rb;
+
+	return ticket;
+}
+
+bool D3D11DebugManager::FetchReadback(uint32_t ticket, bool wait, vector<byte> &data)
+{
+	auto it = m_Readbacks.find(ticket);
+
+	if(it == m_Readbacks.end())
+	{
+		RDCWARN("Unknown readback ticket %u", ticket);
+		return false;
+	}
+
+	PendingReadback &rb = it->second;
+
+	ID3D11Resource *res = rb.buffer ? rb.staging : m_ResourceManager->UnwrapResource(rb.staging);
+
+	D3D11_MAPPED_SUBRESOURCE mapped = {0};
+	HRESULT hr = m_pImmediateContext->Map(res, rb.subresource, D3D11_MAP_READ, wait ? 0 : D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+
+	if(hr == DXGI_ERROR_WAS_STILL_DRAWING)
+		return false;
+
+	bool ret = SUCCEEDED(hr);
+
+	if(ret)
+	{
+		data.resize(rb.size);
+
+		if(rb.buffer)
+		{
+			memcpy(&data[0], mapped.pData, rb.size);
+		}
+		else
+		{
+			MapIntercept intercept;
+			intercept.InitWrappedResource(rb.staging, rb.subresource, &data[0]);
+			intercept.SetD3D(mapped);
+			intercept.CopyFromD3D();
+		}
+
+		m_pImmediateContext->Unmap(res, rb.subresource);
+	}
+	else
+	{
+		RDCERR("Couldn't map readback staging resource. %08x", hr);
+	}
+
+	ReleaseReadback(rb);
+	m_Readbacks.erase(it);
+
+	return ret;
+}
+
+void D3D11DebugManager::ReleaseReadback(PendingReadback &rb)
+{
+	if(rb.buffer && m_ReadbackBuffers.size() < MAX_READBACK_BUFFERS)
+		m_ReadbackBuffers.push_back((ID3D11Buffer *)rb.staging);
+	else
+		SAFE_RELEASE(rb.staging);
+
+	rb.staging = NULL;
+}
+
+void D3D11DebugManager::FreeReadbacks()
+{
+	for(auto it=m_Readbacks.begin(); it != m_Readbacks.end(); ++it)
+		SAFE_RELEASE(it->second.staging);
+
+	for(size_t i=0; i < m_ReadbackBuffers.size(); i++)
+		SAFE_RELEASE(m_ReadbackBuffers[i]);
+
+	m_Readbacks.clear();
+	m_ReadbackBuffers.clear();
+}
+
 void D3D11DebugManager::CopyArrayToTex2DMS(ID3D11Texture2D *destMS, ID3D11Texture2D *srcArray)
 {
 	D3D11RenderStateTracker tracker(m_WrappedContext);
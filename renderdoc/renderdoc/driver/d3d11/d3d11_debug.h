@@ -127,6 +127,11 @@ class D3D11DebugManager
 		/* Added by Stephan Richter | END */
 
 		byte *GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip, bool resolve, bool forceRGBA8unorm, float blackPoint, float whitePoint, size_t &dataSize);
+
+		uint32_t QueueBufferReadback(ResourceId buff, uint32_t offset, uint32_t len);
+		uint32_t QueueTextureReadback(ResourceId tex, uint32_t arrayIdx, uint32_t mip);
+		bool FetchReadback(uint32_t ticket, bool wait, vector<byte> &data);
+		void FreeReadbacks();
 		
 		void FillCBufferVariables(const vector<DXBC::CBufferVariable> &invars, vector<ShaderVariable> &outvars,
 								  bool flattenVec4s, const vector<byte> &data);
@@ -369,6 +374,26 @@ class D3D11DebugManager
 
 		static const uint32_t STAGE_BUFFER_BYTE_SIZE = 4*1024*1024;
 
+		// in-flight batched readbacks. Buffers are copied into a small ring of
+		// recycled staging buffers on the real device, textures into a one-slice
+		// wrapped staging texture so MapIntercept can repack the rows.
+		struct PendingReadback
+		{
+			ID3D11Resource *staging;
+			UINT subresource;
+			uint32_t size;
+			bool buffer;
+		};
+
+		static const size_t MAX_READBACK_BUFFERS = 8;
+		static const uint32_t READBACK_BUFFER_ALIGN = 64*1024;
+
+		uint32_t m_ReadbackTicket;
+		map<uint32_t, PendingReadback> m_Readbacks;
+		vector<ID3D11Buffer *> m_ReadbackBuffers;
+
+		void ReleaseReadback(PendingReadback &rb);
+
 		struct FontData
 		{
 			FontData() { RDCEraseMem(this, sizeof(FontData)); }
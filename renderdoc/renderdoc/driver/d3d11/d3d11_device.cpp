@@ -208,6 +208,7 @@ const uint32_t D3D11InitParams::D3D11_OLD_VERSIONS[D3D11InitParams::D3D11_NUM_SU
 	0x000005, // from 0x5 to 0x6, several new calls were made 'drawcalls', like Copy & GenerateMips, with serialised debug messages
 	0x000006, // from 0x6 to 0x7, we added some more padding in some buffer & texture chunks to get larger alignment than 16-byte
 	0x000007, // from 0x7 to 0x8, we changed the UAV arrays in the render state to be D3D11.1 sized and separate CS array.
+	0x000008, // from 0x8 to 0x9, Unmap chunks list the separate ranges that were written, instead of one span.
 };
 
 ReplayCreateStatus D3D11InitParams::Serialise()
@@ -287,6 +288,7 @@ WrappedID3D11Device::WrappedID3D11Device(ID3D11Device* realDevice, D3D11InitPara
 
 	m_FrameCounter = 0;
 	m_FailedFrame = 0;
+
 	m_FailedReason = CaptureSucceeded;
 	m_Failures = 0;
 
@@ -421,6 +423,8 @@ WrappedID3D11Device::~WrappedID3D11Device()
 
 	RenderDoc::Inst().RemoveDeviceFrameCapturer((ID3D11Device *)this);
 
+	FreeReplayCheckpoints();
+
 	for(auto it = m_CachedStateObjects.begin(); it != m_CachedStateObjects.end(); ++it)
 		if(*it)
 			(*it)->Release();
@@ -977,7 +981,9 @@ void WrappedID3D11Device::ProcessChunk(uint64_t offset, D3D11ChunkType context)
 		break;
 	default:
 		// ignore system chunks
-		if(context == INITIAL_CONTENTS)
+		if(context == INITIAL_CONTENTS && GetResourceManager()->IsDeferringInitialContents())
+			GetResourceManager()->DeferInitialContentsChunk();
+		else if(context == INITIAL_CONTENTS)
 			Serialise_InitialState(NULL);
 		else if(context < FIRST_CHUNK_ID)
 			m_pSerialiser->SkipCurrentChunk();
@@ -1020,18 +1026,16 @@ void WrappedID3D11Device::ReadLogInitialisation()
 
 	int chunkIdx = 0;
 
-	struct chunkinfo
-	{
-		chunkinfo() : count(0), totalsize(0), total(0.0) {}
-		int count;
-		uint64_t totalsize;
-		double total;
-	};
+	m_LoadProfiler.Reset();
+	GetResourceManager()->SetLoadProfiler(&m_LoadProfiler);
+	GetResourceManager()->SetInitialContentsBudget(RenderDoc::Inst().GetInitialContentsBudget());
 
-	map<D3D11ChunkType,chunkinfo> chunkInfos;
+	PerformanceTimer totalTimer;
 
 	SCOPED_TIMER("chunk initialisation");
 
+	WrappedShader::StartBackgroundReflection();
+
 	while(1)
 	{
 		PerformanceTimer timer;
@@ -1054,20 +1058,30 @@ void WrappedID3D11Device::ReadLogInitialisation()
 		
 		RenderDoc::Inst().SetProgress(FileInitialRead, float(offset)/float(m_pSerialiser->GetSize()));
 
+		if(context == INITIAL_CONTENTS)
+			m_LoadProfiler.AddInitialContents(GetResourceManager()->TakeLastInitialContentsType(),
+			                                  m_pSerialiser->GetOffset() - offset, timer.GetMilliseconds());
+
 		if(context == CAPTURE_SCOPE)
 		{
 			frameOffset = offset;
 
+			PerformanceTimer applyTimer;
+
 			GetResourceManager()->ApplyInitialContents();
 
+			m_LoadProfiler.SetApplyTime(applyTimer.GetMilliseconds());
+
+			PerformanceTimer replayTimer;
+
 			m_pImmediateContext->ReplayLog(READING, 0, 0, false);
+
+			m_LoadProfiler.SetFrameReplayTime(replayTimer.GetMilliseconds());
 		}
 
 		uint64_t offset2 = m_pSerialiser->GetOffset();
 
-		chunkInfos[context].total += timer.GetMilliseconds();
-		chunkInfos[context].totalsize += offset2 - offset;
-		chunkInfos[context].count++;
+		m_LoadProfiler.AddChunk(context, GetChunkName(context), offset2 - offset, timer.GetMilliseconds());
 
 		if(context == CAPTURE_SCOPE)
 			break;
@@ -1076,18 +1090,12 @@ void WrappedID3D11Device::ReadLogInitialisation()
 			break;
 	}
 
-	for(auto it=chunkInfos.begin(); it != chunkInfos.end(); ++it)
-	{
-		double dcount = double(it->second.count);
+	WrappedShader::FinishBackgroundReflection();
 
-		RDCDEBUG("% 5d chunks - Time: %9.3fms total/%9.3fms avg - Size: %8.3fMB total/%7.3fMB avg - %s (%u)",
-				it->second.count,
-				it->second.total, it->second.total/dcount,
-				double(it->second.totalsize)/(1024.0*1024.0),
-				double(it->second.totalsize)/(dcount*1024.0*1024.0),
-				GetChunkName(it->first), uint32_t(it->first)
-				);
-	}
+	GetResourceManager()->SetLoadProfiler(NULL);
+
+	m_LoadProfiler.SetTotalTime(totalTimer.GetMilliseconds());
+	m_LoadProfiler.Dump();
 
 	RDCDEBUG("Allocating %llu persistant bytes of memory for the log.", m_pSerialiser->GetSize() - frameOffset);
 	
@@ -2238,6 +2246,208 @@ void WrappedID3D11Device::Apply_InitialState(ID3D11DeviceChild *live, D3D11Resou
 	}
 }
 
+bool WrappedID3D11Device::Snapshot_State(ID3D11DeviceChild *live, D3D11ResourceManager::InitialContentData &data, uint64_t &byteSize)
+{
+	ResourceType type = IdentifyTypeByPtr(live);
+
+	if(type == Resource_UnorderedAccessView)
+	{
+		WrappedID3D11UnorderedAccessView *uav = (WrappedID3D11UnorderedAccessView *)live;
+
+		D3D11_UNORDERED_ACCESS_VIEW_DESC desc;
+		uav->GetDesc(&desc);
+
+		// only the hidden counter needs saving, the contents come with the underlying buffer
+		if(desc.ViewDimension != D3D11_UAV_DIMENSION_BUFFER ||
+			(desc.Buffer.Flags & (D3D11_BUFFER_UAV_FLAG_COUNTER|D3D11_BUFFER_UAV_FLAG_APPEND)) == 0)
+			return false;
+
+		ID3D11Buffer *stage = NULL;
+
+		D3D11_BUFFER_DESC bdesc;
+		bdesc.BindFlags = 0;
+		bdesc.ByteWidth = 16;
+		bdesc.MiscFlags = 0;
+		bdesc.StructureByteStride = 0;
+		bdesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+		bdesc.Usage = D3D11_USAGE_STAGING;
+		HRESULT hr = m_pDevice->CreateBuffer(&bdesc, NULL, &stage);
+
+		if(FAILED(hr) || stage == NULL)
+		{
+			RDCERR("Failed to create staging resource for UAV checkpoint %08x", hr);
+			return false;
+		}
+
+		m_pImmediateContext->GetReal()->CopyStructureCount(stage, 0, UNWRAP(WrappedID3D11UnorderedAccessView, uav));
+
+		D3D11_MAPPED_SUBRESOURCE mapped;
+		hr = m_pImmediateContext->GetReal()->Map(stage, 0, D3D11_MAP_READ, 0, &mapped);
+
+		if(FAILED(hr))
+		{
+			RDCERR("Failed to map while creating UAV checkpoint %08x", hr);
+			SAFE_RELEASE(stage);
+			return false;
+		}
+
+		data = D3D11ResourceManager::InitialContentData(NULL, *((uint32_t *)mapped.pData), NULL);
+		byteSize = 0;
+
+		m_pImmediateContext->GetReal()->Unmap(stage, 0);
+
+		SAFE_RELEASE(stage);
+
+		return true;
+	}
+	else if(type == Resource_Buffer)
+	{
+		WrappedID3D11Buffer *buf = (WrappedID3D11Buffer *)live;
+
+		D3D11_BUFFER_DESC desc;
+		buf->GetDesc(&desc);
+
+		if(desc.Usage == D3D11_USAGE_IMMUTABLE)
+			return false;
+
+		desc.BindFlags = 0;
+		desc.CPUAccessFlags = 0;
+		desc.MiscFlags = 0;
+		desc.StructureByteStride = 0;
+		desc.Usage = D3D11_USAGE_DEFAULT;
+
+		ID3D11Buffer *copy = NULL;
+
+		HRESULT hr = m_pDevice->CreateBuffer(&desc, NULL, &copy);
+
+		if(FAILED(hr))
+		{
+			RDCERR("Failed to create buffer checkpoint %08x", hr);
+			return false;
+		}
+
+		m_pImmediateContext->GetReal()->CopyResource(copy, UNWRAP(WrappedID3D11Buffer, buf));
+
+		data = D3D11ResourceManager::InitialContentData(copy, eInitialContents_Copy, NULL);
+		byteSize = desc.ByteWidth;
+
+		return true;
+	}
+	else if(type == Resource_Texture1D)
+	{
+		WrappedID3D11Texture1D *tex1D = (WrappedID3D11Texture1D *)live;
+
+		D3D11_TEXTURE1D_DESC desc;
+		tex1D->GetDesc(&desc);
+
+		if(desc.Usage == D3D11_USAGE_IMMUTABLE)
+			return false;
+
+		byteSize = 0;
+		for(UINT mip=0; mip < desc.MipLevels; mip++)
+			byteSize += GetByteSize(desc.Width, 1, 1, desc.Format, mip)*desc.ArraySize;
+
+		desc.CPUAccessFlags = 0;
+		desc.Usage = D3D11_USAGE_DEFAULT;
+		desc.BindFlags = 0;
+		if(IsDepthFormat(desc.Format))
+			desc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
+		desc.MiscFlags &= ~D3D11_RESOURCE_MISC_GENERATE_MIPS;
+
+		ID3D11Texture1D *copy = NULL;
+
+		HRESULT hr = m_pDevice->CreateTexture1D(&desc, NULL, &copy);
+
+		if(FAILED(hr))
+		{
+			RDCERR("Failed to create tex1D checkpoint %08x", hr);
+			return false;
+		}
+
+		m_pImmediateContext->GetReal()->CopyResource(copy, UNWRAP(WrappedID3D11Texture1D, tex1D));
+
+		data = D3D11ResourceManager::InitialContentData(copy, eInitialContents_Copy, NULL);
+
+		return true;
+	}
+	else if(type == Resource_Texture2D)
+	{
+		WrappedID3D11Texture2D *tex2D = (WrappedID3D11Texture2D *)live;
+
+		D3D11_TEXTURE2D_DESC desc;
+		tex2D->GetDesc(&desc);
+
+		if(desc.Usage == D3D11_USAGE_IMMUTABLE)
+			return false;
+
+		bool isMS = (desc.SampleDesc.Count > 1 || desc.SampleDesc.Quality > 0);
+
+		byteSize = 0;
+		for(UINT mip=0; mip < desc.MipLevels; mip++)
+			byteSize += GetByteSize(desc.Width, desc.Height, 1, desc.Format, mip)*desc.ArraySize*desc.SampleDesc.Count;
+
+		desc.CPUAccessFlags = 0;
+		desc.Usage = D3D11_USAGE_DEFAULT;
+		desc.BindFlags = isMS ? D3D11_BIND_SHADER_RESOURCE : 0;
+		if(IsDepthFormat(desc.Format))
+			desc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
+		desc.MiscFlags &= ~D3D11_RESOURCE_MISC_GENERATE_MIPS;
+
+		ID3D11Texture2D *copy = NULL;
+
+		HRESULT hr = m_pDevice->CreateTexture2D(&desc, NULL, &copy);
+
+		if(FAILED(hr))
+		{
+			RDCERR("Failed to create tex2D checkpoint %08x", hr);
+			return false;
+		}
+
+		m_pImmediateContext->GetReal()->CopyResource(copy, UNWRAP(WrappedID3D11Texture2D, tex2D));
+
+		data = D3D11ResourceManager::InitialContentData(copy, eInitialContents_Copy, NULL);
+
+		return true;
+	}
+	else if(type == Resource_Texture3D)
+	{
+		WrappedID3D11Texture3D *tex3D = (WrappedID3D11Texture3D *)live;
+
+		D3D11_TEXTURE3D_DESC desc;
+		tex3D->GetDesc(&desc);
+
+		if(desc.Usage == D3D11_USAGE_IMMUTABLE)
+			return false;
+
+		byteSize = 0;
+		for(UINT mip=0; mip < desc.MipLevels; mip++)
+			byteSize += GetByteSize(desc.Width, desc.Height, desc.Depth, desc.Format, mip);
+
+		desc.CPUAccessFlags = 0;
+		desc.Usage = D3D11_USAGE_DEFAULT;
+		desc.BindFlags = 0;
+		desc.MiscFlags &= ~D3D11_RESOURCE_MISC_GENERATE_MIPS;
+
+		ID3D11Texture3D *copy = NULL;
+
+		HRESULT hr = m_pDevice->CreateTexture3D(&desc, NULL, &copy);
+
+		if(FAILED(hr))
+		{
+			RDCERR("Failed to create tex3D checkpoint %08x", hr);
+			return false;
+		}
+
+		m_pImmediateContext->GetReal()->CopyResource(copy, UNWRAP(WrappedID3D11Texture3D, tex3D));
+
+		data = D3D11ResourceManager::InitialContentData(copy, eInitialContents_Copy, NULL);
+
+		return true;
+	}
+
+	return false;
+}
+
 void WrappedID3D11Device::SetContextFilter(ResourceId id, uint32_t firstDefEv, uint32_t lastDefEv)
 {
 	m_ReplayDefCtx = id;
@@ -2248,15 +2458,86 @@ void WrappedID3D11Device::SetContextFilter(ResourceId id, uint32_t firstDefEv, u
 /* Added by Stephan Richter | BEGIN */
 void WrappedID3D11Device::SetIDRenderEvents(uint32_t frameID, uint32_t startEventID, uint32_t endEventID)
 {
+	FreeReplayCheckpoints();
 	m_pImmediateContext->SetIDRenderEvents(frameID, startEventID, endEventID);
 }
 
 void WrappedID3D11Device::SetIDRendering(bool active, ResourceId shaderID)
 {
+	FreeReplayCheckpoints();
 	m_pImmediateContext->SetIDRendering(active, shaderID);
 }
 /* Added by Stephan Richter | END */
 
+void WrappedID3D11Device::SetReplayCheckpoints(uint32_t eventInterval, uint64_t memoryBudget)
+{
+	m_Checkpoints.Set(GetResourceManager(), eventInterval, memoryBudget);
+}
+
+void WrappedID3D11Device::FreeReplayCheckpoints()
+{
+	m_Checkpoints.Free(GetResourceManager());
+}
+
+ReplayCheckpointStats WrappedID3D11Device::GetReplayCheckpointStats()
+{
+	return m_Checkpoints.GetStats();
+}
+
+bool WrappedID3D11Device::CanCreateCheckpoint()
+{
+	// mapped pointers and stream-out append positions can't be restored
+	if(m_pImmediateContext->HasOpenMaps())
+		return false;
+
+	D3D11RenderState *rs = m_pImmediateContext->GetCurrentPipelineState();
+
+	for(int i=0; i < D3D11_SO_BUFFER_SLOT_COUNT; i++)
+		if(rs->SO.Buffers[i])
+			return false;
+
+	return true;
+}
+
+void WrappedID3D11Device::GetCheckpointWrittenResources(set<ResourceId> &ids)
+{
+	D3D11ResourceManager *rm = GetResourceManager();
+
+	D3D11ReplayCheckpoints::AddWrittenUses(rm, m_pImmediateContext->GetResourceUses(), ids);
+
+	// CPU-side updates don't count as usage, and the capture only records them as written
+	// if the resource was also bound for writing
+	const set<ResourceId> &updated = m_pImmediateContext->GetUpdatedResources();
+
+	for(auto it = updated.begin(); it != updated.end(); ++it)
+		if(rm->HasLiveResource(*it))
+			ids.insert(*it);
+}
+
+D3D11RenderState *WrappedID3D11Device::FetchCheckpointState()
+{
+	return new D3D11RenderState(m_pImmediateContext);
+}
+
+void WrappedID3D11Device::ApplyCheckpointState(D3D11RenderState *state)
+{
+	state->ApplyState(m_pImmediateContext);
+}
+
+void WrappedID3D11Device::ReplayCheckpointRange(uint32_t startEventID, uint32_t endEventID, bool partial)
+{
+	m_pImmediateContext->ReplayLog(EXECUTING, startEventID, endEventID, partial);
+}
+
+void WrappedID3D11Device::RewindCheckpointFrame(uint32_t frameID)
+{
+	m_pSerialiser->SetOffset(m_FrameRecord[frameID].frameInfo.fileOffset);
+
+	D3D11ChunkType header = (D3D11ChunkType)m_pSerialiser->PushContext(NULL, 1, false);
+	m_pSerialiser->SkipCurrentChunk();
+	m_pSerialiser->PopContext(NULL, header);
+}
+
 void WrappedID3D11Device::ReplayLog(uint32_t frameID, uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType)
 {
 	RDCASSERT(frameID < (uint32_t)m_FrameRecord.size());
@@ -2280,6 +2561,19 @@ void WrappedID3D11Device::ReplayLog(uint32_t frameID, uint32_t startEventID, uin
 	m_pSerialiser->SkipCurrentChunk();
 
 	m_pSerialiser->PopContext(NULL, header);
+
+	uint32_t lastEventID = endEventID;
+	if(replayType == eReplay_WithoutDraw)
+		lastEventID = RDCMAX(1U,endEventID)-1;
+
+	// checkpoints only come into play when replaying the immediate context from the
+	// start of the frame
+	bool checkpoints = (!partial && m_Checkpoints.Enabled() && m_ReplayDefCtx == ResourceId());
+
+	const vector<FetchAPIEvent> &events = m_pImmediateContext->GetEvents();
+
+	if(checkpoints && m_Checkpoints.Restore(this, GetResourceManager(), frameID, events, lastEventID, startEventID))
+		partial = true;
 	
 	if(!partial)
 	{
@@ -2291,10 +2585,8 @@ void WrappedID3D11Device::ReplayLog(uint32_t frameID, uint32_t startEventID, uin
 	
 	if(m_ReplayDefCtx == ResourceId())
 	{
-		if(replayType == eReplay_Full)
-			m_pImmediateContext->ReplayLog(EXECUTING, startEventID, endEventID, partial);
-		else if(replayType == eReplay_WithoutDraw)
-			m_pImmediateContext->ReplayLog(EXECUTING, startEventID, RDCMAX(1U,endEventID)-1, partial);
+		if(replayType == eReplay_Full || replayType == eReplay_WithoutDraw)
+			m_Checkpoints.Replay(this, GetResourceManager(), frameID, events, startEventID, lastEventID, partial, checkpoints);
 		else if(replayType == eReplay_OnlyDraw)
 			m_pImmediateContext->ReplayLog(EXECUTING, endEventID, endEventID, partial);
 		else
@@ -2828,11 +3120,8 @@ bool WrappedID3D11Device::EndFrameCapture(void *dev, void *wnd)
 			RDCDEBUG("Done");	
 		}
 
-		m_pFileSerialiser->FlushToDisk();
-
-		SAFE_DELETE(m_pFileSerialiser);
-
-		RenderDoc::Inst().SuccessfullyWrittenLog();
+		RenderDoc::Inst().FinishWriteSerialiser(m_pFileSerialiser);
+		m_pFileSerialiser = NULL;
 
 		m_State = WRITING_IDLE;
 
@@ -3103,6 +3392,14 @@ HRESULT WrappedID3D11Device::Present(IDXGISwapChain *swap, UINT SyncInterval, UI
 					GetDebugManager()->RenderText(0.0f, y, "%d Captures saved.\n", (uint32_t)m_FrameRecord.size());
 					y += 1.0f;
 
+					if(RenderDoc::Inst().IsPeriodicCapturing())
+					{
+						CaptureStats stats = RenderDoc::Inst().GetCaptureStats();
+						GetDebugManager()->RenderText(0.0f, y, "Periodic capture: %u written (%.1f MB), %u skipped.\n",
+							stats.captured, float(stats.bytesWritten)/1024.0f/1024.0f, stats.skippedBusy + stats.skippedDiskSpace);
+						y += 1.0f;
+					}
+
 					uint64_t now = Timing::GetUnixTimestamp();
 					for(size_t i=0; i < m_FrameRecord.size(); i++)
 					{
@@ -31,6 +31,7 @@
 #include "common/timing.h"
 
 #include "core/core.h"
+#include "core/replay_checkpoints.h"
 #include "api/replay/renderdoc_replay.h"
 
 #include "d3d11_common.h"
@@ -65,10 +66,10 @@ struct D3D11InitParams : public RDCInitParams
 	UINT NumFeatureLevels;
 	D3D_FEATURE_LEVEL FeatureLevels[16];
 	
-	static const uint32_t D3D11_SERIALISE_VERSION = 0x0000008;
+	static const uint32_t D3D11_SERIALISE_VERSION = 0x0000009;
 
 	// backwards compatibility for old logs described at the declaration of this array
-	static const uint32_t D3D11_NUM_SUPPORTED_OLD_VERSIONS = 4;
+	static const uint32_t D3D11_NUM_SUPPORTED_OLD_VERSIONS = 5;
 	static const uint32_t D3D11_OLD_VERSIONS[D3D11_NUM_SUPPORTED_OLD_VERSIONS];
 
 	// version number internal to d3d11 stream
@@ -171,6 +172,7 @@ struct DummyID3D11InfoQueue : public ID3D11InfoQueue
 };
 
 class WrappedID3D11ClassLinkage;
+struct D3D11RenderState;
 enum CaptureFailReason;
 
 #if defined(INCLUDE_D3D_11_1)
@@ -179,7 +181,9 @@ enum CaptureFailReason;
 #define D3DDEVICEPARENT ID3D11Device
 #endif
 
-class WrappedID3D11Device : public IFrameCapturer, public D3DDEVICEPARENT
+typedef ReplayCheckpoints<D3D11ResourceManager, D3D11RenderState> D3D11ReplayCheckpoints;
+
+class WrappedID3D11Device : public IFrameCapturer, public D3DDEVICEPARENT, public D3D11ReplayCheckpoints::Driver
 {
 private:
 	// since enumeration creates a lot of devices, save
@@ -267,6 +271,18 @@ private:
 
 	vector<DebugMessage> m_DebugMessages;
 
+	LoadProfiler m_LoadProfiler;
+
+	// snapshots taken during replays from the start of the frame, see ReplayCheckpoints
+	D3D11ReplayCheckpoints m_Checkpoints;
+
+	bool CanCreateCheckpoint();
+	void GetCheckpointWrittenResources(set<ResourceId> &ids);
+	D3D11RenderState *FetchCheckpointState();
+	void ApplyCheckpointState(D3D11RenderState *state);
+	void ReplayCheckpointRange(uint32_t startEventID, uint32_t endEventID, bool partial);
+	void RewindCheckpointFrame(uint32_t frameID);
+
 	vector<FetchFrameRecord> m_FrameRecord;
 	const FetchDrawcall *GetDrawcall(const FetchDrawcall *draw, uint32_t eventID);
 	
@@ -302,6 +318,9 @@ public:
 
 	Serialiser *GetSerialiser() { return m_pSerialiser; }
 
+	// only for paging in deferred initial contents, see ResourceManager::DeferInitialContentsChunk
+	void SetSerialiser(Serialiser *ser) { m_pSerialiser = ser; }
+
 	ResourceId GetResourceID() { return m_ResourceID; }
 
 	vector<FetchFrameRecord> &GetFrameRecord() { return m_FrameRecord; }
@@ -329,11 +348,17 @@ public:
 	bool Serialise_InitialState(ID3D11DeviceChild *res);
 	void Create_InitialState(ResourceId id, ID3D11DeviceChild *live, bool hasData);
 	void Apply_InitialState(ID3D11DeviceChild *live, D3D11ResourceManager::InitialContentData initial);
+	bool Snapshot_State(ID3D11DeviceChild *live, D3D11ResourceManager::InitialContentData &data, uint64_t &byteSize);
 
 	void ReadLogInitialisation();
 	void ProcessChunk(uint64_t offset, D3D11ChunkType context);
+	LoadProfiler &GetLoadProfiler() { return m_LoadProfiler; }
+	LoadProfile GetLoadProfile() { return m_LoadProfiler.Bake(); }
 	void SetContextFilter(ResourceId id, uint32_t firstDefEv, uint32_t lastDefEv);
 	void ReplayLog(uint32_t frameID, uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType);
+	void SetReplayCheckpoints(uint32_t eventInterval, uint64_t memoryBudget);
+	void FreeReplayCheckpoints();
+	ReplayCheckpointStats GetReplayCheckpointStats();
 	
 	/* Added by Stephan Richter | BEGIN */
 	void SetIDRenderEvents(uint32_t frameID, uint32_t startEvent, uint32_t endEvent);
@@ -120,3 +120,34 @@ void D3D11ResourceManager::Apply_InitialState(ID3D11DeviceChild *live, InitialCo
 {
 	m_Device->Apply_InitialState(live, data);
 }
+
+string D3D11ResourceManager::GetResourceTypeName(ID3D11DeviceChild *live)
+{
+	return ToStr::Get(IdentifyTypeByPtr(live));
+}
+
+bool D3D11ResourceManager::Snapshot_State(ID3D11DeviceChild *live, InitialContentData &data, uint64_t &byteSize)
+{
+	return m_Device->Snapshot_State(live, data, byteSize);
+}
+
+void D3D11ResourceManager::Free_Snapshot(InitialContentData data)
+{
+	SAFE_RELEASE(data.resource);
+}
+
+ResourceId D3D11ResourceManager::Peek_InitialStateID(Serialiser *ser)
+{
+	ResourceType type = Resource_Unknown;
+	ResourceId Id = ResourceId();
+	ser->Serialise("type", type);
+	ser->Serialise("Id", Id);
+	return Id;
+}
+
+void D3D11ResourceManager::SetSerialiser(Serialiser *ser)
+{
+	// initial states are serialised by the device
+	m_pSerialiser = ser;
+	m_Device->SetSerialiser(ser);
+}
@@ -157,6 +157,14 @@ class D3D11ResourceManager : public ResourceManager<ID3D11DeviceChild*, D3D11Res
 		void Create_InitialState(ResourceId id, ID3D11DeviceChild *live, bool hasData);
 		void Apply_InitialState(ID3D11DeviceChild *live, InitialContentData data);
 
+		string GetResourceTypeName(ID3D11DeviceChild *live);
+
+		bool Snapshot_State(ID3D11DeviceChild *live, InitialContentData &data, uint64_t &byteSize);
+		void Free_Snapshot(InitialContentData data);
+
+		ResourceId Peek_InitialStateID(Serialiser *ser);
+		void SetSerialiser(Serialiser *ser);
+
 		WrappedID3D11Device *m_Device;
 };
 
@@ -1528,16 +1528,18 @@ bool D3D11RenderState::shader::Used_CB(uint32_t slot) const
 	if(shad == NULL)
 		return false;
 
-	DXBC::DXBCFile *dxbc = shad->GetDXBC();
+	// reflection rather than the DXBC so that shaders in the reflection cache
+	// never need to be parsed just to build resource usage
+	ShaderReflection *refl = shad->GetDetails();
 
-	// have to assume it's used if there's no DXBC
-	if(dxbc == NULL)
+	// have to assume it's used if there's no reflection
+	if(refl == NULL)
 		return true;
 
-	if(slot >= dxbc->m_CBuffers.size())
+	if(slot >= (uint32_t)refl->ConstantBlocks.count)
 		return false;
 
-	if(dxbc->m_CBuffers[slot].variables.empty())
+	if(refl->ConstantBlocks[slot].variables.count == 0)
 		return false;
 
 	return true;
@@ -1553,24 +1555,15 @@ bool D3D11RenderState::shader::Used_SRV(uint32_t slot) const
 	if(shad == NULL)
 		return false;
 
-	DXBC::DXBCFile *dxbc = shad->GetDXBC();
+	ShaderReflection *refl = shad->GetDetails();
 
-	// have to assume it's used if there's no DXBC
-	if(dxbc == NULL)
+	// have to assume it's used if there's no reflection
+	if(refl == NULL)
 		return true;
 
-	for(size_t i=0; i < dxbc->m_Resources.size(); i++)
-	{
-		if(dxbc->m_Resources[i].bindPoint == slot &&
-			(dxbc->m_Resources[i].type == DXBC::ShaderInputBind::TYPE_TEXTURE ||
-			 dxbc->m_Resources[i].type == DXBC::ShaderInputBind::TYPE_STRUCTURED ||
-			 dxbc->m_Resources[i].type == DXBC::ShaderInputBind::TYPE_TBUFFER ||
-			 dxbc->m_Resources[i].type == DXBC::ShaderInputBind::TYPE_BYTEADDRESS)
-		  )
-		{
+	for(int32_t i=0; i < refl->Resources.count; i++)
+		if(refl->Resources[i].bindPoint == (int32_t)slot && refl->Resources[i].IsSRV)
 			return true;
-		}
-	}
 
 	return false;
 }
@@ -1582,26 +1575,15 @@ bool D3D11RenderState::shader::Used_UAV(uint32_t slot) const
 	if(shad == NULL)
 		return false;
 
-	DXBC::DXBCFile *dxbc = shad->GetDXBC();
+	ShaderReflection *refl = shad->GetDetails();
 
-	// have to assume it's used if there's no DXBC
-	if(dxbc == NULL)
+	// have to assume it's used if there's no reflection
+	if(refl == NULL)
 		return true;
 
-	for(size_t i=0; i < dxbc->m_Resources.size(); i++)
-	{
-		if(dxbc->m_Resources[i].bindPoint == slot &&
-			(dxbc->m_Resources[i].type == DXBC::ShaderInputBind::TYPE_UAV_APPEND_STRUCTURED ||
-			 dxbc->m_Resources[i].type == DXBC::ShaderInputBind::TYPE_UAV_CONSUME_STRUCTURED ||
-			 dxbc->m_Resources[i].type == DXBC::ShaderInputBind::TYPE_UAV_RWBYTEADDRESS ||
-			 dxbc->m_Resources[i].type == DXBC::ShaderInputBind::TYPE_UAV_RWSTRUCTURED ||
-			 dxbc->m_Resources[i].type == DXBC::ShaderInputBind::TYPE_UAV_RWSTRUCTURED_WITH_COUNTER ||
-			 dxbc->m_Resources[i].type == DXBC::ShaderInputBind::TYPE_UAV_RWTYPED)
-		  )
-		{
+	for(int32_t i=0; i < refl->Resources.count; i++)
+		if(refl->Resources[i].bindPoint == (int32_t)slot && refl->Resources[i].IsReadWrite)
 			return true;
-		}
-	}
 
 	return false;
 }
@@ -331,6 +331,11 @@ vector<FetchFrameRecord> D3D11Replay::GetFrameRecord()
 	return m_pDevice->GetFrameRecord();
 }
 
+LoadProfile D3D11Replay::GetLoadProfile()
+{
+	return m_pDevice->GetLoadProfile();
+}
+
 vector<EventUsage> D3D11Replay::GetUsage(ResourceId id)
 {
 	return m_pDevice->GetImmediateContext()->GetUsage(id);
@@ -1217,6 +1222,16 @@ void D3D11Replay::SetContextFilter(ResourceId id, uint32_t firstDefEv, uint32_t
 	m_pDevice->SetContextFilter(id, firstDefEv, lastDefEv);
 }
 
+void D3D11Replay::SetReplayCheckpoints(uint32_t eventInterval, uint64_t memoryBudget)
+{
+	m_pDevice->SetReplayCheckpoints(eventInterval, memoryBudget);
+}
+
+ReplayCheckpointStats D3D11Replay::GetReplayCheckpointStats()
+{
+	return m_pDevice->GetReplayCheckpointStats();
+}
+
 /* Added by Stephan Richter | BEGIN */
 void D3D11Replay::SetIDRendering(bool active, ResourceId shaderID)
 {
@@ -1322,6 +1337,26 @@ byte *D3D11Replay::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mi
 	return m_pDevice->GetDebugManager()->GetTextureData(tex, arrayIdx, mip, resolve, forceRGBA8unorm, blackPoint, whitePoint, dataSize);
 }
 
+uint32_t D3D11Replay::QueueBufferReadback(ResourceId buff, uint32_t offset, uint32_t len)
+{
+	return m_pDevice->GetDebugManager()->QueueBufferReadback(buff, offset, len);
+}
+
+uint32_t D3D11Replay::QueueTextureReadback(ResourceId tex, uint32_t arrayIdx, uint32_t mip)
+{
+	return m_pDevice->GetDebugManager()->QueueTextureReadback(tex, arrayIdx, mip);
+}
+
+bool D3D11Replay::FetchReadback(uint32_t ticket, bool wait, vector<byte> &data)
+{
+	return m_pDevice->GetDebugManager()->FetchReadback(ticket, wait, data);
+}
+
+void D3D11Replay::FreeReadbacks()
+{
+	m_pDevice->GetDebugManager()->FreeReadbacks();
+}
+
 /* Added by Stephan Richter | BEGIN */
 vector<byte> D3D11Replay::GetShaderData(ResourceId buff)
 {	
@@ -1335,11 +1370,13 @@ vector<byte> D3D11Replay::GetShaderData(ResourceId buff)
 
 void D3D11Replay::ReplaceResource(ResourceId from, ResourceId to)
 {
+	m_pDevice->FreeReplayCheckpoints();
 	m_pDevice->GetResourceManager()->ReplaceResource(from, to);
 }
 
 void D3D11Replay::RemoveReplacement(ResourceId id)
 {
+	m_pDevice->FreeReplayCheckpoints();
 	m_pDevice->GetResourceManager()->RemoveReplacement(id);
 }
 
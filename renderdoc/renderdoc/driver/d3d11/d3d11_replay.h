@@ -59,6 +59,7 @@ class D3D11Replay : public IReplayDriver
 		vector<EventUsage> GetUsage(ResourceId id);
 
 		vector<FetchFrameRecord> GetFrameRecord();
+		LoadProfile GetLoadProfile();
 
 		void SavePipelineState() { m_CurPipelineState = MakePipelineState(); }
 		D3D11PipelineState GetD3D11PipelineState() { return m_CurPipelineState; }
@@ -70,6 +71,8 @@ class D3D11Replay : public IReplayDriver
 		void ReadLogInitialisation();
 		void SetContextFilter(ResourceId id, uint32_t firstDefEv, uint32_t lastDefEv);
 		void ReplayLog(uint32_t frameID, uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType);
+		void SetReplayCheckpoints(uint32_t eventInterval, uint64_t memoryBudget);
+		ReplayCheckpointStats GetReplayCheckpointStats();
 
 		uint64_t MakeOutputWindow(void *w, bool depth);
 		void DestroyOutputWindow(uint64_t id);
@@ -93,6 +96,11 @@ class D3D11Replay : public IReplayDriver
 		
 		vector<byte> GetBufferData(ResourceId buff, uint32_t offset, uint32_t len);
 		byte *GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip, bool resolve, bool forceRGBA8unorm, float blackPoint, float whitePoint, size_t &dataSize);
+
+		uint32_t QueueBufferReadback(ResourceId buff, uint32_t offset, uint32_t len);
+		uint32_t QueueTextureReadback(ResourceId tex, uint32_t arrayIdx, uint32_t mip);
+		bool FetchReadback(uint32_t ticket, bool wait, vector<byte> &data);
+		void FreeReadbacks();
 		
 		/* Added by Stephan Richter | BEGIN */
 		vector<byte> GetShaderData(ResourceId buff);
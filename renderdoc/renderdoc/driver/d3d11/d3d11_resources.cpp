@@ -62,6 +62,88 @@ map<ResourceId,WrappedID3D11Texture3D::TextureEntry> WrappedTexture<ID3D11Textur
 map<ResourceId,WrappedID3D11Buffer::BufferEntry> WrappedID3D11Buffer::m_BufferList;
 map<ResourceId,WrappedShader::ShaderEntry*> WrappedShader::m_ShaderList;
 Threading::CriticalSection WrappedShader::m_ShaderListLock;
+std::deque<ResourceId> WrappedShader::m_ReflectionQueue;
+vector<Threading::ThreadHandle> WrappedShader::m_ReflectionThreads;
+volatile bool WrappedShader::m_ReflectionFinish = false;
+
+void WrappedShader::StartBackgroundReflection()
+{
+	SCOPED_LOCK(m_ShaderListLock);
+
+	if(!m_ReflectionThreads.empty())
+		return;
+
+	m_ReflectionFinish = false;
+
+	// leave a core for the thread doing the loading
+	uint32_t numThreads = RDCMAX(1U, Threading::GetProcessorCount()-1);
+
+	for(uint32_t i=0; i < numThreads; i++)
+		m_ReflectionThreads.push_back(Threading::CreateThread(&WrappedShader::ReflectionThreadEntry, NULL));
+}
+
+void WrappedShader::FinishBackgroundReflection()
+{
+	vector<Threading::ThreadHandle> threads;
+
+	{
+		SCOPED_LOCK(m_ShaderListLock);
+		threads.swap(m_ReflectionThreads);
+		m_ReflectionFinish = true;
+	}
+
+	// threads empty the queue before exiting
+	for(size_t i=0; i < threads.size(); i++)
+	{
+		Threading::JoinThread(threads[i]);
+		Threading::CloseThread(threads[i]);
+	}
+}
+
+void WrappedShader::ReflectionThreadEntry(void *)
+{
+	while(true)
+	{
+		ShaderEntry *entry = NULL;
+		bool idle = false;
+
+		{
+			SCOPED_LOCK(m_ShaderListLock);
+
+			if(m_ReflectionQueue.empty())
+			{
+				if(m_ReflectionFinish)
+					return;
+
+				idle = true;
+			}
+			else
+			{
+				auto it = m_ShaderList.find(m_ReflectionQueue.front());
+				m_ReflectionQueue.pop_front();
+
+				// lock the entry before letting go of the list, so it can't be deleted under us
+				if(it != m_ShaderList.end())
+				{
+					entry = it->second;
+					entry->m_Lock.Lock();
+				}
+			}
+		}
+
+		if(idle)
+		{
+			Threading::Sleep(1);
+			continue;
+		}
+
+		if(entry)
+		{
+			entry->GetDetails();
+			entry->m_Lock.Unlock();
+		}
+	}
+}
 
 UINT GetMipForSubresource(ID3D11Resource *res, int Subresource)
 {
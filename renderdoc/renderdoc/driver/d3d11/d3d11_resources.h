@@ -29,6 +29,7 @@
 #include "driver/d3d11/d3d11_manager.h"
 #include "driver/shaders/dxbc/dxbc_inspect.h"
 #include <algorithm>
+#include <deque>
 
 enum ResourceType
 {
@@ -1102,14 +1103,25 @@ public:
 
 			DXBC::DXBCFile *GetDXBC()
 			{
+				SCOPED_LOCK(m_Lock);
 				if(m_DXBCFile == NULL && !m_Bytecode.empty())
 					m_DXBCFile = new DXBC::DXBCFile((const void *)&m_Bytecode[0], m_Bytecode.size());
 				return m_DXBCFile;
 			}
 			ShaderReflection *GetDetails()
 			{
+				SCOPED_LOCK(m_Lock);
+
+				// the reflection is usually all that's needed when opening a capture,
+				// so check the cache before parsing the DXBC at all
+				if(m_Details == NULL)
+					m_Details = LoadCachedShaderReflection(m_Bytecode);
+
 				if(m_Details == NULL && GetDXBC() != NULL)
+				{
 					m_Details = MakeShaderReflection(m_DXBCFile);
+					StoreCachedShaderReflection(m_Bytecode, m_Details);
+				}
 				return m_Details;
 			}
 			/* Added by Stephan Richter | BEGIN */
@@ -1122,6 +1134,12 @@ public:
 			ShaderEntry(const ShaderEntry &e);
 			ShaderEntry &operator =(const ShaderEntry &e);
 
+			friend class WrappedShader;
+
+			// held while parsing, so a background reflection thread and the
+			// replay don't both build the same details
+			Threading::CriticalSection m_Lock;
+
 			vector<byte> m_Bytecode;
 
 			DXBC::DXBCFile *m_DXBCFile;
@@ -1137,6 +1155,9 @@ public:
 
 		RDCASSERT(m_ShaderList.find(m_ID) == m_ShaderList.end());
 		m_ShaderList[m_ID] = new ShaderEntry(code, codeLen);
+
+		if(!m_ReflectionThreads.empty())
+			m_ReflectionQueue.push_back(m_ID);
 	}
 	virtual ~WrappedShader()
 	{
@@ -1145,14 +1166,34 @@ public:
 		auto it = m_ShaderList.find(m_ID);
 		if(it != m_ShaderList.end())
 		{
-			delete it->second;
+			ShaderEntry *entry = it->second;
 			m_ShaderList.erase(it);
+
+			// a reflection thread could still be working on it
+			entry->m_Lock.Lock();
+			entry->m_Lock.Unlock();
+
+			delete entry;
 		}
 	}
 
-	DXBC::DXBCFile *GetDXBC() { SCOPED_LOCK(m_ShaderListLock); return m_ShaderList[m_ID]->GetDXBC(); }
-	ShaderReflection *GetDetails() { SCOPED_LOCK(m_ShaderListLock); return m_ShaderList[m_ID]->GetDetails(); }
+	DXBC::DXBCFile *GetDXBC() { return GetEntry()->GetDXBC(); }
+	ShaderReflection *GetDetails() { return GetEntry()->GetDetails(); }
+
+	// while a capture loads, shaders are queued as they're created and worker threads
+	// build their reflection, so it's ready by the time the frame is replayed rather
+	// than being done one at a time on the loading thread.
+	static void StartBackgroundReflection();
+	static void FinishBackgroundReflection();
 private:
+	ShaderEntry *GetEntry() { SCOPED_LOCK(m_ShaderListLock); return m_ShaderList[m_ID]; }
+
+	static void ReflectionThreadEntry(void *);
+
+	static std::deque<ResourceId> m_ReflectionQueue;
+	static vector<Threading::ThreadHandle> m_ReflectionThreads;
+	static volatile bool m_ReflectionFinish;
+
 	ResourceId m_ID;
 };
 
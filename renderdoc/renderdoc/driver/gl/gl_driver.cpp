@@ -362,6 +362,11 @@ WrappedOpenGL::WrappedOpenGL(const char *logfile, const GLHookSet &funcs)
 	if(RenderDoc::Inst().GetCrashHandler())
 		RenderDoc::Inst().GetCrashHandler()->RegisterMemoryRegion(this, sizeof(WrappedOpenGL));
 
+	m_ThreadSlot = Threading::AllocateTLSSlot();
+	m_LockFreeBlockReasons = 0;
+	m_LockFreeBlocked = 0;
+	m_DeleteGeneration = 0;
+
 	globalExts.push_back("GL_ARB_arrays_of_arrays");
 	globalExts.push_back("GL_ARB_base_instance");
 	globalExts.push_back("GL_ARB_blend_func_extended");
@@ -719,6 +724,11 @@ WrappedOpenGL::WrappedOpenGL(const char *logfile, const GLHookSet &funcs)
 	if(RenderDoc::Inst().IsReplayApp())
 	{
 		m_State = READING;
+
+		// nothing is lock-free while replaying. No other threads can be in here yet
+		m_LockFreeBlockReasons = eLockFreeBlock_NotIdle;
+		m_LockFreeBlocked = 1;
+
 		if(logfile)
 		{
 			m_pSerialiser = new Serialiser(logfile, Serialiser::READING, false);
@@ -787,6 +797,14 @@ WrappedOpenGL::WrappedOpenGL(const char *logfile, const GLHookSet &funcs)
 	m_FakeVAO = 0;
 	m_FakeIdxBuf = 0;
 	m_FakeIdxSize = 0;
+
+
+	m_DoRenderID = false;
+	m_IDStartEvent = m_IDEndEvent = 0;
+	m_IDFSProg = 0;
+	m_IDPipe = 0;
+	RDCEraseEl(m_IDUniforms);
+	m_IDPrevProg = m_IDPrevPipe = 0;
 		
 	RDCDEBUG("Debug Text enabled - for development! remove before release!");
 	m_pSerialiser->SetDebugText(true);
@@ -914,6 +932,11 @@ const char * WrappedOpenGL::GetChunkName(uint32_t idx)
 
 WrappedOpenGL::~WrappedOpenGL()
 {
+	FreeReplayCheckpoints();
+
+	if(m_IDPipe) m_Real.glDeleteProgramPipelines(1, &m_IDPipe);
+	if(m_IDFSProg) m_Real.glDeleteProgram(m_IDFSProg);
+
 	if(m_FakeIdxBuf) m_Real.glDeleteBuffers(1, &m_FakeIdxBuf);
 	if(m_FakeVAO) m_Real.glDeleteVertexArrays(1, &m_FakeVAO);
 	if(m_FakeBB_FBO) m_Real.glDeleteFramebuffers(1, &m_FakeBB_FBO);
@@ -941,18 +964,179 @@ WrappedOpenGL::~WrappedOpenGL()
 
 	SAFE_DELETE(m_ResourceManager);
 
+	for(size_t i=0; i < m_ThreadData.size(); i++)
+		delete m_ThreadData[i];
+	m_ThreadData.clear();
+
 	if(RenderDoc::Inst().GetCrashHandler())
 		RenderDoc::Inst().GetCrashHandler()->UnregisterMemoryRegion(this);
 }
 
 void *WrappedOpenGL::GetCtx()
 {
-	return (void *)m_ActiveContexts[Threading::GetCurrentID()].ctx;
+	ThreadData *t = (ThreadData *)Threading::GetTLSValue(m_ThreadSlot);
+	return t ? t->ctx : NULL;
 }
 
 WrappedOpenGL::ContextData &WrappedOpenGL::GetCtxData()
 {
-	return m_ContextData[GetCtx()];
+	ThreadData *t = (ThreadData *)Threading::GetTLSValue(m_ThreadSlot);
+	if(t && t->ctxdata)
+		return *t->ctxdata;
+
+	// lock-free calls never get here, see BeginLockFreeCall
+	SCOPED_LOCK(m_HookLock);
+
+	if(t == NULL)
+		return m_ContextData[NULL];
+
+	t->ctxdata = &m_ContextData[t->ctx];
+	return *t->ctxdata;
+}
+
+WrappedOpenGL::ThreadData *WrappedOpenGL::GetThreadData()
+{
+	ThreadData *t = (ThreadData *)Threading::GetTLSValue(m_ThreadSlot);
+
+	if(t == NULL)
+	{
+		t = new ThreadData();
+		Threading::SetTLSValue(m_ThreadSlot, t);
+
+		SCOPED_LOCK(m_HookLock);
+		m_ThreadData.push_back(t);
+	}
+
+	return t;
+}
+
+void WrappedOpenGL::SetActiveContext(const GLWindowingData &winData)
+{
+	SCOPED_LOCK(m_HookLock);
+
+	m_ActiveContexts[Threading::GetCurrentID()] = winData;
+
+	ThreadData *t = GetThreadData();
+	t->ctx = winData.ctx;
+	t->ctxdata = winData.ctx ? &m_ContextData[winData.ctx] : NULL;
+}
+
+void WrappedOpenGL::BlockLockFreeCalls(uint32_t reason)
+{
+	SCOPED_LOCK(m_HookLock);
+
+	uint32_t prevReasons = m_LockFreeBlockReasons;
+	m_LockFreeBlockReasons |= reason;
+
+	// already blocked, nothing can be in flight
+	if(prevReasons != 0)
+		return;
+
+	Atomic::Inc32(&m_LockFreeBlocked);
+
+	// threads only register with the lock held, so the list can't change under us. Any
+	// call that got in before the flag was set finishes without touching shared state,
+	// they're never long.
+	for(size_t i=0; i < m_ThreadData.size(); i++)
+		while(m_ThreadData[i]->lockFreeCalls > 0)
+			Threading::Sleep(0);
+}
+
+void WrappedOpenGL::UnblockLockFreeCalls(uint32_t reason)
+{
+	SCOPED_LOCK(m_HookLock);
+
+	if(m_LockFreeBlockReasons == 0)
+		return;
+
+	m_LockFreeBlockReasons &= ~reason;
+
+	if(m_LockFreeBlockReasons == 0)
+		Atomic::Dec32(&m_LockFreeBlocked);
+}
+
+Serialiser *WrappedOpenGL::GetThreadSerialiser()
+{
+	ThreadData *t = (ThreadData *)Threading::GetTLSValue(m_ThreadSlot);
+
+	if(t == NULL || t->lockFreeCalls == 0 || t->escalated)
+		return m_pSerialiser;
+
+	// chunks copy out the serialiser's contents and rewind it, so each thread only
+	// needs the one.
+	if(t->serialiser == NULL)
+	{
+		t->serialiser = new Serialiser(NULL, Serialiser::WRITING, false);
+		t->serialiser->SetDebugText(m_pSerialiser->GetDebugText());
+		t->serialiser->SetChunkNameLookup(&GetChunkName);
+	}
+
+	return t->serialiser;
+}
+
+Chunk *WrappedOpenGL::SerialiseGenChunk(GLChunkType type, ResourceId id)
+{
+	Serialiser *ser = GetThreadSerialiser();
+
+	ScopedContext scope(ser, NULL, GetChunkName(type), type, false);
+	ser->Serialise("id", id);
+
+	return scope.Get();
+}
+
+bool WrappedOpenGL::CheckDirtyCache(ResourceId id, int32_t cleanGeneration)
+{
+	ThreadData *t = (ThreadData *)Threading::GetTLSValue(m_ThreadSlot);
+
+	if(t == NULL || t->ctxdata == NULL || t->lockFreeCalls == 0 || t->escalated)
+		return false;
+
+	ContextData &cd = *t->ctxdata;
+
+	// anything cleaned since we last looked could need marking again
+	if(cd.m_DirtyCacheGeneration != cleanGeneration)
+	{
+		cd.m_DirtyCache.clear();
+		cd.m_DirtyCacheGeneration = cleanGeneration;
+	}
+
+	return !cd.m_DirtyCache.insert(id).second;
+}
+
+void WrappedOpenGL::AddCoherentMap(GLResourceRecord *record)
+{
+	// lock-free calls skip CoherentMapImplicitBarrier's flush, so they must not run
+	// while there are any coherent maps.
+	if(m_CoherentMaps.empty())
+		BlockLockFreeCalls(eLockFreeBlock_CoherentMaps);
+
+	m_CoherentMaps.insert(record);
+}
+
+void WrappedOpenGL::RemoveCoherentMap(GLResourceRecord *record)
+{
+	m_CoherentMaps.erase(record);
+
+	if(m_CoherentMaps.empty())
+		UnblockLockFreeCalls(eLockFreeBlock_CoherentMaps);
+}
+
+void WrappedOpenGL::MarkDrawBindingsDirty()
+{
+	ContextData &cd = GetCtxData();
+
+	// resources only stop being dirty when they're deleted, so if nothing has been bound
+	// or deleted since the last draw there's nothing new for MarkDirty to find.
+	int32_t gen = m_DeleteGeneration;
+
+	if(!cd.m_DrawBindingsChanged && cd.m_DeleteGeneration == gen)
+		return;
+
+	cd.m_DrawBindingsChanged = false;
+	cd.m_DeleteGeneration = gen;
+
+	GLRenderState state(&m_Real, m_pSerialiser, m_State);
+	state.MarkDirty(this);
 }
 
 // defined in gl_<platform>_hooks.cpp
@@ -969,6 +1153,13 @@ void immediateEnd();
 
 void WrappedOpenGL::DeleteContext(void *contextHandle)
 {
+	SCOPED_LOCK(m_HookLock);
+
+	// lock-free calls on other threads could still be using this context's data. Wait for
+	// them to finish, and keep new ones out until the threads using it have been detached
+	// below.
+	BlockLockFreeCalls(eLockFreeBlock_Context);
+
 	ContextData &ctxdata = m_ContextData[contextHandle];
 
 	RenderDoc::Inst().RemoveDeviceFrameCapturer(ctxdata.ctx);
@@ -996,7 +1187,15 @@ void WrappedOpenGL::DeleteContext(void *contextHandle)
 		}
 	}
 
+	// don't leave any thread pointing at the data we're about to free. If the context
+	// is still current somewhere, that thread will look it up again under the lock.
+	for(size_t i=0; i < m_ThreadData.size(); i++)
+		if(m_ThreadData[i]->ctxdata == &ctxdata)
+			m_ThreadData[i]->ctxdata = NULL;
+
 	m_ContextData.erase(contextHandle);
+
+	UnblockLockFreeCalls(eLockFreeBlock_Context);
 }
 
 void WrappedOpenGL::ContextData::UnassociateWindow(void *wndHandle)
@@ -1167,6 +1366,8 @@ void WrappedOpenGL::ContextData::CreateDebugData(const GLHookSet &gl)
 
 void WrappedOpenGL::CreateContext(GLWindowingData winData, void *shareContext, GLInitParams initParams, bool core, bool attribsCreate)
 {
+	SCOPED_LOCK(m_HookLock);
+
 	// TODO: support multiple GL contexts more explicitly
 	m_InitParams = initParams;
 
@@ -1180,6 +1381,8 @@ void WrappedOpenGL::CreateContext(GLWindowingData winData, void *shareContext, G
 
 void WrappedOpenGL::RegisterContext(GLWindowingData winData, void *shareContext, bool core, bool attribsCreate)
 {
+	SCOPED_LOCK(m_HookLock);
+
 	ContextData &ctxdata = m_ContextData[winData.ctx];
 	ctxdata.ctx = winData.ctx;
 	ctxdata.isCore = core;
@@ -1188,7 +1391,9 @@ void WrappedOpenGL::RegisterContext(GLWindowingData winData, void *shareContext,
 
 void WrappedOpenGL::ActivateContext(GLWindowingData winData)
 {
-	m_ActiveContexts[Threading::GetCurrentID()] = winData;
+	SCOPED_LOCK(m_HookLock);
+
+	SetActiveContext(winData);
 	if(winData.ctx)
 	{
 		for(auto it = m_LastContexts.begin(); it != m_LastContexts.end(); ++it)
@@ -1322,6 +1527,8 @@ void WrappedOpenGL::ActivateContext(GLWindowingData winData)
 
 void WrappedOpenGL::WindowSize(void *windowHandle, uint32_t w, uint32_t h)
 {
+	SCOPED_LOCK(m_HookLock);
+
 	// TODO: support multiple window handles
 	m_InitParams.width = w;
 	m_InitParams.height = h;
@@ -1960,6 +2167,10 @@ void WrappedOpenGL::ReplaceResource(ResourceId from, ResourceId to)
 
 void WrappedOpenGL::RemoveReplacement(ResourceId id)
 {
+	// checkpoints were made with the old resources bound. ReplaceResource comes through
+	// here first too.
+	FreeReplayCheckpoints();
+
 	// do actual removal
 	GetResourceManager()->RemoveReplacement(id);
 
@@ -2017,6 +2228,8 @@ void WrappedOpenGL::FreeTargetResource(ResourceId id)
 
 void WrappedOpenGL::SwapBuffers(void *windowHandle)
 {
+	SCOPED_LOCK(m_HookLock);
+
 	if(m_State == WRITING_IDLE)
 		RenderDoc::Inst().Tick();
 
@@ -2174,6 +2387,14 @@ void WrappedOpenGL::SwapBuffers(void *windowHandle)
 					RenderOverlayText(0.0f, y, "%d Captures saved.\n", (uint32_t)m_FrameRecord.size());
 					y += 1.0f;
 
+					if(RenderDoc::Inst().IsPeriodicCapturing())
+					{
+						CaptureStats stats = RenderDoc::Inst().GetCaptureStats();
+						RenderOverlayText(0.0f, y, "Periodic capture: %u written (%.1f MB), %u skipped.\n",
+							stats.captured, float(stats.bytesWritten)/1024.0f/1024.0f, stats.skippedBusy + stats.skippedDiskSpace);
+						y += 1.0f;
+					}
+
 					uint64_t now = Timing::GetUnixTimestamp();
 					for(size_t i=0; i < m_FrameRecord.size(); i++)
 					{
@@ -2305,15 +2526,20 @@ void WrappedOpenGL::MakeValidContextCurrent(GLWindowingData &prevctx, void *favo
 			RDCERR("Couldn't find GL context to make current on this thread %llu.", Threading::GetCurrentID());
 		}
 
-		m_ActiveContexts[Threading::GetCurrentID()] = prevctx;
+		SetActiveContext(prevctx);
 		MakeContextCurrent(prevctx);
 	}
 }
 
 void WrappedOpenGL::StartFrameCapture(void *dev, void *wnd)
 {
+	SCOPED_LOCK(m_HookLock);
+
 	if(m_State != WRITING_IDLE) return;
 
+	// from here on every call goes through the hook lock until we're idle again
+	BlockLockFreeCalls(eLockFreeBlock_NotIdle);
+
 	RenderDoc::Inst().SetCurrentDriver(RDC_OpenGL);
 
 	m_State = WRITING_CAPFRAME;
@@ -2346,7 +2572,7 @@ void WrappedOpenGL::StartFrameCapture(void *dev, void *wnd)
 	if(switchctx.ctx != prevctx.ctx)
 	{
 		MakeContextCurrent(prevctx);
-		m_ActiveContexts[Threading::GetCurrentID()] = prevctx;
+		SetActiveContext(prevctx);
 	}
 
 	RDCLOG("Starting capture, frame %u", m_FrameCounter);
@@ -2354,6 +2580,8 @@ void WrappedOpenGL::StartFrameCapture(void *dev, void *wnd)
 
 bool WrappedOpenGL::EndFrameCapture(void *dev, void *wnd)
 {
+	SCOPED_LOCK(m_HookLock);
+
 	if(m_State != WRITING_CAPFRAME) return true;
 	
 	CaptureFailReason reason = CaptureSucceeded;
@@ -2444,11 +2672,8 @@ bool WrappedOpenGL::EndFrameCapture(void *dev, void *wnd)
 			RDCDEBUG("Done");	
 		}
 
-		m_pFileSerialiser->FlushToDisk();
-
-		RenderDoc::Inst().SuccessfullyWrittenLog();
-
-		SAFE_DELETE(m_pFileSerialiser);
+		RenderDoc::Inst().FinishWriteSerialiser(m_pFileSerialiser);
+		m_pFileSerialiser = NULL;
 
 		m_State = WRITING_IDLE;
 
@@ -2459,9 +2684,11 @@ bool WrappedOpenGL::EndFrameCapture(void *dev, void *wnd)
 		if(switchctx.ctx != prevctx.ctx)
 		{
 			MakeContextCurrent(prevctx);
-			m_ActiveContexts[Threading::GetCurrentID()] = prevctx;
+			SetActiveContext(prevctx);
 		}
 
+		UnblockLockFreeCalls(eLockFreeBlock_NotIdle);
+
 		return true;
 	}
 	else
@@ -2520,6 +2747,8 @@ bool WrappedOpenGL::EndFrameCapture(void *dev, void *wnd)
 			m_State = WRITING_IDLE;
 
 			GetResourceManager()->MarkUnwrittenResources();
+
+			UnblockLockFreeCalls(eLockFreeBlock_NotIdle);
 		}
 		else
 		{
@@ -2533,7 +2762,7 @@ bool WrappedOpenGL::EndFrameCapture(void *dev, void *wnd)
 		if(switchctx.ctx != prevctx.ctx)
 		{
 			MakeContextCurrent(prevctx);
-			m_ActiveContexts[Threading::GetCurrentID()] = prevctx;
+			SetActiveContext(prevctx);
 		}
 
 		return false;
@@ -2669,7 +2898,7 @@ void WrappedOpenGL::ContextEndFrame()
 
 	if(HasCallstack)
 	{
-		Callstack::Stackwalk *call = Callstack::Collect();
+		Callstack::Stackwalk *call = RenderDoc::Inst().CollectCallstack();
 
 		RDCASSERT(call->NumLevels() < 0xff);
 
@@ -2829,7 +3058,7 @@ void WrappedOpenGL::Serialise_DebugMessages()
 	{
 		if(m_State >= WRITING)
 		{
-			Callstack::Stackwalk *call = Callstack::Collect();
+			Callstack::Stackwalk *call = RenderDoc::Inst().CollectCallstack();
 
 			RDCASSERT(call->NumLevels() < 0xff);
 
@@ -2903,6 +3132,11 @@ bool WrappedOpenGL::RecordUpdateCheck(GLResourceRecord *record)
 		return false;
 	}
 
+	// the caller is about to serialise a chunk. The records passed here are for
+	// container objects, which only their own context touches, so only that needs
+	// the hook lock.
+	EscalateLockFreeCall();
+
 	return true;
 }
 
@@ -2981,15 +3215,11 @@ void WrappedOpenGL::ReadLogInitialisation()
 
 	int chunkIdx = 0;
 
-	struct chunkinfo
-	{
-		chunkinfo() : count(0), totalsize(0), total(0.0) {}
-		int count;
-		uint64_t totalsize;
-		double total;
-	};
+	m_LoadProfiler.Reset();
+	GetResourceManager()->SetLoadProfiler(&m_LoadProfiler);
+	GetResourceManager()->SetInitialContentsBudget(RenderDoc::Inst().GetInitialContentsBudget());
 
-	map<GLChunkType,chunkinfo> chunkInfos;
+	PerformanceTimer totalTimer;
 
 	SCOPED_TIMER("chunk initialisation");
 
@@ -3015,20 +3245,30 @@ void WrappedOpenGL::ReadLogInitialisation()
 		
 		RenderDoc::Inst().SetProgress(FileInitialRead, float(offset)/float(m_pSerialiser->GetSize()));
 
+		if((int)context == (int)INITIAL_CONTENTS)
+			m_LoadProfiler.AddInitialContents(GetResourceManager()->TakeLastInitialContentsType(),
+			                                  m_pSerialiser->GetOffset() - offset, timer.GetMilliseconds());
+
 		if(context == CAPTURE_SCOPE)
 		{
 			frameOffset = offset;
 
+			PerformanceTimer applyTimer;
+
 			GetResourceManager()->ApplyInitialContents();
 
+			m_LoadProfiler.SetApplyTime(applyTimer.GetMilliseconds());
+
+			PerformanceTimer replayTimer;
+
 			ContextReplayLog(READING, 0, 0, false);
+
+			m_LoadProfiler.SetFrameReplayTime(replayTimer.GetMilliseconds());
 		}
 
 		uint64_t offset2 = m_pSerialiser->GetOffset();
 
-		chunkInfos[context].total += timer.GetMilliseconds();
-		chunkInfos[context].totalsize += offset2 - offset;
-		chunkInfos[context].count++;
+		m_LoadProfiler.AddChunk(context, GetChunkName(context), offset2 - offset, timer.GetMilliseconds());
 		
 		if(context == CAPTURE_SCOPE)
 			break;
@@ -3036,19 +3276,11 @@ void WrappedOpenGL::ReadLogInitialisation()
 		if(m_pSerialiser->AtEnd())
 			break;
 	}
-	
-	for(auto it=chunkInfos.begin(); it != chunkInfos.end(); ++it)
-	{
-		double dcount = double(it->second.count);
-
-		RDCDEBUG("% 5d chunks - Time: %9.3fms total/%9.3fms avg - Size: %8.3fMB total/%7.3fMB avg - %s (%u)",
-				it->second.count,
-				it->second.total, it->second.total/dcount,
-				double(it->second.totalsize)/(1024.0*1024.0),
-				double(it->second.totalsize)/(dcount*1024.0*1024.0),
-				GetChunkName(it->first), uint32_t(it->first)
-				);
-	}
+
+	GetResourceManager()->SetLoadProfiler(NULL);
+
+	m_LoadProfiler.SetTotalTime(totalTimer.GetMilliseconds());
+	m_LoadProfiler.Dump();
 
 	RDCDEBUG("Allocating %llu persistant bytes of memory for the log.", m_pSerialiser->GetSize() - frameOffset);
 	
@@ -3875,7 +4107,9 @@ void WrappedOpenGL::ProcessChunk(uint64_t offset, GLChunkType context)
 		break;
 	default:
 		// ignore system chunks
-		if((int)context == (int)INITIAL_CONTENTS)
+		if((int)context == (int)INITIAL_CONTENTS && GetResourceManager()->IsDeferringInitialContents())
+			GetResourceManager()->DeferInitialContentsChunk();
+		else if((int)context == (int)INITIAL_CONTENTS)
 			GetResourceManager()->Serialise_InitialState(GLResource(MakeNullResource));
 		else if((int)context < (int)FIRST_CHUNK_ID)
 			m_pSerialiser->SkipCurrentChunk();
@@ -3964,7 +4198,12 @@ void WrappedOpenGL::ContextReplayLog(LogState readType, uint32_t startEventID, u
 
 		GLChunkType chunktype = (GLChunkType)m_pSerialiser->PushContext(NULL, 1, false);
 
+		PerformanceTimer timer;
+
 		ContextProcessChunk(offset, chunktype, false);
+
+		if(m_State == READING)
+			m_LoadProfiler.AddEvent(m_CurEventID, timer.GetMilliseconds());
 		
 		RenderDoc::Inst().SetProgress(FrameEventsRead, float(offset - startOffset)/float(m_pSerialiser->GetSize()));
 		
@@ -4478,6 +4717,274 @@ const FetchDrawcall *WrappedOpenGL::GetDrawcall(uint32_t frameID, uint32_t event
 	return NULL;
 }
 
+void WrappedOpenGL::SetReplayCheckpoints(uint32_t eventInterval, uint64_t memoryBudget)
+{
+	m_Checkpoints.Set(GetResourceManager(), eventInterval, memoryBudget);
+}
+
+void WrappedOpenGL::FreeReplayCheckpoints()
+{
+	m_Checkpoints.Free(GetResourceManager());
+}
+
+ReplayCheckpointStats WrappedOpenGL::GetReplayCheckpointStats()
+{
+	return m_Checkpoints.GetStats();
+}
+
+bool WrappedOpenGL::CanCreateCheckpoint()
+{
+	// we can't snapshot in the middle of a query, conditional render or transform
+	// feedback, as replaying on from here wouldn't begin them again.
+	for(size_t i=0; i < 8; i++)
+		for(int j=0; j < 8; j++)
+			if(m_ActiveQueries[i][j])
+				return false;
+
+	return !m_ActiveConditional && !m_ActiveFeedback;
+}
+
+void WrappedOpenGL::GetCheckpointWrittenResources(set<ResourceId> &ids)
+{
+	GLResourceManager *rm = GetResourceManager();
+
+	GLReplayCheckpoints::AddWrittenUses(rm, m_ResourceUses, ids);
+
+	// sub-data uploads and maps are picked up by GetCheckpointResources from the capture's
+	// written list, but GL buffers have no initial contents to fall back on so include any
+	// buffer the frame uses at all to be safe.
+	for(auto it = m_ResourceUses.begin(); it != m_ResourceUses.end(); ++it)
+	{
+		ResourceId id = rm->GetOriginalID(it->first);
+
+		if(rm->HasLiveResource(id) && rm->GetLiveResource(id).Namespace == eResBuffer && !it->second.empty())
+			ids.insert(id);
+	}
+}
+
+GLRenderState *WrappedOpenGL::FetchCheckpointState()
+{
+	GLRenderState *state = new GLRenderState(&m_Real, NULL, READING);
+	state->FetchState(GetCtx(), this);
+	return state;
+}
+
+void WrappedOpenGL::ApplyCheckpointState(GLRenderState *state)
+{
+	state->ApplyState(GetCtx(), this);
+}
+
+void WrappedOpenGL::ReplayCheckpointRange(uint32_t startEventID, uint32_t endEventID, bool partial)
+{
+	ContextReplayLog(EXECUTING, startEventID, endEventID, partial);
+}
+
+void WrappedOpenGL::RewindCheckpointFrame(uint32_t frameID)
+{
+	m_pSerialiser->SetOffset(m_FrameRecord[frameID].frameInfo.fileOffset);
+
+	GLChunkType header = (GLChunkType)m_pSerialiser->PushContext(NULL, 1, false);
+	m_pSerialiser->SkipCurrentChunk();
+	m_pSerialiser->PopContext(NULL, header);
+}
+
+static const char *IDRenderFSSource =
+	"#version 420 core\n"
+	"\n"
+	"uniform uint RENDERDOC_TexID;\n"
+	"uniform uint RENDERDOC_MeshID;\n"
+	"uniform uint RENDERDOC_ShaderID;\n"
+	"\n"
+	"layout (location = 0) out vec4 TexOut;\n"
+	"layout (location = 1) out vec4 MeshOut;\n"
+	"layout (location = 2) out vec4 ShaderOut;\n"
+	"layout (location = 3) out vec4 HighOut;\n"
+	"\n"
+	"vec4 encode(uint id)\n"
+	"{\n"
+	"	return vec4(uvec4(id, id >> 8, id >> 16, id >> 24) & uvec4(0xff)) / 255.0f;\n"
+	"}\n"
+	"\n"
+	"void main()\n"
+	"{\n"
+	"	vec4 tc = encode(RENDERDOC_TexID);\n"
+	"	vec4 mc = encode(RENDERDOC_MeshID);\n"
+	"	vec4 sc = encode(RENDERDOC_ShaderID);\n"
+	"	TexOut = vec4(tc.xyz, 1.0f);\n"
+	"	MeshOut = vec4(mc.xyz, 1.0f);\n"
+	"	ShaderOut = vec4(sc.xyz, 1.0f);\n"
+	"	HighOut = vec4(tc.w, mc.w, sc.w, 1.0f);\n"
+	"}\n";
+
+void WrappedOpenGL::SetIDRenderEvents(uint32_t frameID, uint32_t startEvent, uint32_t endEvent)
+{
+	FreeReplayCheckpoints();
+
+	m_IDStartEvent = startEvent;
+	m_IDEndEvent = endEvent;
+}
+
+void WrappedOpenGL::SetIDRendering(bool active)
+{
+	FreeReplayCheckpoints();
+
+	m_DoRenderID = active;
+
+	if(active && m_IDFSProg == 0)
+	{
+		m_IDFSProg = m_Real.glCreateShaderProgramv(eGL_FRAGMENT_SHADER, 1, &IDRenderFSSource);
+
+		GLint status = 0;
+		m_Real.glGetProgramiv(m_IDFSProg, eGL_LINK_STATUS, &status);
+
+		if(status == 0)
+		{
+			char buffer[1024] = {0};
+			m_Real.glGetProgramInfoLog(m_IDFSProg, 1024, NULL, buffer);
+			RDCERR("Couldn't build ID rendering program: %s", buffer);
+
+			m_Real.glDeleteProgram(m_IDFSProg);
+			m_IDFSProg = 0;
+			m_DoRenderID = false;
+			return;
+		}
+
+		m_IDUniforms[0] = m_Real.glGetUniformLocation(m_IDFSProg, "RENDERDOC_TexID");
+		m_IDUniforms[1] = m_Real.glGetUniformLocation(m_IDFSProg, "RENDERDOC_MeshID");
+		m_IDUniforms[2] = m_Real.glGetUniformLocation(m_IDFSProg, "RENDERDOC_ShaderID");
+
+		m_Real.glGenProgramPipelines(1, &m_IDPipe);
+	}
+}
+
+bool WrappedOpenGL::IsIDRenderingPass()
+{
+	return m_DoRenderID && m_State == EXECUTING && m_IDFSProg != 0 &&
+		m_IDStartEvent < m_CurEventID && m_CurEventID < m_IDEndEvent;
+}
+
+bool WrappedOpenGL::SetupIDDraw()
+{
+	if(!IsIDRenderingPass())
+		return false;
+
+	void *ctx = GetCtx();
+
+	GLResourceManager *rm = GetResourceManager();
+
+	m_Real.glGetIntegerv(eGL_CURRENT_PROGRAM, (GLint *)&m_IDPrevProg);
+	m_Real.glGetIntegerv(eGL_PROGRAM_PIPELINE_BINDING, (GLint *)&m_IDPrevPipe);
+
+	ResourceId stageShaders[4];
+	GLuint stagePrograms[4] = {0};
+
+	ResourceId fragShader, fragProgram;
+
+	if(m_IDPrevProg != 0)
+	{
+		fragProgram = rm->GetID(ProgramRes(ctx, m_IDPrevProg));
+
+		auto progit = m_Programs.find(fragProgram);
+		if(progit == m_Programs.end())
+			return false;
+
+		ProgramData &prog = progit->second;
+
+		for(size_t i=0; i < 4; i++)
+		{
+			stageShaders[i] = prog.stageShaders[i];
+			stagePrograms[i] = m_IDPrevProg;
+		}
+
+		fragShader = prog.stageShaders[4];
+	}
+	else if(m_IDPrevPipe != 0)
+	{
+		auto pipeit = m_Pipelines.find(rm->GetID(ProgramPipeRes(ctx, m_IDPrevPipe)));
+		if(pipeit == m_Pipelines.end())
+			return false;
+
+		PipelineData &pipe = pipeit->second;
+
+		for(size_t i=0; i < 4; i++)
+		{
+			stageShaders[i] = pipe.stageShaders[i];
+			if(pipe.stagePrograms[i] != ResourceId())
+				stagePrograms[i] = rm->GetCurrentResource(pipe.stagePrograms[i]).name;
+		}
+
+		fragShader = pipe.stageShaders[4];
+		fragProgram = pipe.stagePrograms[4];
+	}
+	else
+	{
+		return false;
+	}
+
+	// the same as the overlay pipeline - each stage's separable program with the uniforms
+	// copied across, and our program in place of the fragment shader.
+	for(size_t i=0; i < 4; i++)
+	{
+		GLuint prog = 0;
+
+		auto shadit = m_Shaders.find(stageShaders[i]);
+
+		if(stageShaders[i] != ResourceId() && shadit != m_Shaders.end())
+		{
+			ShaderData &shad = shadit->second;
+			prog = shad.prog;
+
+			CopyProgramUniforms(m_Real, stagePrograms[i], prog);
+
+			if(i == 0)
+				CopyProgramAttribBindings(m_Real, stagePrograms[i], prog, &shad.reflection);
+		}
+
+		m_Real.glUseProgramStages(m_IDPipe, ShaderBit(i), prog);
+	}
+
+	m_Real.glUseProgramStages(m_IDPipe, eGL_FRAGMENT_SHADER_BIT, m_IDFSProg);
+
+	// texture on unit 0, as D3D11 uses the first pixel shader SRV
+	GLuint tex = 0;
+	{
+		GLenum activeTex = eGL_TEXTURE0;
+		m_Real.glGetIntegerv(eGL_ACTIVE_TEXTURE, (GLint *)&activeTex);
+		m_Real.glActiveTexture(eGL_TEXTURE0);
+
+		m_Real.glGetIntegerv(eGL_TEXTURE_BINDING_2D, (GLint *)&tex);
+		if(tex == 0)
+			m_Real.glGetIntegerv(eGL_TEXTURE_BINDING_2D_ARRAY, (GLint *)&tex);
+
+		m_Real.glActiveTexture(activeTex);
+	}
+
+	// the index buffer, or the buffer feeding attribute 0 for non-indexed draws
+	GLuint mesh = 0;
+	m_Real.glGetIntegerv(eGL_ELEMENT_ARRAY_BUFFER_BINDING, (GLint *)&mesh);
+	if(mesh == 0)
+		m_Real.glGetVertexAttribiv(0, eGL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, (GLint *)&mesh);
+
+	uint32_t texID = tex ? uint32_t(rm->GetOriginalID(rm->GetID(TextureRes(ctx, tex))).id) : 0;
+	uint32_t meshID = mesh ? uint32_t(rm->GetOriginalID(rm->GetID(BufferRes(ctx, mesh))).id) : 0;
+	uint32_t shaderID = uint32_t(rm->GetOriginalID(fragShader != ResourceId() ? fragShader : fragProgram).id);
+
+	m_Real.glProgramUniform1ui(m_IDFSProg, m_IDUniforms[0], texID);
+	m_Real.glProgramUniform1ui(m_IDFSProg, m_IDUniforms[1], meshID);
+	m_Real.glProgramUniform1ui(m_IDFSProg, m_IDUniforms[2], shaderID);
+
+	m_Real.glUseProgram(0);
+	m_Real.glBindProgramPipeline(m_IDPipe);
+
+	return true;
+}
+
+void WrappedOpenGL::FinishIDDraw()
+{
+	m_Real.glBindProgramPipeline(m_IDPrevPipe);
+	m_Real.glUseProgram(m_IDPrevProg);
+}
+
 void WrappedOpenGL::ReplayLog(uint32_t frameID, uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType)
 {
 	RDCASSERT(frameID < (uint32_t)m_FrameRecord.size());
@@ -4501,6 +5008,16 @@ void WrappedOpenGL::ReplayLog(uint32_t frameID, uint32_t startEventID, uint32_t
 	m_pSerialiser->SkipCurrentChunk();
 
 	m_pSerialiser->PopContext(NULL, header);
+
+	uint32_t lastEventID = endEventID;
+	if(replayType == eReplay_WithoutDraw)
+		lastEventID = RDCMAX(1U,endEventID)-1;
+
+	// checkpoints only come into play when replaying from the start of the frame
+	bool checkpoints = (!partial && m_Checkpoints.Enabled());
+
+	if(checkpoints && m_Checkpoints.Restore(this, GetResourceManager(), frameID, m_Events, lastEventID, startEventID))
+		partial = true;
 	
 	if(!partial)
 	{
@@ -4509,10 +5026,8 @@ void WrappedOpenGL::ReplayLog(uint32_t frameID, uint32_t startEventID, uint32_t
 	}
 	
 	{
-		if(replayType == eReplay_Full)
-			ContextReplayLog(EXECUTING, startEventID, endEventID, partial);
-		else if(replayType == eReplay_WithoutDraw)
-			ContextReplayLog(EXECUTING, startEventID, RDCMAX(1U,endEventID)-1, partial);
+		if(replayType == eReplay_Full || replayType == eReplay_WithoutDraw)
+			m_Checkpoints.Replay(this, GetResourceManager(), frameID, m_Events, startEventID, lastEventID, partial, checkpoints);
 		else if(replayType == eReplay_OnlyDraw)
 			ContextReplayLog(EXECUTING, endEventID, endEventID, partial);
 		else
@@ -29,6 +29,7 @@
 #include "common/timing.h"
 
 #include "core/core.h"
+#include "core/replay_checkpoints.h"
 
 #include "replay/replay_driver.h"
 
@@ -55,7 +56,7 @@ struct GLInitParams : public RDCInitParams
 	uint32_t width;
 	uint32_t height;
 	
-	static const uint32_t GL_SERIALISE_VERSION = 0x0000010;
+	static const uint32_t GL_SERIALISE_VERSION = 0x0000011;
 
 	// version number internal to opengl stream
 	uint32_t SerialiseVersion;
@@ -99,13 +100,18 @@ struct Replacement
 	GLResource res;
 };
 
-class WrappedOpenGL : public IFrameCapturer
+typedef ReplayCheckpoints<GLResourceManager, GLRenderState> GLReplayCheckpoints;
+
+class WrappedOpenGL : public IFrameCapturer, public GLReplayCheckpoints::Driver
 {
 	private:
 		const GLHookSet &m_Real;
 
 		friend class GLReplay;
 		friend class GLResourceManager;
+		friend class ScopedGLHookLock;
+		friend struct GLHookBench;
+		friend struct GLIdleBench;
 
 		const GLHookSet &GetHookset() { return m_Real; }
 
@@ -165,8 +171,17 @@ class WrappedOpenGL : public IFrameCapturer
 		PerformanceTimer m_FrameTimer;
 		vector<double> m_FrameTimes;
 		double m_TotalTime, m_AvgFrametime, m_MinFrametime, m_MaxFrametime;
-		
-		set<ResourceId> m_HighTrafficResources;
+
+		// while idle every draw has to mark anything it might write to as dirty (see
+		// GLRenderState::MarkDirty), but that's a lot of glGet calls and the answer only
+		// changes when the relevant bindings do. Wrappers that change them call
+		// DrawBindingsChanged(), and deleting any resource bumps m_DeleteGeneration since
+		// a name bound in another context could be reused for something new.
+		volatile int32_t m_DeleteGeneration;
+
+		void DrawBindingsChanged() { if(m_State >= WRITING) GetCtxData().m_DrawBindingsChanged = true; }
+		void ResourcesDeleted() { Atomic::Inc32(&m_DeleteGeneration); }
+		void MarkDrawBindingsDirty();
 
 		// we store two separate sets of maps, since for an explicit glMemoryBarrier
 		// we need to flush both types of maps, but for implicit sync points we only
@@ -183,10 +198,42 @@ class WrappedOpenGL : public IFrameCapturer
 		// in a coherent persistent mapped buffer, to propogate changes across. In most
 		// cases hopefully m_CoherentMaps will be empty so this will amount to an inlined
 		// check and jump
+		// m_CoherentMaps only changes with lock-free calls blocked (see AddCoherentMap), so
+		// lock-free calls always see it empty here.
 		inline void CoherentMapImplicitBarrier()
 		{ if(!m_CoherentMaps.empty()) PersistentMapMemoryBarrier(m_CoherentMaps); }
 
+		void AddCoherentMap(GLResourceRecord *record);
+		void RemoveCoherentMap(GLResourceRecord *record);
+
 		vector<FetchFrameRecord> m_FrameRecord;
+
+		LoadProfiler m_LoadProfiler;
+
+		// snapshots taken during replays from the start of the frame, see ReplayCheckpoints
+		GLReplayCheckpoints m_Checkpoints;
+
+		bool CanCreateCheckpoint();
+		void GetCheckpointWrittenResources(set<ResourceId> &ids);
+		GLRenderState *FetchCheckpointState();
+		void ApplyCheckpointState(GLRenderState *state);
+		void ReplayCheckpointRange(uint32_t startEventID, uint32_t endEventID, bool partial);
+		void RewindCheckpointFrame(uint32_t frameID);
+
+		// ID rendering. While enabled, draws from m_IDStartEvent to m_IDEndEvent are made
+		// with our own fragment program writing out the texture, mesh and shader IDs.
+		bool m_DoRenderID;
+		uint32_t m_IDStartEvent;
+		uint32_t m_IDEndEvent;
+		GLuint m_IDFSProg;
+		GLuint m_IDPipe;
+		GLint m_IDUniforms[3];
+		GLuint m_IDPrevProg;
+		GLuint m_IDPrevPipe;
+
+		bool IsIDRenderingPass();
+		bool SetupIDDraw();
+		void FinishIDDraw();
 		
 		const FetchDrawcall *GetDrawcall(const FetchDrawcall *draw, uint32_t eventID);
 		
@@ -350,6 +397,9 @@ class WrappedOpenGL : public IFrameCapturer
 				m_Renderbuffer = ResourceId();
 				m_TextureUnit = 0;
 				m_ProgramPipeline = m_Program = 0;
+				m_DrawBindingsChanged = true;
+				m_DeleteGeneration = 0;
+				m_DirtyCacheGeneration = 0;
 			}
 
 			void *ctx;
@@ -402,12 +452,122 @@ class WrappedOpenGL : public IFrameCapturer
 			GLuint m_ProgramPipeline;
 			GLuint m_Program;
 
+			// see MarkDrawBindingsDirty
+			bool m_DrawBindingsChanged;
+			int32_t m_DeleteGeneration;
+
+			// see CheckDirtyCache
+			set<ResourceId> m_DirtyCache;
+			int32_t m_DirtyCacheGeneration;
+
 			GLResourceRecord *GetActiveTexRecord() { return m_TextureRecord[m_TextureUnit]; }
 		};
 
 		map<void*, ContextData> m_ContextData;
 		
 		ContextData &GetCtxData();
+
+		// per-thread data, stored in TLS so GetCtx()/GetCtxData() don't have to look
+		// through m_ActiveContexts and m_ContextData - those are only safe to touch with
+		// m_HookLock held, and idle lock-free calls don't hold it.
+		struct ThreadData
+		{
+			ThreadData() : ctx(NULL), ctxdata(NULL), lockFreeCalls(0), escalated(false), serialiser(NULL) {}
+			~ThreadData() { SAFE_DELETE(serialiser); }
+
+			void *ctx;
+			ContextData *ctxdata;
+
+			// non-zero while this thread is inside a call that skipped m_HookLock
+			volatile int32_t lockFreeCalls;
+
+			// set when a lock-free call found it needed the hook lock after all, see
+			// EscalateLockFreeCall
+			bool escalated;
+
+			// lock-free calls can't write to m_pSerialiser, see GetThreadSerialiser
+			Serialiser *serialiser;
+		};
+
+		uint64_t m_ThreadSlot;
+		vector<ThreadData *> m_ThreadData;
+
+		ThreadData *GetThreadData();
+		void SetActiveContext(const GLWindowingData &winData);
+
+		// taken by the hooks around every call that isn't idle lock-free, and by any
+		// driver entry point that changes contexts or the capture state.
+		Threading::CriticalSection m_HookLock;
+
+		// reasons calls can't currently go lock-free. Anything that lock-free calls read
+		// without a lock (m_State, m_CoherentMaps, another thread's ContextData) only
+		// changes while one of these is set.
+		enum LockFreeBlock
+		{
+			eLockFreeBlock_NotIdle      = 0x1, // replaying, or capturing a frame
+			eLockFreeBlock_CoherentMaps = 0x2, // coherent maps must be flushed on every call
+			eLockFreeBlock_Context      = 0x4, // a context's data is being freed
+		};
+
+		// only changed with m_HookLock held. m_LockFreeBlocked is what BeginLockFreeCall
+		// checks, and is non-zero whenever any reason is set. Setting it waits for any
+		// lock-free calls still in flight.
+		uint32_t m_LockFreeBlockReasons;
+		volatile int32_t m_LockFreeBlocked;
+
+		void BlockLockFreeCalls(uint32_t reason);
+		void UnblockLockFreeCalls(uint32_t reason);
+
+		ThreadData *BeginLockFreeCall()
+		{
+			ThreadData *t = (ThreadData *)Threading::GetTLSValue(m_ThreadSlot);
+
+			// no context current (or not seen on this thread yet), take the slow path
+			if(t == NULL || t->ctxdata == NULL)
+				return NULL;
+
+			// publish that we're in a call before checking, so BlockLockFreeCalls either
+			// sees us and waits or we see the block and fall back to locking.
+			Atomic::Inc32(&t->lockFreeCalls);
+
+			if(m_LockFreeBlocked == 0)
+				return t;
+
+			Atomic::Dec32(&t->lockFreeCalls);
+			return NULL;
+		}
+
+		bool InLockFreeCall()
+		{
+			ThreadData *t = (ThreadData *)Threading::GetTLSValue(m_ThreadSlot);
+			return t && t->lockFreeCalls > 0 && !t->escalated;
+		}
+
+		// called by lock-free wrappers once they find they need more than the current
+		// context's data and the resource records - serialising to m_pSerialiser, or the
+		// driver's own maps. Leaves the call holding m_HookLock until it returns. A
+		// capture can start while we wait for the lock, so m_State is only reliable when
+		// read after this.
+		void EscalateLockFreeCall()
+		{
+			ThreadData *t = (ThreadData *)Threading::GetTLSValue(m_ThreadSlot);
+			if(t == NULL || t->lockFreeCalls == 0 || t->escalated)
+				return;
+
+			// stop counting as lock-free first, BlockLockFreeCalls could be waiting on us
+			// while holding the lock.
+			Atomic::Dec32(&t->lockFreeCalls);
+			m_HookLock.Lock();
+			t->escalated = true;
+		}
+
+		// the serialiser to build chunks on - the thread's own one while lock-free
+		Serialiser *GetThreadSerialiser();
+
+		// glGen* chunks only hold the new object's ID, so lock-free calls build them
+		// with this instead of Serialise_glGen*. Must write the same as those do.
+		Chunk *SerialiseGenChunk(GLChunkType type, ResourceId id);
+
 		GLuint GetUniformProgram();
 
 		void MakeValidContextCurrent(GLWindowingData &prevctx, void *favourWnd);
@@ -470,6 +630,18 @@ class WrappedOpenGL : public IFrameCapturer
 		GLReplay *GetReplay() { return &m_Replay; }
 		void *GetCtx();
 
+		// while idle, the hooks call functions this returns true for without taking
+		// the hook lock, see ScopedGLHookLock. These are the functions that only touch
+		// the current context's data, the (internally locked) resource manager and
+		// records when not capturing a frame, or take the lock themselves when they
+		// need more - see gl_lockfree.cpp.
+		static bool IsIdleLockFree(const char *function);
+
+		// while lock-free, each context remembers what it has already marked dirty so
+		// repeated updates to the same resource don't all take the resource manager's
+		// lock. Returns true if id was already marked, adding it if not.
+		bool CheckDirtyCache(ResourceId id, int32_t cleanGeneration);
+
 		void SetDebugMsgContext(const char *context) { m_DebugMsgContext = context; }
 		
 		void AddDebugMessage(DebugMessage msg) { if(m_State < WRITING) m_DebugMessages.push_back(msg); }
@@ -481,6 +653,14 @@ class WrappedOpenGL : public IFrameCapturer
 		void Initialise(GLInitParams &params);
 		void ReplayLog(uint32_t frameID, uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType);
 		void ReadLogInitialisation();
+		LoadProfile GetLoadProfile() { return m_LoadProfiler.Bake(); }
+
+		void SetReplayCheckpoints(uint32_t eventInterval, uint64_t memoryBudget);
+		void FreeReplayCheckpoints();
+		ReplayCheckpointStats GetReplayCheckpointStats();
+
+		void SetIDRenderEvents(uint32_t frameID, uint32_t startEvent, uint32_t endEvent);
+		void SetIDRendering(bool active);
 
 		GLuint GetFakeBBFBO() { return m_FakeBB_FBO; }
 		GLuint GetFakeVAO() { return m_FakeVAO; }
@@ -1471,3 +1651,35 @@ class ScopedDebugContext
 	private:
 		WrappedOpenGL *m_GL;
 };
+
+// held by the hooks around each call into the driver. Takes the hook lock unless
+// idleLockFree is set and the driver can run the call lock-free right now.
+class ScopedGLHookLock
+{
+	public:
+		ScopedGLHookLock(WrappedOpenGL *gl, bool idleLockFree)
+		{
+			m_GL = gl;
+			m_Thread = idleLockFree ? m_GL->BeginLockFreeCall() : NULL;
+
+			if(m_Thread == NULL)
+				m_GL->m_HookLock.Lock();
+		}
+
+		~ScopedGLHookLock()
+		{
+			if(m_Thread && !m_Thread->escalated)
+			{
+				Atomic::Dec32(&m_Thread->lockFreeCalls);
+			}
+			else
+			{
+				if(m_Thread)
+					m_Thread->escalated = false;
+				m_GL->m_HookLock.Unlock();
+			}
+		}
+	private:
+		WrappedOpenGL *m_GL;
+		WrappedOpenGL::ThreadData *m_Thread;
+};
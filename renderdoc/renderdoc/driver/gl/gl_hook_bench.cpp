@@ -0,0 +1,221 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2014 Crytek
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+// Standalone benchmark for the per-call overhead of the Linux GL hooks, built
+// with 'make hook_bench'. This drives a real WrappedOpenGL through the same
+// ScopedGLHookLock the hooks use, with a hookset that only has stubs for the few
+// functions needed to activate a context and the call being forwarded:
+//  - "global lock": a function that isn't idle lock-free, always takes m_HookLock
+//  - "idle":        an idle lock-free function while the driver is idle
+//  - "idle lookup": the same, also looking up a resource's ID through the resource
+//                   manager like most wrappers do
+//  - "capturing":   the same function with lock-free calls blocked, as they are
+//                   from the start of a frame capture
+// each with 1 to 8 threads hammering calls at the same time, each thread with
+// its own context. Threads are pinned round-robin to the CPUs we're allowed to
+// run on, contention numbers are meaningless with fewer than 2.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+
+#include "common/common.h"
+#include "common/threading.h"
+#include "common/timing.h"
+#include "os/os_specific.h"
+#include "driver/gl/gl_driver.h"
+
+static const uint32_t CallsPerThread = 2000000;
+
+// friend of WrappedOpenGL, lets the bench block lock-free calls the same way
+// StartFrameCapture does without needing a live context to really capture.
+struct GLHookBench
+{
+	static void BlockLockFreeCalls(WrappedOpenGL *gl) { gl->BlockLockFreeCalls(WrappedOpenGL::eLockFreeBlock_NotIdle); }
+	static void UnblockLockFreeCalls(WrappedOpenGL *gl) { gl->UnblockLockFreeCalls(WrappedOpenGL::eLockFreeBlock_NotIdle); }
+};
+
+enum HookMode
+{
+	eMode_GlobalLock = 0,
+	eMode_Idle,
+	eMode_IdleLookup,
+	eMode_Capturing,
+	eMode_Count,
+};
+
+static const char *modeNames[] = { "global lock", "idle", "idle lookup", "capturing" };
+
+static GLHookSet hooks;
+static WrappedOpenGL *driver = NULL;
+static volatile int32_t startFlag = 0;
+
+// registered up front, looked up by every call in eMode_IdleLookup
+static GLResource lookupRes;
+
+static vector<int> cpus;
+
+// only enough of an implementation for ActivateContext: no extensions, no version
+static void APIENTRY StubGetIntegerv(GLenum pname, GLint *data) { *data = 0; }
+static const GLubyte * APIENTRY StubGetStringi(GLenum name, GLuint index) { return (const GLubyte *)""; }
+
+// stand-in for the real GL function that's forwarded to. Does nothing, so the only
+// shared cache lines are the ones the hook touches.
+static void RealFunction(uint32_t v) {}
+static void (*volatile realFunc)(uint32_t) = &RealFunction;
+
+struct BenchThread
+{
+	bool lockFree;
+	bool lookup;
+	int cpu;
+	uint32_t misses;
+	double ms;
+
+	// keep each thread's data on its own cache line like separate allocations would be
+	char padding[64];
+};
+
+static void BenchThreadEntry(void *param)
+{
+	BenchThread *bench = (BenchThread *)param;
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(bench->cpu, &set);
+	sched_setaffinity(0, sizeof(set), &set);
+
+	// the context handle is never dereferenced, it only needs to be unique per thread
+	GLWindowingData winData;
+	winData.SetCtx(bench);
+	driver->ActivateContext(winData);
+
+	while(startFlag == 0)
+		;
+
+	PerformanceTimer timer;
+
+	for(uint32_t i=0; i < CallsPerThread; i++)
+	{
+		ScopedGLHookLock lock(driver, bench->lockFree);
+		realFunc(i);
+
+		if(bench->lookup && driver->GetResourceManager()->GetID(lookupRes) == ResourceId())
+			bench->misses++;
+	}
+
+	bench->ms = timer.GetMilliseconds();
+
+	driver->ActivateContext(GLWindowingData());
+}
+
+int main(int argc, char **argv)
+{
+	hooks.glGetIntegerv = &StubGetIntegerv;
+	hooks.glGetStringi = &StubGetStringi;
+
+	driver = new WrappedOpenGL("", hooks);
+
+	lookupRes = BufferRes(NULL, 1);
+	driver->GetResourceManager()->RegisterResource(lookupRes);
+
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	sched_getaffinity(0, sizeof(allowed), &allowed);
+	for(int c=0; c < CPU_SETSIZE; c++)
+		if(CPU_ISSET(c, &allowed))
+			cpus.push_back(c);
+
+	printf("%d CPU(s) available\n", (int)cpus.size());
+	if(cpus.size() < 2)
+		printf("WARNING: fewer than 2 CPUs, threads can't actually contend\n");
+
+	// look up the flags the same way the hooks do
+	bool lockFree[eMode_Count] = {
+		WrappedOpenGL::IsIdleLockFree("glDeleteBuffers"),
+		WrappedOpenGL::IsIdleLockFree("glUniform1f"),
+		WrappedOpenGL::IsIdleLockFree("glBindBuffer"),
+		WrappedOpenGL::IsIdleLockFree("glUniform1f"),
+	};
+
+	uint32_t threadCounts[] = { 1, 2, 4, 8 };
+
+	printf("%-12s", "ns/call");
+	for(size_t t=0; t < ARRAY_COUNT(threadCounts); t++)
+		printf(" %7u thr", threadCounts[t]);
+	printf("\n");
+
+	for(int m=0; m < eMode_Count; m++)
+	{
+		printf("%-12s", modeNames[m]);
+
+		if(m == eMode_Capturing)
+			GLHookBench::BlockLockFreeCalls(driver);
+
+		for(size_t t=0; t < ARRAY_COUNT(threadCounts); t++)
+		{
+			uint32_t count = threadCounts[t];
+
+			BenchThread *benches = new BenchThread[count];
+			Threading::ThreadHandle *threads = new Threading::ThreadHandle[count];
+
+			startFlag = 0;
+
+			for(uint32_t i=0; i < count; i++)
+			{
+				benches[i].lockFree = lockFree[m];
+				benches[i].lookup = (m == eMode_IdleLookup);
+				benches[i].cpu = cpus[i % cpus.size()];
+				benches[i].misses = 0;
+				threads[i] = Threading::CreateThread(&BenchThreadEntry, &benches[i]);
+			}
+
+			Atomic::Inc32(&startFlag);
+
+			double worst = 0.0;
+			for(uint32_t i=0; i < count; i++)
+			{
+				Threading::JoinThread(threads[i]);
+				Threading::CloseThread(threads[i]);
+				worst = RDCMAX(worst, benches[i].ms);
+			}
+
+			// wall time per call on each thread, i.e. how much a single thread is slowed
+			printf(" %11.1f", worst*1.0e6/double(CallsPerThread));
+
+			delete[] benches;
+			delete[] threads;
+		}
+
+		if(m == eMode_Capturing)
+			GLHookBench::UnblockLockFreeCalls(driver);
+
+		printf("\n");
+	}
+
+	SAFE_DELETE(driver);
+
+	return 0;
+}
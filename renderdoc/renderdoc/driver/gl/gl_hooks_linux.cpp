@@ -24,6 +24,7 @@
 
 #include <dlfcn.h>
 #include <stdio.h>
+#include <algorithm>
 
 #include "hooks/hooks.h"
 
@@ -52,43 +53,29 @@ typedef Bool (*PFNGLXQUERYEXTENSIONPROC)(Display *dpy, int *errorBase, int *even
 
 void *libGLdlsymHandle = RTLD_NEXT; // default to RTLD_NEXT, but overwritten if app calls dlopen() on real libGL
 
+// these build the lookup tables used by glXGetProcAddress (see GLHookTables), one entry per
+// name in the lists generated by hookset.pl. Aliases get their own entry pointing at the same slot
 #define HookInit(function) \
-	if(!strcmp(func, STRINGIZE(function))) \
-	{ \
-		OpenGLHook::glhooks.GL.function = (CONCAT(function, _hooktype))realFunc; \
-		return (__GLXextFuncPtr)&CONCAT(function, _renderdoc_hooked); \
-	}
+	hooks.push_back(GLHookEntry(STRINGIZE(function), (void **)&OpenGLHook::glhooks.GL.function, (__GLXextFuncPtr)&CONCAT(function, _renderdoc_hooked)));
 
 #define HookExtension(funcPtrType, function) \
-	if(!strcmp(func, STRINGIZE(function))) \
-	{ \
-		OpenGLHook::glhooks.GL.function = (funcPtrType)realFunc; \
-		return (__GLXextFuncPtr)&CONCAT(function, _renderdoc_hooked); \
-	}
+	hooks.push_back(GLHookEntry(STRINGIZE(function), (void **)&OpenGLHook::glhooks.GL.function, (__GLXextFuncPtr)&CONCAT(function, _renderdoc_hooked)));
 
 #define HookExtensionAlias(funcPtrType, function, alias) \
-	if(!strcmp(func, STRINGIZE(alias))) \
-	{ \
-		OpenGLHook::glhooks.GL.function = (funcPtrType)realFunc; \
-		return (__GLXextFuncPtr)&CONCAT(function, _renderdoc_hooked); \
-	}
+	hooks.push_back(GLHookEntry(STRINGIZE(alias), (void **)&OpenGLHook::glhooks.GL.function, (__GLXextFuncPtr)&CONCAT(function, _renderdoc_hooked)));
 
-#if 0 // debug print for each unsupported function requested (but not used)
-#define HandleUnsupported(funcPtrType, function) \
-	if(lowername == STRINGIZE(function)) \
-	{ \
-		CONCAT(unsupported_real_,function) = (CONCAT(function, _hooktype))realFunc; \
-		RDCDEBUG("Requesting function pointer for unsupported function " STRINGIZE(function)); \
-		return (__GLXextFuncPtr)&CONCAT(function, _renderdoc_hooked); \
-	}
-#else
 #define HandleUnsupported(funcPtrType, function) \
-	if(lowername == STRINGIZE(function)) \
-	{ \
-		CONCAT(unsupported_real_,function) = (CONCAT(function, _hooktype))realFunc; \
-		return (__GLXextFuncPtr)&CONCAT(function, _renderdoc_hooked); \
-	}
-#endif
+	unsupported.push_back(GLHookEntry(STRINGIZE(function), (void **)&CONCAT(unsupported_real_,function), (__GLXextFuncPtr)&CONCAT(function, _renderdoc_hooked)));
+
+struct GLHookEntry
+{
+	GLHookEntry(const char *n, void **r, __GLXextFuncPtr h) : name(n), real(r), hook(h) {}
+	const char *name;
+	void **real;
+	__GLXextFuncPtr hook;
+
+	bool operator <(const GLHookEntry &o) const { return strcmp(name, o.name) < 0; }
+};
 
 /*
 	in bash:
@@ -104,13 +91,15 @@ void *libGLdlsymHandle = RTLD_NEXT; // default to RTLD_NEXT, but overwritten if
             for I in `seq 1 $N`; do echo -n "t$I"; if [ $I -ne $N ]; then echo -n ", "; fi; done;
         echo "); \\";
 
+        echo -e "\tstatic bool CONCAT(function, _lockfree) = WrappedOpenGL::IsIdleLockFree(STRINGIZE(function)); \\";
+
         echo -e "\textern \"C\" __attribute__ ((visibility (\"default\"))) \\";
 
         echo -en "\tret function(";
             for I in `seq 1 $N`; do echo -n "t$I p$I"; if [ $I -ne $N ]; then echo -n ", "; fi; done;
         echo ") \\";
  
-        echo -en "\t{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(";
+        echo -en "\t{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(";
             for I in `seq 1 $N`; do echo -n "p$I"; if [ $I -ne $N ]; then echo -n ", "; fi; done;
         echo "); } \\";
 
@@ -118,7 +107,7 @@ void *libGLdlsymHandle = RTLD_NEXT; // default to RTLD_NEXT, but overwritten if
             for I in `seq 1 $N`; do echo -n "t$I p$I"; if [ $I -ne $N ]; then echo -n ", "; fi; done;
         echo ") \\";
  
-        echo -en "\t{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(";
+        echo -en "\t{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(";
             for I in `seq 1 $N`; do echo -n "p$I"; if [ $I -ne $N ]; then echo -n ", "; fi; done;
         echo -n "); }";
     }
@@ -144,117 +133,135 @@ void *libGLdlsymHandle = RTLD_NEXT; // default to RTLD_NEXT, but overwritten if
 
 #define HookWrapper0(ret, function) \
 	typedef ret (*CONCAT(function, _hooktype)) (); \
+	static bool CONCAT(function, _lockfree) = WrappedOpenGL::IsIdleLockFree(STRINGIZE(function)); \
 	extern "C" __attribute__ ((visibility ("default"))) \
 	ret function() \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(); } \
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(); } \
 	ret CONCAT(function,_renderdoc_hooked)() \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(); }
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(); }
 #define HookWrapper1(ret, function, t1, p1) \
 	typedef ret (*CONCAT(function, _hooktype)) (t1); \
+	static bool CONCAT(function, _lockfree) = WrappedOpenGL::IsIdleLockFree(STRINGIZE(function)); \
 	extern "C" __attribute__ ((visibility ("default"))) \
 	ret function(t1 p1) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1); } \
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1); } \
 	ret CONCAT(function,_renderdoc_hooked)(t1 p1) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1); }
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1); }
 #define HookWrapper2(ret, function, t1, p1, t2, p2) \
 	typedef ret (*CONCAT(function, _hooktype)) (t1, t2); \
+	static bool CONCAT(function, _lockfree) = WrappedOpenGL::IsIdleLockFree(STRINGIZE(function)); \
 	extern "C" __attribute__ ((visibility ("default"))) \
 	ret function(t1 p1, t2 p2) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2); } \
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2); } \
 	ret CONCAT(function,_renderdoc_hooked)(t1 p1, t2 p2) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2); }
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2); }
 #define HookWrapper3(ret, function, t1, p1, t2, p2, t3, p3) \
 	typedef ret (*CONCAT(function, _hooktype)) (t1, t2, t3); \
+	static bool CONCAT(function, _lockfree) = WrappedOpenGL::IsIdleLockFree(STRINGIZE(function)); \
 	extern "C" __attribute__ ((visibility ("default"))) \
 	ret function(t1 p1, t2 p2, t3 p3) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3); } \
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3); } \
 	ret CONCAT(function,_renderdoc_hooked)(t1 p1, t2 p2, t3 p3) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3); }
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3); }
 #define HookWrapper4(ret, function, t1, p1, t2, p2, t3, p3, t4, p4) \
 	typedef ret (*CONCAT(function, _hooktype)) (t1, t2, t3, t4); \
+	static bool CONCAT(function, _lockfree) = WrappedOpenGL::IsIdleLockFree(STRINGIZE(function)); \
 	extern "C" __attribute__ ((visibility ("default"))) \
 	ret function(t1 p1, t2 p2, t3 p3, t4 p4) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3, p4); } \
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3, p4); } \
 	ret CONCAT(function,_renderdoc_hooked)(t1 p1, t2 p2, t3 p3, t4 p4) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3, p4); }
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3, p4); }
 #define HookWrapper5(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5) \
 	typedef ret (*CONCAT(function, _hooktype)) (t1, t2, t3, t4, t5); \
+	static bool CONCAT(function, _lockfree) = WrappedOpenGL::IsIdleLockFree(STRINGIZE(function)); \
 	extern "C" __attribute__ ((visibility ("default"))) \
 	ret function(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3, p4, p5); } \
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3, p4, p5); } \
 	ret CONCAT(function,_renderdoc_hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3, p4, p5); }
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3, p4, p5); }
 #define HookWrapper6(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6) \
 	typedef ret (*CONCAT(function, _hooktype)) (t1, t2, t3, t4, t5, t6); \
+	static bool CONCAT(function, _lockfree) = WrappedOpenGL::IsIdleLockFree(STRINGIZE(function)); \
 	extern "C" __attribute__ ((visibility ("default"))) \
 	ret function(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6); } \
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3, p4, p5, p6); } \
 	ret CONCAT(function,_renderdoc_hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6); }
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3, p4, p5, p6); }
 #define HookWrapper7(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6, t7, p7) \
 	typedef ret (*CONCAT(function, _hooktype)) (t1, t2, t3, t4, t5, t6, t7); \
+	static bool CONCAT(function, _lockfree) = WrappedOpenGL::IsIdleLockFree(STRINGIZE(function)); \
 	extern "C" __attribute__ ((visibility ("default"))) \
 	ret function(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7); } \
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3, p4, p5, p6, p7); } \
 	ret CONCAT(function,_renderdoc_hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7); }
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3, p4, p5, p6, p7); }
 #define HookWrapper8(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6, t7, p7, t8, p8) \
 	typedef ret (*CONCAT(function, _hooktype)) (t1, t2, t3, t4, t5, t6, t7, t8); \
+	static bool CONCAT(function, _lockfree) = WrappedOpenGL::IsIdleLockFree(STRINGIZE(function)); \
 	extern "C" __attribute__ ((visibility ("default"))) \
 	ret function(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7, p8); } \
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3, p4, p5, p6, p7, p8); } \
 	ret CONCAT(function,_renderdoc_hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7, p8); }
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3, p4, p5, p6, p7, p8); }
 #define HookWrapper9(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6, t7, p7, t8, p8, t9, p9) \
 	typedef ret (*CONCAT(function, _hooktype)) (t1, t2, t3, t4, t5, t6, t7, t8, t9); \
+	static bool CONCAT(function, _lockfree) = WrappedOpenGL::IsIdleLockFree(STRINGIZE(function)); \
 	extern "C" __attribute__ ((visibility ("default"))) \
 	ret function(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, t9 p9) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7, p8, p9); } \
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3, p4, p5, p6, p7, p8, p9); } \
 	ret CONCAT(function,_renderdoc_hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, t9 p9) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7, p8, p9); }
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3, p4, p5, p6, p7, p8, p9); }
 #define HookWrapper10(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6, t7, p7, t8, p8, t9, p9, t10, p10) \
 	typedef ret (*CONCAT(function, _hooktype)) (t1, t2, t3, t4, t5, t6, t7, t8, t9, t10); \
+	static bool CONCAT(function, _lockfree) = WrappedOpenGL::IsIdleLockFree(STRINGIZE(function)); \
 	extern "C" __attribute__ ((visibility ("default"))) \
 	ret function(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, t9 p9, t10 p10) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10); } \
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10); } \
 	ret CONCAT(function,_renderdoc_hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, t9 p9, t10 p10) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10); }
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10); }
 #define HookWrapper11(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6, t7, p7, t8, p8, t9, p9, t10, p10, t11, p11) \
 	typedef ret (*CONCAT(function, _hooktype)) (t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11); \
+	static bool CONCAT(function, _lockfree) = WrappedOpenGL::IsIdleLockFree(STRINGIZE(function)); \
 	extern "C" __attribute__ ((visibility ("default"))) \
 	ret function(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, t9 p9, t10 p10, t11 p11) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11); } \
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11); } \
 	ret CONCAT(function,_renderdoc_hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, t9 p9, t10 p10, t11 p11) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11); }
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11); }
 #define HookWrapper12(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6, t7, p7, t8, p8, t9, p9, t10, p10, t11, p11, t12, p12) \
 	typedef ret (*CONCAT(function, _hooktype)) (t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12); \
+	static bool CONCAT(function, _lockfree) = WrappedOpenGL::IsIdleLockFree(STRINGIZE(function)); \
 	extern "C" __attribute__ ((visibility ("default"))) \
 	ret function(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, t9 p9, t10 p10, t11 p11, t12 p12) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12); } \
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12); } \
 	ret CONCAT(function,_renderdoc_hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, t9 p9, t10 p10, t11 p11, t12 p12) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12); }
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12); }
 #define HookWrapper13(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6, t7, p7, t8, p8, t9, p9, t10, p10, t11, p11, t12, p12, t13, p13) \
 	typedef ret (*CONCAT(function, _hooktype)) (t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13); \
+	static bool CONCAT(function, _lockfree) = WrappedOpenGL::IsIdleLockFree(STRINGIZE(function)); \
 	extern "C" __attribute__ ((visibility ("default"))) \
 	ret function(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, t9 p9, t10 p10, t11 p11, t12 p12, t13 p13) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13); } \
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13); } \
 	ret CONCAT(function,_renderdoc_hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, t9 p9, t10 p10, t11 p11, t12 p12, t13 p13) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13); }
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13); }
 #define HookWrapper14(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6, t7, p7, t8, p8, t9, p9, t10, p10, t11, p11, t12, p12, t13, p13, t14, p14) \
 	typedef ret (*CONCAT(function, _hooktype)) (t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14); \
+	static bool CONCAT(function, _lockfree) = WrappedOpenGL::IsIdleLockFree(STRINGIZE(function)); \
 	extern "C" __attribute__ ((visibility ("default"))) \
 	ret function(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, t9 p9, t10 p10, t11 p11, t12 p12, t13 p13, t14 p14) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13, p14); } \
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13, p14); } \
 	ret CONCAT(function,_renderdoc_hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, t9 p9, t10 p10, t11 p11, t12 p12, t13 p13, t14 p14) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13, p14); }
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13, p14); }
 #define HookWrapper15(ret, function, t1, p1, t2, p2, t3, p3, t4, p4, t5, p5, t6, p6, t7, p7, t8, p8, t9, p9, t10, p10, t11, p11, t12, p12, t13, p13, t14, p14, t15, p15) \
 	typedef ret (*CONCAT(function, _hooktype)) (t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14, t15); \
+	static bool CONCAT(function, _lockfree) = WrappedOpenGL::IsIdleLockFree(STRINGIZE(function)); \
 	extern "C" __attribute__ ((visibility ("default"))) \
 	ret function(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, t9 p9, t10 p10, t11 p11, t12 p12, t13 p13, t14 p14, t15 p15) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13, p14, p15); } \
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13, p14, p15); } \
 	ret CONCAT(function,_renderdoc_hooked)(t1 p1, t2 p2, t3 p3, t4 p4, t5 p5, t6 p6, t7 p7, t8 p8, t9 p9, t10 p10, t11 p11, t12 p12, t13 p13, t14 p14, t15 p15) \
-	{ SCOPED_LOCK(glLock); return OpenGLHook::glhooks.GetDriver()->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13, p14, p15); }
+	{ WrappedOpenGL *gl = OpenGLHook::glhooks.GetDriver(); ScopedGLHookLock lock(gl, CONCAT(function, _lockfree)); return gl->function(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13, p14, p15); }
 
+// only guards creating the driver. Calls into it are serialised by the driver's
+// own hook lock, see ScopedGLHookLock.
 Threading::CriticalSection glLock;
 
 class OpenGLHook : LibraryHook
@@ -364,7 +371,11 @@ class OpenGLHook : LibraryHook
 		WrappedOpenGL *GetDriver()
 		{
 			if(m_GLDriver == NULL)
-				m_GLDriver = new WrappedOpenGL("", GL);
+			{
+				SCOPED_LOCK(glLock);
+				if(m_GLDriver == NULL)
+					m_GLDriver = new WrappedOpenGL("", GL);
+			}
 
 			return m_GLDriver;
 		}
@@ -772,6 +783,45 @@ bool OpenGLHook::SetupHooks(GLHookSet &GL)
 	return success;
 }
 
+// glXGetProcAddress is called for every function the application (and PopulateHooks) uses, so
+// rather than testing the name against every hooked function in turn we sort the lists once and
+// binary search them.
+struct GLHookTables
+{
+	GLHookTables()
+	{
+		DLLExportHooks();
+		HookCheckGLExtensions();
+		CheckUnsupported();
+
+		// stable so that if a name is listed twice the first one wins, as it would
+		// have when checking the lists in order
+		std::stable_sort(hooks.begin(), hooks.end());
+		std::stable_sort(unsupported.begin(), unsupported.end());
+	}
+
+	vector<GLHookEntry> hooks;
+	vector<GLHookEntry> unsupported;
+};
+
+// built on first use. Initialising a function-local static is thread-safe, so another
+// thread calling glXGetProcAddress at the same time waits rather than seeing half-built tables
+static const GLHookTables &GetHookTables()
+{
+	static GLHookTables tables;
+	return tables;
+}
+
+static const GLHookEntry *FindHook(const vector<GLHookEntry> &table, const char *func)
+{
+	vector<GLHookEntry>::const_iterator it = std::lower_bound(table.begin(), table.end(), GLHookEntry(func, NULL, NULL));
+
+	if(it != table.end() && !strcmp(it->name, func))
+		return &*it;
+
+	return NULL;
+}
+
 __attribute__ ((visibility ("default")))
 __GLXextFuncPtr glXGetProcAddress(const GLubyte *f)
 {
@@ -809,14 +859,20 @@ __GLXextFuncPtr glXGetProcAddress(const GLubyte *f)
 	if(realFunc == NULL)
 		return realFunc;
 	
-	DLLExportHooks();
-	HookCheckGLExtensions();
+	const GLHookTables &tables = GetHookTables();
+
+	const GLHookEntry *hook = FindHook(tables.hooks, func);
 
 	// at the moment the unsupported functions are all lowercase (as their name is generated from the
 	// typedef name).
-	string lowername = strlower(string(func));
+	if(hook == NULL)
+		hook = FindHook(tables.unsupported, strlower(string(func)).c_str());
 
-	CheckUnsupported();
+	if(hook)
+	{
+		*hook->real = (void *)realFunc;
+		return hook->hook;
+	}
 
 	// for any other function, if it's not a core or extension function we know about,
 	// just return NULL
@@ -0,0 +1,414 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2014 Crytek
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+// Standalone benchmark for the frame time overhead of idle draws, built with
+// 'make idle_bench'. Replays a synthetic frame - render passes of draws with
+// the usual uniform/texture/UBO churn in between and a compute pass writing
+// an SSBO and image - through a real WrappedOpenGL, on top of a fake GL whose
+// glGet* calls just read back a state table:
+//  - "native":  just the GL calls, straight to the fake GL
+//  - "per draw": the driver with every draw treated as if a binding changed,
+//               so GLRenderState::MarkDirty runs each time as it used to
+//  - "cached":  the driver as it is, see WrappedOpenGL::MarkDrawBindingsDirty
+// The fake glGet* calls are far cheaper than a real driver's, so the query
+// count per frame is printed too - multiply it by your driver's cost for a
+// better idea of what the per-draw version really costs.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common/common.h"
+#include "common/threading.h"
+#include "common/timing.h"
+#include "os/os_specific.h"
+#include "driver/gl/gl_driver.h"
+
+static const uint32_t NumFrames = 200;
+static const uint32_t PassesPerFrame = 20;
+static const uint32_t DrawsPerPass = 100;
+
+enum
+{
+	MaxImageUnits = 8,
+	MaxFeedbackBuffers = 4,
+	MaxAtomicBuffers = 8,
+	MaxStorageBuffers = 16,
+	MaxUniformBuffers = 16,
+	MaxTextureUnits = 16,
+	MaxColorAttachments = 8,
+
+	// colour attachments, then depth and stencil
+	NumAttachSlots = MaxColorAttachments+2,
+
+	NumUniformBuffers = 16,
+	NumSampledTextures = 32,
+};
+
+// friend of WrappedOpenGL, lets the per draw mode flag the bindings as changed
+// before every draw so the real MarkDrawBindingsDirty never skips MarkDirty.
+struct GLIdleBench
+{
+	static void DrawBindingsChanged(WrappedOpenGL *gl) { gl->DrawBindingsChanged(); }
+};
+
+// the fake GL behind the driver. Binds go into the state table and the queries
+// read it back.
+struct FakeGLState
+{
+	GLuint nextBuffer, nextTexture, nextFramebuffer, nextProgram;
+
+	GLuint drawFramebuffer;
+	GLuint activeTexture;
+
+	GLuint images[MaxImageUnits];
+	GLuint feedback[MaxFeedbackBuffers];
+	GLuint atomics[MaxAtomicBuffers];
+	GLuint storage[MaxStorageBuffers];
+	GLuint uniformBuffers[MaxUniformBuffers];
+	GLuint textures[MaxTextureUnits];
+	GLuint attachments[PassesPerFrame+1][NumAttachSlots];
+	GLuint uniforms[64];
+
+	volatile uint32_t sink;
+};
+
+static FakeGLState fake;
+static uint32_t queries = 0;
+
+static GLHookSet hooks;
+static WrappedOpenGL *driver = NULL;
+
+static GLuint *IndexedBinding(GLenum target, GLuint index)
+{
+	switch(target)
+	{
+		case eGL_IMAGE_BINDING_NAME: return &fake.images[index];
+		case eGL_TRANSFORM_FEEDBACK_BUFFER:
+		case eGL_TRANSFORM_FEEDBACK_BUFFER_BINDING: return &fake.feedback[index];
+		case eGL_ATOMIC_COUNTER_BUFFER:
+		case eGL_ATOMIC_COUNTER_BUFFER_BINDING: return &fake.atomics[index];
+		case eGL_SHADER_STORAGE_BUFFER:
+		case eGL_SHADER_STORAGE_BUFFER_BINDING: return &fake.storage[index];
+		case eGL_UNIFORM_BUFFER:
+		case eGL_UNIFORM_BUFFER_BINDING: return &fake.uniformBuffers[index];
+		default: break;
+	}
+
+	return NULL;
+}
+
+static uint32_t AttachSlot(GLenum attachment)
+{
+	if(attachment == eGL_DEPTH_ATTACHMENT) return MaxColorAttachments;
+	if(attachment == eGL_STENCIL_ATTACHMENT) return MaxColorAttachments+1;
+	return attachment - eGL_COLOR_ATTACHMENT0;
+}
+
+static void APIENTRY FakeGenBuffers(GLsizei n, GLuint *names) { for(GLsizei i=0; i < n; i++) names[i] = ++fake.nextBuffer; }
+static void APIENTRY FakeGenTextures(GLsizei n, GLuint *names) { for(GLsizei i=0; i < n; i++) names[i] = ++fake.nextTexture; }
+static void APIENTRY FakeGenFramebuffers(GLsizei n, GLuint *names) { for(GLsizei i=0; i < n; i++) names[i] = ++fake.nextFramebuffer; }
+static GLuint APIENTRY FakeCreateProgram() { return ++fake.nextProgram; }
+static void APIENTRY FakeUseProgram(GLuint program) {}
+
+static void APIENTRY FakeBindFramebuffer(GLenum target, GLuint framebuffer)
+{
+	if(target == eGL_DRAW_FRAMEBUFFER || target == eGL_FRAMEBUFFER)
+		fake.drawFramebuffer = framebuffer;
+}
+
+static void APIENTRY FakeFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+	fake.attachments[fake.drawFramebuffer][AttachSlot(attachment)] = texture;
+}
+
+static void APIENTRY FakeActiveTexture(GLenum texture) { fake.activeTexture = texture - eGL_TEXTURE0; }
+static void APIENTRY FakeBindTexture(GLenum target, GLuint texture) { fake.textures[fake.activeTexture] = texture; }
+static void APIENTRY FakeBindBufferBase(GLenum target, GLuint index, GLuint buffer) { *IndexedBinding(target, index) = buffer; }
+
+static void APIENTRY FakeBindImageTexture(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format)
+{
+	fake.images[unit] = texture;
+}
+
+static void APIENTRY FakeUniform1ui(GLint location, GLuint v0) { fake.uniforms[location] = v0; }
+static void APIENTRY FakeDrawArrays(GLenum mode, GLint first, GLsizei count) { fake.sink += count; }
+static void APIENTRY FakeDispatchCompute(GLuint x, GLuint y, GLuint z) { fake.sink += x*y*z; }
+
+static void APIENTRY FakeGetIntegerv(GLenum pname, GLint *data)
+{
+	queries++;
+
+	switch(pname)
+	{
+		case eGL_MAX_IMAGE_UNITS: *data = MaxImageUnits; break;
+		case eGL_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS: *data = MaxFeedbackBuffers; break;
+		case eGL_MAX_ATOMIC_COUNTER_BUFFER_BINDINGS: *data = MaxAtomicBuffers; break;
+		case eGL_MAX_SHADER_STORAGE_BUFFER_BINDINGS: *data = MaxStorageBuffers; break;
+		case eGL_MAX_COLOR_ATTACHMENTS: *data = MaxColorAttachments; break;
+		case eGL_DRAW_FRAMEBUFFER_BINDING: *data = (GLint)fake.drawFramebuffer; break;
+		default: *data = 0; break;
+	}
+}
+
+static void APIENTRY FakeGetIntegeri_v(GLenum target, GLuint index, GLint *data)
+{
+	queries++;
+
+	GLuint *binding = IndexedBinding(target, index);
+	*data = binding ? (GLint)*binding : 0;
+}
+
+static void APIENTRY FakeGetFramebufferAttachmentParameteriv(GLenum target, GLenum attachment, GLenum pname, GLint *params)
+{
+	queries++;
+
+	if(pname == eGL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE)
+		*params = eGL_TEXTURE;
+	else
+		*params = (GLint)fake.attachments[fake.drawFramebuffer][AttachSlot(attachment)];
+}
+
+static const GLubyte * APIENTRY FakeGetStringi(GLenum name, GLuint index) { return (const GLubyte *)""; }
+
+enum IdleMode
+{
+	eMode_Native = 0,
+	eMode_PerDraw,
+	eMode_Cached,
+	eMode_Count,
+};
+
+static const char *modeNames[] = { "native", "per draw", "cached" };
+
+// the objects the frame uses, all created through the driver so it has records for them
+struct FrameObjects
+{
+	GLuint program;
+	GLuint framebuffers[PassesPerFrame];
+	GLuint targets[PassesPerFrame][3];
+	GLuint textures[NumSampledTextures];
+	GLuint uniformBuffers[NumUniformBuffers];
+	GLuint storageBuffer;
+	GLuint storageImage;
+};
+
+static FrameObjects objs;
+
+static void CreateObjects()
+{
+	objs.program = driver->glCreateProgram();
+	driver->glUseProgram(objs.program);
+
+	driver->glGenTextures(NumSampledTextures, objs.textures);
+	driver->glGenTextures(1, &objs.storageImage);
+	driver->glGenBuffers(NumUniformBuffers, objs.uniformBuffers);
+	driver->glGenBuffers(1, &objs.storageBuffer);
+
+	for(uint32_t i=0; i < NumSampledTextures; i++)
+		driver->glBindTexture(eGL_TEXTURE_2D, objs.textures[i]);
+	driver->glBindTexture(eGL_TEXTURE_2D, objs.storageImage);
+	driver->glBindTexture(eGL_TEXTURE_2D, 0);
+
+	// framebuffers with two colour targets and depth
+	driver->glGenFramebuffers(PassesPerFrame, objs.framebuffers);
+
+	for(uint32_t p=0; p < PassesPerFrame; p++)
+	{
+		driver->glGenTextures(3, objs.targets[p]);
+
+		for(uint32_t i=0; i < 3; i++)
+			driver->glBindTexture(eGL_TEXTURE_2D, objs.targets[p][i]);
+		driver->glBindTexture(eGL_TEXTURE_2D, 0);
+
+		driver->glBindFramebuffer(eGL_DRAW_FRAMEBUFFER, objs.framebuffers[p]);
+		driver->glFramebufferTexture2D(eGL_DRAW_FRAMEBUFFER, eGL_COLOR_ATTACHMENT0, eGL_TEXTURE_2D, objs.targets[p][0], 0);
+		driver->glFramebufferTexture2D(eGL_DRAW_FRAMEBUFFER, eGL_COLOR_ATTACHMENT1, eGL_TEXTURE_2D, objs.targets[p][1], 0);
+		driver->glFramebufferTexture2D(eGL_DRAW_FRAMEBUFFER, eGL_DEPTH_ATTACHMENT, eGL_TEXTURE_2D, objs.targets[p][2], 0);
+	}
+
+	driver->glBindFramebuffer(eGL_DRAW_FRAMEBUFFER, 0);
+}
+
+// the calls the frame makes, either straight to the fake GL or through the driver
+struct IdleContext
+{
+	IdleMode mode;
+
+	void BindFramebuffer(GLuint name)
+	{
+		if(mode == eMode_Native)
+			hooks.glBindFramebuffer(eGL_DRAW_FRAMEBUFFER, name);
+		else
+			driver->glBindFramebuffer(eGL_DRAW_FRAMEBUFFER, name);
+	}
+
+	void BindBufferBase(GLenum target, GLuint index, GLuint name)
+	{
+		if(mode == eMode_Native)
+			hooks.glBindBufferBase(target, index, name);
+		else
+			driver->glBindBufferBase(target, index, name);
+	}
+
+	void BindTexture(GLuint unit, GLuint name)
+	{
+		if(mode == eMode_Native)
+		{
+			hooks.glActiveTexture(GLenum(eGL_TEXTURE0 + unit));
+			hooks.glBindTexture(eGL_TEXTURE_2D, name);
+		}
+		else
+		{
+			driver->glActiveTexture(GLenum(eGL_TEXTURE0 + unit));
+			driver->glBindTexture(eGL_TEXTURE_2D, name);
+		}
+	}
+
+	void BindImageTexture(GLuint unit, GLuint name)
+	{
+		if(mode == eMode_Native)
+			hooks.glBindImageTexture(unit, name, 0, GL_FALSE, 0, eGL_READ_WRITE, eGL_RGBA8);
+		else
+			driver->glBindImageTexture(unit, name, 0, GL_FALSE, 0, eGL_READ_WRITE, eGL_RGBA8);
+	}
+
+	void Uniform(GLint location, GLuint v)
+	{
+		if(mode == eMode_Native)
+			hooks.glUniform1ui(location, v);
+		else
+			driver->glUniform1ui(location, v);
+	}
+
+	void Draw(GLsizei count)
+	{
+		if(mode == eMode_PerDraw)
+			GLIdleBench::DrawBindingsChanged(driver);
+
+		if(mode == eMode_Native)
+			hooks.glDrawArrays(eGL_TRIANGLES, 0, count);
+		else
+			driver->glDrawArrays(eGL_TRIANGLES, 0, count);
+	}
+
+	void Dispatch(GLuint groups)
+	{
+		if(mode == eMode_PerDraw)
+			GLIdleBench::DrawBindingsChanged(driver);
+
+		if(mode == eMode_Native)
+			hooks.glDispatchCompute(groups, 1, 1);
+		else
+			driver->glDispatchCompute(groups, 1, 1);
+	}
+};
+
+static void ReplayFrame(IdleContext &ctx, uint32_t frame)
+{
+	for(uint32_t p=0; p < PassesPerFrame; p++)
+	{
+		ctx.BindFramebuffer(objs.framebuffers[p]);
+
+		for(uint32_t d=0; d < DrawsPerPass; d++)
+		{
+			ctx.BindBufferBase(eGL_UNIFORM_BUFFER, 0, objs.uniformBuffers[d % NumUniformBuffers]);
+			ctx.BindTexture(0, objs.textures[d % NumSampledTextures]);
+			ctx.BindTexture(1, objs.textures[(d+7) % NumSampledTextures]);
+
+			for(GLint u=0; u < 4; u++)
+				ctx.Uniform(u, frame + d);
+
+			ctx.Draw(3*(d+1));
+		}
+	}
+
+	// compute pass writing a storage buffer and an image
+	ctx.BindBufferBase(eGL_SHADER_STORAGE_BUFFER, 0, objs.storageBuffer);
+	ctx.BindImageTexture(0, objs.storageImage);
+	ctx.Dispatch(64);
+	ctx.BindBufferBase(eGL_SHADER_STORAGE_BUFFER, 0, 0);
+	ctx.BindImageTexture(0, 0);
+}
+
+int main(int argc, char **argv)
+{
+	hooks.glGenBuffers = &FakeGenBuffers;
+	hooks.glGenTextures = &FakeGenTextures;
+	hooks.glGenFramebuffers = &FakeGenFramebuffers;
+	hooks.glCreateProgram = &FakeCreateProgram;
+	hooks.glUseProgram = &FakeUseProgram;
+	hooks.glBindFramebuffer = &FakeBindFramebuffer;
+	hooks.glFramebufferTexture2D = &FakeFramebufferTexture2D;
+	hooks.glActiveTexture = &FakeActiveTexture;
+	hooks.glBindTexture = &FakeBindTexture;
+	hooks.glBindBufferBase = &FakeBindBufferBase;
+	hooks.glBindImageTexture = &FakeBindImageTexture;
+	hooks.glUniform1ui = &FakeUniform1ui;
+	hooks.glDrawArrays = &FakeDrawArrays;
+	hooks.glDispatchCompute = &FakeDispatchCompute;
+	hooks.glGetIntegerv = &FakeGetIntegerv;
+	hooks.glGetIntegeri_v = &FakeGetIntegeri_v;
+	hooks.glGetFramebufferAttachmentParameteriv = &FakeGetFramebufferAttachmentParameteriv;
+	hooks.glGetStringi = &FakeGetStringi;
+
+	driver = new WrappedOpenGL("", hooks);
+
+	// the context handle is never dereferenced, it only needs to be unique
+	GLWindowingData winData;
+	winData.SetCtx(&fake);
+	driver->ActivateContext(winData);
+
+	CreateObjects();
+
+	printf("%-10s %10s %12s %10s\n", "mode", "ms/frame", "us overhead", "queries");
+
+	double nativeMS = 0.0;
+
+	for(int m=0; m < eMode_Count; m++)
+	{
+		IdleContext ctx;
+		ctx.mode = (IdleMode)m;
+
+		queries = 0;
+
+		PerformanceTimer timer;
+
+		for(uint32_t f=0; f < NumFrames; f++)
+			ReplayFrame(ctx, f);
+
+		double ms = timer.GetMilliseconds()/double(NumFrames);
+
+		if(m == eMode_Native)
+			nativeMS = ms;
+
+		printf("%-10s %10.3f %12.1f %10u\n", modeNames[m], ms, (ms-nativeMS)*1000.0, queries/NumFrames);
+	}
+
+	driver->ActivateContext(GLWindowingData());
+
+	SAFE_DELETE(driver);
+
+	return 0;
+}
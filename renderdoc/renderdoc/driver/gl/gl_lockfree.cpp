@@ -0,0 +1,508 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2014 Crytek
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#include "gl_driver.h"
+
+#include <algorithm>
+
+// Functions the hooks may call without the hook lock while we're idle. When
+// not capturing a frame each of these only:
+//  - calls through to the real function
+//  - reads or writes the current context's ContextData
+//  - registers resources, looks up IDs/records or marks resources dirty through
+//    the resource manager, which has its own locks
+//  - reads or changes a shared GLResourceRecord with the record locked (AddChunk,
+//    Get/SetDataType) or through its atomic highTraffic flag
+//  - builds chunks on the thread's own serialiser, see SerialiseGenChunk
+//  - calls CoherentMapImplicitBarrier(), which never has work to do while lock-free
+// and calls EscalateLockFreeCall() before anything else: serialising through
+// m_pSerialiser, touching one of the driver's own maps or re-typing a resource.
+// Deleting resources or contexts must NOT be listed.
+// Nor can anything that blocks the CPU until the GPU catches up (glFinish,
+// glClientWaitSync, query results, readbacks to client memory): starting a
+// capture holds the hook lock while it waits for lock-free calls to finish, so
+// if the wait depends on another thread that's blocked on the lock, neither
+// would ever finish.
+// Aliases are hooked to the same wrapper so only the core names need be here.
+//
+// Keep sorted (plain strcmp order), it's binary searched.
+static const char *idleLockFreeFunctions[] = {
+	"glActiveShaderProgram",
+	"glActiveTexture",
+	"glBindBuffer",
+	"glBindImageTexture",
+	"glBindProgramPipeline",
+	"glBindRenderbuffer",
+	"glBindSampler",
+	"glBindTexture",
+	"glBindVertexArray",
+	"glBlendBarrierKHR",
+	"glBlendColor",
+	"glBlendEquation",
+	"glBlendEquationSeparate",
+	"glBlendEquationSeparatei",
+	"glBlendEquationi",
+	"glBlendFunc",
+	"glBlendFuncSeparate",
+	"glBlendFuncSeparatei",
+	"glBlendFunci",
+	"glBlitFramebuffer",
+	"glBlitNamedFramebuffer",
+	"glBufferSubData",
+	"glCheckFramebufferStatus",
+	"glCheckNamedFramebufferStatusEXT",
+	"glClampColor",
+	"glClear",
+	"glClearBufferData",
+	"glClearBufferSubData",
+	"glClearBufferfi",
+	"glClearBufferfv",
+	"glClearBufferiv",
+	"glClearBufferuiv",
+	"glClearColor",
+	"glClearDepth",
+	"glClearDepthf",
+	"glClearNamedBufferDataEXT",
+	"glClearNamedBufferSubData",
+	"glClearNamedBufferSubDataEXT",
+	"glClearNamedFramebufferfi",
+	"glClearNamedFramebufferfv",
+	"glClearNamedFramebufferiv",
+	"glClearNamedFramebufferuiv",
+	"glClearStencil",
+	"glClearTexImage",
+	"glClearTexSubImage",
+	"glClipControl",
+	"glColorMask",
+	"glColorMaski",
+	"glCompressedMultiTexSubImage1DEXT",
+	"glCompressedMultiTexSubImage2DEXT",
+	"glCompressedMultiTexSubImage3DEXT",
+	"glCompressedTexSubImage1D",
+	"glCompressedTexSubImage2D",
+	"glCompressedTexSubImage3D",
+	"glCompressedTextureSubImage1D",
+	"glCompressedTextureSubImage1DEXT",
+	"glCompressedTextureSubImage2D",
+	"glCompressedTextureSubImage2DEXT",
+	"glCompressedTextureSubImage3D",
+	"glCompressedTextureSubImage3DEXT",
+	"glCopyImageSubData",
+	"glCopyMultiTexSubImage1DEXT",
+	"glCopyMultiTexSubImage2DEXT",
+	"glCopyTexSubImage1D",
+	"glCopyTexSubImage2D",
+	"glCopyTextureSubImage1D",
+	"glCopyTextureSubImage1DEXT",
+	"glCopyTextureSubImage2D",
+	"glCopyTextureSubImage2DEXT",
+	"glCullFace",
+	"glDebugMessageControl",
+	"glDepthBoundsEXT",
+	"glDepthFunc",
+	"glDepthMask",
+	"glDepthRange",
+	"glDepthRangeArrayv",
+	"glDepthRangeIndexed",
+	"glDepthRangef",
+	"glDisable",
+	"glDisablei",
+	"glDispatchCompute",
+	"glDispatchComputeGroupSizeARB",
+	"glDispatchComputeIndirect",
+	"glDrawArrays",
+	"glDrawArraysIndirect",
+	"glDrawArraysInstanced",
+	"glDrawArraysInstancedBaseInstance",
+	"glDrawBuffer",
+	"glDrawBuffers",
+	"glDrawElements",
+	"glDrawElementsBaseVertex",
+	"glDrawElementsIndirect",
+	"glDrawElementsInstanced",
+	"glDrawElementsInstancedBaseInstance",
+	"glDrawElementsInstancedBaseVertex",
+	"glDrawElementsInstancedBaseVertexBaseInstance",
+	"glDrawRangeElements",
+	"glDrawRangeElementsBaseVertex",
+	"glDrawTransformFeedback",
+	"glDrawTransformFeedbackInstanced",
+	"glDrawTransformFeedbackStream",
+	"glDrawTransformFeedbackStreamInstanced",
+	"glEnable",
+	"glEnablei",
+	"glFlush",
+	"glFrontFace",
+	"glGenBuffers",
+	"glGenFramebuffers",
+	"glGenRenderbuffers",
+	"glGenSamplers",
+	"glGenTextures",
+	"glGenVertexArrays",
+	"glGenerateMipmap",
+	"glGenerateMultiTexMipmapEXT",
+	"glGenerateTextureMipmap",
+	"glGenerateTextureMipmapEXT",
+	"glGetActiveAtomicCounterBufferiv",
+	"glGetActiveAttrib",
+	"glGetActiveSubroutineName",
+	"glGetActiveSubroutineUniformName",
+	"glGetActiveSubroutineUniformiv",
+	"glGetActiveUniform",
+	"glGetActiveUniformBlockName",
+	"glGetActiveUniformBlockiv",
+	"glGetActiveUniformName",
+	"glGetActiveUniformsiv",
+	"glGetAttachedShaders",
+	"glGetAttribLocation",
+	"glGetBooleanIndexedvEXT",
+	"glGetBooleani_v",
+	"glGetBooleanv",
+	"glGetBufferParameteri64v",
+	"glGetBufferParameteriv",
+	"glGetDebugMessageLog",
+	"glGetDoubleIndexedvEXT",
+	"glGetDoublei_v",
+	"glGetDoublev",
+	"glGetError",
+	"glGetFloatIndexedvEXT",
+	"glGetFloati_v",
+	"glGetFloatv",
+	"glGetFragDataIndex",
+	"glGetFragDataLocation",
+	"glGetFramebufferAttachmentParameteriv",
+	"glGetFramebufferParameteriv",
+	"glGetGraphicsResetStatus",
+	"glGetInteger64i_v",
+	"glGetInteger64v",
+	"glGetIntegerIndexedvEXT",
+	"glGetIntegeri_v",
+	"glGetIntegerv",
+	"glGetInternalformati64v",
+	"glGetInternalformativ",
+	"glGetMultiTexLevelParameterfvEXT",
+	"glGetMultiTexLevelParameterivEXT",
+	"glGetMultiTexParameterIivEXT",
+	"glGetMultiTexParameterIuivEXT",
+	"glGetMultiTexParameterfvEXT",
+	"glGetMultiTexParameterivEXT",
+	"glGetMultisamplefv",
+	"glGetNamedBufferParameteri64v",
+	"glGetNamedBufferParameterivEXT",
+	"glGetNamedFramebufferAttachmentParameterivEXT",
+	"glGetNamedFramebufferParameterivEXT",
+	"glGetNamedProgramivEXT",
+	"glGetNamedRenderbufferParameterivEXT",
+	"glGetNamedStringARB",
+	"glGetNamedStringivARB",
+	"glGetObjectLabel",
+	"glGetObjectLabelEXT",
+	"glGetObjectPtrLabel",
+	"glGetPointerIndexedvEXT",
+	"glGetPointeri_vEXT",
+	"glGetPointerv",
+	"glGetProgramBinary",
+	"glGetProgramInfoLog",
+	"glGetProgramInterfaceiv",
+	"glGetProgramPipelineInfoLog",
+	"glGetProgramPipelineiv",
+	"glGetProgramResourceIndex",
+	"glGetProgramResourceLocation",
+	"glGetProgramResourceLocationIndex",
+	"glGetProgramResourceName",
+	"glGetProgramResourceiv",
+	"glGetProgramStageiv",
+	"glGetProgramiv",
+	"glGetQueryBufferObjecti64v",
+	"glGetQueryBufferObjectiv",
+	"glGetQueryBufferObjectui64v",
+	"glGetQueryBufferObjectuiv",
+	"glGetQueryIndexediv",
+	"glGetQueryiv",
+	"glGetRenderbufferParameteriv",
+	"glGetSamplerParameterIiv",
+	"glGetSamplerParameterIuiv",
+	"glGetSamplerParameterfv",
+	"glGetSamplerParameteriv",
+	"glGetShaderInfoLog",
+	"glGetShaderPrecisionFormat",
+	"glGetShaderSource",
+	"glGetShaderiv",
+	"glGetSubroutineIndex",
+	"glGetSubroutineUniformLocation",
+	"glGetSynciv",
+	"glGetTexLevelParameterfv",
+	"glGetTexLevelParameteriv",
+	"glGetTexParameterIiv",
+	"glGetTexParameterIuiv",
+	"glGetTexParameterfv",
+	"glGetTexParameteriv",
+	"glGetTextureLevelParameterfv",
+	"glGetTextureLevelParameterfvEXT",
+	"glGetTextureLevelParameteriv",
+	"glGetTextureLevelParameterivEXT",
+	"glGetTextureParameterIiv",
+	"glGetTextureParameterIivEXT",
+	"glGetTextureParameterIuiv",
+	"glGetTextureParameterIuivEXT",
+	"glGetTextureParameterfv",
+	"glGetTextureParameterfvEXT",
+	"glGetTextureParameteriv",
+	"glGetTextureParameterivEXT",
+	"glGetTransformFeedbackVarying",
+	"glGetTransformFeedbacki64_v",
+	"glGetTransformFeedbacki_v",
+	"glGetTransformFeedbackiv",
+	"glGetUniformBlockIndex",
+	"glGetUniformIndices",
+	"glGetUniformLocation",
+	"glGetUniformSubroutineuiv",
+	"glGetUniformdv",
+	"glGetUniformfv",
+	"glGetUniformiv",
+	"glGetUniformuiv",
+	"glGetVertexArrayIndexed64iv",
+	"glGetVertexArrayIndexediv",
+	"glGetVertexArrayIntegeri_vEXT",
+	"glGetVertexArrayIntegervEXT",
+	"glGetVertexArrayPointeri_vEXT",
+	"glGetVertexArrayPointervEXT",
+	"glGetVertexArrayiv",
+	"glGetVertexAttribIiv",
+	"glGetVertexAttribIuiv",
+	"glGetVertexAttribLdv",
+	"glGetVertexAttribPointerv",
+	"glGetVertexAttribdv",
+	"glGetVertexAttribfv",
+	"glGetVertexAttribiv",
+	"glGetnUniformdv",
+	"glGetnUniformfv",
+	"glGetnUniformiv",
+	"glGetnUniformuiv",
+	"glHint",
+	"glInsertEventMarkerEXT",
+	"glIsBuffer",
+	"glIsEnabled",
+	"glIsEnabledi",
+	"glIsFramebuffer",
+	"glIsNamedStringARB",
+	"glIsProgram",
+	"glIsProgramPipeline",
+	"glIsQuery",
+	"glIsRenderbuffer",
+	"glIsSampler",
+	"glIsShader",
+	"glIsSync",
+	"glIsTexture",
+	"glIsTransformFeedback",
+	"glIsVertexArray",
+	"glLineWidth",
+	"glLogicOp",
+	"glMinSampleShading",
+	"glMultiDrawArrays",
+	"glMultiDrawArraysIndirect",
+	"glMultiDrawArraysIndirectCountARB",
+	"glMultiDrawElements",
+	"glMultiDrawElementsBaseVertex",
+	"glMultiDrawElementsIndirect",
+	"glMultiDrawElementsIndirectCountARB",
+	"glMultiTexSubImage1DEXT",
+	"glMultiTexSubImage2DEXT",
+	"glMultiTexSubImage3DEXT",
+	"glNamedBufferSubData",
+	"glNamedBufferSubDataEXT",
+	"glPatchParameterfv",
+	"glPatchParameteri",
+	"glPauseTransformFeedback",
+	"glPixelStoref",
+	"glPixelStorei",
+	"glPointParameterf",
+	"glPointParameterfv",
+	"glPointParameteri",
+	"glPointParameteriv",
+	"glPointSize",
+	"glPolygonMode",
+	"glPolygonOffset",
+	"glPolygonOffsetClampEXT",
+	"glPopDebugGroup",
+	"glPopGroupMarkerEXT",
+	"glPrimitiveRestartIndex",
+	"glProgramBinary",
+	"glProgramUniform1d",
+	"glProgramUniform1dv",
+	"glProgramUniform1f",
+	"glProgramUniform1fv",
+	"glProgramUniform1i",
+	"glProgramUniform1iv",
+	"glProgramUniform1ui",
+	"glProgramUniform1uiv",
+	"glProgramUniform2d",
+	"glProgramUniform2dv",
+	"glProgramUniform2f",
+	"glProgramUniform2fv",
+	"glProgramUniform2i",
+	"glProgramUniform2iv",
+	"glProgramUniform2ui",
+	"glProgramUniform2uiv",
+	"glProgramUniform3d",
+	"glProgramUniform3dv",
+	"glProgramUniform3f",
+	"glProgramUniform3fv",
+	"glProgramUniform3i",
+	"glProgramUniform3iv",
+	"glProgramUniform3ui",
+	"glProgramUniform3uiv",
+	"glProgramUniform4d",
+	"glProgramUniform4dv",
+	"glProgramUniform4f",
+	"glProgramUniform4fv",
+	"glProgramUniform4i",
+	"glProgramUniform4iv",
+	"glProgramUniform4ui",
+	"glProgramUniform4uiv",
+	"glProgramUniformMatrix2dv",
+	"glProgramUniformMatrix2fv",
+	"glProgramUniformMatrix2x3dv",
+	"glProgramUniformMatrix2x3fv",
+	"glProgramUniformMatrix2x4dv",
+	"glProgramUniformMatrix2x4fv",
+	"glProgramUniformMatrix3dv",
+	"glProgramUniformMatrix3fv",
+	"glProgramUniformMatrix3x2dv",
+	"glProgramUniformMatrix3x2fv",
+	"glProgramUniformMatrix3x4dv",
+	"glProgramUniformMatrix3x4fv",
+	"glProgramUniformMatrix4dv",
+	"glProgramUniformMatrix4fv",
+	"glProgramUniformMatrix4x2dv",
+	"glProgramUniformMatrix4x2fv",
+	"glProgramUniformMatrix4x3dv",
+	"glProgramUniformMatrix4x3fv",
+	"glProvokingVertex",
+	"glPushDebugGroup",
+	"glPushGroupMarkerEXT",
+	"glQueryCounter",
+	"glRasterSamplesEXT",
+	"glReadBuffer",
+	"glReleaseShaderCompiler",
+	"glResumeTransformFeedback",
+	"glSampleCoverage",
+	"glSampleMaski",
+	"glScissor",
+	"glScissorArrayv",
+	"glScissorIndexed",
+	"glScissorIndexedv",
+	"glShaderBinary",
+	"glStencilFunc",
+	"glStencilFuncSeparate",
+	"glStencilMask",
+	"glStencilMaskSeparate",
+	"glStencilOp",
+	"glStencilOpSeparate",
+	"glStringMarkerGREMEDY",
+	"glTexSubImage1D",
+	"glTexSubImage2D",
+	"glTexSubImage3D",
+	"glTextureBarrier",
+	"glTextureSubImage1D",
+	"glTextureSubImage1DEXT",
+	"glTextureSubImage2D",
+	"glTextureSubImage2DEXT",
+	"glTextureSubImage3D",
+	"glTextureSubImage3DEXT",
+	"glUniform1d",
+	"glUniform1dv",
+	"glUniform1f",
+	"glUniform1fv",
+	"glUniform1i",
+	"glUniform1iv",
+	"glUniform1ui",
+	"glUniform1uiv",
+	"glUniform2d",
+	"glUniform2dv",
+	"glUniform2f",
+	"glUniform2fv",
+	"glUniform2i",
+	"glUniform2iv",
+	"glUniform2ui",
+	"glUniform2uiv",
+	"glUniform3d",
+	"glUniform3dv",
+	"glUniform3f",
+	"glUniform3fv",
+	"glUniform3i",
+	"glUniform3iv",
+	"glUniform3ui",
+	"glUniform3uiv",
+	"glUniform4d",
+	"glUniform4dv",
+	"glUniform4f",
+	"glUniform4fv",
+	"glUniform4i",
+	"glUniform4iv",
+	"glUniform4ui",
+	"glUniform4uiv",
+	"glUniformMatrix2dv",
+	"glUniformMatrix2fv",
+	"glUniformMatrix2x3dv",
+	"glUniformMatrix2x3fv",
+	"glUniformMatrix2x4dv",
+	"glUniformMatrix2x4fv",
+	"glUniformMatrix3dv",
+	"glUniformMatrix3fv",
+	"glUniformMatrix3x2dv",
+	"glUniformMatrix3x2fv",
+	"glUniformMatrix3x4dv",
+	"glUniformMatrix3x4fv",
+	"glUniformMatrix4dv",
+	"glUniformMatrix4fv",
+	"glUniformMatrix4x2dv",
+	"glUniformMatrix4x2fv",
+	"glUniformMatrix4x3dv",
+	"glUniformMatrix4x3fv",
+	"glUseProgram",
+	"glValidateProgram",
+	"glValidateProgramPipeline",
+	"glViewport",
+	"glViewportArrayv",
+	"glViewportIndexedf",
+	"glViewportIndexedfv",
+	"glWaitSync",
+};
+
+static bool strless(const char *a, const char *b)
+{
+	return strcmp(a, b) < 0;
+}
+
+bool WrappedOpenGL::IsIdleLockFree(const char *function)
+{
+	const char **begin = idleLockFreeFunctions;
+	const char **end = begin + ARRAY_COUNT(idleLockFreeFunctions);
+
+	const char **it = std::lower_bound(begin, end, function, strless);
+
+	return it != end && !strcmp(*it, function);
+}
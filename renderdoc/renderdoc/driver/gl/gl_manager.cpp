@@ -194,6 +194,17 @@ void Serialiser::Serialise(const char *name, TextureStateInitialData &el)
 	Serialise("texBufSize", el.texBufSize);
 }
 
+void GLResourceManager::MarkDirtyResource(ResourceId id)
+{
+	// resources only become clean again when deleted, and a context that has seen the
+	// same generation already marked this one. High traffic resources are marked on
+	// every update, so this keeps lock-free calls from all contending on m_Lock.
+	if(m_GL->CheckDirtyCache(id, m_CleanGeneration))
+		return;
+
+	ResourceManager::MarkDirtyResource(id);
+}
+
 void GLResourceManager::MarkVAOReferenced(GLResource res, FrameRefType ref)
 {
 	const GLHookSet &gl = m_GL->m_Real;
@@ -512,6 +523,11 @@ bool GLResourceManager::Prepare_InitialState(GLResource res)
 }
 
 void GLResourceManager::PrepareTextureInitialContents(ResourceId liveid, ResourceId origid, GLResource res)
+{
+	SetInitialContents(origid, CopyTextureContents(liveid, res));
+}
+
+GLResourceManager::InitialContentData GLResourceManager::CopyTextureContents(ResourceId liveid, GLResource res)
 {
 	const GLHookSet &gl = m_GL->m_Real;
 
@@ -525,7 +541,7 @@ void GLResourceManager::PrepareTextureInitialContents(ResourceId liveid, Resourc
 		// textures can get here as GL_NONE if they were created and dirtied (by setting lots of
 		// texture parameters) without ever having storage allocated (via glTexStorage or glTexImage).
 		// in that case, just ignore as we won't bother with the initial states.
-		SetInitialContents(origid, InitialContentData(GLResource(MakeNullResource), 0, (byte *)state));
+		return InitialContentData(GLResource(MakeNullResource), 0, (byte *)state);
 	}
 	else if(details.curType != eGL_TEXTURE_BUFFER)
 	{
@@ -781,7 +797,7 @@ void GLResourceManager::PrepareTextureInitialContents(ResourceId liveid, Resourc
 
 		gl.glTextureParameterivEXT(res.name, details.curType, eGL_TEXTURE_MAX_LEVEL, (GLint *)&state->maxLevel);
 
-		SetInitialContents(origid, InitialContentData(TextureRes(res.Context, tex), 0, (byte *)state));
+		return InitialContentData(TextureRes(res.Context, tex), 0, (byte *)state);
 	}
 	else
 	{
@@ -794,7 +810,7 @@ void GLResourceManager::PrepareTextureInitialContents(ResourceId liveid, Resourc
 		gl.glGetTextureLevelParameterivEXT(res.name, details.curType, 0, eGL_TEXTURE_BUFFER_OFFSET, (GLint *)&state->texBufOffs);
 		gl.glGetTextureLevelParameterivEXT(res.name, details.curType, 0, eGL_TEXTURE_BUFFER_SIZE, (GLint *)&state->texBufSize);
 
-		SetInitialContents(origid, InitialContentData(GLResource(MakeNullResource), 0, (byte *)state));
+		return InitialContentData(GLResource(MakeNullResource), 0, (byte *)state);
 	}
 }
 
@@ -803,6 +819,13 @@ bool GLResourceManager::Force_InitialState(GLResource res)
 	return false;
 }
 
+ResourceId GLResourceManager::Peek_InitialStateID(Serialiser *ser)
+{
+	ResourceId Id = ResourceId();
+	ser->Serialise("Id", Id);
+	return Id;
+}
+
 bool GLResourceManager::Serialise_InitialState(GLResource res)
 {
 	ResourceId Id = ResourceId();
@@ -1703,9 +1726,33 @@ void GLResourceManager::Apply_InitialState(GLResource live, InitialContentData i
 			}
 		}
 	}
+	else if(live.Namespace == eResBuffer)
+	{
+		// only replay checkpoints snapshot buffers
+		GLint length = (GLint)initial.num;
+
+		// the frame may have respecified the buffer with a different size since
+		GLint liveLength = 0;
+		gl.glGetNamedBufferParameterivEXT(live.name, eGL_BUFFER_SIZE, &liveLength);
+
+		if(liveLength != length)
+			gl.glNamedBufferDataEXT(live.name, (GLsizeiptr)length, NULL, eGL_DYNAMIC_DRAW);
+
+		gl.glNamedCopyBufferSubDataEXT(initial.resource.name, live.name, 0, 0, (GLsizeiptr)length);
+	}
 	else if(live.Namespace == eResProgram)
 	{
-		CopyProgramUniforms(gl, initial.resource.name, live.name);
+		if(initial.resource.name)
+		{
+			CopyProgramUniforms(gl, initial.resource.name, live.name);
+		}
+		else if(initial.blob)
+		{
+			// replay checkpoints keep the uniform values serialised rather than in a relinked copy
+			Serialiser ser((size_t)initial.num, initial.blob, false);
+
+			SerialiseProgramUniforms(gl, &ser, live.name, NULL, false);
+		}
 	}
 	else if(live.Namespace == eResFramebuffer)
 	{
@@ -1835,3 +1882,110 @@ void GLResourceManager::Apply_InitialState(GLResource live, InitialContentData i
 		RDCERR("Unexpected type of resource requiring initial state");
 	}
 }
+
+bool GLResourceManager::Snapshot_State(GLResource live, InitialContentData &data, uint64_t &byteSize)
+{
+	const GLHookSet &gl = m_GL->m_Real;
+
+	if(live.Namespace == eResBuffer)
+	{
+		GLint length = 0;
+		gl.glGetNamedBufferParameterivEXT(live.name, eGL_BUFFER_SIZE, &length);
+
+		if(length <= 0)
+			return false;
+
+		GLuint buf = 0;
+		gl.glGenBuffers(1, &buf);
+		gl.glNamedBufferDataEXT(buf, (GLsizeiptr)length, NULL, eGL_STATIC_COPY);
+		gl.glNamedCopyBufferSubDataEXT(live.name, buf, 0, 0, (GLsizeiptr)length);
+
+		data = InitialContentData(BufferRes(live.Context, buf), (uint32_t)length, NULL);
+		byteSize = (uint64_t)length;
+		return true;
+	}
+	else if(live.Namespace == eResTexture)
+	{
+		ResourceId liveid = GetID(live);
+		WrappedOpenGL::TextureData &details = m_GL->m_Textures[liveid];
+
+		// no storage has been allocated, nothing to keep
+		if(details.internalFormat == eGL_NONE)
+			return false;
+
+		data = CopyTextureContents(liveid, live);
+
+		byteSize = sizeof(TextureStateInitialData);
+
+		if(data.resource.name)
+		{
+			GLsizei d = details.curType == eGL_TEXTURE_3D ? details.depth : 1;
+
+			uint64_t size = 0;
+			if(IsCompressedFormat(details.internalFormat))
+				size = GetCompressedByteSize(details.width, details.height, d, details.internalFormat, 0);
+			else
+				size = GetByteSize(details.width, details.height, d, GetBaseFormat(details.internalFormat), GetDataType(details.internalFormat));
+
+			if(details.curType == eGL_TEXTURE_CUBE_MAP)
+				size *= 6;
+			else if(details.curType != eGL_TEXTURE_3D)
+				size *= RDCMAX(details.depth, 1);
+
+			size *= RDCMAX(details.samples, 1);
+
+			// roughly account for the mip chain
+			byteSize += size + size/3;
+		}
+
+		return true;
+	}
+	else if(live.Namespace == eResProgram)
+	{
+		Serialiser ser(NULL, Serialiser::WRITING, false);
+
+		SerialiseProgramUniforms(gl, &ser, live.name, NULL, true);
+
+		size_t length = (size_t)ser.GetSize();
+
+		byte *blob = Serialiser::AllocAlignedBuffer(length);
+		memcpy(blob, ser.GetRawPtr(0), length);
+
+		data = InitialContentData(GLResource(MakeNullResource), (uint32_t)length, blob);
+		byteSize = length;
+		return true;
+	}
+	else if(live.Namespace == eResFramebuffer || live.Namespace == eResFeedback || live.Namespace == eResVertexArray)
+	{
+		size_t length = sizeof(FramebufferInitialData);
+		if(live.Namespace == eResFeedback)
+			length = sizeof(FeedbackInitialData);
+		else if(live.Namespace == eResVertexArray)
+			length = sizeof(VAOInitialData);
+
+		byte *blob = Serialiser::AllocAlignedBuffer(length);
+		RDCEraseMem(blob, length);
+
+		Prepare_InitialState(live, blob);
+
+		data = InitialContentData(GLResource(MakeNullResource), 0, blob);
+		byteSize = length;
+		return true;
+	}
+
+	// renderbuffers aren't restored by initial contents either, and other objects have no
+	// contents the frame can change.
+	return false;
+}
+
+void GLResourceManager::Free_Snapshot(InitialContentData data)
+{
+	const GLHookSet &gl = m_GL->m_Real;
+
+	if(data.resource.Namespace == eResBuffer && data.resource.name)
+		gl.glDeleteBuffers(1, &data.resource.name);
+	else if(data.resource.Namespace == eResTexture && data.resource.name)
+		gl.glDeleteTextures(1, &data.resource.name);
+
+	Serialiser::FreeAlignedBuffer(data.blob);
+}
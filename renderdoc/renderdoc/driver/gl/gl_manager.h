@@ -35,7 +35,7 @@ class GLResourceManager : public ResourceManager<GLResource, GLResourceRecord>
 {
 	public: 
 		GLResourceManager(LogState state, Serialiser *ser, WrappedOpenGL *gl)
-			: ResourceManager(state, ser), m_GL(gl), m_SyncName(1)
+			: ResourceManager(state, ser), m_GL(gl), m_SyncName(1), m_CleanGeneration(0)
 		{
 		}
 		~GLResourceManager() {}
@@ -93,12 +93,16 @@ class GLResourceManager : public ResourceManager<GLResource, GLResourceRecord>
 		
 		inline void RemoveResourceRecord(ResourceId id)
 		{
-			for(auto it = m_GLResourceRecords.begin(); it != m_GLResourceRecords.end(); it++)
 			{
-				if(it->second->GetResourceID() == id)
+				SCOPED_WRITELOCK(m_NameLock);
+
+				for(auto it = m_GLResourceRecords.begin(); it != m_GLResourceRecords.end(); it++)
 				{
-					m_GLResourceRecords.erase(it);
-					break;
+					if(it->second->GetResourceID() == id)
+					{
+						m_GLResourceRecords.erase(it);
+						break;
+					}
 				}
 			}
 			
@@ -108,8 +112,10 @@ class GLResourceManager : public ResourceManager<GLResource, GLResourceRecord>
 		ResourceId RegisterResource(GLResource res)
 		{
 			ResourceId id = ResourceIDGen::GetNewUniqueID();
-			m_CurrentResourceIds[res] = id;
 			AddCurrentResource(id, res);
+
+			SCOPED_WRITELOCK(m_NameLock);
+			m_CurrentResourceIds[res] = id;
 			return id;
 		}
 
@@ -117,6 +123,7 @@ class GLResourceManager : public ResourceManager<GLResource, GLResourceRecord>
 
 		bool HasCurrentResource(GLResource res)
 		{
+			SCOPED_READLOCK(m_NameLock);
 			auto it = m_CurrentResourceIds.find(res);
 			if(it != m_CurrentResourceIds.end())
 				return true;
@@ -126,16 +133,27 @@ class GLResourceManager : public ResourceManager<GLResource, GLResourceRecord>
 
 		void UnregisterResource(GLResource res)
 		{
-			auto it = m_CurrentResourceIds.find(res);
-			if(it != m_CurrentResourceIds.end())
+			ResourceId id;
+
 			{
-				ReleaseCurrentResource(it->second);
-				m_CurrentResourceIds.erase(res);
+				SCOPED_WRITELOCK(m_NameLock);
+				auto it = m_CurrentResourceIds.find(res);
+				if(it == m_CurrentResourceIds.end())
+					return;
+
+				id = it->second;
+				m_CurrentResourceIds.erase(it);
 			}
+
+			ReleaseCurrentResource(id);
 		}
 
+		// the GL driver calls these lookups from idle lock-free calls on any number of
+		// threads, so the name maps have their own reader-writer lock rather than going
+		// through m_Lock. It's only ever held around the map access itself.
 		ResourceId GetID(GLResource res)
 		{
+			SCOPED_READLOCK(m_NameLock);
 			auto it = m_CurrentResourceIds.find(res);
 			if(it != m_CurrentResourceIds.end())
 				return it->second;
@@ -147,9 +165,12 @@ class GLResourceManager : public ResourceManager<GLResource, GLResourceRecord>
 			GLResourceRecord *ret = ResourceManager::AddResourceRecord(id);
 			GLResource res = GetCurrentResource(id);
 
-			m_GLResourceRecords[res] = ret;
+			// fill in the record before other threads can find it
 			ret->Resource = res;
 
+			SCOPED_WRITELOCK(m_NameLock);
+			m_GLResourceRecords[res] = ret;
+
 			return ret;
 		}
 		
@@ -164,9 +185,12 @@ class GLResourceManager : public ResourceManager<GLResource, GLResourceRecord>
 
 		GLResourceRecord *GetResourceRecord(GLResource res)
 		{
-			auto it = m_GLResourceRecords.find(res);
-			if(it != m_GLResourceRecords.end())
-				return it->second;
+			{
+				SCOPED_READLOCK(m_NameLock);
+				auto it = m_GLResourceRecords.find(res);
+				if(it != m_GLResourceRecords.end())
+					return it->second;
+			}
 
 			return ResourceManager::GetResourceRecord(GetID(res));
 		}
@@ -179,18 +203,23 @@ class GLResourceManager : public ResourceManager<GLResource, GLResourceRecord>
 			ResourceManager::MarkResourceFrameReferenced(GetID(res), refType);
 		}
 
-		using ResourceManager::MarkDirtyResource;
+		void MarkDirtyResource(ResourceId id);
 
 		void MarkDirtyResource(GLResource res)
 		{
-			return ResourceManager::MarkDirtyResource(GetID(res));
+			return MarkDirtyResource(GetID(res));
 		}
 
-		using ResourceManager::MarkCleanResource;
+		void MarkCleanResource(ResourceId id)
+		{
+			// invalidates the driver's per-context caches, see MarkDirtyResource
+			Atomic::Inc32(&m_CleanGeneration);
+			return ResourceManager::MarkCleanResource(id);
+		}
 		
 		void MarkCleanResource(GLResource res)
 		{
-			return ResourceManager::MarkCleanResource(GetID(res));
+			return MarkCleanResource(GetID(res));
 		}
 
 		void RegisterSync(void *ctx, GLsync sync, GLuint &name, ResourceId &id)
@@ -198,17 +227,20 @@ class GLResourceManager : public ResourceManager<GLResource, GLResourceRecord>
 			name = (GLuint)Atomic::Inc64(&m_SyncName);
 			id = RegisterResource(SyncRes(ctx, name));
 
+			SCOPED_LOCK(m_Lock);
 			m_SyncIDs[sync] = id;
 			m_CurrentSyncs[name] = sync;
 		}
 
 		GLsync GetSync(GLuint name)
 		{
+			SCOPED_LOCK(m_Lock);
 			return m_CurrentSyncs[name];
 		}
 
 		ResourceId GetSyncID(GLsync sync)
 		{
+			SCOPED_LOCK(m_Lock);
 			return m_SyncIDs[sync];
 		}
 		
@@ -233,10 +265,22 @@ class GLResourceManager : public ResourceManager<GLResource, GLResourceRecord>
 		bool Prepare_InitialState(GLResource res);
 
 		void PrepareTextureInitialContents(ResourceId liveid, ResourceId origid, GLResource res);
+		InitialContentData CopyTextureContents(ResourceId liveid, GLResource res);
 
 		void Create_InitialState(ResourceId id, GLResource live, bool hasData);
 		void Apply_InitialState(GLResource live, InitialContentData initial);
 
+		string GetResourceTypeName(GLResource live) { return ToStr::Get(live.Namespace); }
+
+		bool Snapshot_State(GLResource live, InitialContentData &data, uint64_t &byteSize);
+		void Free_Snapshot(InitialContentData data);
+
+		ResourceId Peek_InitialStateID(Serialiser *ser);
+
+		// guards m_GLResourceRecords and m_CurrentResourceIds. Nothing else is taken
+		// while it's held.
+		Threading::RWLock m_NameLock;
+
 		map<GLResource, GLResourceRecord*> m_GLResourceRecords;
 
 		map<GLResource, ResourceId> m_CurrentResourceIds;
@@ -247,6 +291,9 @@ class GLResourceManager : public ResourceManager<GLResource, GLResourceRecord>
 		map<GLuint, GLsync> m_CurrentSyncs;
 		volatile int64_t m_SyncName;
 
+		// bumped whenever anything is marked clean
+		volatile int32_t m_CleanGeneration;
+
 		WrappedOpenGL *m_GL;
 };
 
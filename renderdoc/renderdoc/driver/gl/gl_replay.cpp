@@ -40,12 +40,16 @@ GLReplay::GLReplay()
 	m_DebugCtx = NULL;
 
 	m_OutputWindowID = 1;
+
+	m_ReadbackTicket = 1;
 }
 
 void GLReplay::Shutdown()
 {
 	PreContextShutdownCounters();
 
+	FreeReadbacks();
+
 	DeleteDebugData();
 
 	DestroyOutputWindow(m_DebugID);
@@ -76,6 +80,22 @@ vector<FetchFrameRecord> GLReplay::GetFrameRecord()
 	return m_pDriver->GetFrameRecord();
 }
 
+LoadProfile GLReplay::GetLoadProfile()
+{
+	return m_pDriver->GetLoadProfile();
+}
+
+void GLReplay::SetReplayCheckpoints(uint32_t eventInterval, uint64_t memoryBudget)
+{
+	MakeCurrentReplayContext(&m_ReplayCtx);
+	m_pDriver->SetReplayCheckpoints(eventInterval, memoryBudget);
+}
+
+ReplayCheckpointStats GLReplay::GetReplayCheckpointStats()
+{
+	return m_pDriver->GetReplayCheckpointStats();
+}
+
 ResourceId GLReplay::GetLiveID(ResourceId id)
 {
 	return m_pDriver->GetResourceManager()->GetLiveID(id);
@@ -108,6 +128,50 @@ vector<ResourceId> GLReplay::GetBuffers()
 	return ret;
 }
 
+vector<ResourceId> GLReplay::GetPixelShaders()
+{
+	vector<ResourceId> ret;
+
+	for(auto it=m_pDriver->m_Shaders.begin(); it != m_pDriver->m_Shaders.end(); ++it)
+	{
+		// skip our own shaders that aren't from the log
+		if(it->second.type != eGL_FRAGMENT_SHADER ||
+		   m_pDriver->GetResourceManager()->GetOriginalID(it->first) == it->first) continue;
+
+		ret.push_back(it->first);
+	}
+
+	return ret;
+}
+
+vector<byte> GLReplay::GetShaderData(ResourceId id)
+{
+	vector<byte> ret;
+
+	auto it = m_pDriver->m_Shaders.find(id);
+	if(it == m_pDriver->m_Shaders.end())
+		return ret;
+
+	// GL has no bytecode, the sources as given to glShaderSource are the closest thing
+	const vector<string> &sources = it->second.sources;
+	for(size_t i=0; i < sources.size(); i++)
+		ret.insert(ret.end(), sources[i].begin(), sources[i].end());
+
+	return ret;
+}
+
+void GLReplay::SetIDRendering(bool active, ResourceId shaderId)
+{
+	// the passed shader is HLSL built for D3D11, GL uses its own fragment program
+	MakeCurrentReplayContext(&m_ReplayCtx);
+	m_pDriver->SetIDRendering(active);
+}
+
+void GLReplay::SetIDRenderingEvents(uint32_t frameID, uint32_t startEvent, uint32_t endEvent)
+{
+	m_pDriver->SetIDRenderEvents(frameID, startEvent, endEvent);
+}
+
 vector<ResourceId> GLReplay::GetTextures()
 {
 	vector<ResourceId> ret;
@@ -2395,6 +2459,331 @@ byte *GLReplay::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
 	return ret;
 }
 
+GLuint GLReplay::AllocReadbackPBO(uint32_t size, uint32_t &pboSize)
+{
+	const GLHookSet &gl = m_pDriver->GetHookset();
+
+	// recycle a previous PBO if it's big enough, to avoid reallocating storage
+	// for every resource in a bulk readback
+	for(size_t i=0; i < m_ReadbackPBOs.size(); i++)
+	{
+		if(m_ReadbackPBOs[i].second >= size)
+		{
+			GLuint pbo = m_ReadbackPBOs[i].first;
+			pboSize = m_ReadbackPBOs[i].second;
+			m_ReadbackPBOs.erase(m_ReadbackPBOs.begin()+i);
+			return pbo;
+		}
+	}
+
+	GLuint pbo = 0;
+	gl.glGenBuffers(1, &pbo);
+	gl.glBindBuffer(eGL_PIXEL_PACK_BUFFER, pbo);
+	gl.glBufferData(eGL_PIXEL_PACK_BUFFER, (GLsizeiptr)size, NULL, eGL_STREAM_READ);
+	gl.glBindBuffer(eGL_PIXEL_PACK_BUFFER, 0);
+
+	pboSize = size;
+	return pbo;
+}
+
+uint32_t GLReplay::SubmitReadback(PendingReadback &rb)
+{
+	const GLHookSet &gl = m_pDriver->GetHookset();
+
+	rb.fence = gl.glFenceSync(eGL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	uint32_t ticket = m_ReadbackTicket++;
+	m_Readbacks[ticket] = rb;
+
+	return ticket;
+}
+
+void GLReplay::ReleaseReadback(PendingReadback &rb)
+{
+	const GLHookSet &gl = m_pDriver->GetHookset();
+
+	if(rb.fence)
+		gl.glDeleteSync(rb.fence);
+
+	if(m_ReadbackPBOs.size() < MAX_READBACK_PBOS)
+		m_ReadbackPBOs.push_back(std::make_pair(rb.pbo, rb.pboSize));
+	else
+		gl.glDeleteBuffers(1, &rb.pbo);
+
+	rb.fence = NULL;
+	rb.pbo = 0;
+}
+
+uint32_t GLReplay::QueueBufferReadback(ResourceId buff, uint32_t offset, uint32_t len)
+{
+	auto it = m_pDriver->m_Buffers.find(buff);
+
+	if(it == m_pDriver->m_Buffers.end())
+	{
+		RDCWARN("Requesting readback for non-existant buffer %llu", buff);
+		return 0;
+	}
+
+	uint32_t bufsize = (uint32_t)it->second.size;
+
+	if(offset >= bufsize)
+		return 0;
+
+	// same clamping as GetBufferData
+	if(len == 0 || offset+len > bufsize)
+		len = bufsize-offset;
+
+	MakeCurrentReplayContext(m_DebugCtx);
+
+	const GLHookSet &gl = m_pDriver->GetHookset();
+
+	PendingReadback rb;
+	RDCEraseEl(rb);
+	rb.size = len;
+	rb.pbo = AllocReadbackPBO(len, rb.pboSize);
+
+	// bindings on the debug context are ours, so they're reset to 0 afterwards
+	// rather than queried and restored.
+	gl.glBindBuffer(eGL_COPY_READ_BUFFER, it->second.resource.name);
+	gl.glBindBuffer(eGL_COPY_WRITE_BUFFER, rb.pbo);
+
+	gl.glCopyBufferSubData(eGL_COPY_READ_BUFFER, eGL_COPY_WRITE_BUFFER, (GLintptr)offset, 0, (GLsizeiptr)len);
+
+	gl.glBindBuffer(eGL_COPY_READ_BUFFER, 0);
+	gl.glBindBuffer(eGL_COPY_WRITE_BUFFER, 0);
+
+	return SubmitReadback(rb);
+}
+
+uint32_t GLReplay::QueueTextureReadback(ResourceId tex, uint32_t arrayIdx, uint32_t mip)
+{
+	auto it = m_pDriver->m_Textures.find(tex);
+
+	if(it == m_pDriver->m_Textures.end())
+	{
+		RDCWARN("Requesting readback for non-existant texture %llu", tex);
+		return 0;
+	}
+
+	auto &texDetails = it->second;
+
+	GLenum texType = texDetails.curType;
+	GLuint texname = texDetails.resource.name;
+	GLenum intFormat = texDetails.internalFormat;
+
+	MakeCurrentReplayContext(m_DebugCtx);
+
+	const GLHookSet &gl = m_pDriver->GetHookset();
+
+	if(texType == eGL_TEXTURE_BUFFER)
+	{
+		GLuint bufName = 0;
+		gl.glGetTextureLevelParameterivEXT(texname, texType, 0, eGL_TEXTURE_BUFFER_DATA_STORE_BINDING, (GLint *)&bufName);
+		ResourceId id = m_pDriver->GetResourceManager()->GetID(BufferRes(m_pDriver->GetCtx(), bufName));
+
+		GLuint offs = 0, size = 0;
+		gl.glGetTextureLevelParameterivEXT(texname, texType, 0, eGL_TEXTURE_BUFFER_OFFSET, (GLint *)&offs);
+		gl.glGetTextureLevelParameterivEXT(texname, texType, 0, eGL_TEXTURE_BUFFER_SIZE, (GLint *)&size);
+
+		return QueueBufferReadback(id, offs, size);
+	}
+
+	// multisampled textures need a resolve or a copy to an array first
+	if(texDetails.samples > 1)
+		return 0;
+
+	PendingReadback rb;
+	RDCEraseEl(rb);
+	rb.texture = true;
+	rb.arrayIdx = arrayIdx;
+	rb.height = RDCMAX(1, texDetails.height>>mip);
+	rb.depth = RDCMAX(1, texDetails.depth>>mip);
+
+	GLsizei width = RDCMAX(1, texDetails.width>>mip);
+
+	if(texType == eGL_TEXTURE_2D_ARRAY ||
+		texType == eGL_TEXTURE_1D_ARRAY ||
+		texType == eGL_TEXTURE_CUBE_MAP_ARRAY)
+	{
+		// array size doesn't get mip'd down
+		rb.depth = texDetails.depth;
+		rb.array = true;
+
+		if(arrayIdx >= (uint32_t)rb.depth)
+			return 0;
+	}
+
+	GLenum target = texType;
+	if(texType == eGL_TEXTURE_CUBE_MAP)
+	{
+		GLenum targets[] = {
+			eGL_TEXTURE_CUBE_MAP_POSITIVE_X,
+			eGL_TEXTURE_CUBE_MAP_NEGATIVE_X,
+			eGL_TEXTURE_CUBE_MAP_POSITIVE_Y,
+			eGL_TEXTURE_CUBE_MAP_NEGATIVE_Y,
+			eGL_TEXTURE_CUBE_MAP_POSITIVE_Z,
+			eGL_TEXTURE_CUBE_MAP_NEGATIVE_Z,
+		};
+
+		if(arrayIdx >= ARRAY_COUNT(targets))
+			return 0;
+
+		target = targets[arrayIdx];
+		rb.depth = 1;
+	}
+
+	gl.glBindTexture(texType, texname);
+
+	GLenum fmt = eGL_NONE;
+	GLenum type = eGL_NONE;
+
+	if(IsCompressedFormat(intFormat))
+	{
+		GLuint compSize = 0;
+		gl.glGetTexLevelParameteriv(target, mip, eGL_TEXTURE_COMPRESSED_IMAGE_SIZE, (GLint *)&compSize);
+
+		rb.compressed = true;
+		rb.size = compSize;
+	}
+	else
+	{
+		fmt = GetBaseFormat(intFormat);
+		type = GetDataType(intFormat);
+
+		rb.size = (uint32_t)GetByteSize(width, rb.height, rb.depth, fmt, type);
+		rb.rowSize = GetByteSize(width, 1, 1, fmt, type);
+	}
+
+	if(rb.size == 0)
+	{
+		gl.glBindTexture(texType, 0);
+		return 0;
+	}
+
+	rb.pbo = AllocReadbackPBO(rb.size, rb.pboSize);
+
+	gl.glBindBuffer(eGL_PIXEL_PACK_BUFFER, rb.pbo);
+	gl.glPixelStorei(eGL_PACK_ALIGNMENT, 1);
+
+	// with a pack buffer bound the pointer is an offset into it, so this
+	// returns without waiting for the GPU
+	if(rb.compressed)
+		gl.glGetCompressedTexImage(target, (GLint)mip, NULL);
+	else
+		gl.glGetTexImage(target, (GLint)mip, fmt, type, NULL);
+
+	gl.glBindBuffer(eGL_PIXEL_PACK_BUFFER, 0);
+	gl.glBindTexture(texType, 0);
+
+	return SubmitReadback(rb);
+}
+
+bool GLReplay::FetchReadback(uint32_t ticket, bool wait, vector<byte> &data)
+{
+	auto it = m_Readbacks.find(ticket);
+
+	if(it == m_Readbacks.end())
+	{
+		RDCWARN("Unknown readback ticket %u", ticket);
+		return false;
+	}
+
+	PendingReadback &rb = it->second;
+
+	MakeCurrentReplayContext(m_DebugCtx);
+
+	const GLHookSet &gl = m_pDriver->GetHookset();
+
+	// flush on the first check so the fence is guaranteed to signal eventually
+	GLenum status = gl.glClientWaitSync(rb.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+
+	while(wait && status == eGL_TIMEOUT_EXPIRED)
+		status = gl.glClientWaitSync(rb.fence, 0, 1000000000ULL);
+
+	if(status == eGL_TIMEOUT_EXPIRED)
+		return false;
+
+	if(status == eGL_WAIT_FAILED)
+		RDCERR("Failed waiting on readback fence");
+
+	gl.glBindBuffer(eGL_COPY_READ_BUFFER, rb.pbo);
+
+	byte *src = (byte *)gl.glMapBufferRange(eGL_COPY_READ_BUFFER, 0, (GLsizeiptr)rb.size, GL_MAP_READ_BIT);
+
+	bool ret = (src != NULL);
+
+	if(src == NULL)
+	{
+		RDCERR("Failed to map readback buffer");
+	}
+	else if(!rb.texture || rb.compressed)
+	{
+		data.resize(rb.size);
+		memcpy(&data[0], src, rb.size);
+	}
+	else
+	{
+		// need to vertically flip the image to get conventional row ordering,
+		// and for arrays just extract the slice we're interested in.
+		size_t sliceSize = rb.rowSize*rb.height;
+		GLsizei numSlices = rb.depth;
+
+		if(rb.array)
+		{
+			src += sliceSize*rb.arrayIdx;
+			numSlices = 1;
+		}
+
+		data.resize(sliceSize*numSlices);
+
+		for(GLsizei d=0; d < numSlices; d++)
+		{
+			byte *srcRow = src + d*sliceSize + (rb.height-1)*rb.rowSize;
+			byte *dstRow = &data[d*sliceSize];
+
+			for(GLsizei i=0; i < rb.height; i++)
+			{
+				memcpy(dstRow, srcRow, rb.rowSize);
+
+				dstRow += rb.rowSize;
+				srcRow -= rb.rowSize;
+			}
+		}
+	}
+
+	if(src)
+		gl.glUnmapBuffer(eGL_COPY_READ_BUFFER);
+
+	gl.glBindBuffer(eGL_COPY_READ_BUFFER, 0);
+
+	ReleaseReadback(rb);
+	m_Readbacks.erase(it);
+
+	return ret;
+}
+
+void GLReplay::FreeReadbacks()
+{
+	if(m_Readbacks.empty() && m_ReadbackPBOs.empty())
+		return;
+
+	MakeCurrentReplayContext(m_DebugCtx);
+
+	const GLHookSet &gl = m_pDriver->GetHookset();
+
+	for(auto it=m_Readbacks.begin(); it != m_Readbacks.end(); ++it)
+	{
+		gl.glDeleteSync(it->second.fence);
+		gl.glDeleteBuffers(1, &it->second.pbo);
+	}
+
+	for(size_t i=0; i < m_ReadbackPBOs.size(); i++)
+		gl.glDeleteBuffers(1, &m_ReadbackPBOs[i].first);
+
+	m_Readbacks.clear();
+	m_ReadbackPBOs.clear();
+}
+
 void GLReplay::BuildCustomShader(string source, string entry, const uint32_t compileFlags, ShaderStageType type, ResourceId *id, string *errors)
 {
 	if(id == NULL || errors == NULL)
@@ -98,11 +98,11 @@ class GLReplay : public IReplayDriver
 		vector<ResourceId> GetTextures();
 		FetchTexture GetTexture(ResourceId id) { return m_CachedTextures[id]; }
 
-		vector<ResourceId> GetPixelShaders() { return vector < ResourceId >(); }
+		vector<ResourceId> GetPixelShaders();
 		ShaderReflection *GetShader(ResourceId id);
 	
 		/* Added by Stephan Richter | BEGIN */
-		vector<byte> GetShaderData(ResourceId id) { return vector<byte>(); }
+		vector<byte> GetShaderData(ResourceId id);
 		/* Added by Stephan Richter | END */
 		
 		vector<DebugMessage> GetDebugMessages();
@@ -110,6 +110,9 @@ class GLReplay : public IReplayDriver
 		vector<EventUsage> GetUsage(ResourceId id);
 
 		vector<FetchFrameRecord> GetFrameRecord();
+		LoadProfile GetLoadProfile();
+		void SetReplayCheckpoints(uint32_t eventInterval, uint64_t memoryBudget);
+		ReplayCheckpointStats GetReplayCheckpointStats();
 
 		void SavePipelineState();
 		D3D11PipelineState GetD3D11PipelineState() { return D3D11PipelineState(); }
@@ -121,8 +124,8 @@ class GLReplay : public IReplayDriver
 		void SetContextFilter(ResourceId id, uint32_t firstDefEv, uint32_t lastDefEv);
 		
 		/* Added by Stephan Richter | BEGIN */
-		void SetIDRendering(bool active, ResourceId shaderId) {}
-		void SetIDRenderingEvents(uint32_t frameID, uint32_t startEvent, uint32_t endEvent) {}
+		void SetIDRendering(bool active, ResourceId shaderId);
+		void SetIDRenderingEvents(uint32_t frameID, uint32_t startEvent, uint32_t endEvent);
 		/* Added by Stephan Richter | END */
 
 		void ReplayLog(uint32_t frameID, uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType);
@@ -151,6 +154,11 @@ class GLReplay : public IReplayDriver
 		
 		vector<byte> GetBufferData(ResourceId buff, uint32_t offset, uint32_t len);
 		byte *GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip, bool resolve, bool forceRGBA8unorm, float blackPoint, float whitePoint, size_t &dataSize);
+
+		uint32_t QueueBufferReadback(ResourceId buff, uint32_t offset, uint32_t len);
+		uint32_t QueueTextureReadback(ResourceId tex, uint32_t arrayIdx, uint32_t mip);
+		bool FetchReadback(uint32_t ticket, bool wait, vector<byte> &data);
+		void FreeReadbacks();
 		
 		void ReplaceResource(ResourceId from, ResourceId to);
 		void RemoveReplacement(ResourceId id);
@@ -349,6 +357,34 @@ class GLReplay : public IReplayDriver
 		// <frame,instance> -> data
 		map< pair<uint32_t,uint32_t>, GLPostVSData > m_PostVSData;
 
+		// in-flight batched readbacks, all on the debug context. Texture
+		// readbacks copy the whole mip (every slice for arrays) and are
+		// trimmed and flipped to match GetTextureData when fetched.
+		struct PendingReadback
+		{
+			GLuint pbo;
+			uint32_t pboSize;
+			GLsync fence;
+			uint32_t size;
+
+			bool texture;
+			bool compressed;
+			bool array;
+			uint32_t arrayIdx;
+			size_t rowSize;
+			GLsizei height, depth;
+		};
+
+		static const size_t MAX_READBACK_PBOS = 8;
+
+		uint32_t m_ReadbackTicket;
+		map<uint32_t, PendingReadback> m_Readbacks;
+		vector< pair<GLuint, uint32_t> > m_ReadbackPBOs;
+
+		GLuint AllocReadbackPBO(uint32_t size, uint32_t &pboSize);
+		uint32_t SubmitReadback(PendingReadback &rb);
+		void ReleaseReadback(PendingReadback &rb);
+
 		void InitDebugData();
 		void DeleteDebugData();
 		
@@ -1043,3 +1043,30 @@ bool IsProxyTarget(GLenum target)
 
 	return false;
 }
+
+template<>
+string ToStrHelper<false, GLNamespace>::Get(const GLNamespace &el)
+{
+	switch(el)
+	{
+		TOSTR_CASE_STRINGIZE(eResSpecial)
+		TOSTR_CASE_STRINGIZE(eResTexture)
+		TOSTR_CASE_STRINGIZE(eResSampler)
+		TOSTR_CASE_STRINGIZE(eResFramebuffer)
+		TOSTR_CASE_STRINGIZE(eResRenderbuffer)
+		TOSTR_CASE_STRINGIZE(eResBuffer)
+		TOSTR_CASE_STRINGIZE(eResVertexArray)
+		TOSTR_CASE_STRINGIZE(eResShader)
+		TOSTR_CASE_STRINGIZE(eResProgram)
+		TOSTR_CASE_STRINGIZE(eResProgramPipe)
+		TOSTR_CASE_STRINGIZE(eResFeedback)
+		TOSTR_CASE_STRINGIZE(eResQuery)
+		TOSTR_CASE_STRINGIZE(eResSync)
+		default: break;
+	}
+
+	char tostrBuf[256] = {0};
+	StringFormat::snprintf(tostrBuf, 255, "GLNamespace<%d>", el);
+
+	return tostrBuf;
+}
@@ -137,7 +137,8 @@ struct GLResourceRecord : public ResourceRecord
 	GLResourceRecord(ResourceId id) :
 	ResourceRecord(id, true),
 		datatype(eGL_NONE),
-		usage(eGL_NONE)
+		usage(eGL_NONE),
+		highTraffic(0)
 	{
 		RDCEraseEl(ShadowPtr);
 		RDCEraseEl(Map);
@@ -173,13 +174,32 @@ struct GLResourceRecord : public ResourceRecord
 	{
 #if !defined(RELEASE)
 		if(target == eGL_NONE) return; // target == GL_NONE means ARB_dsa, target was omitted
+		LockChunks();
 		if(datatype == eGL_NONE)
 			datatype = TextureBinding(target);
 		else
 			RDCASSERT(datatype == TextureBinding(target));
+		UnlockChunks();
 #endif
 	}
 
+	// idle lock-free calls read datatype without the hook lock, so it's only ever
+	// changed with the record locked and they read it through GetDataType().
+	void SetDataType(GLenum type)
+	{
+		LockChunks();
+		datatype = type;
+		UnlockChunks();
+	}
+
+	GLenum GetDataType()
+	{
+		LockChunks();
+		GLenum ret = datatype;
+		UnlockChunks();
+		return ret;
+	}
+
 	bool AlreadyDataType(GLenum target)
 	{
 		return datatype == TextureBinding(target);
@@ -188,6 +208,17 @@ struct GLResourceRecord : public ResourceRecord
 	GLenum datatype;
 	GLenum usage;
 
+	// set once the resource is updated often enough that we stop recording the updates
+	// and just treat it as dirty. Never cleared, and only set with the hook lock held,
+	// so idle lock-free calls can check it without taking any lock.
+	volatile int32_t highTraffic;
+
+	void MarkHighTraffic()
+	{
+		if(highTraffic == 0)
+			Atomic::Inc32(&highTraffic);
+	}
+
 	GLResource Resource;
 
 	void AllocShadowStorage(size_t size)
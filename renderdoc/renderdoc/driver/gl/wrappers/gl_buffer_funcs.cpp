@@ -62,6 +62,11 @@ void WrappedOpenGL::glGenBuffers(GLsizei n, GLuint *buffers)
 		{
 			Chunk *chunk = NULL;
 
+			if(InLockFreeCall())
+			{
+				chunk = SerialiseGenChunk(GEN_BUFFER, id);
+			}
+			else
 			{
 				SCOPED_SERIALISE_CONTEXT(GEN_BUFFER);
 				Serialise_glGenBuffers(1, buffers+i);
@@ -146,7 +151,7 @@ bool WrappedOpenGL::Serialise_glBindBuffer(GLenum target, GLuint buffer)
 	if(m_State >= WRITING)
 	{
 		if(Id != ResourceId())
-			GetResourceManager()->GetResourceRecord(Id)->datatype = Target;
+			GetResourceManager()->GetResourceRecord(Id)->SetDataType(Target);
 	}
 	else if(m_State < WRITING)
 	{
@@ -232,8 +237,10 @@ void WrappedOpenGL::glBindBuffer(GLenum target, GLuint buffer)
 		GLResourceRecord *r = cd.m_BufferRecord[idx] = GetResourceManager()->GetResourceRecord(BufferRes(GetCtx(), buffer));
 
 		// it's legal to re-type buffers, generate another BindBuffer chunk to rename
-		if(r->datatype != target)
+		if(r->GetDataType() != target)
 		{
+			EscalateLockFreeCall();
+
 			Chunk *chunk = NULL;
 			
 			r->LockChunks();
@@ -729,9 +736,11 @@ void WrappedOpenGL::glNamedBufferSubDataEXT(GLuint buffer, GLintptr offset, GLsi
 		GLResourceRecord *record = GetResourceManager()->GetResourceRecord(BufferRes(GetCtx(), buffer));
 		RDCASSERT(record);
 		
-		if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State != WRITING_CAPFRAME)
+		if(record->highTraffic && m_State != WRITING_CAPFRAME)
 			return;
 
+		EscalateLockFreeCall();
+
 		SCOPED_SERIALISE_CONTEXT(BUFFERSUBDATA);
 		Serialise_glNamedBufferSubDataEXT(buffer, offset, size, data);
 
@@ -750,7 +759,7 @@ void WrappedOpenGL::glNamedBufferSubDataEXT(GLuint buffer, GLintptr offset, GLsi
 				
 			if(record->UpdateCount > 10)
 			{
-				m_HighTrafficResources.insert(record->GetResourceID());
+				record->MarkHighTraffic();
 				GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 			}
 		}
@@ -774,9 +783,11 @@ void WrappedOpenGL::glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr s
 
 		GLResource res = record->Resource;
 		
-		if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State != WRITING_CAPFRAME)
+		if(record->highTraffic && m_State != WRITING_CAPFRAME)
 			return;
 
+		EscalateLockFreeCall();
+
 		SCOPED_SERIALISE_CONTEXT(BUFFERSUBDATA);
 		Serialise_glNamedBufferSubDataEXT(res.name, offset, size, data);
 
@@ -795,7 +806,7 @@ void WrappedOpenGL::glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr s
 				
 			if(record->UpdateCount > 10)
 			{
-				m_HighTrafficResources.insert(record->GetResourceID());
+				record->MarkHighTraffic();
 				GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 			}
 		}
@@ -832,12 +843,12 @@ void WrappedOpenGL::glNamedCopyBufferSubDataEXT(GLuint readBuffer, GLuint writeB
 		GLResourceRecord *writerecord = GetResourceManager()->GetResourceRecord(BufferRes(GetCtx(), writeBuffer));
 		RDCASSERT(readrecord && writerecord);
 
-		if(m_HighTrafficResources.find(writerecord->GetResourceID()) != m_HighTrafficResources.end() && m_State != WRITING_CAPFRAME)
+		if(writerecord->highTraffic && m_State != WRITING_CAPFRAME)
 			return;
 
 		if(GetResourceManager()->IsResourceDirty(readrecord->GetResourceID()) && m_State != WRITING_CAPFRAME)
 		{
-			m_HighTrafficResources.insert(writerecord->GetResourceID());
+			writerecord->MarkHighTraffic();
 			GetResourceManager()->MarkDirtyResource(writerecord->GetResourceID());
 			return;
 		}
@@ -861,7 +872,7 @@ void WrappedOpenGL::glNamedCopyBufferSubDataEXT(GLuint readBuffer, GLuint writeB
 
 			if(writerecord->UpdateCount > 60)
 			{
-				m_HighTrafficResources.insert(writerecord->GetResourceID());
+				writerecord->MarkHighTraffic();
 				GetResourceManager()->MarkDirtyResource(writerecord->GetResourceID());
 			}
 		}
@@ -885,12 +896,12 @@ void WrappedOpenGL::glCopyBufferSubData(GLenum readTarget, GLenum writeTarget, G
 		GLResourceRecord *writerecord = GetCtxData().m_BufferRecord[BufferIdx(writeTarget)];
 		RDCASSERT(readrecord && writerecord);
 
-		if(m_HighTrafficResources.find(writerecord->GetResourceID()) != m_HighTrafficResources.end() && m_State != WRITING_CAPFRAME)
+		if(writerecord->highTraffic && m_State != WRITING_CAPFRAME)
 			return;
 
 		if(GetResourceManager()->IsResourceDirty(readrecord->GetResourceID()) && m_State != WRITING_CAPFRAME)
 		{
-			m_HighTrafficResources.insert(writerecord->GetResourceID());
+			writerecord->MarkHighTraffic();
 			GetResourceManager()->MarkDirtyResource(writerecord->GetResourceID());
 			return;
 		}
@@ -916,7 +927,7 @@ void WrappedOpenGL::glCopyBufferSubData(GLenum readTarget, GLenum writeTarget, G
 
 			if(writerecord->UpdateCount > 60)
 			{
-				m_HighTrafficResources.insert(writerecord->GetResourceID());
+				writerecord->MarkHighTraffic();
 				GetResourceManager()->MarkDirtyResource(writerecord->GetResourceID());
 			}
 		}
@@ -1024,6 +1035,10 @@ void WrappedOpenGL::glBindBufferBase(GLenum target, GLuint index, GLuint buffer)
 	}
 
 	m_Real.glBindBufferBase(target, index, buffer);
+
+	// uniform buffers aren't written by draws, see GLRenderState::MarkDirty
+	if(target != eGL_UNIFORM_BUFFER)
+		DrawBindingsChanged();
 }
 
 bool WrappedOpenGL::Serialise_glBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
@@ -1129,6 +1144,10 @@ void WrappedOpenGL::glBindBufferRange(GLenum target, GLuint index, GLuint buffer
 	}
 
 	m_Real.glBindBufferRange(target, index, buffer, offset, size);
+
+	// uniform buffers aren't written by draws, see GLRenderState::MarkDirty
+	if(target != eGL_UNIFORM_BUFFER)
+		DrawBindingsChanged();
 }
 
 bool WrappedOpenGL::Serialise_glBindBuffersBase(GLenum target, GLuint first, GLsizei count, const GLuint *buffers)
@@ -1166,6 +1185,10 @@ bool WrappedOpenGL::Serialise_glBindBuffersBase(GLenum target, GLuint first, GLs
 void WrappedOpenGL::glBindBuffersBase(GLenum target, GLuint first, GLsizei count, const GLuint *buffers)
 {
 	m_Real.glBindBuffersBase(target, first, count, buffers);
+
+	// uniform buffers aren't written by draws, see GLRenderState::MarkDirty
+	if(target != eGL_UNIFORM_BUFFER)
+		DrawBindingsChanged();
 	
 	ContextData &cd = GetCtxData();
 
@@ -1311,6 +1334,10 @@ void WrappedOpenGL::glBindBuffersRange(GLenum target, GLuint first, GLsizei coun
 {
 	m_Real.glBindBuffersRange(target, first, count, buffers, offsets, sizes);
 
+	// uniform buffers aren't written by draws, see GLRenderState::MarkDirty
+	if(target != eGL_UNIFORM_BUFFER)
+		DrawBindingsChanged();
+
 	ContextData &cd = GetCtxData();
 
 	if(m_State >= WRITING && buffers && count > 0)
@@ -1647,7 +1674,7 @@ void *WrappedOpenGL::glMapNamedBufferRangeEXT(GLuint buffer, GLintptr offset, GL
 		bool directMap = false;
 
 		// first check if we've already given up on these buffers
-		if(m_State != WRITING_CAPFRAME && m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end())
+		if(m_State != WRITING_CAPFRAME && record->highTraffic)
 			directMap = true;
 		
 		if(!directMap && m_State != WRITING_CAPFRAME && GetResourceManager()->IsResourceDirty(record->GetResourceID()))
@@ -1666,7 +1693,7 @@ void *WrappedOpenGL::glMapNamedBufferRangeEXT(GLuint buffer, GLintptr offset, GL
 
 		if(directMap)
 		{
-			m_HighTrafficResources.insert(record->GetResourceID());
+			record->MarkHighTraffic();
 			GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 		}
 
@@ -1681,7 +1708,7 @@ void *WrappedOpenGL::glMapNamedBufferRangeEXT(GLuint buffer, GLintptr offset, GL
 			Atomic::Inc64(&record->Map.persistentMaps);
 			m_PersistentMaps.insert(record);
 			if(record->Map.access & GL_MAP_COHERENT_BIT)
-				m_CoherentMaps.insert(record);
+				AddCoherentMap(record);
 		}
 
 		// if we're doing a direct map, pass onto GL and return
@@ -1794,7 +1821,7 @@ void *WrappedOpenGL::glMapNamedBufferRangeEXT(GLuint buffer, GLintptr offset, GL
 				// mark as high-traffic if we update it often enough
 				if(record->UpdateCount > 60)
 				{
-					m_HighTrafficResources.insert(record->GetResourceID());
+					record->MarkHighTraffic();
 					GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 				}
 			}
@@ -1897,6 +1924,12 @@ bool WrappedOpenGL::Serialise_glUnmapNamedBufferEXT(GLuint buffer)
 	size_t diffStart = 0;
 	size_t diffEnd = (size_t)len;
 
+	// when the app wrote to several separate parts of the buffer, only those
+	// ranges are serialised, packed together one after the other. Otherwise
+	// this is empty and the data covers all of [diffStart, diffEnd)
+	vector<DiffRange> ranges;
+	vector<byte> packed;
+
 	if(m_State == WRITING_CAPFRAME &&
 		// don't bother checking diff range for tiny buffers
 		len > 512 &&
@@ -1907,17 +1940,35 @@ bool WrappedOpenGL::Serialise_glUnmapNamedBufferEXT(GLuint buffer)
 		// similarly for invalidate maps, we want to update the whole buffer
 		!record->Map.invalidate) 
 	{
-		bool found = FindDiffRange(record->Map.ptr, record->GetShadowPtr(1)+offs, (size_t)len, diffStart, diffEnd);
-		if(found)
+		FindDiffRanges(record->Map.ptr, record->GetShadowPtr(1)+offs, (size_t)len, MapDiffMergeGap, ranges);
+		if(!ranges.empty())
 		{
+			diffStart = ranges.front().start;
+			diffEnd = ranges.back().end;
+
+			size_t written = 0;
+			for(size_t i=0; i < ranges.size(); i++)
+				written += ranges[i].end - ranges[i].start;
+
 			static size_t saved = 0;
 
-			saved += (size_t)len - (diffEnd-diffStart);
+			saved += (size_t)len - written;
 
-			RDCDEBUG("Mapped resource size %u, difference: %u -> %u. Total bytes saved so far: %u",
-				(uint32_t)len, (uint32_t)diffStart, (uint32_t)diffEnd, (uint32_t)saved);
+			RDCDEBUG("Mapped resource size %u, difference: %u -> %u in %u ranges. Total bytes saved so far: %u",
+				(uint32_t)len, (uint32_t)diffStart, (uint32_t)diffEnd, (uint32_t)ranges.size(), (uint32_t)saved);
 
-			len = diffEnd-diffStart;
+			if(ranges.size() > 1)
+			{
+				packed.reserve(written);
+				for(size_t i=0; i < ranges.size(); i++)
+					packed.insert(packed.end(), record->Map.ptr+ranges[i].start, record->Map.ptr+ranges[i].end);
+			}
+			else
+			{
+				ranges.clear();
+			}
+
+			len = written;
 		}
 		else
 		{
@@ -1942,7 +1993,33 @@ bool WrappedOpenGL::Serialise_glUnmapNamedBufferEXT(GLuint buffer)
 	SERIALISE_ELEMENT(uint32_t, DiffStart, (uint32_t)diffStart);
 	SERIALISE_ELEMENT(uint32_t, DiffEnd, (uint32_t)diffEnd);
 
-	SERIALISE_ELEMENT_BUF(byte *, data, record->Map.ptr+diffStart, (size_t)len);
+	{
+		uint32_t numRanges = (uint32_t)ranges.size();
+		m_pSerialiser->Serialise("NumRanges", numRanges);
+
+		if(m_State < WRITING)
+			ranges.resize(numRanges);
+
+		for(uint32_t i=0; i < numRanges; i++)
+		{
+			uint32_t rangeStart = (uint32_t)ranges[i].start;
+			uint32_t rangeEnd = (uint32_t)ranges[i].end;
+
+			m_pSerialiser->Serialise("RangeStart", rangeStart);
+			m_pSerialiser->Serialise("RangeEnd", rangeEnd);
+
+			ranges[i].start = rangeStart;
+			ranges[i].end = rangeEnd;
+		}
+	}
+
+	if(ranges.empty())
+	{
+		DiffRange whole = { DiffStart, DiffEnd };
+		ranges.push_back(whole);
+	}
+
+	SERIALISE_ELEMENT_BUF(byte *, data, packed.empty() ? record->Map.ptr+diffStart : &packed[0], (size_t)len);
 
 	if(m_State < WRITING)
 	{
@@ -1963,8 +2040,16 @@ bool WrappedOpenGL::Serialise_glUnmapNamedBufferEXT(GLuint buffer)
 		}
 		else
 		{
-			void *ptr = m_Real.glMapNamedBufferRangeEXT(buffer, (GLintptr)(offs+DiffStart), GLsizeiptr(DiffEnd-DiffStart), GL_MAP_WRITE_BIT);
-			memcpy(ptr, data, size_t(DiffEnd-DiffStart));
+			// map the whole span once, and copy each range out of the packed data
+			byte *ptr = (byte *)m_Real.glMapNamedBufferRangeEXT(buffer, (GLintptr)(offs+DiffStart), GLsizeiptr(DiffEnd-DiffStart), GL_MAP_WRITE_BIT);
+
+			size_t packedOffs = 0;
+			for(size_t i=0; i < ranges.size(); i++)
+			{
+				memcpy(ptr + ranges[i].start - DiffStart, data + packedOffs, ranges[i].end - ranges[i].start);
+				packedOffs += ranges[i].end - ranges[i].start;
+			}
+
 			m_Real.glUnmapNamedBufferEXT(buffer);
 		}
 	}
@@ -2062,7 +2147,7 @@ GLboolean WrappedOpenGL::glUnmapNamedBufferEXT(GLuint buffer)
 			{
 				m_PersistentMaps.erase(record);
 				if(record->Map.access & GL_MAP_COHERENT_BIT)
-					m_CoherentMaps.erase(record);
+					RemoveCoherentMap(record);
 			}
 		}
 
@@ -2256,10 +2341,13 @@ void WrappedOpenGL::PersistentMapMemoryBarrier(const set<GLResourceRecord *> &ma
 
 		RDCASSERT(record && record->Map.persistentPtr);
 		
-		size_t diffStart = 0, diffEnd = 0;
-		bool found = FindDiffRange(record->GetShadowPtr(0), record->GetShadowPtr(1), (size_t)record->Length, diffStart, diffEnd);
-		if(found)
+		vector<DiffRange> ranges;
+		FindDiffRanges(record->GetShadowPtr(0), record->GetShadowPtr(1), (size_t)record->Length, MapDiffMergeGap, ranges);
+
+		for(size_t i=0; i < ranges.size(); i++)
 		{
+			size_t diffStart = ranges[i].start, diffEnd = ranges[i].end;
+
 			// update the modified region in the 'comparison' shadow buffer for next check
 			memcpy(record->GetShadowPtr(1) + diffStart, record->GetShadowPtr(0) + diffStart, diffEnd - diffStart);
 
@@ -2392,6 +2480,8 @@ void WrappedOpenGL::glDeleteTransformFeedbacks(GLsizei n, const GLuint *ids)
 	}
 	
 	m_Real.glDeleteTransformFeedbacks(n, ids);
+
+	ResourcesDeleted();
 }
 
 bool WrappedOpenGL::Serialise_glTransformFeedbackBufferBase(GLuint xfb, GLuint index, GLuint buffer)
@@ -2421,6 +2511,8 @@ void WrappedOpenGL::glTransformFeedbackBufferBase(GLuint xfb, GLuint index, GLui
 {
 	m_Real.glTransformFeedbackBufferBase(xfb, index, buffer);
 
+	DrawBindingsChanged();
+
 	if(m_State >= WRITING)
 	{
 		SCOPED_SERIALISE_CONTEXT(FEEDBACK_BUFFER_BASE);
@@ -2472,6 +2564,8 @@ void WrappedOpenGL::glTransformFeedbackBufferRange(GLuint xfb, GLuint index, GLu
 {
 	m_Real.glTransformFeedbackBufferRange(xfb, index, buffer, offset, size);
 
+	DrawBindingsChanged();
+
 	if(m_State >= WRITING)
 	{
 		SCOPED_SERIALISE_CONTEXT(FEEDBACK_BUFFER_RANGE);
@@ -2514,6 +2608,8 @@ void WrappedOpenGL::glBindTransformFeedback(GLenum target, GLuint id)
 {
 	m_Real.glBindTransformFeedback(target, id);
 
+	DrawBindingsChanged();
+
 	GLResourceRecord *record = NULL;
 
 	if(m_State >= WRITING)
@@ -3492,6 +3588,11 @@ void WrappedOpenGL::glGenVertexArrays(GLsizei n, GLuint *arrays)
 		{
 			Chunk *chunk = NULL;
 
+			if(InLockFreeCall())
+			{
+				chunk = SerialiseGenChunk(GEN_VERTEXARRAY, id);
+			}
+			else
 			{
 				SCOPED_SERIALISE_CONTEXT(GEN_VERTEXARRAY);
 				Serialise_glGenVertexArrays(1, arrays+i);
@@ -3967,7 +4068,7 @@ void WrappedOpenGL::glDeleteBuffers(GLsizei n, const GLuint *buffers)
 				{
 					m_PersistentMaps.erase(record);
 					if(record->Map.access & GL_MAP_COHERENT_BIT)
-						m_CoherentMaps.erase(record);
+						RemoveCoherentMap(record);
 
 					m_Real.glUnmapNamedBufferEXT(res.name);
 				}
@@ -3984,6 +4085,8 @@ void WrappedOpenGL::glDeleteBuffers(GLsizei n, const GLuint *buffers)
 	}
 	
 	m_Real.glDeleteBuffers(n, buffers);
+
+	ResourcesDeleted();
 }
 
 void WrappedOpenGL::glDeleteVertexArrays(GLsizei n, const GLuint *arrays)
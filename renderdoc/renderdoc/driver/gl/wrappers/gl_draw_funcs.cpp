@@ -92,8 +92,7 @@ void WrappedOpenGL::glDispatchCompute(GLuint num_groups_x, GLuint num_groups_y,
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -182,8 +181,7 @@ void WrappedOpenGL::glDispatchComputeGroupSizeARB(GLuint num_groups_x, GLuint nu
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -244,8 +242,7 @@ void WrappedOpenGL::glDispatchComputeIndirect(GLintptr indirect)
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -345,7 +342,9 @@ bool WrappedOpenGL::Serialise_glDrawTransformFeedback(GLenum mode, GLuint id)
 
 	if(m_State <= EXECUTING)
 	{
+		bool idDraw = SetupIDDraw();
 		m_Real.glDrawTransformFeedback(Mode, fid == ResourceId() ? 0 : GetResourceManager()->GetLiveResource(fid).name);
+		if(idDraw) FinishIDDraw();
 	}
 	
 	const string desc = m_pSerialiser->GetDebugStr();
@@ -396,8 +395,7 @@ void WrappedOpenGL::glDrawTransformFeedback(GLenum mode, GLuint id)
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -409,7 +407,9 @@ bool WrappedOpenGL::Serialise_glDrawTransformFeedbackInstanced(GLenum mode, GLui
 
 	if(m_State <= EXECUTING)
 	{
+		bool idDraw = SetupIDDraw();
 		m_Real.glDrawTransformFeedbackInstanced(Mode, fid == ResourceId() ? 0 : GetResourceManager()->GetLiveResource(fid).name, Count);
+		if(idDraw) FinishIDDraw();
 	}
 	
 	const string desc = m_pSerialiser->GetDebugStr();
@@ -460,8 +460,7 @@ void WrappedOpenGL::glDrawTransformFeedbackInstanced(GLenum mode, GLuint id, GLs
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -473,7 +472,9 @@ bool WrappedOpenGL::Serialise_glDrawTransformFeedbackStream(GLenum mode, GLuint
 
 	if(m_State <= EXECUTING)
 	{
+		bool idDraw = SetupIDDraw();
 		m_Real.glDrawTransformFeedbackStream(Mode, fid == ResourceId() ? 0 : GetResourceManager()->GetLiveResource(fid).name, Stream);
+		if(idDraw) FinishIDDraw();
 	}
 	
 	const string desc = m_pSerialiser->GetDebugStr();
@@ -524,8 +525,7 @@ void WrappedOpenGL::glDrawTransformFeedbackStream(GLenum mode, GLuint id, GLuint
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -538,7 +538,9 @@ bool WrappedOpenGL::Serialise_glDrawTransformFeedbackStreamInstanced(GLenum mode
 
 	if(m_State <= EXECUTING)
 	{
+		bool idDraw = SetupIDDraw();
 		m_Real.glDrawTransformFeedbackStreamInstanced(Mode, fid == ResourceId() ? 0 : GetResourceManager()->GetLiveResource(fid).name, Stream, Count);
+		if(idDraw) FinishIDDraw();
 	}
 	
 	const string desc = m_pSerialiser->GetDebugStr();
@@ -589,8 +591,7 @@ void WrappedOpenGL::glDrawTransformFeedbackStreamInstanced(GLenum mode, GLuint i
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -603,7 +604,9 @@ bool WrappedOpenGL::Serialise_glDrawArrays(GLenum mode, GLint first, GLsizei cou
 
 	if(m_State <= EXECUTING)
 	{
+		bool idDraw = SetupIDDraw();
 		m_Real.glDrawArrays(Mode, First, Count);
+		if(idDraw) FinishIDDraw();
 	}
 	
 	const string desc = m_pSerialiser->GetDebugStr();
@@ -653,8 +656,7 @@ void WrappedOpenGL::glDrawArrays(GLenum mode, GLint first, GLsizei count)
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -665,7 +667,9 @@ bool WrappedOpenGL::Serialise_glDrawArraysIndirect(GLenum mode, const void *indi
 
 	if(m_State <= EXECUTING)
 	{
+		bool idDraw = SetupIDDraw();
 		m_Real.glDrawArraysIndirect(Mode, (const void *)Offset);
+		if(idDraw) FinishIDDraw();
 	}
 	
 	const string desc = m_pSerialiser->GetDebugStr();
@@ -718,8 +722,7 @@ void WrappedOpenGL::glDrawArraysIndirect(GLenum mode, const void *indirect)
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -732,7 +735,9 @@ bool WrappedOpenGL::Serialise_glDrawArraysInstanced(GLenum mode, GLint first, GL
 
 	if(m_State <= EXECUTING)
 	{
+		bool idDraw = SetupIDDraw();
 		m_Real.glDrawArraysInstanced(Mode, First, Count, InstanceCount);
+		if(idDraw) FinishIDDraw();
 	}
 	
 	const string desc = m_pSerialiser->GetDebugStr();
@@ -783,8 +788,7 @@ void WrappedOpenGL::glDrawArraysInstanced(GLenum mode, GLint first, GLsizei coun
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -798,7 +802,9 @@ bool WrappedOpenGL::Serialise_glDrawArraysInstancedBaseInstance(GLenum mode, GLi
 
 	if(m_State <= EXECUTING)
 	{
+		bool idDraw = SetupIDDraw();
 		m_Real.glDrawArraysInstancedBaseInstance(Mode, First, Count, InstanceCount, BaseInstance);
+		if(idDraw) FinishIDDraw();
 	}
 	
 	const string desc = m_pSerialiser->GetDebugStr();
@@ -849,8 +855,7 @@ void WrappedOpenGL::glDrawArraysInstancedBaseInstance(GLenum mode, GLint first,
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -936,7 +941,9 @@ bool WrappedOpenGL::Serialise_glDrawElements(GLenum mode, GLsizei count, GLenum
 
 	if(m_State <= EXECUTING)
 	{
+		bool idDraw = SetupIDDraw();
 		m_Real.glDrawElements(Mode, Count, Type, (const void *)IdxOffset);
+		if(idDraw) FinishIDDraw();
 
 		Common_postElements(idxDelete);
 	}
@@ -994,8 +1001,7 @@ void WrappedOpenGL::glDrawElements(GLenum mode, GLsizei count, GLenum type, cons
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -1007,7 +1013,9 @@ bool WrappedOpenGL::Serialise_glDrawElementsIndirect(GLenum mode, GLenum type, c
 
 	if(m_State <= EXECUTING)
 	{
+		bool idDraw = SetupIDDraw();
 		m_Real.glDrawElementsIndirect(Mode, Type, (const void *)Offset);
+		if(idDraw) FinishIDDraw();
 	}
 	
 	const string desc = m_pSerialiser->GetDebugStr();
@@ -1067,8 +1075,7 @@ void WrappedOpenGL::glDrawElementsIndirect(GLenum mode, GLenum type, const void
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -1085,7 +1092,9 @@ bool WrappedOpenGL::Serialise_glDrawRangeElements(GLenum mode, GLuint start, GLu
 
 	if(m_State <= EXECUTING)
 	{
+		bool idDraw = SetupIDDraw();
 		m_Real.glDrawRangeElements(Mode, Start, End, Count, Type, (const void *)IdxOffset);
+		if(idDraw) FinishIDDraw();
 		
 		Common_postElements(idxDelete);
 	}
@@ -1143,8 +1152,7 @@ void WrappedOpenGL::glDrawRangeElements(GLenum mode, GLuint start, GLuint end, G
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -1162,7 +1170,9 @@ bool WrappedOpenGL::Serialise_glDrawRangeElementsBaseVertex(GLenum mode, GLuint
 
 	if(m_State <= EXECUTING)
 	{
+		bool idDraw = SetupIDDraw();
 		m_Real.glDrawRangeElementsBaseVertex(Mode, Start, End, Count, Type, (const void *)IdxOffset, BaseVtx);
+		if(idDraw) FinishIDDraw();
 
 		Common_postElements(idxDelete);
 	}
@@ -1220,8 +1230,7 @@ void WrappedOpenGL::glDrawRangeElementsBaseVertex(GLenum mode, GLuint start, GLu
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -1237,7 +1246,9 @@ bool WrappedOpenGL::Serialise_glDrawElementsBaseVertex(GLenum mode, GLsizei coun
 
 	if(m_State <= EXECUTING)
 	{
+		bool idDraw = SetupIDDraw();
 		m_Real.glDrawElementsBaseVertex(Mode, Count, Type, (const void *)IdxOffset, BaseVtx);
+		if(idDraw) FinishIDDraw();
 		
 		Common_postElements(idxDelete);
 	}
@@ -1295,8 +1306,7 @@ void WrappedOpenGL::glDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -1312,7 +1322,9 @@ bool WrappedOpenGL::Serialise_glDrawElementsInstanced(GLenum mode, GLsizei count
 
 	if(m_State <= EXECUTING)
 	{
+		bool idDraw = SetupIDDraw();
 		m_Real.glDrawElementsInstanced(Mode, Count, Type, (const void *)IdxOffset, InstCount);
+		if(idDraw) FinishIDDraw();
 
 		Common_postElements(idxDelete);
 	}
@@ -1370,8 +1382,7 @@ void WrappedOpenGL::glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum t
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -1388,7 +1399,9 @@ bool WrappedOpenGL::Serialise_glDrawElementsInstancedBaseInstance(GLenum mode, G
 
 	if(m_State <= EXECUTING)
 	{
+		bool idDraw = SetupIDDraw();
 		m_Real.glDrawElementsInstancedBaseInstance(Mode, Count, Type, (const void *)IdxOffset, InstCount, BaseInstance);
+		if(idDraw) FinishIDDraw();
 		
 		Common_postElements(idxDelete);
 	}
@@ -1446,8 +1459,7 @@ void WrappedOpenGL::glDrawElementsInstancedBaseInstance(GLenum mode, GLsizei cou
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -1464,7 +1476,9 @@ bool WrappedOpenGL::Serialise_glDrawElementsInstancedBaseVertex(GLenum mode, GLs
 
 	if(m_State <= EXECUTING)
 	{
+		bool idDraw = SetupIDDraw();
 		m_Real.glDrawElementsInstancedBaseVertex(Mode, Count, Type, (const void *)IdxOffset, InstCount, BaseVertex);
+		if(idDraw) FinishIDDraw();
 
 		Common_postElements(idxDelete);
 	}
@@ -1523,8 +1537,7 @@ void WrappedOpenGL::glDrawElementsInstancedBaseVertex(GLenum mode, GLsizei count
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -1542,7 +1555,9 @@ bool WrappedOpenGL::Serialise_glDrawElementsInstancedBaseVertexBaseInstance(GLen
 
 	if(m_State <= EXECUTING)
 	{
+		bool idDraw = SetupIDDraw();
 		m_Real.glDrawElementsInstancedBaseVertexBaseInstance(Mode, Count, Type, (const void *)IdxOffset, InstCount, BaseVertex, BaseInstance);
+		if(idDraw) FinishIDDraw();
 		
 		Common_postElements(idxDelete);
 	}
@@ -1601,8 +1616,7 @@ void WrappedOpenGL::glDrawElementsInstancedBaseVertexBaseInstance(GLenum mode, G
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -1616,7 +1630,9 @@ bool WrappedOpenGL::Serialise_glMultiDrawArrays(GLenum mode, const GLint *first,
 
 	if(m_State == READING)
 	{
+		bool idDraw = SetupIDDraw();
 		m_Real.glMultiDrawArrays(Mode, firstArray, countArray, Count);
+		if(idDraw) FinishIDDraw();
 	}
 	else if(m_State <= EXECUTING)
 	{
@@ -1643,7 +1659,9 @@ bool WrappedOpenGL::Serialise_glMultiDrawArrays(GLenum mode, const GLint *first,
 			// if we're replaying part-way into a multidraw, we can replay the first part 'easily'
 			// by just reducing the Count parameter to however many we want to replay. This only
 			// works if we're replaying from the first multidraw to the nth (n less than Count)
+			bool idDraw = SetupIDDraw();
 			m_Real.glMultiDrawArrays(Mode, firstArray, countArray, RDCMIN(Count, m_LastEventID - baseEventID + 1));
+			if(idDraw) FinishIDDraw();
 		}
 		else
 		{
@@ -1654,7 +1672,9 @@ bool WrappedOpenGL::Serialise_glMultiDrawArrays(GLenum mode, const GLint *first,
 
 			uint32_t drawidx = (m_LastEventID - baseEventID);
 
+			bool idDraw = SetupIDDraw();
 			m_Real.glDrawArrays(Mode, firstArray[drawidx], countArray[drawidx]);
+			if(idDraw) FinishIDDraw();
 		}
 	}
 	
@@ -1730,8 +1750,7 @@ void WrappedOpenGL::glMultiDrawArrays(GLenum mode, const GLint *first, const GLs
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -1767,7 +1786,9 @@ bool WrappedOpenGL::Serialise_glMultiDrawElements(GLenum mode, const GLsizei *co
 
 	if(m_State == READING)
 	{
+		bool idDraw = SetupIDDraw();
 		m_Real.glMultiDrawElements(Mode, countArray, Type, idxOffsArray, Count);
+		if(idDraw) FinishIDDraw();
 	}
 	else if(m_State <= EXECUTING)
 	{
@@ -1794,7 +1815,9 @@ bool WrappedOpenGL::Serialise_glMultiDrawElements(GLenum mode, const GLsizei *co
 			// if we're replaying part-way into a multidraw, we can replay the first part 'easily'
 			// by just reducing the Count parameter to however many we want to replay. This only
 			// works if we're replaying from the first multidraw to the nth (n less than Count)
+			bool idDraw = SetupIDDraw();
 			m_Real.glMultiDrawElements(Mode, countArray, Type, idxOffsArray, RDCMIN(Count, m_LastEventID - baseEventID + 1));
+			if(idDraw) FinishIDDraw();
 		}
 		else
 		{
@@ -1805,7 +1828,9 @@ bool WrappedOpenGL::Serialise_glMultiDrawElements(GLenum mode, const GLsizei *co
 
 			uint32_t drawidx = (m_LastEventID - baseEventID);
 
+			bool idDraw = SetupIDDraw();
 			m_Real.glDrawElements(Mode, countArray[drawidx], Type, idxOffsArray[drawidx]);
+			if(idDraw) FinishIDDraw();
 		}
 	}
 	
@@ -1890,8 +1915,7 @@ void WrappedOpenGL::glMultiDrawElements(GLenum mode, const GLsizei *count, GLenu
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -1928,7 +1952,9 @@ bool WrappedOpenGL::Serialise_glMultiDrawElementsBaseVertex(GLenum mode, const G
 
 	if(m_State == READING)
 	{
+		bool idDraw = SetupIDDraw();
 		m_Real.glMultiDrawElementsBaseVertex(Mode, countArray, Type, idxOffsArray, Count, baseArray);
+		if(idDraw) FinishIDDraw();
 	}
 	else if(m_State <= EXECUTING)
 	{
@@ -1955,7 +1981,9 @@ bool WrappedOpenGL::Serialise_glMultiDrawElementsBaseVertex(GLenum mode, const G
 			// if we're replaying part-way into a multidraw, we can replay the first part 'easily'
 			// by just reducing the Count parameter to however many we want to replay. This only
 			// works if we're replaying from the first multidraw to the nth (n less than Count)
+			bool idDraw = SetupIDDraw();
 			m_Real.glMultiDrawElementsBaseVertex(Mode, countArray, Type, idxOffsArray, RDCMIN(Count, m_LastEventID - baseEventID + 1), baseArray);
+			if(idDraw) FinishIDDraw();
 		}
 		else
 		{
@@ -1966,7 +1994,9 @@ bool WrappedOpenGL::Serialise_glMultiDrawElementsBaseVertex(GLenum mode, const G
 
 			uint32_t drawidx = (m_LastEventID - baseEventID);
 
+			bool idDraw = SetupIDDraw();
 			m_Real.glDrawElementsBaseVertex(Mode, countArray[drawidx], Type, idxOffsArray[drawidx], baseArray[drawidx]);
+			if(idDraw) FinishIDDraw();
 		}
 	}
 	
@@ -2052,8 +2082,7 @@ void WrappedOpenGL::glMultiDrawElementsBaseVertex(GLenum mode, const GLsizei *co
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -2066,7 +2095,9 @@ bool WrappedOpenGL::Serialise_glMultiDrawArraysIndirect(GLenum mode, const void
 
 	if(m_State == READING)
 	{
+		bool idDraw = SetupIDDraw();
 		m_Real.glMultiDrawArraysIndirect(Mode, (const void *)Offset, Count, Stride);
+		if(idDraw) FinishIDDraw();
 	}
 	else if(m_State <= EXECUTING)
 	{
@@ -2093,7 +2124,9 @@ bool WrappedOpenGL::Serialise_glMultiDrawArraysIndirect(GLenum mode, const void
 			// if we're replaying part-way into a multidraw, we can replay the first part 'easily'
 			// by just reducing the Count parameter to however many we want to replay. This only
 			// works if we're replaying from the first multidraw to the nth (n less than Count)
+			bool idDraw = SetupIDDraw();
 			m_Real.glMultiDrawArraysIndirect(Mode, (const void *)Offset, RDCMIN(Count, m_LastEventID - baseEventID + 1), Stride);
+			if(idDraw) FinishIDDraw();
 		}
 		else
 		{
@@ -2114,7 +2147,9 @@ bool WrappedOpenGL::Serialise_glMultiDrawArraysIndirect(GLenum mode, const void
 
 			m_Real.glGetBufferSubData(eGL_DRAW_INDIRECT_BUFFER, offs, sizeof(params), &params);
 
+			bool idDraw = SetupIDDraw();
 			m_Real.glDrawArraysInstancedBaseInstance(Mode, params.first, params.count, params.instanceCount, params.baseInstance);
+			if(idDraw) FinishIDDraw();
 		}
 	}
 	
@@ -2203,8 +2238,7 @@ void WrappedOpenGL::glMultiDrawArraysIndirect(GLenum mode, const void *indirect,
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -2223,7 +2257,9 @@ bool WrappedOpenGL::Serialise_glMultiDrawElementsIndirect(GLenum mode, GLenum ty
 		
 	if(m_State == READING)
 	{
+		bool idDraw = SetupIDDraw();
 		m_Real.glMultiDrawElementsIndirect(Mode, Type, (const void *)Offset, Count, Stride);
+		if(idDraw) FinishIDDraw();
 	}
 	else if(m_State <= EXECUTING)
 	{
@@ -2250,7 +2286,9 @@ bool WrappedOpenGL::Serialise_glMultiDrawElementsIndirect(GLenum mode, GLenum ty
 			// if we're replaying part-way into a multidraw, we can replay the first part 'easily'
 			// by just reducing the Count parameter to however many we want to replay. This only
 			// works if we're replaying from the first multidraw to the nth (n less than Count)
+			bool idDraw = SetupIDDraw();
 			m_Real.glMultiDrawElementsIndirect(Mode, Type, (const void *)Offset, RDCMIN(Count, m_LastEventID - baseEventID + 1), Stride);
+			if(idDraw) FinishIDDraw();
 		}
 		else
 		{
@@ -2271,8 +2309,10 @@ bool WrappedOpenGL::Serialise_glMultiDrawElementsIndirect(GLenum mode, GLenum ty
 
 			m_Real.glGetBufferSubData(eGL_DRAW_INDIRECT_BUFFER, offs, sizeof(params), &params);
 
+			bool idDraw = SetupIDDraw();
 			m_Real.glDrawElementsInstancedBaseVertexBaseInstance(Mode, params.count, Type, (const void *)ptrdiff_t(params.firstIndex*IdxSize),
 			                                                     params.instanceCount, params.baseVertex, params.baseInstance);
+			if(idDraw) FinishIDDraw();
 		}
 	}
 	
@@ -2363,8 +2403,7 @@ void WrappedOpenGL::glMultiDrawElementsIndirect(GLenum mode, GLenum type, const
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -2387,7 +2426,9 @@ bool WrappedOpenGL::Serialise_glMultiDrawArraysIndirectCountARB(GLenum mode, GLi
 
 	if(m_State == READING)
 	{
+		bool idDraw = SetupIDDraw();
 		m_Real.glMultiDrawArraysIndirectCountARB(Mode, (GLintptr)Offset, (GLintptr)Count, MaxCount, Stride);
+		if(idDraw) FinishIDDraw();
 	}
 	else if(m_State <= EXECUTING)
 	{
@@ -2414,7 +2455,9 @@ bool WrappedOpenGL::Serialise_glMultiDrawArraysIndirectCountARB(GLenum mode, GLi
 			// if we're replaying part-way into a multidraw, we can replay the first part 'easily'
 			// by just reducing the Count parameter to however many we want to replay. This only
 			// works if we're replaying from the first multidraw to the nth (n less than Count)
+			bool idDraw = SetupIDDraw();
 			m_Real.glMultiDrawArraysIndirect(Mode, (const void *)Offset, RDCMIN(realdrawcount, m_LastEventID - baseEventID + 1), Stride);
+			if(idDraw) FinishIDDraw();
 		}
 		else
 		{
@@ -2435,7 +2478,9 @@ bool WrappedOpenGL::Serialise_glMultiDrawArraysIndirectCountARB(GLenum mode, GLi
 
 			m_Real.glGetBufferSubData(eGL_DRAW_INDIRECT_BUFFER, offs, sizeof(params), &params);
 
+			bool idDraw = SetupIDDraw();
 			m_Real.glDrawArraysInstancedBaseInstance(Mode, params.first, params.count, params.instanceCount, params.baseInstance);
+			if(idDraw) FinishIDDraw();
 		}
 	}
 	
@@ -2525,8 +2570,7 @@ void WrappedOpenGL::glMultiDrawArraysIndirectCountARB(GLenum mode, GLintptr indi
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -2555,7 +2599,9 @@ bool WrappedOpenGL::Serialise_glMultiDrawElementsIndirectCountARB(GLenum mode, G
 
 	if(m_State == READING)
 	{
+		bool idDraw = SetupIDDraw();
 		m_Real.glMultiDrawElementsIndirectCountARB(Mode, Type, (GLintptr)Offset, (GLintptr)Count, MaxCount, Stride);
+		if(idDraw) FinishIDDraw();
 	}
 	else if(m_State <= EXECUTING)
 	{
@@ -2582,7 +2628,9 @@ bool WrappedOpenGL::Serialise_glMultiDrawElementsIndirectCountARB(GLenum mode, G
 			// if we're replaying part-way into a multidraw, we can replay the first part 'easily'
 			// by just reducing the Count parameter to however many we want to replay. This only
 			// works if we're replaying from the first multidraw to the nth (n less than Count)
+			bool idDraw = SetupIDDraw();
 			m_Real.glMultiDrawElementsIndirect(Mode, Type, (const void *)Offset, RDCMIN(realdrawcount, m_LastEventID - baseEventID + 1), Stride);
+			if(idDraw) FinishIDDraw();
 		}
 		else
 		{
@@ -2603,8 +2651,10 @@ bool WrappedOpenGL::Serialise_glMultiDrawElementsIndirectCountARB(GLenum mode, G
 
 			m_Real.glGetBufferSubData(eGL_DRAW_INDIRECT_BUFFER, offs, sizeof(params), &params);
 
+			bool idDraw = SetupIDDraw();
 			m_Real.glDrawElementsInstancedBaseVertexBaseInstance(Mode, params.count, Type, (const void *)ptrdiff_t(params.firstIndex*IdxSize),
 			                                                     params.instanceCount, params.baseVertex, params.baseInstance);
+			if(idDraw) FinishIDDraw();
 		}
 	}
 	
@@ -2695,8 +2745,7 @@ void WrappedOpenGL::glMultiDrawElementsIndirectCountARB(GLenum mode, GLenum type
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -2809,8 +2858,7 @@ void WrappedOpenGL::glClearNamedFramebufferfv(GLuint framebuffer, GLenum buffer,
 	}
 	else if(m_State == WRITING_IDLE)
 	{
-		GLRenderState state(&m_Real, m_pSerialiser, m_State);
-		state.MarkDirty(this);
+		MarkDrawBindingsDirty();
 	}
 }
 
@@ -59,6 +59,11 @@ void WrappedOpenGL::glGenFramebuffers(GLsizei n, GLuint *framebuffers)
 		{
 			Chunk *chunk = NULL;
 
+			if(InLockFreeCall())
+			{
+				chunk = SerialiseGenChunk(GEN_FRAMEBUFFERS, id);
+			}
+			else
 			{
 				SCOPED_SERIALISE_CONTEXT(GEN_FRAMEBUFFERS);
 				Serialise_glGenFramebuffers(1, framebuffers+i);
@@ -160,6 +165,8 @@ bool WrappedOpenGL::Serialise_glNamedFramebufferTextureEXT(GLuint framebuffer, G
 void WrappedOpenGL::glNamedFramebufferTextureEXT(GLuint framebuffer, GLenum attachment, GLuint texture, GLint level)
 {
 	m_Real.glNamedFramebufferTextureEXT(framebuffer, attachment, texture, level);
+
+	DrawBindingsChanged();
 	
 	if(m_State >= WRITING)
 	{
@@ -174,7 +181,7 @@ void WrappedOpenGL::glNamedFramebufferTextureEXT(GLuint framebuffer, GLenum atta
 				m_MissingTracks.insert(texrecord->GetResourceID());
 		}
 
-		if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State != WRITING_CAPFRAME)
+		if(record->highTraffic && m_State != WRITING_CAPFRAME)
 			return;
 
 		SCOPED_SERIALISE_CONTEXT(FRAMEBUFFER_TEX);
@@ -187,7 +194,7 @@ void WrappedOpenGL::glNamedFramebufferTextureEXT(GLuint framebuffer, GLenum atta
 				
 			if(record->UpdateCount > 10)
 			{
-				m_HighTrafficResources.insert(record->GetResourceID());
+				record->MarkHighTraffic();
 				GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 			}
 		}
@@ -203,6 +210,8 @@ void WrappedOpenGL::glNamedFramebufferTextureEXT(GLuint framebuffer, GLenum atta
 void WrappedOpenGL::glFramebufferTexture(GLenum target, GLenum attachment, GLuint texture, GLint level)
 {
 	m_Real.glFramebufferTexture(target, attachment, texture, level);
+
+	DrawBindingsChanged();
 	
 	if(m_State >= WRITING)
 	{
@@ -226,7 +235,7 @@ void WrappedOpenGL::glFramebufferTexture(GLenum target, GLenum attachment, GLuin
 				m_MissingTracks.insert(texrecord->GetResourceID());
 		}
 
-		if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State != WRITING_CAPFRAME)
+		if(record->highTraffic && m_State != WRITING_CAPFRAME)
 			return;
 
 		SCOPED_SERIALISE_CONTEXT(FRAMEBUFFER_TEX);
@@ -243,7 +252,7 @@ void WrappedOpenGL::glFramebufferTexture(GLenum target, GLenum attachment, GLuin
 
 				if(record->UpdateCount > 10)
 				{
-					m_HighTrafficResources.insert(record->GetResourceID());
+					record->MarkHighTraffic();
 					GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 				}
 			}
@@ -290,6 +299,8 @@ bool WrappedOpenGL::Serialise_glNamedFramebufferTexture1DEXT(GLuint framebuffer,
 void WrappedOpenGL::glNamedFramebufferTexture1DEXT(GLuint framebuffer, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
 {
 	m_Real.glNamedFramebufferTexture1DEXT(framebuffer, attachment, textarget, texture, level);
+
+	DrawBindingsChanged();
 	
 	if(m_State >= WRITING)
 	{
@@ -304,7 +315,7 @@ void WrappedOpenGL::glNamedFramebufferTexture1DEXT(GLuint framebuffer, GLenum at
 				m_MissingTracks.insert(texrecord->GetResourceID());
 		}
 
-		if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State != WRITING_CAPFRAME)
+		if(record->highTraffic && m_State != WRITING_CAPFRAME)
 			return;
 
 		SCOPED_SERIALISE_CONTEXT(FRAMEBUFFER_TEX1D);
@@ -317,7 +328,7 @@ void WrappedOpenGL::glNamedFramebufferTexture1DEXT(GLuint framebuffer, GLenum at
 				
 			if(record->UpdateCount > 10)
 			{
-				m_HighTrafficResources.insert(record->GetResourceID());
+				record->MarkHighTraffic();
 				GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 			}
 		}
@@ -333,6 +344,8 @@ void WrappedOpenGL::glNamedFramebufferTexture1DEXT(GLuint framebuffer, GLenum at
 void WrappedOpenGL::glFramebufferTexture1D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
 {
 	m_Real.glFramebufferTexture1D(target, attachment, textarget, texture, level);
+
+	DrawBindingsChanged();
 	
 	if(m_State >= WRITING)
 	{
@@ -356,7 +369,7 @@ void WrappedOpenGL::glFramebufferTexture1D(GLenum target, GLenum attachment, GLe
 				m_MissingTracks.insert(texrecord->GetResourceID());
 		}
 
-		if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State != WRITING_CAPFRAME)
+		if(record->highTraffic && m_State != WRITING_CAPFRAME)
 			return;
 
 		SCOPED_SERIALISE_CONTEXT(FRAMEBUFFER_TEX1D);
@@ -373,7 +386,7 @@ void WrappedOpenGL::glFramebufferTexture1D(GLenum target, GLenum attachment, GLe
 
 				if(record->UpdateCount > 10)
 				{
-					m_HighTrafficResources.insert(record->GetResourceID());
+					record->MarkHighTraffic();
 					GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 				}
 			}
@@ -420,6 +433,8 @@ bool WrappedOpenGL::Serialise_glNamedFramebufferTexture2DEXT(GLuint framebuffer,
 void WrappedOpenGL::glNamedFramebufferTexture2DEXT(GLuint framebuffer, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
 {
 	m_Real.glNamedFramebufferTexture2DEXT(framebuffer, attachment, textarget, texture, level);
+
+	DrawBindingsChanged();
 	
 	if(m_State >= WRITING)
 	{
@@ -434,7 +449,7 @@ void WrappedOpenGL::glNamedFramebufferTexture2DEXT(GLuint framebuffer, GLenum at
 				m_MissingTracks.insert(texrecord->GetResourceID());
 		}
 
-		if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State != WRITING_CAPFRAME)
+		if(record->highTraffic && m_State != WRITING_CAPFRAME)
 			return;
 
 		SCOPED_SERIALISE_CONTEXT(FRAMEBUFFER_TEX2D);
@@ -447,7 +462,7 @@ void WrappedOpenGL::glNamedFramebufferTexture2DEXT(GLuint framebuffer, GLenum at
 				
 			if(record->UpdateCount > 10)
 			{
-				m_HighTrafficResources.insert(record->GetResourceID());
+				record->MarkHighTraffic();
 				GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 			}
 		}
@@ -463,6 +478,8 @@ void WrappedOpenGL::glNamedFramebufferTexture2DEXT(GLuint framebuffer, GLenum at
 void WrappedOpenGL::glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
 {
 	m_Real.glFramebufferTexture2D(target, attachment, textarget, texture, level);
+
+	DrawBindingsChanged();
 	
 	if(m_State >= WRITING)
 	{
@@ -486,7 +503,7 @@ void WrappedOpenGL::glFramebufferTexture2D(GLenum target, GLenum attachment, GLe
 				m_MissingTracks.insert(texrecord->GetResourceID());
 		}
 		
-		if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State != WRITING_CAPFRAME)
+		if(record->highTraffic && m_State != WRITING_CAPFRAME)
 			return;
 
 		SCOPED_SERIALISE_CONTEXT(FRAMEBUFFER_TEX2D);
@@ -503,7 +520,7 @@ void WrappedOpenGL::glFramebufferTexture2D(GLenum target, GLenum attachment, GLe
 
 				if(record->UpdateCount > 10)
 				{
-					m_HighTrafficResources.insert(record->GetResourceID());
+					record->MarkHighTraffic();
 					GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 				}
 			}
@@ -551,6 +568,8 @@ bool WrappedOpenGL::Serialise_glNamedFramebufferTexture3DEXT(GLuint framebuffer,
 void WrappedOpenGL::glNamedFramebufferTexture3DEXT(GLuint framebuffer, GLenum attachment, GLenum textarget, GLuint texture, GLint level, GLint zoffset)
 {
 	m_Real.glNamedFramebufferTexture3DEXT(framebuffer, attachment, textarget, texture, level, zoffset);
+
+	DrawBindingsChanged();
 	
 	if(m_State >= WRITING)
 	{
@@ -565,7 +584,7 @@ void WrappedOpenGL::glNamedFramebufferTexture3DEXT(GLuint framebuffer, GLenum at
 				m_MissingTracks.insert(texrecord->GetResourceID());
 		}
 
-		if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State != WRITING_CAPFRAME)
+		if(record->highTraffic && m_State != WRITING_CAPFRAME)
 			return;
 
 		SCOPED_SERIALISE_CONTEXT(FRAMEBUFFER_TEX3D);
@@ -578,7 +597,7 @@ void WrappedOpenGL::glNamedFramebufferTexture3DEXT(GLuint framebuffer, GLenum at
 				
 			if(record->UpdateCount > 10)
 			{
-				m_HighTrafficResources.insert(record->GetResourceID());
+				record->MarkHighTraffic();
 				GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 			}
 		}
@@ -594,6 +613,8 @@ void WrappedOpenGL::glNamedFramebufferTexture3DEXT(GLuint framebuffer, GLenum at
 void WrappedOpenGL::glFramebufferTexture3D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level, GLint zoffset)
 {
 	m_Real.glFramebufferTexture3D(target, attachment, textarget, texture, level, zoffset);
+
+	DrawBindingsChanged();
 	
 	if(m_State >= WRITING)
 	{
@@ -617,7 +638,7 @@ void WrappedOpenGL::glFramebufferTexture3D(GLenum target, GLenum attachment, GLe
 				m_MissingTracks.insert(texrecord->GetResourceID());
 		}
 
-		if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State != WRITING_CAPFRAME)
+		if(record->highTraffic && m_State != WRITING_CAPFRAME)
 			return;
 
 		SCOPED_SERIALISE_CONTEXT(FRAMEBUFFER_TEX3D);
@@ -634,7 +655,7 @@ void WrappedOpenGL::glFramebufferTexture3D(GLenum target, GLenum attachment, GLe
 
 				if(record->UpdateCount > 10)
 				{
-					m_HighTrafficResources.insert(record->GetResourceID());
+					record->MarkHighTraffic();
 					GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 				}
 			}
@@ -679,12 +700,14 @@ bool WrappedOpenGL::Serialise_glNamedFramebufferRenderbufferEXT(GLuint framebuff
 void WrappedOpenGL::glNamedFramebufferRenderbufferEXT(GLuint framebuffer, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer)
 {
 	m_Real.glNamedFramebufferRenderbufferEXT(framebuffer, attachment, renderbuffertarget, renderbuffer);
+
+	DrawBindingsChanged();
 	
 	if(m_State >= WRITING)
 	{
 		GLResourceRecord *record = GetResourceManager()->GetResourceRecord(FramebufferRes(GetCtx(), framebuffer));
 		
-		if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State != WRITING_CAPFRAME)
+		if(record->highTraffic && m_State != WRITING_CAPFRAME)
 			return;
 
 		SCOPED_SERIALISE_CONTEXT(FRAMEBUFFER_RENDBUF);
@@ -697,7 +720,7 @@ void WrappedOpenGL::glNamedFramebufferRenderbufferEXT(GLuint framebuffer, GLenum
 				
 			if(record->UpdateCount > 10)
 			{
-				m_HighTrafficResources.insert(record->GetResourceID());
+				record->MarkHighTraffic();
 				GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 			}
 		}
@@ -713,6 +736,8 @@ void WrappedOpenGL::glNamedFramebufferRenderbufferEXT(GLuint framebuffer, GLenum
 void WrappedOpenGL::glFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer)
 {
 	m_Real.glFramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer);
+
+	DrawBindingsChanged();
 	
 	if(m_State >= WRITING)
 	{
@@ -727,7 +752,7 @@ void WrappedOpenGL::glFramebufferRenderbuffer(GLenum target, GLenum attachment,
 			if(GetCtxData().m_ReadFramebufferRecord) record = GetCtxData().m_ReadFramebufferRecord;
 		}
 		
-		if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State != WRITING_CAPFRAME)
+		if(record->highTraffic && m_State != WRITING_CAPFRAME)
 			return;
 
 		SCOPED_SERIALISE_CONTEXT(FRAMEBUFFER_RENDBUF);
@@ -744,7 +769,7 @@ void WrappedOpenGL::glFramebufferRenderbuffer(GLenum target, GLenum attachment,
 
 				if(record->UpdateCount > 10)
 				{
-					m_HighTrafficResources.insert(record->GetResourceID());
+					record->MarkHighTraffic();
 					GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 				}
 			}
@@ -791,6 +816,8 @@ bool WrappedOpenGL::Serialise_glNamedFramebufferTextureLayerEXT(GLuint framebuff
 void WrappedOpenGL::glNamedFramebufferTextureLayerEXT(GLuint framebuffer, GLenum attachment, GLuint texture, GLint level, GLint layer)
 {
 	m_Real.glNamedFramebufferTextureLayerEXT(framebuffer, attachment, texture, level, layer);
+
+	DrawBindingsChanged();
 	
 	if(m_State >= WRITING)
 	{
@@ -805,7 +832,7 @@ void WrappedOpenGL::glNamedFramebufferTextureLayerEXT(GLuint framebuffer, GLenum
 				m_MissingTracks.insert(texrecord->GetResourceID());
 		}
 
-		if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State != WRITING_CAPFRAME)
+		if(record->highTraffic && m_State != WRITING_CAPFRAME)
 			return;
 
 		SCOPED_SERIALISE_CONTEXT(FRAMEBUFFER_TEXLAYER);
@@ -818,7 +845,7 @@ void WrappedOpenGL::glNamedFramebufferTextureLayerEXT(GLuint framebuffer, GLenum
 				
 			if(record->UpdateCount > 10)
 			{
-				m_HighTrafficResources.insert(record->GetResourceID());
+				record->MarkHighTraffic();
 				GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 			}
 		}
@@ -834,6 +861,8 @@ void WrappedOpenGL::glNamedFramebufferTextureLayerEXT(GLuint framebuffer, GLenum
 void WrappedOpenGL::glFramebufferTextureLayer(GLenum target, GLenum attachment, GLuint texture, GLint level, GLint layer)
 {
 	m_Real.glFramebufferTextureLayer(target, attachment, texture, level, layer);
+
+	DrawBindingsChanged();
 	
 	if(m_State >= WRITING)
 	{
@@ -857,7 +886,7 @@ void WrappedOpenGL::glFramebufferTextureLayer(GLenum target, GLenum attachment,
 				m_MissingTracks.insert(texrecord->GetResourceID());
 		}
 
-		if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State != WRITING_CAPFRAME)
+		if(record->highTraffic && m_State != WRITING_CAPFRAME)
 			return;
 
 		SCOPED_SERIALISE_CONTEXT(FRAMEBUFFER_TEXLAYER);
@@ -874,7 +903,7 @@ void WrappedOpenGL::glFramebufferTextureLayer(GLenum target, GLenum attachment,
 
 				if(record->UpdateCount > 10)
 				{
-					m_HighTrafficResources.insert(record->GetResourceID());
+					record->MarkHighTraffic();
 					GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 				}
 			}
@@ -1061,6 +1090,8 @@ void WrappedOpenGL::glBindFramebuffer(GLenum target, GLuint framebuffer)
 		GetCtxData().m_ReadFramebufferRecord = GetResourceManager()->GetResourceRecord(FramebufferRes(GetCtx(), framebuffer));
 
 	m_Real.glBindFramebuffer(target, framebuffer);
+
+	DrawBindingsChanged();
 }
 
 bool WrappedOpenGL::Serialise_glFramebufferDrawBufferEXT(GLuint framebuffer, GLenum buf)
@@ -1459,6 +1490,8 @@ void WrappedOpenGL::glDeleteFramebuffers(GLsizei n, const GLuint *framebuffers)
 	}
 	
 	m_Real.glDeleteFramebuffers(n, framebuffers);
+
+	ResourcesDeleted();
 }
 
 bool WrappedOpenGL::Serialise_glGenRenderbuffers(GLsizei n, GLuint* renderbuffers)
@@ -1496,6 +1529,11 @@ void WrappedOpenGL::glGenRenderbuffers(GLsizei n, GLuint *renderbuffers)
 		{
 			Chunk *chunk = NULL;
 
+			if(InLockFreeCall())
+			{
+				chunk = SerialiseGenChunk(GEN_RENDERBUFFERS, id);
+			}
+			else
 			{
 				SCOPED_SERIALISE_CONTEXT(GEN_RENDERBUFFERS);
 				Serialise_glGenRenderbuffers(1, renderbuffers+i);
@@ -1594,6 +1632,8 @@ void WrappedOpenGL::glDeleteRenderbuffers(GLsizei n, const GLuint *renderbuffers
 	}
 	
 	m_Real.glDeleteRenderbuffers(n, renderbuffers);
+
+	ResourcesDeleted();
 }
 
 bool WrappedOpenGL::Serialise_glNamedRenderbufferStorageEXT(GLuint renderbuffer, GLenum internalformat, GLsizei width, GLsizei height)
@@ -59,6 +59,11 @@ void WrappedOpenGL::glGenSamplers(GLsizei count, GLuint *samplers)
 		{
 			Chunk *chunk = NULL;
 
+			if(InLockFreeCall())
+			{
+				chunk = SerialiseGenChunk(GEN_SAMPLERS, id);
+			}
+			else
 			{
 				SCOPED_SERIALISE_CONTEXT(GEN_SAMPLERS);
 				Serialise_glGenSamplers(1, samplers+i);
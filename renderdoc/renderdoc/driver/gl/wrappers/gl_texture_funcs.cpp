@@ -83,6 +83,11 @@ void WrappedOpenGL::glGenTextures(GLsizei n, GLuint* textures)
 		{
 			Chunk *chunk = NULL;
 
+			if(InLockFreeCall())
+			{
+				chunk = SerialiseGenChunk(GEN_TEXTURE, id);
+			}
+			else
 			{
 				SCOPED_SERIALISE_CONTEXT(GEN_TEXTURE);
 				Serialise_glGenTextures(1, textures+i);
@@ -150,7 +155,7 @@ void WrappedOpenGL::glCreateTextures(GLenum target, GLsizei n, GLuint* textures)
 			GLResourceRecord *record = GetResourceManager()->AddResourceRecord(id);
 			RDCASSERT(record);
 
-			record->datatype = TextureBinding(target);
+			record->SetDataType(TextureBinding(target));
 			m_Textures[id].resource = res;
 			m_Textures[id].curType = TextureTarget(target);
 
@@ -181,6 +186,8 @@ void WrappedOpenGL::glDeleteTextures(GLsizei n, const GLuint *textures)
 	}
 	
 	m_Real.glDeleteTextures(n, textures);
+
+	ResourcesDeleted();
 }
 
 bool WrappedOpenGL::Serialise_glBindTexture(GLenum target, GLuint texture)
@@ -190,7 +197,7 @@ bool WrappedOpenGL::Serialise_glBindTexture(GLenum target, GLuint texture)
 	
 	if(m_State == WRITING_IDLE)
 	{
-		GetCtxData().GetActiveTexRecord()->datatype = TextureBinding(Target);
+		GetCtxData().GetActiveTexRecord()->SetDataType(TextureBinding(Target));
 	}
 	else if(m_State < WRITING)
 	{
@@ -252,13 +259,18 @@ void WrappedOpenGL::glBindTexture(GLenum target, GLuint texture)
 	{
 		GLResourceRecord *r = cd.m_TextureRecord[cd.m_TextureUnit] = GetResourceManager()->GetResourceRecord(TextureRes(GetCtx(), texture));
 
-		if(r->datatype)
+		GLenum datatype = r->GetDataType();
+
+		if(datatype)
 		{
 			// it's illegal to retype a texture
-			RDCASSERT(r->datatype == TextureBinding(target));
+			RDCASSERT(datatype == TextureBinding(target));
 		}
 		else
 		{
+			// first bind types the texture, which needs serialising
+			EscalateLockFreeCall();
+
 			Chunk *chunk = NULL;
 
 			{
@@ -348,7 +360,7 @@ bool WrappedOpenGL::Serialise_glBindMultiTextureEXT(GLenum texunit, GLenum targe
 	
 	if(m_State == WRITING_IDLE)
 	{
-		GetCtxData().m_TextureRecord[Unit]->datatype = TextureBinding(Target);
+		GetCtxData().m_TextureRecord[Unit]->SetDataType(TextureBinding(Target));
 	}
 	else if(m_State < WRITING)
 	{
@@ -506,6 +518,8 @@ bool WrappedOpenGL::Serialise_glBindImageTexture(GLuint unit, GLuint texture, GL
 void WrappedOpenGL::glBindImageTexture(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format)
 {
 	m_Real.glBindImageTexture(unit, texture, level, layered, layer, access, format);
+
+	DrawBindingsChanged();
 	
 	if(m_State == WRITING_CAPFRAME)
 	{
@@ -563,6 +577,8 @@ bool WrappedOpenGL::Serialise_glBindImageTextures(GLuint first, GLsizei count, c
 void WrappedOpenGL::glBindImageTextures(GLuint first, GLsizei count, const GLuint *textures)
 {
 	m_Real.glBindImageTextures(first, count, textures);
+
+	DrawBindingsChanged();
 	
 	if(m_State >= WRITING_CAPFRAME)
 	{
@@ -1092,7 +1108,7 @@ void WrappedOpenGL::Common_glTextureParameteriEXT(GLResourceRecord *record, GLen
 {
 	if(!record) return;
 
-	if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State != WRITING_CAPFRAME)
+	if(record->highTraffic && m_State != WRITING_CAPFRAME)
 		return;
 	
 	// CLAMP isn't supported (border texels gone), assume they meant CLAMP_TO_EDGE
@@ -1113,7 +1129,7 @@ void WrappedOpenGL::Common_glTextureParameteriEXT(GLResourceRecord *record, GLen
 
 		if(record->UpdateCount > 12)
 		{
-			m_HighTrafficResources.insert(record->GetResourceID());
+			record->MarkHighTraffic();
 			GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 		}
 	}
@@ -1176,7 +1192,7 @@ void WrappedOpenGL::Common_glTextureParameterivEXT(GLResourceRecord *record, GLe
 {
 	if(!record) return;
 
-	if(m_State != WRITING_CAPFRAME && m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end())
+	if(m_State != WRITING_CAPFRAME && record->highTraffic)
 		return;
 	
 	GLint clamptoedge = eGL_CLAMP_TO_EDGE;
@@ -1198,7 +1214,7 @@ void WrappedOpenGL::Common_glTextureParameterivEXT(GLResourceRecord *record, GLe
 
 		if(record->UpdateCount > 12)
 		{
-			m_HighTrafficResources.insert(record->GetResourceID());
+			record->MarkHighTraffic();
 			GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 		}
 	}
@@ -1261,7 +1277,7 @@ void WrappedOpenGL::Common_glTextureParameterIivEXT(GLResourceRecord *record, GL
 {
 	if(!record) return;
 	
-	if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State != WRITING_CAPFRAME)
+	if(record->highTraffic && m_State != WRITING_CAPFRAME)
 		return;
 	
 	GLint clamptoedge = eGL_CLAMP_TO_EDGE;
@@ -1283,7 +1299,7 @@ void WrappedOpenGL::Common_glTextureParameterIivEXT(GLResourceRecord *record, GL
 			
 		if(record->UpdateCount > 12)
 		{
-			m_HighTrafficResources.insert(record->GetResourceID());
+			record->MarkHighTraffic();
 			GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 		}
 	}
@@ -1346,7 +1362,7 @@ void WrappedOpenGL::Common_glTextureParameterIuivEXT(GLResourceRecord *record, G
 {
 	if(!record) return;
 	
-	if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State != WRITING_CAPFRAME)
+	if(record->highTraffic && m_State != WRITING_CAPFRAME)
 		return;
 	
 	GLuint clamptoedge = eGL_CLAMP_TO_EDGE;
@@ -1368,7 +1384,7 @@ void WrappedOpenGL::Common_glTextureParameterIuivEXT(GLResourceRecord *record, G
 			
 		if(record->UpdateCount > 12)
 		{
-			m_HighTrafficResources.insert(record->GetResourceID());
+			record->MarkHighTraffic();
 			GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 		}
 	}
@@ -1428,7 +1444,7 @@ void WrappedOpenGL::Common_glTextureParameterfEXT(GLResourceRecord *record, GLen
 {
 	if(!record) return;
 	
-	if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State != WRITING_CAPFRAME)
+	if(record->highTraffic && m_State != WRITING_CAPFRAME)
 		return;
 	
 	// CLAMP isn't supported (border texels gone), assume they meant CLAMP_TO_EDGE
@@ -1449,7 +1465,7 @@ void WrappedOpenGL::Common_glTextureParameterfEXT(GLResourceRecord *record, GLen
 			
 		if(record->UpdateCount > 12)
 		{
-			m_HighTrafficResources.insert(record->GetResourceID());
+			record->MarkHighTraffic();
 			GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 		}
 	}
@@ -1512,7 +1528,7 @@ void WrappedOpenGL::Common_glTextureParameterfvEXT(GLResourceRecord *record, GLe
 {
 	if(!record) return;
 
-	if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State != WRITING_CAPFRAME)
+	if(record->highTraffic && m_State != WRITING_CAPFRAME)
 		return;
 	
 	GLfloat clamptoedge = (float)eGL_CLAMP_TO_EDGE;
@@ -1534,7 +1550,7 @@ void WrappedOpenGL::Common_glTextureParameterfvEXT(GLResourceRecord *record, GLe
 
 		if(record->UpdateCount > 12)
 		{
-			m_HighTrafficResources.insert(record->GetResourceID());
+			record->MarkHighTraffic();
 			GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 		}
 	}
@@ -3509,9 +3525,11 @@ void WrappedOpenGL::Common_glTextureSubImage1DEXT(GLResourceRecord *record, GLen
 	}
 	else
 	{
-		if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State == WRITING_IDLE)
+		if(record->highTraffic && m_State == WRITING_IDLE)
 			return;
 
+		EscalateLockFreeCall();
+
 		SCOPED_SERIALISE_CONTEXT(TEXSUBIMAGE1D);
 		Serialise_glTextureSubImage1DEXT(record->Resource.name, target, level, xoffset, width, format, type, pixels);
 
@@ -3528,7 +3546,7 @@ void WrappedOpenGL::Common_glTextureSubImage1DEXT(GLResourceRecord *record, GLen
 
 			if(record->UpdateCount > 60)
 			{
-				m_HighTrafficResources.insert(record->GetResourceID());
+				record->MarkHighTraffic();
 				GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 			}
 		}
@@ -3665,9 +3683,11 @@ void WrappedOpenGL::Common_glTextureSubImage2DEXT(GLResourceRecord *record, GLen
 	}
 	else
 	{
-		if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State == WRITING_IDLE)
+		if(record->highTraffic && m_State == WRITING_IDLE)
 			return;
 
+		EscalateLockFreeCall();
+
 		SCOPED_SERIALISE_CONTEXT(TEXSUBIMAGE2D);
 		Serialise_glTextureSubImage2DEXT(record->Resource.name, target, level, xoffset, yoffset, width, height, format, type, pixels);
 
@@ -3684,7 +3704,7 @@ void WrappedOpenGL::Common_glTextureSubImage2DEXT(GLResourceRecord *record, GLen
 
 			if(record->UpdateCount > 60)
 			{
-				m_HighTrafficResources.insert(record->GetResourceID());
+				record->MarkHighTraffic();
 				GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 			}
 		}
@@ -3823,9 +3843,11 @@ void WrappedOpenGL::Common_glTextureSubImage3DEXT(GLResourceRecord *record, GLen
 	}
 	else
 	{
-		if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State == WRITING_IDLE)
+		if(record->highTraffic && m_State == WRITING_IDLE)
 			return;
 
+		EscalateLockFreeCall();
+
 		SCOPED_SERIALISE_CONTEXT(TEXSUBIMAGE3D);
 		Serialise_glTextureSubImage3DEXT(record->Resource.name, target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, pixels);
 		
@@ -3842,7 +3864,7 @@ void WrappedOpenGL::Common_glTextureSubImage3DEXT(GLResourceRecord *record, GLen
 
 			if(record->UpdateCount > 60)
 			{
-				m_HighTrafficResources.insert(record->GetResourceID());
+				record->MarkHighTraffic();
 				GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 			}
 		}
@@ -3959,9 +3981,11 @@ void WrappedOpenGL::Common_glCompressedTextureSubImage1DEXT(GLResourceRecord *re
 	}
 	else
 	{
-		if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State == WRITING_IDLE)
+		if(record->highTraffic && m_State == WRITING_IDLE)
 			return;
 
+		EscalateLockFreeCall();
+
 		SCOPED_SERIALISE_CONTEXT(TEXSUBIMAGE1D_COMPRESSED);
 		Serialise_glCompressedTextureSubImage1DEXT(record->Resource.name, target, level, xoffset, width, format, imageSize, pixels);
 		
@@ -3978,7 +4002,7 @@ void WrappedOpenGL::Common_glCompressedTextureSubImage1DEXT(GLResourceRecord *re
 
 			if(record->UpdateCount > 60)
 			{
-				m_HighTrafficResources.insert(record->GetResourceID());
+				record->MarkHighTraffic();
 				GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 			}
 		}
@@ -4097,9 +4121,11 @@ void WrappedOpenGL::Common_glCompressedTextureSubImage2DEXT(GLResourceRecord *re
 	}
 	else
 	{
-		if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State == WRITING_IDLE)
+		if(record->highTraffic && m_State == WRITING_IDLE)
 			return;
 
+		EscalateLockFreeCall();
+
 		SCOPED_SERIALISE_CONTEXT(TEXSUBIMAGE2D_COMPRESSED);
 		Serialise_glCompressedTextureSubImage2DEXT(record->Resource.name, target, level, xoffset, yoffset, width, height, format, imageSize, pixels);
 		
@@ -4116,7 +4142,7 @@ void WrappedOpenGL::Common_glCompressedTextureSubImage2DEXT(GLResourceRecord *re
 
 			if(record->UpdateCount > 60)
 			{
-				m_HighTrafficResources.insert(record->GetResourceID());
+				record->MarkHighTraffic();
 				GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 			}
 		}
@@ -4237,9 +4263,11 @@ void WrappedOpenGL::Common_glCompressedTextureSubImage3DEXT(GLResourceRecord *re
 	}
 	else
 	{
-		if(m_HighTrafficResources.find(record->GetResourceID()) != m_HighTrafficResources.end() && m_State == WRITING_IDLE)
+		if(record->highTraffic && m_State == WRITING_IDLE)
 			return;
 
+		EscalateLockFreeCall();
+
 		SCOPED_SERIALISE_CONTEXT(TEXSUBIMAGE3D_COMPRESSED);
 		Serialise_glCompressedTextureSubImage3DEXT(record->Resource.name, target, level, xoffset, yoffset, zoffset, width, height, depth, format, imageSize, pixels);
 		
@@ -4256,7 +4284,7 @@ void WrappedOpenGL::Common_glCompressedTextureSubImage3DEXT(GLResourceRecord *re
 
 			if(record->UpdateCount > 60)
 			{
-				m_HighTrafficResources.insert(record->GetResourceID());
+				record->MarkHighTraffic();
 				GetResourceManager()->MarkDirtyResource(record->GetResourceID());
 			}
 		}
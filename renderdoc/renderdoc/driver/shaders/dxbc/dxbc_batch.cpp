@@ -0,0 +1,977 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2014 Crytek
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#include <math.h>
+
+#include "common/common.h"
+#include "dxbc_batch.h"
+#include "dxbc_debug.h"
+#include "dxbc_inspect.h"
+
+using namespace DXBC;
+
+namespace ShaderDebug
+{
+
+BatchProgram::BatchProgram(DXBCFile *dxbc)
+{
+	m_Supported = true;
+	m_MaxDepth = 0;
+	m_NumTemps = 0;
+
+	m_Immediate = dxbc->m_Immediate;
+
+	for(size_t i=0; i < dxbc->GetNumDeclarations(); i++)
+	{
+		const ASMDecl &decl = dxbc->GetDeclaration(i);
+
+		if(decl.declaration == OPCODE_DCL_TEMPS)
+		{
+			m_NumTemps = decl.numTemps;
+		}
+		else if(decl.declaration == OPCODE_DCL_INDEXABLE_TEMP)
+		{
+			if(decl.tempReg >= m_IndexTempSizes.size())
+				m_IndexTempSizes.resize(decl.tempReg+1);
+
+			m_IndexTempSizes[decl.tempReg] = decl.numTemps;
+		}
+		else if(decl.declaration == OPCODE_DCL_FUNCTION_BODY ||
+		        decl.declaration == OPCODE_DCL_FUNCTION_TABLE ||
+		        decl.declaration == OPCODE_DCL_INTERFACE)
+		{
+			m_Supported = false;
+		}
+	}
+
+	// indexable temps are flattened into one run of registers
+	uint32_t offs = 0;
+	m_IndexTempOffsets.resize(m_IndexTempSizes.size());
+	for(size_t i=0; i < m_IndexTempSizes.size(); i++)
+	{
+		m_IndexTempOffsets[i] = offs;
+		offs += m_IndexTempSizes[i];
+	}
+
+	vector<uint32_t> flowStack;
+
+	m_Instructions.resize(dxbc->GetNumInstructions());
+
+	for(size_t i=0; m_Supported && i < dxbc->GetNumInstructions(); i++)
+	{
+		const ASMOperation &op = dxbc->GetInstruction(i);
+		BatchInstruction &inst = m_Instructions[i];
+
+		RDCEraseEl(inst);
+
+		inst.op = op.operation;
+		inst.type = State::OperationType(op.operation);
+		inst.saturate = op.saturate;
+		inst.nonzero = op.nonzero;
+		inst.jump = ~0U;
+		inst.dst.file = eBatchReg_Null;
+
+		bool hasDst = true;
+
+		switch(op.operation)
+		{
+			case OPCODE_ADD: case OPCODE_IADD: case OPCODE_MUL: case OPCODE_DIV:
+			case OPCODE_MAD: case OPCODE_IMAD: case OPCODE_UMAD:
+			case OPCODE_DP2: case OPCODE_DP3: case OPCODE_DP4:
+			case OPCODE_MIN: case OPCODE_MAX: case OPCODE_IMIN: case OPCODE_IMAX: case OPCODE_UMIN: case OPCODE_UMAX:
+			case OPCODE_FRC: case OPCODE_ROUND_PI: case OPCODE_ROUND_NI: case OPCODE_ROUND_Z: case OPCODE_ROUND_NE:
+			case OPCODE_SQRT: case OPCODE_RSQ: case OPCODE_RCP: case OPCODE_EXP: case OPCODE_LOG:
+			case OPCODE_INEG: case OPCODE_ISHL: case OPCODE_ISHR: case OPCODE_USHR:
+			case OPCODE_AND: case OPCODE_OR: case OPCODE_XOR: case OPCODE_NOT:
+			case OPCODE_EQ: case OPCODE_NE: case OPCODE_LT: case OPCODE_GE:
+			case OPCODE_IEQ: case OPCODE_INE: case OPCODE_ILT: case OPCODE_IGE: case OPCODE_ULT: case OPCODE_UGE:
+			case OPCODE_ITOF: case OPCODE_UTOF: case OPCODE_FTOI: case OPCODE_FTOU:
+			case OPCODE_MOV: case OPCODE_MOVC:
+			case OPCODE_DERIV_RTX: case OPCODE_DERIV_RTX_COARSE: case OPCODE_DERIV_RTX_FINE:
+			case OPCODE_DERIV_RTY: case OPCODE_DERIV_RTY_COARSE: case OPCODE_DERIV_RTY_FINE:
+				break;
+			case OPCODE_NOP:
+			case OPCODE_CUSTOMDATA:
+			case OPCODE_BREAK:
+			case OPCODE_CONTINUE:
+			case OPCODE_RET:
+			case OPCODE_BREAKC:
+			case OPCODE_CONTINUEC:
+			case OPCODE_RETC:
+			case OPCODE_DISCARD:
+				hasDst = false;
+				break;
+			case OPCODE_IF:
+				hasDst = false;
+				flowStack.push_back((uint32_t)i);
+				break;
+			case OPCODE_ELSE:
+				hasDst = false;
+				if(flowStack.empty() || m_Instructions[flowStack.back()].op != OPCODE_IF)
+				{
+					m_Supported = false;
+					break;
+				}
+				m_Instructions[flowStack.back()].jump = (uint32_t)i;
+				flowStack.back() = (uint32_t)i;
+				break;
+			case OPCODE_ENDIF:
+				hasDst = false;
+				if(flowStack.empty() || m_Instructions[flowStack.back()].op == OPCODE_LOOP)
+				{
+					m_Supported = false;
+					break;
+				}
+				m_Instructions[flowStack.back()].jump = (uint32_t)i;
+				flowStack.pop_back();
+				break;
+			case OPCODE_LOOP:
+				hasDst = false;
+				flowStack.push_back((uint32_t)i);
+				break;
+			case OPCODE_ENDLOOP:
+				hasDst = false;
+				if(flowStack.empty() || m_Instructions[flowStack.back()].op != OPCODE_LOOP)
+				{
+					m_Supported = false;
+					break;
+				}
+				m_Instructions[flowStack.back()].jump = (uint32_t)i;
+				inst.jump = flowStack.back();
+				flowStack.pop_back();
+				break;
+			default:
+				// resource access, doubles, switch, subroutines etc - use ShaderDebug::State
+				m_Supported = false;
+				break;
+		}
+
+		m_MaxDepth = RDCMAX(m_MaxDepth, (uint32_t)flowStack.size());
+
+		if(!m_Supported)
+			break;
+
+		size_t firstSrc = 0;
+
+		if(hasDst)
+		{
+			if(op.operands.empty() || !Decode(op.operands[0], inst.dst))
+			{
+				m_Supported = false;
+				break;
+			}
+
+			if(inst.dst.file != eBatchReg_Null &&
+			   inst.dst.file != eBatchReg_Temp &&
+			   inst.dst.file != eBatchReg_IndexableTemp &&
+			   inst.dst.file != eBatchReg_Output)
+			{
+				m_Supported = false;
+				break;
+			}
+
+			firstSrc = 1;
+		}
+
+		if(op.operands.size() - firstSrc > 3)
+		{
+			m_Supported = false;
+			break;
+		}
+
+		inst.numSrcs = uint32_t(op.operands.size() - firstSrc);
+
+		for(uint32_t s=0; s < inst.numSrcs; s++)
+		{
+			if(!Decode(op.operands[firstSrc + s], inst.src[s]))
+			{
+				m_Supported = false;
+				break;
+			}
+		}
+	}
+
+	if(!flowStack.empty())
+		m_Supported = false;
+
+	if(!m_Supported)
+		m_Instructions.clear();
+}
+
+bool BatchProgram::Decode(const ASMOperand &oper, BatchOperand &ret)
+{
+	RDCEraseEl(ret);
+
+	ret.relReg = ~0U;
+	ret.modifier = oper.modifier;
+
+	for(int c=0; c < 4; c++)
+	{
+		ret.comps[c] = oper.comps[c] == 0xff ? (uint8_t)c : oper.comps[c];
+		ret.values[c] = oper.values[c];
+
+		if(oper.comps[c] != 0xff)
+			ret.mask |= 1 << oper.comps[c];
+	}
+
+	if(ret.mask == 0)
+		ret.mask = 0x1;
+
+	ret.scalar = (oper.comps[0] != 0xff && oper.comps[1] == 0xff && oper.comps[2] == 0xff && oper.comps[3] == 0xff);
+
+	// the index that can be relative - the element in an array or cbuffer
+	size_t elemIdx = 0;
+
+	switch(oper.type)
+	{
+		case TYPE_NULL:                      ret.file = eBatchReg_Null; return true;
+		case TYPE_IMMEDIATE32:               ret.file = eBatchReg_Immediate; return oper.numComponents != NUMCOMPS_N;
+		case TYPE_TEMP:                      ret.file = eBatchReg_Temp; elemIdx = ~0U; break;
+		case TYPE_INPUT:                     ret.file = eBatchReg_Input; elemIdx = ~0U; break;
+		case TYPE_OUTPUT:                    ret.file = eBatchReg_Output; elemIdx = ~0U; break;
+		case TYPE_INDEXABLE_TEMP:            ret.file = eBatchReg_IndexableTemp; elemIdx = 1; break;
+		case TYPE_CONSTANT_BUFFER:           ret.file = eBatchReg_ConstantBuffer; elemIdx = 1; break;
+		case TYPE_IMMEDIATE_CONSTANT_BUFFER: ret.file = eBatchReg_ImmediateCB; elemIdx = 0; break;
+		default:
+			return false;
+	}
+
+	if(oper.indices.size() != (elemIdx == ~0U ? 1 : elemIdx+1))
+		return false;
+
+	for(size_t i=0; i < oper.indices.size(); i++)
+	{
+		const ASMIndex &idx = oper.indices[i];
+
+		uint32_t val = idx.absolute ? (uint32_t)idx.index : 0;
+
+		if(idx.relative)
+		{
+			const ASMOperand &rel = idx.operand;
+
+			// only plain temps are supported as relative addresses, which covers what fxc emits
+			if(i != elemIdx || rel.type != TYPE_TEMP || rel.indices.size() != 1 ||
+			   rel.indices[0].relative || rel.modifier != OPERAND_MODIFIER_NONE)
+				return false;
+
+			ret.relReg = (uint32_t)rel.indices[0].index;
+			ret.relComp = rel.comps[0] == 0xff ? 0 : rel.comps[0];
+		}
+
+		if(i == elemIdx)
+			ret.element = val;
+		else
+			ret.reg = val;
+	}
+
+	if(ret.file == eBatchReg_IndexableTemp && ret.reg >= m_IndexTempSizes.size())
+		return false;
+
+	return true;
+}
+
+BatchState::BatchState(const BatchProgram &program, const ShaderDebugTrace &trace, const ShaderDebugState &initial, uint32_t numLanes)
+	: m_Program(program)
+{
+	const uint32_t N = m_NumLanes = numLanes;
+
+	m_NumInputs = (uint32_t)trace.inputs.count;
+	m_NumOutputs = (uint32_t)initial.outputs.count;
+	m_OutputLayout = initial.outputs;
+
+	uint32_t numIndexTemps = 0;
+	for(size_t i=0; i < program.m_IndexTempSizes.size(); i++)
+		numIndexTemps += program.m_IndexTempSizes[i];
+
+	RDCEraseEl(m_FileRegs);
+	m_FileRegs[eBatchReg_Temp] = program.m_NumTemps;
+	m_FileRegs[eBatchReg_IndexableTemp] = numIndexTemps;
+	m_FileRegs[eBatchReg_Input] = m_NumInputs;
+	m_FileRegs[eBatchReg_Output] = m_NumOutputs;
+
+	size_t base = 0;
+	for(int f=0; f <= eBatchReg_Output; f++)
+	{
+		m_FileBase[f] = base;
+		base += m_FileRegs[f]*4*N;
+	}
+
+	// temps start zeroed the same as State::Init
+	Value zero;
+	zero.u = 0;
+	m_Regs.resize(base, zero);
+
+	for(uint32_t r=0; r < m_NumInputs; r++)
+		for(uint32_t c=0; c < 4; c++)
+			for(uint32_t l=0; l < N; l++)
+				Reg(eBatchReg_Input, r, c)[l].u = trace.inputs[r].value.uv[c];
+
+	for(uint32_t r=0; r < m_NumOutputs; r++)
+		for(uint32_t c=0; c < 4; c++)
+			for(uint32_t l=0; l < N; l++)
+				Reg(eBatchReg_Output, r, c)[l].u = initial.outputs[r].value.uv[c];
+
+	for(int32_t cb=0; cb < trace.cbuffers.count; cb++)
+	{
+		m_CBOffsets.push_back(uint32_t(m_CBData.size()/4));
+		m_CBCounts.push_back((uint32_t)trace.cbuffers[cb].count);
+
+		for(int32_t i=0; i < trace.cbuffers[cb].count; i++)
+		{
+			for(uint32_t c=0; c < 4; c++)
+			{
+				Value v;
+				v.u = trace.cbuffers[cb][i].value.uv[c];
+				m_CBData.push_back(v);
+			}
+		}
+	}
+
+	// 3 sources and the result, plus a condition mask
+	m_Scratch.resize(4*4*N + N);
+
+	Value all;
+	all.u = ~0U;
+	m_Exec.resize(N, all);
+	m_Alive.resize(N, all);
+	m_Discarded.resize(N, 0);
+
+	m_Depth = 0;
+	m_Frames.resize(program.m_MaxDepth);
+	m_FrameMasks.resize(program.m_MaxDepth*2*N);
+	for(uint32_t d=0; d < program.m_MaxDepth; d++)
+	{
+		m_Frames[d].saved = &m_FrameMasks[(d*2 + 0)*N];
+		m_Frames[d].other = &m_FrameMasks[(d*2 + 1)*N];
+	}
+}
+
+BatchState::Value *BatchState::Reg(BatchRegFile file, uint32_t reg, uint32_t comp)
+{
+	if(file > eBatchReg_Output || reg >= m_FileRegs[file])
+		return NULL;
+
+	// register files are laid out as [reg][component][lane]
+	return &m_Regs[m_FileBase[file] + (reg*4 + comp)*m_NumLanes];
+}
+
+const BatchState::Value *BatchState::Reg(BatchRegFile file, uint32_t reg, uint32_t comp) const
+{
+	if(file > eBatchReg_Output || reg >= m_FileRegs[file])
+		return NULL;
+
+	return &m_Regs[m_FileBase[file] + (reg*4 + comp)*m_NumLanes];
+}
+
+uint32_t BatchState::Element(const BatchOperand &oper, uint32_t lane) const
+{
+	uint32_t ret = oper.element;
+
+	if(oper.relReg != ~0U)
+	{
+		const Value *rel = Reg(eBatchReg_Temp, oper.relReg, oper.relComp);
+		if(rel)
+			ret += rel[lane].u;
+	}
+
+	return ret;
+}
+
+void BatchState::SetInput(uint32_t lane, uint32_t reg, const ShaderVariable &var)
+{
+	for(uint32_t c=0; c < 4; c++)
+	{
+		Value *v = Reg(eBatchReg_Input, reg, c);
+		if(v)
+			v[lane].u = var.value.uv[c];
+	}
+}
+
+void BatchState::SetHelper(uint32_t lane)
+{
+	m_Exec[lane].u = 0;
+	m_Alive[lane].u = 0;
+}
+
+ShaderVariable BatchState::GetOutput(uint32_t lane, uint32_t reg) const
+{
+	ShaderVariable ret = reg < m_NumOutputs ? m_OutputLayout[reg] : ShaderVariable("", 0U, 0U, 0U, 0U);
+
+	for(uint32_t c=0; c < 4; c++)
+	{
+		const Value *v = Reg(eBatchReg_Output, reg, c);
+		if(v)
+			ret.value.uv[c] = v[lane].u;
+	}
+
+	return ret;
+}
+
+ShaderVariable BatchState::GetTemp(uint32_t lane, uint32_t reg) const
+{
+	char buf[64] = {0};
+	StringFormat::snprintf(buf, 63, "r%d", reg);
+
+	ShaderVariable ret(buf, 0U, 0U, 0U, 0U);
+
+	for(uint32_t c=0; c < 4; c++)
+	{
+		const Value *v = Reg(eBatchReg_Temp, reg, c);
+		if(v)
+			ret.value.uv[c] = v[lane].u;
+	}
+
+	return ret;
+}
+
+void BatchState::FetchSrc(const BatchOperand &oper, VarType type, Value *out)
+{
+	const uint32_t N = m_NumLanes;
+
+	switch(oper.file)
+	{
+		case eBatchReg_Immediate:
+		{
+			for(uint32_t c=0; c < 4; c++)
+				for(uint32_t l=0; l < N; l++)
+					out[c*N + l].u = oper.values[ oper.comps[c] ];
+			break;
+		}
+		case eBatchReg_Temp:
+		case eBatchReg_Input:
+		case eBatchReg_Output:
+		case eBatchReg_IndexableTemp:
+		{
+			if(oper.relReg == ~0U)
+			{
+				uint32_t reg = oper.reg;
+
+				if(oper.file == eBatchReg_IndexableTemp)
+				{
+					reg = m_Program.m_IndexTempOffsets[oper.reg] + oper.element;
+					if(oper.element >= m_Program.m_IndexTempSizes[oper.reg])
+						reg = ~0U;
+				}
+
+				for(uint32_t c=0; c < 4; c++)
+				{
+					const Value *src = Reg(oper.file, reg, oper.comps[c]);
+
+					if(src)
+						memcpy(out + c*N, src, N*sizeof(Value));
+					else
+						memset(out + c*N, 0, N*sizeof(Value));
+				}
+			}
+			else
+			{
+				// relatively addressed, so each lane might read a different element
+				for(uint32_t l=0; l < N; l++)
+				{
+					uint32_t elem = Element(oper, l);
+					bool valid = elem < m_Program.m_IndexTempSizes[oper.reg];
+					uint32_t reg = m_Program.m_IndexTempOffsets[oper.reg] + elem;
+
+					for(uint32_t c=0; c < 4; c++)
+						out[c*N + l].u = valid ? Reg(oper.file, reg, oper.comps[c])[l].u : 0;
+				}
+			}
+			break;
+		}
+		case eBatchReg_ConstantBuffer:
+		{
+			for(uint32_t l=0; l < N; l++)
+			{
+				uint32_t elem = Element(oper, l);
+				bool valid = oper.reg < m_CBOffsets.size() && elem < m_CBCounts[oper.reg];
+				const Value *src = valid ? &m_CBData[(m_CBOffsets[oper.reg] + elem)*4] : NULL;
+
+				for(uint32_t c=0; c < 4; c++)
+					out[c*N + l].u = src ? src[ oper.comps[c] ].u : 0;
+			}
+			break;
+		}
+		case eBatchReg_ImmediateCB:
+		{
+			for(uint32_t l=0; l < N; l++)
+			{
+				uint32_t elem = Element(oper, l);
+				bool valid = elem*4 + 4 <= m_Program.m_Immediate.size();
+
+				for(uint32_t c=0; c < 4; c++)
+					out[c*N + l].u = valid ? m_Program.m_Immediate[elem*4 + oper.comps[c]] : 0;
+			}
+			break;
+		}
+		case eBatchReg_Null:
+		default:
+		{
+			memset(out, 0, 4*N*sizeof(Value));
+			break;
+		}
+	}
+
+	const uint32_t count = 4*N;
+
+	if(oper.modifier == OPERAND_MODIFIER_ABS || oper.modifier == OPERAND_MODIFIER_ABSNEG)
+	{
+		if(type == eVar_Float)
+			for(uint32_t i=0; i < count; i++) out[i].f = out[i].f > 0 ? out[i].f : -out[i].f;
+		else if(type == eVar_Int)
+			for(uint32_t i=0; i < count; i++) out[i].i = out[i].i > 0 ? out[i].i : -out[i].i;
+	}
+
+	if(oper.modifier == OPERAND_MODIFIER_NEG || oper.modifier == OPERAND_MODIFIER_ABSNEG)
+	{
+		if(type == eVar_Float)
+			for(uint32_t i=0; i < count; i++) out[i].f = -out[i].f;
+		else if(type == eVar_Int)
+			for(uint32_t i=0; i < count; i++) out[i].i = -out[i].i;
+	}
+}
+
+void BatchState::WriteDst(const BatchInstruction &inst, Value *res)
+{
+	const BatchOperand &dst = inst.dst;
+	const uint32_t N = m_NumLanes;
+	const Value *exec = &m_Exec[0];
+
+	if(dst.file == eBatchReg_Null)
+		return;
+
+	if(inst.saturate)
+	{
+		const uint32_t count = 4*N;
+
+		if(inst.type == eVar_Float)
+			for(uint32_t i=0; i < count; i++) res[i].f = res[i].f < 0 ? 0 : (res[i].f > 1 ? 1 : res[i].f);
+		else if(inst.type == eVar_Int)
+			for(uint32_t i=0; i < count; i++) res[i].i = res[i].i < 0 ? 0 : (res[i].i > 1 ? 1 : res[i].i);
+		else if(inst.type == eVar_UInt)
+			for(uint32_t i=0; i < count; i++) res[i].u = res[i].u ? 1 : 0;
+	}
+
+	// scalar results are written from .x into whichever component is selected,
+	// vector results component to component - same as State::SetDst
+	if(dst.relReg != ~0U)
+	{
+		for(uint32_t l=0; l < N; l++)
+		{
+			if(!exec[l].u)
+				continue;
+
+			uint32_t elem = Element(dst, l);
+			if(elem >= m_Program.m_IndexTempSizes[dst.reg])
+				continue;
+
+			uint32_t reg = m_Program.m_IndexTempOffsets[dst.reg] + elem;
+
+			for(uint32_t c=0; c < 4; c++)
+				if(dst.mask & (1 << c))
+					Reg(dst.file, reg, c)[l].u = res[(dst.scalar ? 0 : c)*N + l].u;
+		}
+
+		return;
+	}
+
+	uint32_t reg = dst.reg;
+
+	if(dst.file == eBatchReg_IndexableTemp)
+	{
+		if(dst.element >= m_Program.m_IndexTempSizes[dst.reg])
+			return;
+
+		reg = m_Program.m_IndexTempOffsets[dst.reg] + dst.element;
+	}
+
+	for(uint32_t c=0; c < 4; c++)
+	{
+		if(!(dst.mask & (1 << c)))
+			continue;
+
+		Value *d = Reg(dst.file, reg, c);
+		const Value *s = res + (dst.scalar ? 0 : c)*N;
+
+		RDCASSERT(d);
+		if(!d)
+			return;
+
+		for(uint32_t l=0; l < N; l++)
+			d[l].u = (s[l].u & exec[l].u) | (d[l].u & ~exec[l].u);
+	}
+}
+
+bool BatchState::Any(const Value *mask) const
+{
+	for(uint32_t l=0; l < m_NumLanes; l++)
+		if(mask[l].u)
+			return true;
+
+	return false;
+}
+
+void BatchState::Condition(const BatchInstruction &inst, Value *out)
+{
+	const uint32_t N = m_NumLanes;
+
+	Value *test = &m_Scratch[0];
+	FetchSrc(inst.src[0], inst.type, test);
+
+	// if, discard, breakc etc all trigger on the same test of .x
+	for(uint32_t l=0; l < N; l++)
+		out[l].u = ((test[l].u != 0) == inst.nonzero) ? ~0U : 0;
+}
+
+BatchState::FlowFrame *BatchState::Retire(const Value *hit, bool toLoop)
+{
+	const uint32_t N = m_NumLanes;
+
+	for(uint32_t l=0; l < N; l++)
+		m_Exec[l].u &= ~hit[l].u;
+
+	// take the lanes out of enclosing ifs (and loops, when leaving the shader)
+	// so they aren't re-enabled when those blocks end
+	for(uint32_t d=m_Depth; d > 0; d--)
+	{
+		FlowFrame &f = m_Frames[d-1];
+
+		if(toLoop && f.type == OPCODE_LOOP)
+			return &f;
+
+		for(uint32_t l=0; l < N; l++)
+			f.saved[l].u &= ~hit[l].u;
+
+		if(f.type == OPCODE_LOOP)
+			for(uint32_t l=0; l < N; l++)
+				f.other[l].u &= ~hit[l].u;
+	}
+
+	return NULL;
+}
+
+void BatchState::Execute(const BatchInstruction &inst)
+{
+	const uint32_t N = m_NumLanes;
+	const uint32_t count = 4*N;
+
+	Value *a = &m_Scratch[0];
+	Value *b = &m_Scratch[count];
+	Value *c = &m_Scratch[count*2];
+	Value *r = &m_Scratch[count*3];
+
+	Value *srcs[3] = { a, b, c };
+
+	for(uint32_t s=0; s < inst.numSrcs; s++)
+		FetchSrc(inst.src[s], inst.type, srcs[s]);
+
+	switch(inst.op)
+	{
+		case OPCODE_ADD:  for(uint32_t i=0; i < count; i++) r[i].f = a[i].f + b[i].f; break;
+		case OPCODE_IADD: for(uint32_t i=0; i < count; i++) r[i].i = a[i].i + b[i].i; break;
+		case OPCODE_MUL:  for(uint32_t i=0; i < count; i++) r[i].f = a[i].f * b[i].f; break;
+		case OPCODE_DIV:  for(uint32_t i=0; i < count; i++) r[i].f = a[i].f / b[i].f; break;
+		case OPCODE_MAD:  for(uint32_t i=0; i < count; i++) r[i].f = a[i].f * b[i].f + c[i].f; break;
+		case OPCODE_IMAD: for(uint32_t i=0; i < count; i++) r[i].i = a[i].i * b[i].i + c[i].i; break;
+		case OPCODE_UMAD: for(uint32_t i=0; i < count; i++) r[i].u = a[i].u * b[i].u + c[i].u; break;
+
+		case OPCODE_DP2:
+		case OPCODE_DP3:
+		case OPCODE_DP4:
+		{
+			uint32_t numComps = inst.op == OPCODE_DP2 ? 2 : (inst.op == OPCODE_DP3 ? 3 : 4);
+
+			for(uint32_t l=0; l < N; l++)
+				r[l].f = a[l].f * b[l].f;
+
+			for(uint32_t comp=1; comp < numComps; comp++)
+				for(uint32_t l=0; l < N; l++)
+					r[l].f += a[comp*N + l].f * b[comp*N + l].f;
+
+			for(uint32_t comp=1; comp < 4; comp++)
+				memcpy(r + comp*N, r, N*sizeof(Value));
+			break;
+		}
+
+		case OPCODE_MIN:  for(uint32_t i=0; i < count; i++) r[i].f = a[i].f < b[i].f ? a[i].f : b[i].f; break;
+		case OPCODE_MAX:  for(uint32_t i=0; i < count; i++) r[i].f = a[i].f >= b[i].f ? a[i].f : b[i].f; break;
+		case OPCODE_IMIN: for(uint32_t i=0; i < count; i++) r[i].i = a[i].i < b[i].i ? a[i].i : b[i].i; break;
+		case OPCODE_IMAX: for(uint32_t i=0; i < count; i++) r[i].i = a[i].i >= b[i].i ? a[i].i : b[i].i; break;
+		case OPCODE_UMIN: for(uint32_t i=0; i < count; i++) r[i].u = a[i].u < b[i].u ? a[i].u : b[i].u; break;
+		case OPCODE_UMAX: for(uint32_t i=0; i < count; i++) r[i].u = a[i].u >= b[i].u ? a[i].u : b[i].u; break;
+
+		case OPCODE_FRC:      for(uint32_t i=0; i < count; i++) r[i].f = a[i].f - floor(a[i].f); break;
+		case OPCODE_ROUND_PI: for(uint32_t i=0; i < count; i++) r[i].f = ceil(a[i].f); break;
+		case OPCODE_ROUND_NI: for(uint32_t i=0; i < count; i++) r[i].f = floor(a[i].f); break;
+		case OPCODE_ROUND_Z:  for(uint32_t i=0; i < count; i++) r[i].f = floor(a[i].f < 0 ? a[i].f + 0.5f : a[i].f); break;
+		case OPCODE_ROUND_NE: for(uint32_t i=0; i < count; i++) r[i].f = round_ne(a[i].f); break;
+		case OPCODE_SQRT:     for(uint32_t i=0; i < count; i++) r[i].f = sqrtf(a[i].f); break;
+		case OPCODE_RSQ:      for(uint32_t i=0; i < count; i++) r[i].f = 1.0f/sqrtf(a[i].f); break;
+		case OPCODE_RCP:      for(uint32_t i=0; i < count; i++) r[i].f = 1.0f/a[i].f; break;
+		case OPCODE_EXP:      for(uint32_t i=0; i < count; i++) r[i].f = powf(2.0f, a[i].f); break;
+		case OPCODE_LOG:      for(uint32_t i=0; i < count; i++) r[i].f = logf(a[i].f)/logf(2.0f); break;
+
+		// shift amounts come from .x, as in State::Step
+		case OPCODE_INEG: for(uint32_t i=0; i < count; i++) r[i].i = -a[i].i; break;
+		case OPCODE_ISHL: for(uint32_t i=0; i < count; i++) r[i].i = a[i].i << b[i%N].i; break;
+		case OPCODE_ISHR: for(uint32_t i=0; i < count; i++) r[i].i = a[i].i >> (b[i%N].u & 0x1f); break;
+		case OPCODE_USHR: for(uint32_t i=0; i < count; i++) r[i].u = a[i].u >> (b[i%N].u & 0x1f); break;
+		case OPCODE_AND:  for(uint32_t i=0; i < count; i++) r[i].u = a[i].u & b[i].u; break;
+		case OPCODE_OR:   for(uint32_t i=0; i < count; i++) r[i].u = a[i].u | b[i].u; break;
+		case OPCODE_XOR:  for(uint32_t i=0; i < count; i++) r[i].u = a[i].u ^ b[i].u; break;
+		case OPCODE_NOT:  for(uint32_t i=0; i < count; i++) r[i].u = ~a[i].u; break;
+
+		case OPCODE_EQ:  for(uint32_t i=0; i < count; i++) r[i].u = a[i].f == b[i].f ? ~0U : 0; break;
+		case OPCODE_NE:  for(uint32_t i=0; i < count; i++) r[i].u = a[i].f != b[i].f ? ~0U : 0; break;
+		case OPCODE_LT:  for(uint32_t i=0; i < count; i++) r[i].u = a[i].f < b[i].f ? ~0U : 0; break;
+		case OPCODE_GE:  for(uint32_t i=0; i < count; i++) r[i].u = a[i].f >= b[i].f ? ~0U : 0; break;
+		case OPCODE_IEQ: for(uint32_t i=0; i < count; i++) r[i].u = a[i].i == b[i].i ? ~0U : 0; break;
+		case OPCODE_INE: for(uint32_t i=0; i < count; i++) r[i].u = a[i].i != b[i].i ? ~0U : 0; break;
+		case OPCODE_ILT: for(uint32_t i=0; i < count; i++) r[i].u = a[i].i < b[i].i ? ~0U : 0; break;
+		case OPCODE_IGE: for(uint32_t i=0; i < count; i++) r[i].u = a[i].i >= b[i].i ? ~0U : 0; break;
+		case OPCODE_ULT: for(uint32_t i=0; i < count; i++) r[i].u = a[i].u < b[i].u ? ~0U : 0; break;
+		case OPCODE_UGE: for(uint32_t i=0; i < count; i++) r[i].u = a[i].u >= b[i].u ? ~0U : 0; break;
+
+		case OPCODE_ITOF: for(uint32_t i=0; i < count; i++) r[i].f = (float)a[i].i; break;
+		case OPCODE_UTOF: for(uint32_t i=0; i < count; i++) r[i].f = (float)a[i].u; break;
+		case OPCODE_FTOI: for(uint32_t i=0; i < count; i++) r[i].i = (int)a[i].f; break;
+		case OPCODE_FTOU: for(uint32_t i=0; i < count; i++) r[i].u = (uint32_t)a[i].f; break;
+
+		case OPCODE_MOV:  memcpy(r, a, count*sizeof(Value)); break;
+		case OPCODE_MOVC: for(uint32_t i=0; i < count; i++) r[i].u = a[i].u ? b[i].u : c[i].u; break;
+
+		case OPCODE_DERIV_RTX:
+		case OPCODE_DERIV_RTX_COARSE:
+		case OPCODE_DERIV_RTX_FINE:
+		case OPCODE_DERIV_RTY:
+		case OPCODE_DERIV_RTY_COARSE:
+		case OPCODE_DERIV_RTY_FINE:
+		{
+			if(N % 4 != 0)
+			{
+				RDCERR("Derivatives need lanes in whole quads, got %u lanes. Undefined results will occur!", N);
+				memset(r, 0, count*sizeof(Value));
+				break;
+			}
+
+			bool fine = (inst.op == OPCODE_DERIV_RTX_FINE || inst.op == OPCODE_DERIV_RTY_FINE);
+			bool ddx = (inst.op == OPCODE_DERIV_RTX || inst.op == OPCODE_DERIV_RTX_COARSE || inst.op == OPCODE_DERIV_RTX_FINE);
+
+			// lanes in a quad are 0 1 / 2 3. x neighbours differ in bit 0 of the
+			// index, y neighbours in bit 1. Coarse uses the top-left pixel's neighbours.
+			uint32_t bit = ddx ? 1 : 2;
+
+			for(uint32_t i=0; i < count; i++)
+			{
+				uint32_t lo = fine ? (i & ~bit) : (i & ~3U);
+				r[i].f = a[lo | bit].f - a[lo].f;
+			}
+			break;
+		}
+
+		case OPCODE_NOP:
+		case OPCODE_CUSTOMDATA:
+			return;
+
+		default:
+			RDCERR("Unexpected operation %d in batch program", inst.op);
+			return;
+	}
+
+	WriteDst(inst, r);
+}
+
+bool BatchState::Run(uint32_t maxSteps)
+{
+	const uint32_t N = m_NumLanes;
+	const uint32_t numInsts = (uint32_t)m_Program.m_Instructions.size();
+
+	Value *exec = &m_Exec[0];
+	Value *cond = &m_Scratch[4*4*N];
+
+	if(!m_Program.IsSupported())
+	{
+		RDCERR("Running a batch program that couldn't be decoded");
+		return true;
+	}
+
+	if(N == 0)
+		return true;
+
+	uint32_t pc = 0;
+
+	for(uint32_t steps=0; pc < numInsts; steps++)
+	{
+		// nothing left running, and nothing waiting at an outer if/loop
+		if(m_Depth == 0 && !Any(exec))
+			break;
+
+		if(steps >= maxSteps)
+			return false;
+
+		const BatchInstruction &inst = m_Program.m_Instructions[pc];
+
+		switch(inst.op)
+		{
+			case OPCODE_IF:
+			{
+				FlowFrame &f = m_Frames[m_Depth++];
+				f.type = OPCODE_IF;
+
+				Condition(inst, cond);
+
+				for(uint32_t l=0; l < N; l++)
+				{
+					f.saved[l].u = exec[l].u;
+					f.other[l].u = exec[l].u & cond[l].u;
+					exec[l].u = f.other[l].u;
+				}
+
+				// skip straight to the else/endif if no lanes took the branch
+				pc = Any(exec) ? pc+1 : inst.jump;
+				break;
+			}
+			case OPCODE_ELSE:
+			{
+				FlowFrame &f = m_Frames[m_Depth-1];
+
+				for(uint32_t l=0; l < N; l++)
+					exec[l].u = f.saved[l].u & ~f.other[l].u;
+
+				pc = Any(exec) ? pc+1 : inst.jump;
+				break;
+			}
+			case OPCODE_ENDIF:
+			{
+				FlowFrame &f = m_Frames[--m_Depth];
+
+				memcpy(exec, f.saved, N*sizeof(Value));
+
+				pc++;
+				break;
+			}
+			case OPCODE_LOOP:
+			{
+				if(!Any(exec))
+				{
+					pc = inst.jump+1;
+					break;
+				}
+
+				FlowFrame &f = m_Frames[m_Depth++];
+				f.type = OPCODE_LOOP;
+				f.start = pc+1;
+
+				memcpy(f.saved, exec, N*sizeof(Value));
+				memset(f.other, 0, N*sizeof(Value));
+
+				pc++;
+				break;
+			}
+			case OPCODE_ENDLOOP:
+			{
+				FlowFrame &f = m_Frames[m_Depth-1];
+
+				// lanes that continued come back in for the next iteration
+				for(uint32_t l=0; l < N; l++)
+				{
+					exec[l].u |= f.other[l].u;
+					f.other[l].u = 0;
+				}
+
+				if(Any(exec))
+				{
+					pc = f.start;
+				}
+				else
+				{
+					// everyone has broken out
+					memcpy(exec, f.saved, N*sizeof(Value));
+					m_Depth--;
+					pc++;
+				}
+				break;
+			}
+			case OPCODE_BREAK:
+			case OPCODE_BREAKC:
+			case OPCODE_CONTINUE:
+			case OPCODE_CONTINUEC:
+			case OPCODE_RET:
+			case OPCODE_RETC:
+			case OPCODE_DISCARD:
+			{
+				if(inst.op == OPCODE_BREAKC || inst.op == OPCODE_CONTINUEC ||
+				   inst.op == OPCODE_RETC || inst.op == OPCODE_DISCARD)
+				{
+					Condition(inst, cond);
+
+					for(uint32_t l=0; l < N; l++)
+						cond[l].u &= exec[l].u;
+				}
+				else
+				{
+					memcpy(cond, exec, N*sizeof(Value));
+				}
+
+				if(inst.op == OPCODE_RET || inst.op == OPCODE_RETC || inst.op == OPCODE_DISCARD)
+				{
+					// assumes not in a function call, as State::Step does
+					Retire(cond, false);
+
+					for(uint32_t l=0; l < N; l++)
+					{
+						m_Alive[l].u &= ~cond[l].u;
+						if(inst.op == OPCODE_DISCARD && cond[l].u)
+							m_Discarded[l] = 1;
+					}
+				}
+				else
+				{
+					FlowFrame *loop = Retire(cond, true);
+
+					RDCASSERT(loop);
+
+					if(loop && (inst.op == OPCODE_CONTINUE || inst.op == OPCODE_CONTINUEC))
+						for(uint32_t l=0; l < N; l++)
+							loop->other[l].u |= cond[l].u;
+				}
+
+				pc++;
+				break;
+			}
+			default:
+			{
+				if(Any(exec))
+					Execute(inst);
+
+				pc++;
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+}; // namespace ShaderDebug
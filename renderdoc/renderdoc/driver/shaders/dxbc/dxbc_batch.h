@@ -0,0 +1,209 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2014 Crytek
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#pragma once
+
+#include "api/replay/renderdoc_replay.h"
+#include "dxbc_disassemble.h"
+
+namespace DXBC { class DXBCFile; }
+
+// Batch interpreter for running one shader over many lanes (pixels, quads or
+// threads) at once, e.g. to re-evaluate a pixel shader over a whole target.
+//
+// Unlike State::Step which walks ASMOperation and builds ShaderVariables for
+// every instruction, the program is decoded once per DXBCFile into fixed-size
+// instructions with all operand lookups resolved, and register files are kept
+// as structure-of-arrays - register, then component, then lane - so each
+// operation is a flat loop over lanes. Divergent control flow is handled with
+// per-lane execution masks.
+//
+// Only the ALU and flow control subset is covered: anything touching resources,
+// doubles, switch statements or subroutines marks the program as unsupported
+// and callers should fall back to ShaderDebug::State.
+namespace ShaderDebug
+{
+
+enum BatchRegFile
+{
+	eBatchReg_Null = 0,
+	eBatchReg_Temp,
+	eBatchReg_IndexableTemp,
+	eBatchReg_Input,
+	eBatchReg_Output,
+	eBatchReg_ConstantBuffer,
+	eBatchReg_ImmediateCB,
+	eBatchReg_Immediate,
+};
+
+struct BatchOperand
+{
+	BatchRegFile file;
+
+	// register index, or indexable temp array/cbuffer slot
+	uint32_t reg;
+	// element in an indexable temp or cbuffer
+	uint32_t element;
+
+	// temp register and component added to the last index, or ~0U if the
+	// operand isn't relatively addressed
+	uint32_t relReg;
+	uint32_t relComp;
+
+	// source swizzle, with unspecified components filled as GetSrc does
+	uint8_t comps[4];
+	// destination write mask (bit per component)
+	uint8_t mask;
+	// destination with a single component, written from the result's .x
+	bool scalar;
+
+	DXBC::OperandModifier modifier;
+
+	uint32_t values[4];
+};
+
+struct BatchInstruction
+{
+	DXBC::OpcodeType op;
+	VarType type;
+
+	bool saturate;
+	bool nonzero;
+
+	uint32_t numSrcs;
+
+	// matching else/endif for if, endif for else, endloop for loop, loop for endloop
+	uint32_t jump;
+
+	BatchOperand dst;
+	BatchOperand src[3];
+};
+
+class BatchProgram
+{
+	public:
+		BatchProgram(DXBC::DXBCFile *dxbc);
+
+		bool IsSupported() const { return m_Supported; }
+
+	private:
+		friend class BatchState;
+
+		bool Decode(const DXBC::ASMOperand &oper, BatchOperand &ret);
+
+		bool m_Supported;
+
+		vector<BatchInstruction> m_Instructions;
+		uint32_t m_MaxDepth;
+
+		uint32_t m_NumTemps;
+		vector<uint32_t> m_IndexTempOffsets;
+		vector<uint32_t> m_IndexTempSizes;
+
+		vector<uint32_t> m_Immediate;
+};
+
+class BatchState
+{
+	public:
+		// cbuffers and default inputs come from trace, register layout and initial
+		// output values from initial. For pixel shaders numLanes must be a multiple
+		// of 4, with each run of 4 lanes forming a quad for derivatives.
+		BatchState(const BatchProgram &program, const ShaderDebugTrace &trace, const ShaderDebugState &initial, uint32_t numLanes);
+
+		uint32_t GetNumLanes() const { return m_NumLanes; }
+
+		void SetInput(uint32_t lane, uint32_t reg, const ShaderVariable &var);
+
+		// lane takes part in derivatives but doesn't execute (like State::SetHelper)
+		void SetHelper(uint32_t lane);
+
+		// runs until every lane has finished, or maxSteps instructions have been issued.
+		// Returns false if it stopped at the limit
+		bool Run(uint32_t maxSteps = ~0U);
+
+		bool IsDiscarded(uint32_t lane) const { return m_Discarded[lane] != 0; }
+		ShaderVariable GetOutput(uint32_t lane, uint32_t reg) const;
+		ShaderVariable GetTemp(uint32_t lane, uint32_t reg) const;
+
+	private:
+		union Value
+		{
+			uint32_t u;
+			int32_t i;
+			float f;
+		};
+
+		struct FlowFrame
+		{
+			DXBC::OpcodeType type;
+			uint32_t start;
+			// mask on entry to the if/loop
+			Value *saved;
+			// lanes that took the if, or lanes that continued the loop
+			Value *other;
+		};
+
+		Value *Reg(BatchRegFile file, uint32_t reg, uint32_t comp);
+		const Value *Reg(BatchRegFile file, uint32_t reg, uint32_t comp) const;
+		uint32_t Element(const BatchOperand &oper, uint32_t lane) const;
+
+		void FetchSrc(const BatchOperand &oper, VarType type, Value *out);
+		void WriteDst(const BatchInstruction &inst, Value *res);
+		void Execute(const BatchInstruction &inst);
+
+		bool Any(const Value *mask) const;
+		void Condition(const BatchInstruction &inst, Value *out);
+		FlowFrame *Retire(const Value *hit, bool toLoop);
+
+		const BatchProgram &m_Program;
+		uint32_t m_NumLanes;
+
+		uint32_t m_NumInputs;
+		uint32_t m_NumOutputs;
+		rdctype::array<ShaderVariable> m_OutputLayout;
+
+		// register file, see Reg() for the layout
+		vector<Value> m_Regs;
+		size_t m_FileBase[eBatchReg_Output+1];
+		uint32_t m_FileRegs[eBatchReg_Output+1];
+
+		vector<Value> m_CBData;
+		vector<uint32_t> m_CBOffsets;
+		vector<uint32_t> m_CBCounts;
+
+		// scratch space for operands and the result, 4 components x lanes each
+		vector<Value> m_Scratch;
+
+		vector<Value> m_Exec;
+		vector<Value> m_Alive;
+		vector<uint32_t> m_Discarded;
+
+		vector<FlowFrame> m_Frames;
+		vector<Value> m_FrameMasks;
+		uint32_t m_Depth;
+};
+
+}; // namespace ShaderDebug
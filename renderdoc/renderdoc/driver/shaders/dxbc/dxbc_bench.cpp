@@ -0,0 +1,440 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2014 Crytek
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+// Standalone harness for the DXBC interpreter, built by the Makefile in this
+// directory. Every DXBC blob in a directory is disassembled and then run on
+// the CPU with synthetic inputs, both through ShaderDebug::State and (where
+// supported) ShaderDebug::BatchState, reporting throughput and allocations.
+// Nothing here needs a D3D11 device so it can run on machines without a GPU.
+//
+// dxbc_bench <directory> [iterations]
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <new>
+
+#include "common/common.h"
+#include "common/timing.h"
+#include "replay/type_helpers.h"
+#include "dxbc_batch.h"
+#include "dxbc_debug.h"
+#include "dxbc_inspect.h"
+
+static uint64_t allocCount = 0;
+static uint64_t allocBytes = 0;
+
+void *operator new(size_t size)
+{
+	allocCount++;
+	allocBytes += size;
+
+	void *ret = malloc(size ? size : 1);
+	if(ret == NULL)
+		throw std::bad_alloc();
+	return ret;
+}
+
+void *operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+	free(p);
+}
+
+// don't let a shader that loops on synthetic data run forever
+static const uint32_t MaxSteps = 1<<20;
+
+// lanes per BatchState run, a multiple of 4 so pixel shaders form quads
+static const uint32_t BatchLanes = 64;
+
+struct BenchStats
+{
+	BenchStats() { instructions = 0; allocs = 0; ms = 0.0; }
+
+	uint64_t instructions;
+	uint64_t allocs;
+	double ms;
+};
+
+static bool ReadBlob(const string &path, vector<byte> &blob)
+{
+	FILE *f = fopen(path.c_str(), "rb");
+
+	if(f == NULL)
+		return false;
+
+	fseek(f, 0, SEEK_END);
+	long len = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	blob.resize(len > 0 ? (size_t)len : 0);
+	size_t read = blob.empty() ? 0 : fread(&blob[0], 1, blob.size(), f);
+
+	fclose(f);
+
+	// only bother with files that start with the DXBC fourcc
+	return read == blob.size() && blob.size() >= 4 && !memcmp(&blob[0], "DXBC", 4);
+}
+
+static ShaderVariable SyntheticVar(const char *name, uint32_t reg, VarType type, uint32_t columns)
+{
+	ShaderVariable v(name, 0U, 0U, 0U, 0U);
+
+	v.type = type;
+	v.rows = 1;
+	v.columns = columns;
+
+	for(uint32_t c=0; c < 4; c++)
+	{
+		if(type == eVar_Float)
+			v.value.fv[c] = float(reg+1)*0.25f + float(c)*0.125f;
+		else
+			v.value.uv[c] = reg*4 + c;
+	}
+
+	return v;
+}
+
+// same register layout as D3D11DebugManager::CreateShaderDebugState, but with
+// patterned data in place of real vertex/pixel inputs and cbuffer contents.
+static ShaderDebug::State CreateState(ShaderDebugTrace &trace, int quadIdx, DXBC::DXBCFile *dxbc)
+{
+	using namespace DXBC;
+	using namespace ShaderDebug;
+
+	State state(quadIdx, &trace, dxbc, NULL);
+
+	int32_t maxReg = -1;
+	for(size_t i=0; i < dxbc->m_InputSig.size(); i++)
+		maxReg = RDCMAX(maxReg, (int32_t)dxbc->m_InputSig[i].regIndex);
+
+	if(maxReg >= 0)
+	{
+		create_array(trace.inputs, maxReg+1);
+		for(size_t i=0; i < dxbc->m_InputSig.size(); i++)
+		{
+			SigParameter &sig = dxbc->m_InputSig[i];
+
+			VarType type = eVar_Float;
+			if(sig.compType == eCompType_UInt)
+				type = eVar_UInt;
+			else if(sig.compType == eCompType_SInt)
+				type = eVar_Int;
+
+			trace.inputs[sig.regIndex] = SyntheticVar(StringFormat::Fmt("v%u", sig.regIndex).c_str(), sig.regIndex, type, 4);
+		}
+	}
+
+	maxReg = -1;
+	for(size_t i=0; i < dxbc->m_OutputSig.size(); i++)
+		if(dxbc->m_OutputSig[i].regIndex != ~0U)
+			maxReg = RDCMAX(maxReg, (int32_t)dxbc->m_OutputSig[i].regIndex);
+
+	if(maxReg >= 0)
+	{
+		create_array(state.outputs, maxReg+1);
+		for(int32_t i=0; i <= maxReg; i++)
+		{
+			state.outputs[i] = ShaderVariable(StringFormat::Fmt("o%d", i).c_str(), 0U, 0U, 0U, 0U);
+			state.outputs[i].columns = 4;
+		}
+	}
+
+	create_array(trace.cbuffers, dxbc->m_CBuffers.size());
+	for(size_t i=0; i < dxbc->m_CBuffers.size(); i++)
+	{
+		if(dxbc->m_CBuffers[i].descriptor.type != CBuffer::Descriptor::TYPE_CBUFFER)
+			continue;
+
+		uint32_t vec4s = (dxbc->m_CBuffers[i].descriptor.byteSize + 15)/16;
+
+		create_array(trace.cbuffers[i], vec4s);
+		for(uint32_t c=0; c < vec4s; c++)
+			trace.cbuffers[i][c] = SyntheticVar(StringFormat::Fmt("cb%u[%u]", (uint32_t)i, c).c_str(), c, eVar_Float, 4);
+	}
+
+	state.Init();
+
+	return state;
+}
+
+static void CreateGlobalState(ShaderDebug::GlobalState &global, DXBC::DXBCFile *dxbc)
+{
+	for(size_t i=0; i < dxbc->GetNumDeclarations(); i++)
+	{
+		const DXBC::ASMDecl &decl = dxbc->GetDeclaration(i);
+
+		if(decl.declaration == DXBC::OPCODE_DCL_THREAD_GROUP_SHARED_MEMORY_RAW ||
+		   decl.declaration == DXBC::OPCODE_DCL_THREAD_GROUP_SHARED_MEMORY_STRUCTURED)
+		{
+			uint32_t slot = (uint32_t)decl.operand.indices[0].index;
+
+			if(global.groupshared.size() <= slot)
+				global.groupshared.resize(slot+1);
+
+			ShaderDebug::GlobalState::groupsharedMem &mem = global.groupshared[slot];
+
+			mem.structured = (decl.declaration == DXBC::OPCODE_DCL_THREAD_GROUP_SHARED_MEMORY_STRUCTURED);
+			mem.count = decl.count;
+			mem.bytestride = mem.structured ? decl.stride : 4;
+			mem.data.resize(mem.bytestride*mem.count);
+		}
+	}
+}
+
+// runs one quad (pixel shaders) or one thread (everything else) to completion,
+// returning the final state of the first lane and how many steps it took.
+static ShaderDebug::State RunState(DXBC::DXBCFile *dxbc, BenchStats &stats, uint32_t &steps)
+{
+	using namespace ShaderDebug;
+
+	ShaderDebugTrace trace;
+	GlobalState global;
+
+	CreateGlobalState(global, dxbc);
+
+	uint64_t allocs = allocCount;
+	PerformanceTimer timer;
+
+	if(dxbc->m_Type == D3D11_SHVER_PIXEL_SHADER)
+	{
+		State quad[4];
+		State quad2[4];
+
+		for(int i=0; i < 4; i++)
+			quad[i] = CreateState(trace, i, dxbc);
+
+		State *curquad = quad;
+		State *newquad = quad2;
+
+		for(steps=0; steps < MaxSteps && !curquad[0].Finished(); steps++)
+		{
+			for(int i=0; i < 4; i++)
+			{
+				if(!curquad[i].Finished())
+					stats.instructions++;
+				newquad[i] = curquad[i].GetNext(global, curquad);
+			}
+
+			State *a = curquad;
+			curquad = newquad;
+			newquad = a;
+		}
+
+		stats.ms += timer.GetMilliseconds();
+		stats.allocs += allocCount - allocs;
+
+		return curquad[0];
+	}
+
+	State state = CreateState(trace, -1, dxbc);
+
+	for(steps=0; steps < MaxSteps && !state.Finished(); steps++)
+	{
+		state.Step(global, NULL);
+		stats.instructions++;
+	}
+
+	stats.ms += timer.GetMilliseconds();
+	stats.allocs += allocCount - allocs;
+
+	return state;
+}
+
+// runs a batch of lanes with the same inputs as RunState. If the reference run was cut short
+// at MaxSteps its outputs aren't final, so the batch is timed but not compared against it.
+static void RunBatch(DXBC::DXBCFile *dxbc, const ShaderDebug::State &reference, uint32_t steps, BenchStats &stats, uint32_t &mismatches)
+{
+	using namespace ShaderDebug;
+
+	const BatchProgram *program = dxbc->GetBatchProgram();
+
+	ShaderDebugTrace trace;
+	State initial = CreateState(trace, -1, dxbc);
+
+	uint64_t allocs = allocCount;
+	PerformanceTimer timer;
+
+	BatchState batch(*program, trace, initial, BatchLanes);
+
+	for(uint32_t l=0; l < BatchLanes; l++)
+		for(int32_t r=0; r < trace.inputs.count; r++)
+			batch.SetInput(l, (uint32_t)r, trace.inputs[r]);
+
+	bool finished = batch.Run(MaxSteps);
+
+	stats.ms += timer.GetMilliseconds();
+	stats.allocs += allocCount - allocs;
+	stats.instructions += uint64_t(steps)*BatchLanes;
+
+	if(!reference.Finished())
+		return;
+
+	// the reference finished within the limit, so the batch should have too
+	if(!finished)
+	{
+		mismatches += BatchLanes;
+		return;
+	}
+
+	// every lane had the same inputs so every lane should match the State result
+	for(uint32_t l=0; l < BatchLanes; l++)
+	{
+		for(int32_t r=0; r < reference.outputs.count; r++)
+		{
+			ShaderVariable out = batch.GetOutput(l, (uint32_t)r);
+
+			if(memcmp(out.value.uv, reference.outputs[r].value.uv, sizeof(uint32_t)*4))
+				mismatches++;
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	if(argc < 2)
+	{
+		fprintf(stderr, "Usage: %s <directory of DXBC blobs> [iterations]\n", argv[0]);
+		return 1;
+	}
+
+	string dirname = argv[1];
+	uint32_t iterations = argc > 2 ? (uint32_t)atoi(argv[2]) : 1;
+	if(iterations == 0)
+		iterations = 1;
+
+	DIR *dir = opendir(dirname.c_str());
+
+	if(dir == NULL)
+	{
+		fprintf(stderr, "Couldn't open directory '%s'\n", dirname.c_str());
+		return 1;
+	}
+
+	vector<string> files;
+
+	for(dirent *ent = readdir(dir); ent; ent = readdir(dir))
+		if(ent->d_name[0] != '.')
+			files.push_back(dirname + "/" + ent->d_name);
+
+	closedir(dir);
+
+	std::sort(files.begin(), files.end());
+
+	BenchStats totalState, totalBatch;
+	uint32_t numShaders = 0, numBatched = 0, failures = 0;
+
+	for(size_t f=0; f < files.size(); f++)
+	{
+		vector<byte> blob;
+		if(!ReadBlob(files[f], blob))
+			continue;
+
+		DXBC::DXBCFile *dxbc = new DXBC::DXBCFile(&blob[0], blob.size());
+
+		PerformanceTimer disasmTimer;
+		size_t disasmLen = dxbc->GetDisassembly().size();
+		double disasmMS = disasmTimer.GetMilliseconds();
+
+		BenchStats state, batch;
+		uint32_t mismatches = 0;
+		bool truncated = false;
+
+		bool batched = dxbc->GetBatchProgram()->IsSupported();
+
+		for(uint32_t i=0; i < iterations; i++)
+		{
+			uint32_t steps = 0;
+			ShaderDebug::State result = RunState(dxbc, state, steps);
+
+			if(!result.Finished())
+				truncated = true;
+
+			if(batched)
+				RunBatch(dxbc, result, steps, batch, mismatches);
+		}
+
+		printf("%s: %zu instructions, %zu bytes disassembly in %.3f ms\n", files[f].c_str(),
+		       dxbc->GetNumInstructions(), disasmLen, disasmMS);
+		printf("  State:      %llu steps in %.3f ms (%.0f instr/s), %llu allocations\n",
+		       (unsigned long long)state.instructions, state.ms,
+		       state.ms > 0.0 ? double(state.instructions)*1000.0/state.ms : 0.0, (unsigned long long)state.allocs);
+
+		if(truncated)
+			printf("  stopped after %u steps, batch results not compared\n", MaxSteps);
+
+		if(batched)
+		{
+			printf("  BatchState: %llu lane-steps in %.3f ms (%.0f instr/s), %llu allocations, %u mismatches\n",
+			       (unsigned long long)batch.instructions, batch.ms,
+			       batch.ms > 0.0 ? double(batch.instructions)*1000.0/batch.ms : 0.0, (unsigned long long)batch.allocs, mismatches);
+		}
+
+		numShaders++;
+		if(batched)
+			numBatched++;
+		if(mismatches > 0)
+			failures++;
+
+		totalState.instructions += state.instructions;
+		totalState.allocs += state.allocs;
+		totalState.ms += state.ms;
+		totalBatch.instructions += batch.instructions;
+		totalBatch.allocs += batch.allocs;
+		totalBatch.ms += batch.ms;
+
+		SAFE_DELETE(dxbc);
+	}
+
+	printf("\n%u shaders, %u batched, %u with mismatched batch results\n", numShaders, numBatched, failures);
+	printf("State:      %.0f instr/s, %.1f allocations per step\n",
+	       totalState.ms > 0.0 ? double(totalState.instructions)*1000.0/totalState.ms : 0.0,
+	       totalState.instructions > 0 ? double(totalState.allocs)/double(totalState.instructions) : 0.0);
+	printf("BatchState: %.0f instr/s, %.1f allocations per step\n",
+	       totalBatch.ms > 0.0 ? double(totalBatch.instructions)*1000.0/totalBatch.ms : 0.0,
+	       totalBatch.instructions > 0 ? double(totalBatch.allocs)/double(totalBatch.instructions) : 0.0);
+
+	return failures > 0 ? 2 : 0;
+}
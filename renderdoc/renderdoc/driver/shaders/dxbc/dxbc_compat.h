@@ -0,0 +1,93 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2014 Crytek
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#pragma once
+
+// The DXBC code only needs a couple of types from the D3D headers. On windows
+// those come from the SDK, elsewhere they're declared here so that container
+// parsing, disassembly and CPU-side debugging can build without it.
+
+#if defined(WIN32)
+
+// defined in d3d11shader.h, which the .cpp files include
+enum D3D11_SHADER_VERSION_TYPE;
+
+#else
+
+#include <stdint.h>
+#include <strings.h>
+
+enum D3D11_SHADER_VERSION_TYPE
+{
+	D3D11_SHVER_PIXEL_SHADER    = 0,
+	D3D11_SHVER_VERTEX_SHADER   = 1,
+	D3D11_SHVER_GEOMETRY_SHADER = 2,
+	D3D11_SHVER_HULL_SHADER     = 3,
+	D3D11_SHVER_DOMAIN_SHADER   = 4,
+	D3D11_SHVER_COMPUTE_SHADER  = 5,
+
+	D3D11_SHVER_RESERVED0       = 0xFFF0,
+};
+
+struct GUID
+{
+	uint32_t Data1;
+	uint16_t Data2;
+	uint16_t Data3;
+	uint8_t Data4[8];
+};
+
+typedef uint32_t DWORD;
+
+#define _stricmp strcasecmp
+
+inline unsigned char _BitScanForward(unsigned long *index, unsigned long mask)
+{
+	if(mask == 0)
+		return 0;
+
+	*index = (unsigned long)__builtin_ctzl(mask);
+	return 1;
+}
+
+inline unsigned char BitScanForward(DWORD *index, DWORD mask)
+{
+	if(mask == 0)
+		return 0;
+
+	*index = (DWORD)__builtin_ctz(mask);
+	return 1;
+}
+
+inline unsigned char BitScanReverse(DWORD *index, DWORD mask)
+{
+	if(mask == 0)
+		return 0;
+
+	*index = 31 - (DWORD)__builtin_clz(mask);
+	return 1;
+}
+
+#endif
@@ -24,13 +24,16 @@
 
 
 // TODO remove me
+#if defined(WIN32)
 #include "driver/d3d11/d3d11_device.h"
 #include <d3d11shader.h>
+#endif
 
 #include <math.h>
 
 #include "common/common.h"
 #include "maths/formatpacking.h"
+#include "replay/type_helpers.h"
 #include "dxbc_debug.h"
 #include "dxbc_inspect.h"
 
@@ -41,7 +44,7 @@ using namespace DXBC;
 namespace ShaderDebug
 {
 
-static float round_ne(float x)
+float round_ne(float x)
 {
 	// if on 0.5 boundary
 	if(int(x + 0.5f) != int(x))
@@ -51,7 +54,7 @@ static float round_ne(float x)
 	return x < 0 ? x + 0.5f : x;
 }
 	
-VarType State::OperationType(const OpcodeType &op) const
+VarType State::OperationType(const OpcodeType &op)
 {
 	switch(op)
 	{
@@ -529,7 +532,7 @@ void State::Init()
 
 				StringFormat::snprintf(buf, 63, "r%d", t);
 
-				registers[t] = ShaderVariable(buf, 0l, 0l, 0l, 0l);
+				registers[t] = ShaderVariable(buf, 0U, 0U, 0U, 0U);
 			}
 		}
 		if(decl.declaration == OPCODE_DCL_INDEXABLE_TEMP)
@@ -558,7 +561,7 @@ void State::Init()
 
 					StringFormat::snprintf(buf, 63, "x%u[%u]", i, t);
 
-					indexableTemps[i][t] = ShaderVariable(buf, 0l, 0l, 0l, 0l);
+					indexableTemps[i][t] = ShaderVariable(buf, 0U, 0U, 0U, 0U);
 				}
 			}
 		}
@@ -573,6 +576,9 @@ bool State::Finished() const
 void State::SetDst(const ASMOperand &dstoper, const ASMOperation &op, const ShaderVariable &val)
 {
 	ShaderVariable *v = NULL;
+
+	ShaderDebugChange change;
+	RDCEraseEl(change);
 	
 	uint32_t indices[4] = {0};
 
@@ -600,6 +606,8 @@ void State::SetDst(const ASMOperand &dstoper, const ASMOperation &op, const Shad
 			RDCASSERT(indices[0] < (uint32_t)registers.count);
 			if(indices[0] < (uint32_t)registers.count)
 				v = &registers[(size_t)indices[0]];
+			change.type = eDebugReg_Temp;
+			change.index = indices[0];
 			break;
 		}
 		case TYPE_INDEXABLE_TEMP:
@@ -615,6 +623,9 @@ void State::SetDst(const ASMOperand &dstoper, const ASMOperation &op, const Shad
 					if(indices[1] < (uint32_t)indexableTemps[ indices[0] ].count)
 					{
 						v = &indexableTemps[ indices[0] ][ indices[1] ];
+						change.type = eDebugReg_IndexableTemp;
+						change.index = indices[0];
+						change.element = indices[1];
 					}
 				}
 			}
@@ -625,6 +636,8 @@ void State::SetDst(const ASMOperand &dstoper, const ASMOperation &op, const Shad
 			RDCASSERT(indices[0] < (uint32_t)outputs.count);
 			if(indices[0] < (uint32_t)outputs.count)
 				v = &outputs[(size_t)indices[0]];
+			change.type = eDebugReg_Output;
+			change.index = indices[0];
 			break;
 		}
 		case TYPE_INPUT:
@@ -649,6 +662,8 @@ void State::SetDst(const ASMOperand &dstoper, const ASMOperation &op, const Shad
 				if(outputs[i].name.elems && !strcmp(name.c_str(), outputs[i].name.elems))
 				{
 					v = &outputs[i];
+					change.type = eDebugReg_Output;
+					change.index = (uint32_t)i;
 					break;
 				}
 			}
@@ -702,6 +717,11 @@ void State::SetDst(const ASMOperand &dstoper, const ASMOperation &op, const Shad
 			if(compsWritten == 0)
 				v->value.uv[0] = right.value.uv[0];
 		}
+
+		for(size_t i=0; i < 4; i++)
+			change.value[i] = v->value.uv[i];
+
+		changes.push_back(change);
 	}
 }
 
@@ -1023,9 +1043,18 @@ ShaderVariable State::GetSrc(const ASMOperand &oper, const ASMOperation &op) con
 State State::GetNext(GlobalState &global, State quad[4]) const
 {
 	State s = *this;
+	s.Step(global, quad);
+	return s;
+}
+
+void State::Step(GlobalState &global, State quad[4])
+{
+	State &s = *this;
+
+	s.changes.clear();
 
 	if(s.nextInstruction >= s.dxbc->GetNumInstructions())
-		return s;
+		return;
 
 	const ASMOperation &op = s.dxbc->GetInstruction((size_t)s.nextInstruction);
 
@@ -1729,31 +1758,31 @@ State State::GetNext(GlobalState &global, State quad[4]) const
 
 		case OPCODE_EQ:
 			s.SetDst(op.operands[0], op, ShaderVariable("",
-												(srcOpers[0].value.f.x == srcOpers[1].value.f.x ? ~0l : 0l),
-												(srcOpers[0].value.f.y == srcOpers[1].value.f.y ? ~0l : 0l),
-												(srcOpers[0].value.f.z == srcOpers[1].value.f.z ? ~0l : 0l),
-												(srcOpers[0].value.f.w == srcOpers[1].value.f.w ? ~0l : 0l) ));
+												(srcOpers[0].value.f.x == srcOpers[1].value.f.x ? ~0U : 0U),
+												(srcOpers[0].value.f.y == srcOpers[1].value.f.y ? ~0U : 0U),
+												(srcOpers[0].value.f.z == srcOpers[1].value.f.z ? ~0U : 0U),
+												(srcOpers[0].value.f.w == srcOpers[1].value.f.w ? ~0U : 0U) ));
 			break;
 		case OPCODE_NE:
 			s.SetDst(op.operands[0], op, ShaderVariable("",
-												(srcOpers[0].value.f.x != srcOpers[1].value.f.x ? ~0l : 0l),
-												(srcOpers[0].value.f.y != srcOpers[1].value.f.y ? ~0l : 0l),
-												(srcOpers[0].value.f.z != srcOpers[1].value.f.z ? ~0l : 0l),
-												(srcOpers[0].value.f.w != srcOpers[1].value.f.w ? ~0l : 0l) ));
+												(srcOpers[0].value.f.x != srcOpers[1].value.f.x ? ~0U : 0U),
+												(srcOpers[0].value.f.y != srcOpers[1].value.f.y ? ~0U : 0U),
+												(srcOpers[0].value.f.z != srcOpers[1].value.f.z ? ~0U : 0U),
+												(srcOpers[0].value.f.w != srcOpers[1].value.f.w ? ~0U : 0U) ));
 			break;
 		case OPCODE_LT:
 			s.SetDst(op.operands[0], op, ShaderVariable("",
-												(srcOpers[0].value.f.x < srcOpers[1].value.f.x ? ~0l : 0l),
-												(srcOpers[0].value.f.y < srcOpers[1].value.f.y ? ~0l : 0l),
-												(srcOpers[0].value.f.z < srcOpers[1].value.f.z ? ~0l : 0l),
-												(srcOpers[0].value.f.w < srcOpers[1].value.f.w ? ~0l : 0l) ));
+												(srcOpers[0].value.f.x < srcOpers[1].value.f.x ? ~0U : 0U),
+												(srcOpers[0].value.f.y < srcOpers[1].value.f.y ? ~0U : 0U),
+												(srcOpers[0].value.f.z < srcOpers[1].value.f.z ? ~0U : 0U),
+												(srcOpers[0].value.f.w < srcOpers[1].value.f.w ? ~0U : 0U) ));
 			break;
 		case OPCODE_GE:
 			s.SetDst(op.operands[0], op, ShaderVariable("",
-												(srcOpers[0].value.f.x >= srcOpers[1].value.f.x ? ~0l : 0l),
-												(srcOpers[0].value.f.y >= srcOpers[1].value.f.y ? ~0l : 0l),
-												(srcOpers[0].value.f.z >= srcOpers[1].value.f.z ? ~0l : 0l),
-												(srcOpers[0].value.f.w >= srcOpers[1].value.f.w ? ~0l : 0l) ));
+												(srcOpers[0].value.f.x >= srcOpers[1].value.f.x ? ~0U : 0U),
+												(srcOpers[0].value.f.y >= srcOpers[1].value.f.y ? ~0U : 0U),
+												(srcOpers[0].value.f.z >= srcOpers[1].value.f.z ? ~0U : 0U),
+												(srcOpers[0].value.f.w >= srcOpers[1].value.f.w ? ~0U : 0U) ));
 			break;
 		case OPCODE_DEQ:
 		case OPCODE_DNE:
@@ -1769,20 +1798,20 @@ State State::GetNext(GlobalState &global, State quad[4]) const
 			switch(op.operation)
 			{
 				case OPCODE_DEQ:
-					cmp1 = (src0[0] == src1[0] ? ~0l : 0l);
-					cmp2 = (src0[1] == src1[1] ? ~0l : 0l);
+					cmp1 = (src0[0] == src1[0] ? ~0U : 0U);
+					cmp2 = (src0[1] == src1[1] ? ~0U : 0U);
 					break;
 				case OPCODE_DNE:
-					cmp1 = (src0[0] != src1[0] ? ~0l : 0l);
-					cmp2 = (src0[1] != src1[1] ? ~0l : 0l);
+					cmp1 = (src0[0] != src1[0] ? ~0U : 0U);
+					cmp2 = (src0[1] != src1[1] ? ~0U : 0U);
 					break;
 				case OPCODE_DGE:
-					cmp1 = (src0[0] >= src1[0] ? ~0l : 0l);
-					cmp2 = (src0[1] >= src1[1] ? ~0l : 0l);
+					cmp1 = (src0[0] >= src1[0] ? ~0U : 0U);
+					cmp2 = (src0[1] >= src1[1] ? ~0U : 0U);
 					break;
 				case OPCODE_DLT:
-					cmp1 = (src0[0] < src1[0] ? ~0l : 0l);
-					cmp2 = (src0[1] < src1[1] ? ~0l : 0l);
+					cmp1 = (src0[0] < src1[0] ? ~0U : 0U);
+					cmp2 = (src0[1] < src1[1] ? ~0U : 0U);
 					break;
 			}
 
@@ -1807,45 +1836,45 @@ State State::GetNext(GlobalState &global, State quad[4]) const
 		}
 		case OPCODE_IEQ:
 			s.SetDst(op.operands[0], op, ShaderVariable("",
-												(srcOpers[0].value.i.x == srcOpers[1].value.i.x ? ~0l : 0l),
-												(srcOpers[0].value.i.y == srcOpers[1].value.i.y ? ~0l : 0l),
-												(srcOpers[0].value.i.z == srcOpers[1].value.i.z ? ~0l : 0l),
-												(srcOpers[0].value.i.w == srcOpers[1].value.i.w ? ~0l : 0l) ));
+												(srcOpers[0].value.i.x == srcOpers[1].value.i.x ? ~0U : 0U),
+												(srcOpers[0].value.i.y == srcOpers[1].value.i.y ? ~0U : 0U),
+												(srcOpers[0].value.i.z == srcOpers[1].value.i.z ? ~0U : 0U),
+												(srcOpers[0].value.i.w == srcOpers[1].value.i.w ? ~0U : 0U) ));
 			break;
 		case OPCODE_INE:
 			s.SetDst(op.operands[0], op, ShaderVariable("",
-												(srcOpers[0].value.i.x != srcOpers[1].value.i.x ? ~0l : 0l),
-												(srcOpers[0].value.i.y != srcOpers[1].value.i.y ? ~0l : 0l),
-												(srcOpers[0].value.i.z != srcOpers[1].value.i.z ? ~0l : 0l),
-												(srcOpers[0].value.i.w != srcOpers[1].value.i.w ? ~0l : 0l) ));
+												(srcOpers[0].value.i.x != srcOpers[1].value.i.x ? ~0U : 0U),
+												(srcOpers[0].value.i.y != srcOpers[1].value.i.y ? ~0U : 0U),
+												(srcOpers[0].value.i.z != srcOpers[1].value.i.z ? ~0U : 0U),
+												(srcOpers[0].value.i.w != srcOpers[1].value.i.w ? ~0U : 0U) ));
 			break;
 		case OPCODE_IGE:
 			s.SetDst(op.operands[0], op, ShaderVariable("",
-												(srcOpers[0].value.i.x >= srcOpers[1].value.i.x ? ~0l : 0l),
-												(srcOpers[0].value.i.y >= srcOpers[1].value.i.y ? ~0l : 0l),
-												(srcOpers[0].value.i.z >= srcOpers[1].value.i.z ? ~0l : 0l),
-												(srcOpers[0].value.i.w >= srcOpers[1].value.i.w ? ~0l : 0l) ));
+												(srcOpers[0].value.i.x >= srcOpers[1].value.i.x ? ~0U : 0U),
+												(srcOpers[0].value.i.y >= srcOpers[1].value.i.y ? ~0U : 0U),
+												(srcOpers[0].value.i.z >= srcOpers[1].value.i.z ? ~0U : 0U),
+												(srcOpers[0].value.i.w >= srcOpers[1].value.i.w ? ~0U : 0U) ));
 			break;
 		case OPCODE_ILT:
 			s.SetDst(op.operands[0], op, ShaderVariable("",
-												(srcOpers[0].value.i.x < srcOpers[1].value.i.x ? ~0l : 0l),
-												(srcOpers[0].value.i.y < srcOpers[1].value.i.y ? ~0l : 0l),
-												(srcOpers[0].value.i.z < srcOpers[1].value.i.z ? ~0l : 0l),
-												(srcOpers[0].value.i.w < srcOpers[1].value.i.w ? ~0l : 0l) ));
+												(srcOpers[0].value.i.x < srcOpers[1].value.i.x ? ~0U : 0U),
+												(srcOpers[0].value.i.y < srcOpers[1].value.i.y ? ~0U : 0U),
+												(srcOpers[0].value.i.z < srcOpers[1].value.i.z ? ~0U : 0U),
+												(srcOpers[0].value.i.w < srcOpers[1].value.i.w ? ~0U : 0U) ));
 			break;
 		case OPCODE_ULT:
 			s.SetDst(op.operands[0], op, ShaderVariable("",
-												(srcOpers[0].value.u.x < srcOpers[1].value.u.x ? ~0l : 0l),
-												(srcOpers[0].value.u.y < srcOpers[1].value.u.y ? ~0l : 0l),
-												(srcOpers[0].value.u.z < srcOpers[1].value.u.z ? ~0l : 0l),
-												(srcOpers[0].value.u.w < srcOpers[1].value.u.w ? ~0l : 0l) ));
+												(srcOpers[0].value.u.x < srcOpers[1].value.u.x ? ~0U : 0U),
+												(srcOpers[0].value.u.y < srcOpers[1].value.u.y ? ~0U : 0U),
+												(srcOpers[0].value.u.z < srcOpers[1].value.u.z ? ~0U : 0U),
+												(srcOpers[0].value.u.w < srcOpers[1].value.u.w ? ~0U : 0U) ));
 			break;
 		case OPCODE_UGE:
 			s.SetDst(op.operands[0], op, ShaderVariable("",
-												(srcOpers[0].value.u.x >= srcOpers[1].value.u.x ? ~0l : 0l),
-												(srcOpers[0].value.u.y >= srcOpers[1].value.u.y ? ~0l : 0l),
-												(srcOpers[0].value.u.z >= srcOpers[1].value.u.z ? ~0l : 0l),
-												(srcOpers[0].value.u.w >= srcOpers[1].value.u.w ? ~0l : 0l) ));
+												(srcOpers[0].value.u.x >= srcOpers[1].value.u.x ? ~0U : 0U),
+												(srcOpers[0].value.u.y >= srcOpers[1].value.u.y ? ~0U : 0U),
+												(srcOpers[0].value.u.z >= srcOpers[1].value.u.z ? ~0U : 0U),
+												(srcOpers[0].value.u.w >= srcOpers[1].value.u.w ? ~0U : 0U) ));
 			break;
 			
 		/////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -2045,11 +2074,11 @@ State State::GetNext(GlobalState &global, State quad[4]) const
 						break;
 					case OPCODE_IMM_ATOMIC_IMAX:
 					case OPCODE_ATOMIC_IMAX:
-						*idst = max(*idst, *isrc0);
+						*idst = RDCMAX(*idst, *isrc0);
 						break;
 					case OPCODE_IMM_ATOMIC_IMIN:
 					case OPCODE_ATOMIC_IMIN:
-						*idst = min(*idst, *isrc0);
+						*idst = RDCMIN(*idst, *isrc0);
 						break;
 					case OPCODE_IMM_ATOMIC_AND:
 					case OPCODE_ATOMIC_AND:
@@ -2072,11 +2101,11 @@ State State::GetNext(GlobalState &global, State quad[4]) const
 						break;
 					case OPCODE_IMM_ATOMIC_UMAX:
 					case OPCODE_ATOMIC_UMAX:
-						*udst = max(*udst, *usrc0);
+						*udst = RDCMAX(*udst, *usrc0);
 						break;
 					case OPCODE_IMM_ATOMIC_UMIN:
 					case OPCODE_ATOMIC_UMIN:
-						*udst = min(*udst, *usrc0);
+						*udst = RDCMIN(*udst, *usrc0);
 						break;
 				}
 			}
@@ -2218,9 +2247,13 @@ State State::GetNext(GlobalState &global, State quad[4]) const
 
 			if(load && !srv && !gsm && (fmt.numComps != 1 || fmt.byteWidth != 4))
 			{
+#if defined(WIN32)
 				device->AddDebugMessage(eDbgCategory_Shaders, eDbgSeverity_Medium, eDbgSource_RuntimeWarning,
 						StringFormat::Fmt("Shader debugging %d: %s\n" \
 						"UAV loads aren't supported from anything but 32-bit single channel resources", s.nextInstruction-1, op.str.c_str()));
+#else
+				RDCWARN("Shader debugging %d: %s - UAV loads aren't supported from anything but 32-bit single channel resources", s.nextInstruction-1, op.str.c_str());
+#endif
 			}
 
 			if(gsm)
@@ -2325,6 +2358,8 @@ State State::GetNext(GlobalState &global, State quad[4]) const
 			break;
 		}
 
+#if defined(WIN32)
+		// these all query or sample from the bound D3D11 resources on the GPU
 		case OPCODE_SAMPLE_INFO:
 		case OPCODE_SAMPLE_POS:
 		{
@@ -3384,7 +3419,7 @@ State State::GetNext(GlobalState &global, State quad[4]) const
 
 					s.SetDst(op.operands[0], op, fetch);
 
-					return s;
+					return;
 				}
 				if(decl.declaration == OPCODE_DCL_RESOURCE &&
 					decl.operand.type == TYPE_RESOURCE &&
@@ -3977,7 +4012,7 @@ State State::GetNext(GlobalState &global, State quad[4]) const
 			if(FAILED(hr))
 			{
 				RDCERR("Failed to create RT tex %08x", hr);
-				return s;
+				return;
 			}
 
 			tdesc.BindFlags = 0;
@@ -3989,7 +4024,7 @@ State State::GetNext(GlobalState &global, State quad[4]) const
 			if(FAILED(hr))
 			{
 				RDCERR("Failed to create copy tex %08x", hr);
-				return s;
+				return;
 			}
 
 			D3D11_RENDER_TARGET_VIEW_DESC rtDesc;
@@ -4003,7 +4038,7 @@ State State::GetNext(GlobalState &global, State quad[4]) const
 			if(FAILED(hr))
 			{
 				RDCERR("Failed to create rt rtv %08x", hr);
-				return s;
+				return;
 			}
 
 			context->OMSetRenderTargetsAndUnorderedAccessViews(1, &rtv, NULL, 0, 0, NULL, NULL);
@@ -4017,7 +4052,7 @@ State State::GetNext(GlobalState &global, State quad[4]) const
 			if(FAILED(hr))
 			{
 				RDCERR("Failed to map results %08x", hr);
-				return s;
+				return;
 			}
 
 			ShaderVariable lookupResult("tex", 0.0f, 0.0f, 0.0f, 0.0f);
@@ -4052,6 +4087,29 @@ State State::GetNext(GlobalState &global, State quad[4]) const
 			s.SetDst(op.operands[0], op, lookupResult);
 			break;
 		}
+#else
+		case OPCODE_SAMPLE_INFO:
+		case OPCODE_SAMPLE_POS:
+		case OPCODE_BUFINFO:
+		case OPCODE_RESINFO:
+		case OPCODE_SAMPLE:
+		case OPCODE_SAMPLE_L:
+		case OPCODE_SAMPLE_B:
+		case OPCODE_SAMPLE_D:
+		case OPCODE_SAMPLE_C:
+		case OPCODE_SAMPLE_C_LZ:
+		case OPCODE_LD:
+		case OPCODE_LD_MS:
+		case OPCODE_GATHER4:
+		case OPCODE_GATHER4_C:
+		case OPCODE_GATHER4_PO:
+		case OPCODE_GATHER4_PO_C:
+		case OPCODE_LOD:
+		{
+			RDCERR("Operation %d needs a D3D11 device to debug, results will be undefined", op.operation);
+			break;
+		}
+#endif
 
 		/////////////////////////////////////////////////////////////////////////////////////////////////////
 		// Flow control
@@ -4319,8 +4377,36 @@ State State::GetNext(GlobalState &global, State quad[4]) const
 			break;
 		}
 	}
+}
 
-	return s;
+TraceRecorder::TraceRecorder(const State &initial)
+{
+	m_Keyframes.push_back((ShaderDebugState)initial);
+}
+
+void TraceRecorder::AddStep(const State &s)
+{
+	const vector<ShaderDebugChange> &changes = s.GetChanges();
+
+	ShaderDebugStep step;
+	step.nextInstruction = s.nextInstruction;
+	step.firstChange = (uint32_t)m_Changes.size();
+	step.numChanges = (uint32_t)changes.size();
+
+	m_Steps.push_back(step);
+	m_Changes.insert(m_Changes.end(), changes.begin(), changes.end());
+
+	// state N is m_Steps.size() now
+	if(m_Steps.size() % KeyframeInterval == 0)
+		m_Keyframes.push_back((ShaderDebugState)s);
+}
+
+void TraceRecorder::Fill(ShaderDebugTrace &trace) const
+{
+	trace.keyframeInterval = KeyframeInterval;
+	trace.keyframes = m_Keyframes;
+	trace.steps = m_Steps;
+	trace.changes = m_Changes;
 }
 
 }; // namespace ShaderDebug
\ No newline at end of file
@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include "api/replay/renderdoc_replay.h"
 #include "dxbc_disassemble.h"
 
 namespace DXBC { class DXBCFile; struct CBufferVariable; }
@@ -103,6 +104,8 @@ struct GlobalState
 		vector<groupsharedMem> groupshared;
 };
 
+float round_ne(float x);
+
 class State : public ShaderDebugState
 {
 	public:
@@ -145,8 +148,17 @@ class State : public ShaderDebugState
 
 		void Init();
 		bool Finished() const;
+
+		static VarType OperationType(const DXBC::OpcodeType &op);
 		
+		// GetNext returns the following state, leaving this one untouched - needed
+		// for pixel quads where derivatives read the other lanes' current state.
+		// Step advances this state in place.
 		State GetNext(GlobalState &global, State quad[4]) const;
+		void Step(GlobalState &global, State quad[4]);
+
+		// register writes made by the last step
+		const vector<ShaderDebugChange> &GetChanges() const { return changes; }
 
 	private:
 		// index in the pixel quad
@@ -154,6 +166,8 @@ class State : public ShaderDebugState
 		
 		bool done;
 
+		vector<ShaderDebugChange> changes;
+
 		// sets the destination operand by looking up in the register
 		// file and applying any masking or swizzling
 		void SetDst(const DXBC::ASMOperand &dstoper, const DXBC::ASMOperation &op, const ShaderVariable &val); 
@@ -166,11 +180,28 @@ class State : public ShaderDebugState
 		ShaderVariable DDX(bool fine, State quad[4], const DXBC::ASMOperand &oper, const DXBC::ASMOperation &op) const;
 		ShaderVariable DDY(bool fine, State quad[4], const DXBC::ASMOperand &oper, const DXBC::ASMOperation &op) const;
 
-		VarType OperationType(const DXBC::OpcodeType &op) const;
-
 		DXBC::DXBCFile *dxbc;
 		const ShaderDebugTrace *trace;
 		WrappedID3D11Device *device;
 };
 
+// collects the states of a trace as it's simulated, storing a full
+// keyframe every KeyframeInterval steps and just the register writes
+// of the steps in between.
+class TraceRecorder
+{
+	public:
+		static const uint32_t KeyframeInterval = 64;
+
+		TraceRecorder(const State &initial);
+
+		void AddStep(const State &s);
+		void Fill(ShaderDebugTrace &trace) const;
+
+	private:
+		vector<ShaderDebugState> m_Keyframes;
+		vector<ShaderDebugStep> m_Steps;
+		vector<ShaderDebugChange> m_Changes;
+};
+
 }; // namespace ShaderDebug
\ No newline at end of file
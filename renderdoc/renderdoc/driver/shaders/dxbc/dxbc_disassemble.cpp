@@ -28,7 +28,9 @@
 #include "dxbc_disassemble.h"
 #include "serialise/string_utils.h"
 
+#if defined(WIN32)
 #include <d3d11shader.h>
+#endif
 
 #include <math.h>
 
@@ -248,12 +250,12 @@ namespace ExtendedOperand
 };
 
 string toString(const uint32_t values[], uint32_t numComps);
-char *toString(OpcodeType op);
-char *toString(ResourceDimension dim);
-char *toString(ResourceRetType type);
-char *toString(ResinfoRetType type);
-char *toString(InterpolationMode type);
-char *SystemValueToString(uint32_t type);
+const char *toString(OpcodeType op);
+const char *toString(ResourceDimension dim);
+const char *toString(ResourceRetType type);
+const char *toString(ResinfoRetType type);
+const char *toString(InterpolationMode type);
+const char *SystemValueToString(uint32_t type);
 
 bool ASMOperand::operator ==(const ASMOperand &o) const
 {
@@ -2192,7 +2194,7 @@ string toString(const uint32_t values[], uint32_t numComps)
 	return str;
 }
 
-char *toString(OpcodeType op)
+const char *toString(OpcodeType op)
 {
 	switch(op)
 	{
@@ -2442,7 +2444,7 @@ char *toString(OpcodeType op)
 	return "";
 }
 
-char *toString(ResourceDimension dim)
+const char *toString(ResourceDimension dim)
 {
 	switch(dim)
 	{
@@ -2467,7 +2469,7 @@ char *toString(ResourceDimension dim)
 	return "";
 }
 
-char *toString(ResourceRetType type)
+const char *toString(ResourceRetType type)
 {
 	switch(type)
 	{
@@ -2488,7 +2490,7 @@ char *toString(ResourceRetType type)
 	return "";
 }
 
-char *toString(ResinfoRetType type)
+const char *toString(ResinfoRetType type)
 {
 	switch(type)
 	{
@@ -2503,7 +2505,7 @@ char *toString(ResinfoRetType type)
 	return "";
 }
 
-char *toString(InterpolationMode interp)
+const char *toString(InterpolationMode interp)
 {
 	switch(interp)
 	{
@@ -2523,7 +2525,7 @@ char *toString(InterpolationMode interp)
 	return "";
 }
 
-char *SystemValueToString(uint32_t name)
+const char *SystemValueToString(uint32_t name)
 {
 	enum DXBC_SVSemantic
 	{
@@ -29,8 +29,11 @@
 #include "dxbc_inspect.h"
 #include "dxbc_sdbg.h"
 #include "dxbc_spdb.h"
+#include "dxbc_batch.h"
 
+#if defined(WIN32)
 #include <D3D11Shader.h>
+#endif
 
 using std::make_pair;
 
@@ -301,7 +304,7 @@ string TypeName(CBufferVariableType::Descriptor desc)
 {
 	string ret;
 
-	char *type = "";
+	const char *type = "";
 	switch(desc.type)
 	{
 		case VARTYPE_BOOL:
@@ -459,6 +462,7 @@ CBufferVariableType DXBCFile::ParseRDEFType(RDEFHeader *h, char *chunkContents,
 DXBCFile::DXBCFile(const void *ByteCode, size_t ByteCodeLength)
 {
 	m_DebugInfo = NULL;
+	m_BatchProgram = NULL;
 
 	m_Disassembled = false;
 
@@ -903,7 +907,7 @@ DXBCFile::DXBCFile(const void *ByteCode, size_t ByteCodeLength)
 
 				string semanticIdxName = a.semanticName.elems;
 				if(a.needSemanticIndex)
-					semanticIdxName += ToStr::Get(a.semanticIndex);
+					semanticIdxName += StringFormat::Fmt("%u", a.semanticIndex);
 
 				a.semanticIdxName = semanticIdxName;
 			}
@@ -924,6 +928,24 @@ DXBCFile::DXBCFile(const void *ByteCode, size_t ByteCodeLength)
 	}
 }
 
+DXBCFile::~DXBCFile()
+{
+	SAFE_DELETE(m_DebugInfo);
+	SAFE_DELETE(m_BatchProgram);
+}
+
+const ShaderDebug::BatchProgram *DXBCFile::GetBatchProgram()
+{
+	if(m_BatchProgram == NULL)
+	{
+		DisassembleHexDump();
+
+		m_BatchProgram = new ShaderDebug::BatchProgram(this);
+	}
+
+	return m_BatchProgram;
+}
+
 void DXBCFile::GuessResources()
 {
 	char buf[64] = {0};
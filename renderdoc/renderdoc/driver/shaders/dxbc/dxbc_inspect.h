@@ -39,7 +39,9 @@ using std::map;
 
 #include "dxbc_disassemble.h"
 
-enum D3D11_SHADER_VERSION_TYPE;
+#include "dxbc_compat.h"
+
+namespace ShaderDebug { class BatchProgram; }
 
 // many thanks to winehq for information of format of RDEF, STAT and SIGN chunks:
 // http://source.winehq.org/git/wine.git/blob/HEAD:/dlls/d3dcompiler_43/reflection.c
@@ -318,7 +320,7 @@ class DXBCFile
 {
 	public:
 		DXBCFile(const void *ByteCode, size_t ByteCodeLength);
-		~DXBCFile() { SAFE_DELETE(m_DebugInfo); }
+		~DXBCFile();
 
 		D3D11_SHADER_VERSION_TYPE m_Type;
 		struct { uint32_t Major, Minor; } m_Version;
@@ -360,6 +362,9 @@ class DXBCFile
 		const ASMOperation &GetInstruction(size_t i) { return m_Instructions[i]; }
 		
 		size_t NumOperands(OpcodeType op);
+
+		// pre-decoded program for running many lanes at once, built on first use
+		const ShaderDebug::BatchProgram *GetBatchProgram();
 	private:
 		DXBCFile(const DXBCFile &o);
 		DXBCFile &operator =(const DXBCFile &o);
@@ -385,6 +390,8 @@ class DXBCFile
 		vector<ASMOperation> m_Instructions;
 
 		string m_Disassembly;
+
+		ShaderDebug::BatchProgram *m_BatchProgram;
 };
 
 }; // namespace DXBC
\ No newline at end of file
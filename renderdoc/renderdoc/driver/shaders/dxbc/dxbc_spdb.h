@@ -23,7 +23,9 @@
  ******************************************************************************/
 
 
+#if defined(WIN32)
 #include <guiddef.h>
+#endif
 
 #include <string>
 #include <utility>
@@ -36,6 +38,7 @@ using std::map;
 
 #pragma once
 
+#include "dxbc_compat.h"
 #include "dxbc_disassemble.h"
 
 namespace DXBC
@@ -23,13 +23,27 @@
  ******************************************************************************/
 
 #include "os/os_specific.h"
+#include "serialise/string_utils.h"
 
 #include <execinfo.h>
+#include <pthread.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cxxabi.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include <vector>
 #include <map>
+#include <algorithm>
+
+#ifndef SHF_COMPRESSED
+#define SHF_COMPRESSED (1 << 11)
+#endif
 
 void *renderdocBase = NULL;
 void *renderdocEnd = NULL;
@@ -37,11 +51,14 @@ void *renderdocEnd = NULL;
 class LinuxCallstack : public Callstack::Stackwalk
 {
 	public:
-		LinuxCallstack()
+		LinuxCallstack(bool framePointers)
 		{
 			RDCEraseEl(addrs);
 			numLevels = 0;
-			Collect();
+			if(framePointers)
+				CollectFramePointers();
+			else
+				Collect();
 		}
 		LinuxCallstack(uint64_t *calls, size_t num)
 		{
@@ -80,6 +97,66 @@ class LinuxCallstack : public Callstack::Stackwalk
 				addrs[i] = (uint64_t)addrs_ptr[i+offs];
 		}
 
+		void CollectFramePointers()
+		{
+#if defined(__x86_64__) || defined(__i386__) || defined(__aarch64__)
+			// bounds of this thread's stack, looked up once per thread. Any frame
+			// pointer outside them means we've walked into a frame that didn't keep
+			// the chain, so we stop there rather than read garbage
+			static __thread uintptr_t stackLow = 0, stackHigh = 0;
+
+			if(stackHigh == 0)
+			{
+				pthread_attr_t attr;
+				void *addr = NULL;
+				size_t size = 0;
+
+				if(pthread_getattr_np(pthread_self(), &attr) == 0)
+				{
+					pthread_attr_getstack(&attr, &addr, &size);
+					pthread_attr_destroy(&attr);
+				}
+
+				stackLow = (uintptr_t)addr;
+				stackHigh = (uintptr_t)addr + size;
+			}
+
+			// each frame starts with the caller's frame pointer, followed by the
+			// return address
+			void **frame = (void **)__builtin_frame_address(0);
+
+			bool trimming = true;
+
+			while(numLevels < (int)ARRAY_COUNT(addrs))
+			{
+				uintptr_t f = (uintptr_t)frame;
+				if(f < stackLow || f + 2*sizeof(void *) > stackHigh || (f & (sizeof(void *)-1)) != 0)
+					break;
+
+				void *ret = frame[1];
+				if(ret == NULL)
+					break;
+
+				// skip our own frames at the top of the stack, as Collect does
+				if(!trimming || ret < renderdocBase || ret >= renderdocEnd)
+				{
+					trimming = false;
+					addrs[numLevels++] = (uint64_t)ret;
+				}
+
+				void **next = (void **)frame[0];
+
+				// the stack grows down, so each caller's frame must be higher up
+				if(next <= frame)
+					break;
+
+				frame = next;
+			}
+#else
+			Collect();
+#endif
+		}
+
 		uint64_t addrs[128];
 		int numLevels;
 };
@@ -109,7 +186,12 @@ namespace Callstack
 
 	Stackwalk *Collect()
 	{
-		return new LinuxCallstack();
+		return new LinuxCallstack(false);
+	}
+
+	Stackwalk *CollectFramePointers()
+	{
+		return new LinuxCallstack(true);
 	}
 
 	Stackwalk *Create()
@@ -154,77 +236,802 @@ namespace Callstack
 	{
 		uint64_t base;
 		uint64_t end;
+		// offset in the file that the mapping starts at
+		uint64_t offset;
 		char path[2048];
 	};
 
-	class LinuxResolver : public Callstack::StackResolver
+	// bounds-checked little-endian reader over a section of an ELF file. Reading
+	// past the end returns 0s and sets overflow, so a truncated or corrupt table
+	// stops parsing instead of crashing.
+	struct DwarfReader
+	{
+		DwarfReader(const byte *b, const byte *e) : cur(b), end(e), overflow(false) {}
+
+		const byte *cur;
+		const byte *end;
+		bool overflow;
+
+		bool AtEnd() const { return overflow || cur >= end; }
+
+		bool Skip(uint64_t bytes)
+		{
+			if(overflow || bytes > uint64_t(end - cur)) { overflow = true; cur = end; return false; }
+			cur += bytes;
+			return true;
+		}
+
+		uint64_t Read(size_t bytes)
+		{
+			const byte *start = cur;
+			if(!Skip(bytes)) return 0;
+
+			uint64_t ret = 0;
+			for(size_t i=0; i < bytes; i++)
+				ret |= uint64_t(start[i]) << (i*8);
+			return ret;
+		}
+
+		uint8_t U8() { return (uint8_t)Read(1); }
+		uint16_t U16() { return (uint16_t)Read(2); }
+		uint32_t U32() { return (uint32_t)Read(4); }
+		uint64_t U64() { return Read(8); }
+
+		uint64_t ULEB()
+		{
+			uint64_t ret = 0;
+			uint32_t shift = 0;
+			while(!AtEnd())
+			{
+				byte b = *cur++;
+				if(shift < 64) ret |= uint64_t(b & 0x7f) << shift;
+				shift += 7;
+				if((b & 0x80) == 0) return ret;
+			}
+			overflow = true;
+			return ret;
+		}
+
+		int64_t SLEB()
+		{
+			int64_t ret = 0;
+			uint32_t shift = 0;
+			while(!AtEnd())
+			{
+				byte b = *cur++;
+				if(shift < 64) ret |= int64_t(b & 0x7f) << shift;
+				shift += 7;
+				if((b & 0x80) == 0)
+				{
+					if(shift < 64 && (b & 0x40)) ret |= -(int64_t(1) << shift);
+					return ret;
+				}
+			}
+			overflow = true;
+			return ret;
+		}
+
+		const char *Str()
+		{
+			const char *ret = (const char *)cur;
+			while(cur < end && *cur) cur++;
+			if(cur >= end) { overflow = true; return ""; }
+			cur++;
+			return ret;
+		}
+	};
+
+	struct ElfSection
+	{
+		ElfSection() : data(NULL), size(0) {}
+		const byte *data;
+		size_t size;
+
+		const char *GetString(uint64_t offs) const
+		{
+			if(data == NULL || offs >= size) return NULL;
+			// make sure the string is terminated within the section
+			if(memchr(data + offs, 0, size_t(size - offs)) == NULL) return NULL;
+			return (const char *)data + offs;
+		}
+	};
+
+	// function symbols and DWARF line tables for one ELF file, parsed once up
+	// front into tables sorted by address so that each lookup is a binary search.
+	// All addresses are the virtual addresses the file was linked at.
+	class ElfSymbols
 	{
 		public:
-			LinuxResolver(vector<LookupModule> modules)
+			ElfSymbols(const char *path)
 			{
-				m_Modules = modules;
+				m_Valid = LoadFile(path, true);
+
+				// symbols and line info may have been split into a separate debug file
+				if(m_Valid && m_Lines.empty())
+				{
+					vector<string> candidates;
+
+					if(!m_BuildID.empty())
+					{
+						string hex;
+						for(size_t i=0; i < m_BuildID.size(); i++)
+							hex += StringFormat::Fmt("%02x", m_BuildID[i]);
+
+						candidates.push_back("/usr/lib/debug/.build-id/" + hex.substr(0, 2) + "/" + hex.substr(2) + ".debug");
+					}
+
+					if(!m_DebugLink.empty())
+					{
+						string dir = dirname(string(path));
+
+						candidates.push_back(dir + "/" + m_DebugLink);
+						candidates.push_back(dir + "/.debug/" + m_DebugLink);
+						candidates.push_back("/usr/lib/debug" + dir + "/" + m_DebugLink);
+					}
+
+					for(size_t i=0; i < candidates.size() && m_Lines.empty(); i++)
+					{
+						if(candidates[i] != path && access(candidates[i].c_str(), R_OK) == 0)
+							LoadFile(candidates[i].c_str(), false);
+					}
+				}
+
+				std::stable_sort(m_Symbols.begin(), m_Symbols.end());
+				std::stable_sort(m_Lines.begin(), m_Lines.end());
 			}
 
-			Callstack::AddressDetails GetAddr(uint64_t addr)
+			bool IsValid() const { return m_Valid; }
+
+			// converts a file offset inside an executable mapping to the linked address
+			uint64_t FileOffsetToAddress(uint64_t offs) const
 			{
-				EnsureCached(addr);
+				for(size_t i=0; i < m_Segments.size(); i++)
+					if(offs >= m_Segments[i].offset && offs < m_Segments[i].offset + m_Segments[i].size)
+						return offs - m_Segments[i].offset + m_Segments[i].addr;
 
-				return m_Cache[addr];
+				return offs;
+			}
+
+			void Lookup(uint64_t addr, Callstack::AddressDetails &ret) const
+			{
+				Symbol symKey = { addr, ~0ULL, 0 };
+				vector<Symbol>::const_iterator sym = std::upper_bound(m_Symbols.begin(), m_Symbols.end(), symKey);
+				if(sym != m_Symbols.begin())
+				{
+					--sym;
+
+					// symbols with no size are assumed to run up to the next one
+					if(sym->size == 0 || addr < sym->addr + sym->size)
+					{
+						const char *name = &m_Names[sym->name];
+
+						int status = 0;
+						char *demangled = abi::__cxa_demangle(name, NULL, NULL, &status);
+
+						if(demangled && status == 0)
+							ret.function = demangled;
+						else
+							ret.function = name;
+
+						free(demangled);
+					}
+				}
+
+				LineRow lineKey = { addr, 1, 0, 0 };
+				vector<LineRow>::const_iterator row = std::upper_bound(m_Lines.begin(), m_Lines.end(), lineKey);
+				if(row != m_Lines.begin())
+				{
+					--row;
+
+					// the end of a sequence means there's no line info until the next one starts
+					if(row->valid && row->file < m_Files.size())
+					{
+						ret.filename = m_Files[row->file];
+						ret.line = row->line;
+					}
+				}
 			}
 
 		private:
-			void EnsureCached(uint64_t addr)
+			struct Symbol
 			{
-				auto it = m_Cache.insert(std::pair<uint64_t, Callstack::AddressDetails>(addr, Callstack::AddressDetails()));
-				if(!it.second) return;
-				
-				Callstack::AddressDetails &ret = it.first->second;
-				
-				ret.filename = "Unknown";
-				ret.line = 0;
-				ret.function = StringFormat::Fmt("0x%08llx", addr);
+				uint64_t addr;
+				uint64_t size;
+				uint32_t name;
 
-				for(size_t i=0; i < m_Modules.size(); i++)
+				bool operator <(const Symbol &o) const
+				{
+					if(addr != o.addr) return addr < o.addr;
+					// when several symbols alias the same address, sized ones sort last
+					// so the lookup picks them
+					return size < o.size;
+				}
+			};
+
+			struct LineRow
+			{
+				uint64_t addr;
+				// ends of sequences sort before any row starting at the same address
+				uint32_t valid;
+				uint32_t file;
+				uint32_t line;
+
+				bool operator <(const LineRow &o) const
+				{
+					if(addr != o.addr) return addr < o.addr;
+					return valid < o.valid;
+				}
+			};
+
+			struct Segment
+			{
+				uint64_t offset;
+				uint64_t size;
+				uint64_t addr;
+			};
+
+			bool LoadFile(const char *path, bool primary)
+			{
+				int fd = open(path, O_RDONLY);
+				if(fd < 0)
+				{
+					RDCWARN("Couldn't open '%s' for symbol resolution", path);
+					return false;
+				}
+
+				struct stat st;
+				if(fstat(fd, &st) != 0 || st.st_size < (off_t)EI_NIDENT)
+				{
+					close(fd);
+					return false;
+				}
+
+				size_t size = (size_t)st.st_size;
+				void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+				close(fd);
+
+				if(map == MAP_FAILED)
+				{
+					RDCWARN("Couldn't map '%s' for symbol resolution", path);
+					return false;
+				}
+
+				const byte *file = (const byte *)map;
+
+				bool ret = false;
+
+				if(memcmp(file, ELFMAG, SELFMAG) != 0 || file[EI_DATA] != ELFDATA2LSB)
+					RDCWARN("'%s' isn't a little-endian ELF file", path);
+				else if(file[EI_CLASS] == ELFCLASS64)
+					ret = Parse<Elf64_Ehdr, Elf64_Phdr, Elf64_Shdr, Elf64_Sym>(file, size, primary);
+				else if(file[EI_CLASS] == ELFCLASS32)
+					ret = Parse<Elf32_Ehdr, Elf32_Phdr, Elf32_Shdr, Elf32_Sym>(file, size, primary);
+
+				munmap(map, size);
+
+				return ret;
+			}
+
+			template<typename Ehdr, typename Phdr, typename Shdr, typename Sym>
+			bool Parse(const byte *file, size_t size, bool primary)
+			{
+				if(size < sizeof(Ehdr)) return false;
+
+				const Ehdr *ehdr = (const Ehdr *)file;
+
+				if(primary && ehdr->e_phentsize == sizeof(Phdr) &&
+					 ehdr->e_phoff + uint64_t(ehdr->e_phnum)*sizeof(Phdr) <= size)
+				{
+					const Phdr *phdrs = (const Phdr *)(file + ehdr->e_phoff);
+					for(uint32_t i=0; i < ehdr->e_phnum; i++)
+					{
+						if(phdrs[i].p_type != PT_LOAD) continue;
+
+						Segment seg = { phdrs[i].p_offset, phdrs[i].p_filesz, phdrs[i].p_vaddr };
+						m_Segments.push_back(seg);
+					}
+				}
+
+				if(ehdr->e_shentsize != sizeof(Shdr) || ehdr->e_shstrndx >= ehdr->e_shnum ||
+					 ehdr->e_shoff + uint64_t(ehdr->e_shnum)*sizeof(Shdr) > size)
+					return primary;
+
+				const Shdr *shdrs = (const Shdr *)(file + ehdr->e_shoff);
+
+				ElfSection shstrtab = GetSection(file, size, shdrs[ehdr->e_shstrndx]);
+
+				const Shdr *symtab = NULL;
+				const Shdr *dynsym = NULL;
+				ElfSection debugLine, debugLineStr, debugStr;
+
+				for(uint32_t i=0; i < ehdr->e_shnum; i++)
+				{
+					const Shdr &sh = shdrs[i];
+
+					if(sh.sh_type == SHT_SYMTAB) symtab = &sh;
+					if(sh.sh_type == SHT_DYNSYM) dynsym = &sh;
+
+					const char *name = shstrtab.GetString(sh.sh_name);
+					if(name == NULL || sh.sh_type == SHT_NOBITS) continue;
+
+					if(!strcmp(name, ".debug_line") || !strcmp(name, ".debug_line_str") || !strcmp(name, ".debug_str"))
+					{
+						if(sh.sh_flags & SHF_COMPRESSED)
+						{
+							RDCWARN("Compressed debug sections aren't supported, no line info will be available");
+							continue;
+						}
+
+						if(!strcmp(name, ".debug_line")) debugLine = GetSection(file, size, sh);
+						else if(!strcmp(name, ".debug_line_str")) debugLineStr = GetSection(file, size, sh);
+						else debugStr = GetSection(file, size, sh);
+					}
+					else if(primary && !strcmp(name, ".gnu_debuglink"))
+					{
+						const char *link = GetSection(file, size, sh).GetString(0);
+						if(link) m_DebugLink = link;
+					}
+					else if(primary && !strcmp(name, ".note.gnu.build-id"))
+					{
+						ElfSection note = GetSection(file, size, sh);
+						DwarfReader r(note.data, note.data + note.size);
+
+						uint32_t namesz = r.U32();
+						uint32_t descsz = r.U32();
+						uint32_t type = r.U32();
+						r.Skip((namesz + 3) & ~3U);
+
+						if(type == NT_GNU_BUILD_ID && r.Skip(descsz))
+							m_BuildID.assign(r.cur - descsz, r.cur);
+					}
+				}
+
+				// prefer the full symbol table, but stripped files still have the dynamic one
+				if(symtab == NULL) symtab = dynsym;
+
+				if(symtab && symtab->sh_link < ehdr->e_shnum && (m_Symbols.empty() || symtab != dynsym))
 				{
-					if(addr >= m_Modules[i].base && addr < m_Modules[i].end)
+					ElfSection syms = GetSection(file, size, *symtab);
+					ElfSection strs = GetSection(file, size, shdrs[symtab->sh_link]);
+
+					if(syms.data && strs.data)
+					{
+						m_Symbols.clear();
+						m_Names.assign((const char *)strs.data, (const char *)strs.data + strs.size);
+						m_Names.push_back(0);
+
+						const Sym *s = (const Sym *)syms.data;
+						size_t num = syms.size / sizeof(Sym);
+
+						for(size_t i=0; i < num; i++)
+						{
+							uint32_t type = s[i].st_info & 0xf;
+							if((type != STT_FUNC && type != STT_GNU_IFUNC) || s[i].st_shndx == SHN_UNDEF || s[i].st_value == 0)
+								continue;
+
+							if(s[i].st_name >= strs.size) continue;
+
+							Symbol sym = { (uint64_t)s[i].st_value, (uint64_t)s[i].st_size, (uint32_t)s[i].st_name };
+							m_Symbols.push_back(sym);
+						}
+					}
+				}
+
+				if(debugLine.data)
+					ParseLines(debugLine, debugLineStr, debugStr);
+
+				return true;
+			}
+
+			template<typename Shdr>
+			static ElfSection GetSection(const byte *file, size_t size, const Shdr &sh)
+			{
+				ElfSection ret;
+				if(sh.sh_type != SHT_NOBITS && sh.sh_offset <= size && sh.sh_size <= size - sh.sh_offset)
+				{
+					ret.data = file + sh.sh_offset;
+					ret.size = (size_t)sh.sh_size;
+				}
+				return ret;
+			}
+
+			void AddRow(uint64_t addr, const vector<uint32_t> &files, uint32_t file, uint32_t line)
+			{
+				LineRow row = { addr, 1, file < files.size() ? files[file] : ~0U, line };
+				m_Lines.push_back(row);
+			}
+
+			uint32_t AddFile(const vector<string> &dirs, uint64_t dir, const char *name)
+			{
+				string path = name;
+				if(name[0] != '/' && dir < dirs.size() && !dirs[dir].empty())
+					path = dirs[dir] + "/" + path;
+
+				// in DWARF 5 directory 0 is the compilation directory, other directories
+				// can be relative to it
+				if(path[0] != '/' && dir != 0 && !dirs.empty() && !dirs[0].empty())
+					path = dirs[0] + "/" + path;
+
+				std::map<string, uint32_t>::iterator it = m_FileIndex.find(path);
+				if(it != m_FileIndex.end())
+					return it->second;
+
+				uint32_t idx = (uint32_t)m_Files.size();
+				m_Files.push_back(path);
+				m_FileIndex[path] = idx;
+				return idx;
+			}
+
+			enum
+			{
+				DW_LNS_copy = 0x01,
+				DW_LNS_advance_pc = 0x02,
+				DW_LNS_advance_line = 0x03,
+				DW_LNS_set_file = 0x04,
+				DW_LNS_const_add_pc = 0x08,
+				DW_LNS_fixed_advance_pc = 0x09,
+
+				DW_LNE_end_sequence = 0x01,
+				DW_LNE_set_address = 0x02,
+				DW_LNE_define_file = 0x03,
+
+				DW_LNCT_path = 0x1,
+				DW_LNCT_directory_index = 0x2,
+
+				DW_FORM_data2 = 0x05,
+				DW_FORM_data4 = 0x06,
+				DW_FORM_data8 = 0x07,
+				DW_FORM_string = 0x08,
+				DW_FORM_block = 0x09,
+				DW_FORM_data1 = 0x0b,
+				DW_FORM_strp = 0x0e,
+				DW_FORM_udata = 0x0f,
+				DW_FORM_strx = 0x1a,
+				DW_FORM_data16 = 0x1e,
+				DW_FORM_line_strp = 0x1f,
+				DW_FORM_strx1 = 0x25,
+				DW_FORM_strx2 = 0x26,
+				DW_FORM_strx3 = 0x27,
+				DW_FORM_strx4 = 0x28,
+			};
+
+			// reads one attribute of a DWARF 5 directory or file entry. Strings through
+			// .debug_str_offsets aren't supported and come back as NULL
+			static bool ReadForm(DwarfReader &r, uint64_t form, bool dwarf64, const ElfSection &lineStr, const ElfSection &str,
+			                     const char *&s, uint64_t &val)
+			{
+				s = NULL;
+				val = 0;
+
+				switch(form)
+				{
+					case DW_FORM_string: s = r.Str(); break;
+					case DW_FORM_line_strp: s = lineStr.GetString(dwarf64 ? r.U64() : r.U32()); break;
+					case DW_FORM_strp: s = str.GetString(dwarf64 ? r.U64() : r.U32()); break;
+					case DW_FORM_data1: val = r.U8(); break;
+					case DW_FORM_data2: val = r.U16(); break;
+					case DW_FORM_data4: val = r.U32(); break;
+					case DW_FORM_data8: val = r.U64(); break;
+					case DW_FORM_udata: val = r.ULEB(); break;
+					case DW_FORM_data16: r.Skip(16); break;
+					case DW_FORM_block: r.Skip(r.ULEB()); break;
+					case DW_FORM_strx: r.ULEB(); break;
+					case DW_FORM_strx1: r.Skip(1); break;
+					case DW_FORM_strx2: r.Skip(2); break;
+					case DW_FORM_strx3: r.Skip(3); break;
+					case DW_FORM_strx4: r.Skip(4); break;
+					default: return false;
+				}
+
+				return !r.overflow;
+			}
+
+			// reads a DWARF 5 directory or file name table, returning the path and
+			// directory index of each entry
+			static bool ReadEntries(DwarfReader &r, bool dwarf64, const ElfSection &lineStr, const ElfSection &str,
+			                        vector< std::pair<const char *, uint64_t> > &entries)
+			{
+				uint8_t numFormats = r.U8();
+
+				vector< std::pair<uint64_t, uint64_t> > formats(numFormats);
+				for(uint8_t i=0; i < numFormats; i++)
+				{
+					formats[i].first = r.ULEB();
+					formats[i].second = r.ULEB();
+				}
+
+				uint64_t count = r.ULEB();
+				for(uint64_t e=0; e < count && !r.AtEnd(); e++)
+				{
+					std::pair<const char *, uint64_t> entry("", 0);
+
+					for(uint8_t i=0; i < numFormats; i++)
 					{
-						uint64_t relative = addr - m_Modules[i].base;
-						string cmd = StringFormat::Fmt("addr2line -j.text -fCe \"%s\" 0x%llx", m_Modules[i].path, relative);
+						const char *s = NULL;
+						uint64_t val = 0;
+						if(!ReadForm(r, formats[i].second, dwarf64, lineStr, str, s, val))
+							return false;
 
-						FILE *f = ::popen(cmd.c_str(), "r");
+						if(formats[i].first == DW_LNCT_path && s) entry.first = s;
+						if(formats[i].first == DW_LNCT_directory_index) entry.second = val;
+					}
 
-						char result[2048] = {0};
-						fread(result, 1, 2047, f);
+					entries.push_back(entry);
+				}
 
-						fclose(f);
+				return !r.overflow;
+			}
+
+			void ParseLines(const ElfSection &lines, const ElfSection &lineStr, const ElfSection &str)
+			{
+				DwarfReader units(lines.data, lines.data + lines.size);
 
-						char *line2 = strchr(result, '\n');
-						if(line2) { *line2 = 0; line2++; }
+				while(!units.AtEnd())
+				{
+					bool dwarf64 = false;
+					uint64_t length = units.U32();
+					if(length == 0xffffffff)
+					{
+						dwarf64 = true;
+						length = units.U64();
+					}
+
+					const byte *unitStart = units.cur;
+					if(!units.Skip(length)) break;
+
+					DwarfReader r(unitStart, units.cur);
+					ParseLineUnit(r, dwarf64, lineStr, str);
+				}
+
+				m_FileIndex.clear();
+			}
+
+			// runs the line number program for one unit, adding a row whenever the
+			// file or line changes and an end marker after each sequence
+			void ParseLineUnit(DwarfReader &r, bool dwarf64, const ElfSection &lineStr, const ElfSection &str)
+			{
+				uint16_t version = r.U16();
+				if(version < 2 || version > 5) return;
+
+				// address_size and segment_selector_size
+				if(version >= 5) r.Skip(2);
+
+				uint64_t headerLength = dwarf64 ? r.U64() : r.U32();
+				if(r.overflow || headerLength > uint64_t(r.end - r.cur)) return;
+
+				const byte *program = r.cur + headerLength;
+
+				uint8_t minInstLength = r.U8();
+				// maximum_operations_per_instruction, only relevant for VLIW
+				if(version >= 4) r.U8();
+				// default_is_stmt, we keep every row like addr2line
+				r.U8();
+				int8_t lineBase = (int8_t)r.U8();
+				uint8_t lineRange = r.U8();
+				uint8_t opcodeBase = r.U8();
+
+				if(lineRange == 0 || opcodeBase == 0) return;
+
+				uint8_t opcodeLengths[256] = {0};
+				for(uint32_t i=1; i < opcodeBase; i++)
+					opcodeLengths[i] = r.U8();
+
+				vector<string> dirs;
+				// index into m_Files for each file number in this unit
+				vector<uint32_t> files;
+
+				if(version >= 5)
+				{
+					vector< std::pair<const char *, uint64_t> > dirEntries, fileEntries;
+
+					if(!ReadEntries(r, dwarf64, lineStr, str, dirEntries)) return;
+					if(!ReadEntries(r, dwarf64, lineStr, str, fileEntries)) return;
+
+					for(size_t i=0; i < dirEntries.size(); i++)
+						dirs.push_back(dirEntries[i].first);
+
+					for(size_t i=0; i < fileEntries.size(); i++)
+						files.push_back(AddFile(dirs, fileEntries[i].second, fileEntries[i].first));
+				}
+				else
+				{
+					// directory 0 is the compilation directory, which is only listed in .debug_info
+					dirs.push_back("");
+					while(!r.AtEnd())
+					{
+						const char *dir = r.Str();
+						if(dir[0] == 0) break;
+						dirs.push_back(dir);
+					}
+
+					// file numbers start from 1
+					files.push_back(~0U);
+					while(!r.AtEnd())
+					{
+						const char *name = r.Str();
+						if(name[0] == 0) break;
+						uint64_t dir = r.ULEB();
+						r.ULEB(); // modification time
+						r.ULEB(); // length
+						files.push_back(AddFile(dirs, dir, name));
+					}
+				}
 
-						ret.function = result;
+				if(r.overflow) return;
 
-						if(line2)
+				r.cur = program;
+
+				uint64_t address = 0;
+				uint32_t file = 1, line = 1;
+				uint32_t prevFile = ~0U, prevLine = ~0U;
+				// sequences for functions the linker discarded are left at address 0
+				bool discarded = false;
+
+				while(!r.AtEnd())
+				{
+					uint8_t op = r.U8();
+
+					bool emit = false;
+
+					if(op >= opcodeBase)
+					{
+						uint32_t adjusted = op - opcodeBase;
+						address += (adjusted / lineRange) * minInstLength;
+						line += lineBase + int32_t(adjusted % lineRange);
+						emit = true;
+					}
+					else if(op == 0)
+					{
+						uint64_t len = r.ULEB();
+						if(len == 0) continue;
+						if(len > uint64_t(r.end - r.cur)) break;
+
+						const byte *next = r.cur + len;
+
+						uint8_t sub = r.U8();
+						if(sub == DW_LNE_end_sequence)
 						{
-							char *last = line2 + strlen(line2) - 1;
-							uint32_t mul = 1; ret.line = 0;
-							while(*last >= '0' && *last <= '9')
+							if(!discarded)
 							{
-								ret.line += mul * (uint32_t(*last)-uint32_t('0'));
-								*last = 0;
-								last--;
-								mul *= 10;
+								LineRow row = { address, 0, ~0U, 0 };
+								m_Lines.push_back(row);
 							}
-							if(*last == ':') *last = 0;
 
-							ret.filename = line2;
+							address = 0;
+							file = line = 1;
+							prevFile = prevLine = ~0U;
+							discarded = false;
 						}
+						else if(sub == DW_LNE_set_address)
+						{
+							size_t addrSize = (size_t)RDCMIN(len - 1, (uint64_t)sizeof(uint64_t));
+							address = r.Read(addrSize);
+							if(address == 0 || address == ~0ULL || (addrSize == 4 && address == 0xffffffff))
+								discarded = true;
+						}
+						else if(sub == DW_LNE_define_file && version < 5)
+						{
+							const char *name = r.Str();
+							uint64_t dir = r.ULEB();
+							files.push_back(AddFile(dirs, dir, name));
+						}
+
+						r.cur = next;
+					}
+					else
+					{
+						switch(op)
+						{
+							case DW_LNS_copy: emit = true; break;
+							case DW_LNS_advance_pc: address += r.ULEB() * minInstLength; break;
+							case DW_LNS_advance_line: line += (int32_t)r.SLEB(); break;
+							case DW_LNS_set_file: file = (uint32_t)r.ULEB(); break;
+							case DW_LNS_const_add_pc: address += ((255 - opcodeBase) / lineRange) * minInstLength; break;
+							case DW_LNS_fixed_advance_pc: address += r.U16(); break;
+							default:
+								// set_column, negate_stmt etc. only have operands to skip
+								for(uint8_t i=0; i < opcodeLengths[op]; i++)
+									r.ULEB();
+								break;
+						}
+					}
 
-						break;
+					// consecutive rows for the same line only need the first address
+					if(emit && !discarded && (file != prevFile || line != prevLine))
+					{
+						AddRow(address, files, file, line);
+						prevFile = file;
+						prevLine = line;
 					}
 				}
 			}
 
+			bool m_Valid;
+
+			vector<Segment> m_Segments;
+
+			vector<Symbol> m_Symbols;
+			vector<char> m_Names;
+
+			vector<LineRow> m_Lines;
+			vector<string> m_Files;
+			std::map<string, uint32_t> m_FileIndex;
+
+			string m_DebugLink;
+			vector<byte> m_BuildID;
+	};
+
+	struct ModuleBaseCompare
+	{
+		bool operator()(uint64_t addr, const LookupModule &mod) const { return addr < mod.base; }
+		bool operator()(const LookupModule &a, const LookupModule &b) const { return a.base < b.base; }
+	};
+
+	class LinuxResolver : public Callstack::StackResolver
+	{
+		public:
+			LinuxResolver(const vector<LookupModule> &modules, volatile bool *killSignal)
+			{
+				m_Modules = modules;
+				std::sort(m_Modules.begin(), m_Modules.end(), ModuleBaseCompare());
+
+				m_ModuleSymbols.resize(m_Modules.size(), NULL);
+
+				// each file is parsed once, even if it's mapped more than once
+				std::map<string, ElfSymbols *> files;
+
+				for(size_t i=0; i < m_Modules.size(); i++)
+				{
+					if(killSignal && *killSignal) break;
+
+					ElfSymbols *&syms = files[m_Modules[i].path];
+					if(syms == NULL)
+					{
+						syms = new ElfSymbols(m_Modules[i].path);
+						m_Symbols.push_back(syms);
+					}
+
+					m_ModuleSymbols[i] = syms;
+				}
+			}
+
+			~LinuxResolver()
+			{
+				for(size_t i=0; i < m_Symbols.size(); i++)
+					SAFE_DELETE(m_Symbols[i]);
+			}
+
+			Callstack::AddressDetails GetAddr(uint64_t addr)
+			{
+				std::map<uint64_t, Callstack::AddressDetails>::iterator it = m_Cache.find(addr);
+				if(it != m_Cache.end())
+					return it->second;
+
+				Callstack::AddressDetails &ret = m_Cache[addr];
+
+				ret.filename = "Unknown";
+				ret.line = 0;
+				ret.function = StringFormat::Fmt("0x%08llx", addr);
+
+				vector<LookupModule>::iterator mod = std::upper_bound(m_Modules.begin(), m_Modules.end(), addr, ModuleBaseCompare());
+
+				if(mod != m_Modules.begin())
+				{
+					--mod;
+
+					ElfSymbols *syms = m_ModuleSymbols[mod - m_Modules.begin()];
+
+					if(addr < mod->end && syms && syms->IsValid())
+						syms->Lookup(syms->FileOffsetToAddress(addr - mod->base + mod->offset), ret);
+				}
+
+				return ret;
+			}
+
+		private:
 			std::vector<LookupModule> m_Modules;
+			std::vector<ElfSymbols *> m_ModuleSymbols;
+			std::vector<ElfSymbols *> m_Symbols;
 			std::map<uint64_t, Callstack::AddressDetails> m_Cache;
 	};
 
@@ -250,23 +1057,24 @@ namespace Callstack
 		{
 			if(killSignal && *killSignal) break;
 
-			// find .text segments
+			// find executable segments
 			{
-				long unsigned int base = 0, end = 0;
+				long unsigned int base = 0, end = 0, offset = 0;
 
 				int inode = 0;
 				int offs = 0;
 				//                        base-end   perms offset devid   inode offs
-				int num = sscanf(search, "%lx-%lx  r-xp  %*x    %*x:%*x %d    %n", &base, &end, &inode, &offs);
+				int num = sscanf(search, "%lx-%lx  r-xp  %lx    %*x:%*x %d    %n", &base, &end, &offset, &inode, &offs);
 
 				// we don't care about inode actually, we ust use it to verify that
-				// we read all 3 params (and so perms == r-xp)
-				if(num == 3 && offs > 0)
+				// we read all 4 params (and so perms == r-xp)
+				if(num == 4 && offs > 0)
 				{
 					LookupModule mod = {0};
 
 					mod.base = (uint64_t)base;
 					mod.end = (uint64_t)end;
+					mod.offset = (uint64_t)offset;
 
 					search += offs;
 					while(size_t(search-moduleDB) < DBSize && (*search == ' ' || *search == '\t')) search++;
@@ -277,40 +1085,12 @@ namespace Callstack
 						mod.path[n] = 0;
 						for(size_t i=0; i < n; i++)
 						{
-							if(search[i] == 0 || search[i] == '\n') { mod.path[i] = 0; break; }
 							if(search + i >= moduleDB + DBSize) { mod.path[i] = 0; break; }
+							if(search[i] == 0 || search[i] == '\n') { mod.path[i] = 0; break; }
 							mod.path[i] = search[i];
 						}
 
-						// addr2line wants offsets relative to text section, have to find offset of .text section in this
-						// mmapped section
-
-						int textoffs = 0;
-						string cmd = StringFormat::Fmt("readelf -WS \"%s\"", mod.path);
-
-						FILE *f = ::popen(cmd.c_str(), "r");
-
-						char result[4096] = {0};
-						fread(result, 1, 4095, f);
-
-						fclose(f);
-
-						// find .text line
-						char *find = strstr(result, ".text");
-
-						if(find)
-						{
-							find += 5;
-
-							while(isalpha(*find) || isspace(*find)) find++;
-
-							// virtual address is listed first, we want the offset
-							sscanf(find, "%*x %x", &textoffs);
-
-							mod.base += textoffs;
-
-							modules.push_back(mod);
-						}
+						modules.push_back(mod);
 					}
 				}
 			}
@@ -320,6 +1100,6 @@ namespace Callstack
 			search = strchr(search, '\n'); if(search) search++;
 		}
 
-		return new LinuxResolver(modules);
+		return new LinuxResolver(modules, killSignal);
 	}
 };
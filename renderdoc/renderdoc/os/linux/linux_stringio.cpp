@@ -31,8 +31,10 @@
 #include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/statvfs.h>
 #include <unistd.h>
 #include <pwd.h>
+#include <dirent.h>
 
 #include <X11/Xlib.h>
 #include <X11/keysym.h>
@@ -283,6 +285,39 @@ namespace FileIO
 		return 0;
 	}
 
+	uint64_t GetFreeDiskSpace(const string &path)
+	{
+		struct ::statvfs st;
+		int res = statvfs(path.c_str(), &st);
+
+		if(res == 0)
+		{
+			return (uint64_t)st.f_bavail * (uint64_t)st.f_frsize;
+		}
+
+		return UINT64_MAX;
+	}
+
+	void GetFilesInDirectory(const string &path, vector<string> &files)
+	{
+		DIR *dir = opendir(path.c_str());
+
+		if(!dir)
+			return;
+
+		dirent *ent = NULL;
+		while((ent = readdir(dir)) != NULL)
+		{
+			string fn = path + "/" + ent->d_name;
+
+			struct ::stat st;
+			if(stat(fn.c_str(), &st) == 0 && S_ISREG(st.st_mode))
+				files.push_back(ent->d_name);
+		}
+
+		closedir(dir);
+	}
+
 	void Copy(const char *from, const char *to, bool allowOverwrite)
 	{
 		if(from[0] == 0 || to[0] == 0)
@@ -329,6 +364,19 @@ namespace FileIO
 		::fclose(tf);
 	}
 
+	bool Move(const char *from, const char *to, bool allowOverwrite)
+	{
+		if(allowOverwrite)
+			return ::rename(from, to) == 0;
+
+		// link fails if to exists, where rename would silently replace it
+		if(::link(from, to) != 0)
+			return false;
+
+		unlink(from);
+		return true;
+	}
+
 	void Delete(const char *path)
 	{
 		unlink(path);
@@ -52,6 +52,11 @@ namespace Atomic
 		return __sync_add_and_fetch(i, int32_t(1));
 	}
 
+	int32_t Dec32(volatile int32_t *i)
+	{
+		return __sync_add_and_fetch(i, int32_t(-1));
+	}
+
 	int64_t Inc64(volatile int64_t *i)
 	{
 		return __sync_add_and_fetch(i, int64_t(1));
@@ -103,6 +108,42 @@ namespace Threading
 		pthread_mutex_unlock(&m_Data.lock);
 	}
 
+	template<>
+	RWLock::RWLockTemplate()
+	{
+		pthread_rwlock_init(&m_Data, NULL);
+	}
+
+	template<>
+	RWLock::~RWLockTemplate()
+	{
+		pthread_rwlock_destroy(&m_Data);
+	}
+
+	template<>
+	void RWLock::ReadLock()
+	{
+		pthread_rwlock_rdlock(&m_Data);
+	}
+
+	template<>
+	void RWLock::ReadUnlock()
+	{
+		pthread_rwlock_unlock(&m_Data);
+	}
+
+	template<>
+	void RWLock::WriteLock()
+	{
+		pthread_rwlock_wrlock(&m_Data);
+	}
+
+	template<>
+	void RWLock::WriteUnlock()
+	{
+		pthread_rwlock_unlock(&m_Data);
+	}
+
 	struct ThreadInitData
 	{
 		ThreadEntry entryFunc;
@@ -165,4 +206,27 @@ namespace Threading
 	{
 		usleep(milliseconds*1000);
 	}
+
+	uint32_t GetProcessorCount()
+	{
+		long count = sysconf(_SC_NPROCESSORS_ONLN);
+		return count > 0 ? (uint32_t)count : 1;
+	}
+
+	uint64_t AllocateTLSSlot()
+	{
+		pthread_key_t key;
+		pthread_key_create(&key, NULL);
+		return (uint64_t)key;
+	}
+
+	void *GetTLSValue(uint64_t slot)
+	{
+		return pthread_getspecific((pthread_key_t)slot);
+	}
+
+	void SetTLSValue(uint64_t slot, void *value)
+	{
+		pthread_setspecific((pthread_key_t)slot, value);
+	}
 };
@@ -52,5 +52,6 @@ namespace Threading
 		pthread_mutexattr_t attr;
 	};
 	typedef CriticalSectionTemplate<pthreadLockData> CriticalSection;
+	typedef RWLockTemplate<pthread_rwlock_t> RWLock;
 };
 
@@ -84,6 +84,29 @@ namespace Threading
 
 	// must typedef CriticalSectionTemplate<X> CriticalSection
 
+	// many readers or one writer. Not recursive - a thread holding it for
+	// writing must not take it again in either mode.
+	template<class data>
+	class RWLockTemplate
+	{
+		public:
+			RWLockTemplate();
+			~RWLockTemplate();
+			void ReadLock();
+			void ReadUnlock();
+			void WriteLock();
+			void WriteUnlock();
+
+		private:
+			// no copying
+			RWLockTemplate &operator =(const RWLockTemplate &other);
+			RWLockTemplate(const RWLockTemplate &other);
+
+			data m_Data;
+	};
+
+	// must typedef RWLockTemplate<X> RWLock
+
 	typedef void (*ThreadEntry)(void *);
 	typedef uint64_t ThreadHandle;
 	ThreadHandle CreateThread(ThreadEntry entryFunc, void *userData);
@@ -92,6 +115,15 @@ namespace Threading
 	void CloseThread(ThreadHandle handle);
 	void Sleep(uint32_t milliseconds);
 
+	// number of logical processors, for sizing pools of worker threads
+	uint32_t GetProcessorCount();
+
+	// thread-local storage. Slots are never freed, so only allocate one per long-lived
+	// object rather than per-use. Values start as NULL on every thread.
+	uint64_t AllocateTLSSlot();
+	void *GetTLSValue(uint64_t slot);
+	void SetTLSValue(uint64_t slot, void *value);
+
 	// kind of windows specific, to handle this case:
 	// http://blogs.msdn.com/b/oldnewthing/archive/2013/11/05/10463645.aspx
 	void KeepModuleAlive();
@@ -129,6 +161,7 @@ namespace Network
 namespace Atomic
 {
 	int32_t Inc32(volatile int32_t *i);
+	int32_t Dec32(volatile int32_t *i);
 	int64_t Inc64(volatile int64_t *i);
 	int64_t Dec64(volatile int64_t *i);
 	int64_t ExchAdd64(volatile int64_t *i, int64_t a);
@@ -168,6 +201,9 @@ namespace Callstack
 	void Init();
 
 	Stackwalk *Collect();
+	// walks the chain of saved frame pointers instead of fully unwinding. Much
+	// cheaper, but stops early at any frame built without frame pointers
+	Stackwalk *CollectFramePointers();
 	Stackwalk *Create();
 
 	StackResolver *MakeResolver(char *moduleDB, size_t DBSize, string pdbSearchPaths, volatile bool *killSignal);
@@ -188,8 +224,18 @@ namespace FileIO
 	void GetExecutableFilename(string &selfName);
 	
 	uint64_t GetModifiedTimestamp(const string &filename);
+
+	// free space in bytes available to the current user on the volume containing path, or
+	// UINT64_MAX if it couldn't be queried (e.g. path doesn't exist)
+	uint64_t GetFreeDiskSpace(const string &path);
+
+	// names (not full paths) of the regular files directly inside path, in no particular order
+	void GetFilesInDirectory(const string &path, vector<string> &files);
 	
 	void Copy(const char *from, const char *to, bool allowOverwrite);
+	// atomically replaces to (or fails if it exists and allowOverwrite is false). Both paths
+	// must be on the same volume
+	bool Move(const char *from, const char *to, bool allowOverwrite);
 	void Delete(const char *path);
 
 	FILE *fopen(const char *filename, const char *mode);
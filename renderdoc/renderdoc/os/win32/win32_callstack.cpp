@@ -761,6 +761,13 @@ namespace Callstack
 		return new Win32Callstack();
 	}
 
+	Stackwalk *CollectFramePointers()
+	{
+		// RtlCaptureStackBackTrace is already a cheap walk, and x64 code doesn't
+		// keep a frame pointer chain to follow
+		return new Win32Callstack();
+	}
+
 	Stackwalk *Create()
 	{
 		return new Win32Callstack(NULL, 0);
@@ -307,6 +307,37 @@ namespace FileIO
 		return 0;
 	}
 
+	uint64_t GetFreeDiskSpace(const string &path)
+	{
+		wstring wpath = StringFormat::UTF82Wide(path);
+
+		ULARGE_INTEGER freeBytes;
+
+		if(::GetDiskFreeSpaceExW(wpath.c_str(), &freeBytes, NULL, NULL))
+			return (uint64_t)freeBytes.QuadPart;
+
+		return UINT64_MAX;
+	}
+
+	void GetFilesInDirectory(const string &path, vector<string> &files)
+	{
+		wstring wpath = StringFormat::UTF82Wide(path) + L"\\*";
+
+		WIN32_FIND_DATAW findData;
+		HANDLE find = ::FindFirstFileW(wpath.c_str(), &findData);
+
+		if(find == INVALID_HANDLE_VALUE)
+			return;
+
+		do
+		{
+			if((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+				files.push_back(StringFormat::Wide2UTF8(wstring(findData.cFileName)));
+		} while(::FindNextFileW(find, &findData));
+
+		::FindClose(find);
+	}
+
 	void Copy(const char *from, const char *to, bool allowOverwrite)
 	{
 		wstring wfrom = StringFormat::UTF82Wide(string(from));
@@ -315,6 +346,14 @@ namespace FileIO
 		::CopyFileW(wfrom.c_str(), wto.c_str(), allowOverwrite == false);
 	}
 
+	bool Move(const char *from, const char *to, bool allowOverwrite)
+	{
+		wstring wfrom = StringFormat::UTF82Wide(string(from));
+		wstring wto = StringFormat::UTF82Wide(string(to));
+
+		return ::MoveFileExW(wfrom.c_str(), wto.c_str(), allowOverwrite ? MOVEFILE_REPLACE_EXISTING : 0) != FALSE;
+	}
+
 	void Delete(const char *path)
 	{
 		wstring wpath = StringFormat::UTF82Wide(string(path));
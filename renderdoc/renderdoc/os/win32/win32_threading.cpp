@@ -54,6 +54,11 @@ namespace Atomic
 		return (int32_t)InterlockedIncrement((volatile LONG *)i);
 	}
 
+	int32_t Dec32(volatile int32_t *i)
+	{
+		return (int32_t)InterlockedDecrement((volatile LONG *)i);
+	}
+
 	int64_t Inc64(volatile int64_t *i)
 	{
 		return (int64_t)InterlockedIncrement64((volatile LONG64 *)i);
@@ -98,6 +103,35 @@ namespace Threading
 		LeaveCriticalSection(&m_Data);
 	}
 
+	RWLock::RWLockTemplate()
+	{
+		InitializeSRWLock(&m_Data);
+	}
+
+	RWLock::~RWLockTemplate()
+	{
+	}
+
+	void RWLock::ReadLock()
+	{
+		AcquireSRWLockShared(&m_Data);
+	}
+
+	void RWLock::ReadUnlock()
+	{
+		ReleaseSRWLockShared(&m_Data);
+	}
+
+	void RWLock::WriteLock()
+	{
+		AcquireSRWLockExclusive(&m_Data);
+	}
+
+	void RWLock::WriteUnlock()
+	{
+		ReleaseSRWLockExclusive(&m_Data);
+	}
+
 	struct ThreadInitData
 	{
 		ThreadEntry entryFunc;
@@ -164,4 +198,26 @@ namespace Threading
 	{
 		::Sleep((DWORD)milliseconds);
 	}
+
+	uint32_t GetProcessorCount()
+	{
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return info.dwNumberOfProcessors > 0 ? (uint32_t)info.dwNumberOfProcessors : 1;
+	}
+
+	uint64_t AllocateTLSSlot()
+	{
+		return (uint64_t)TlsAlloc();
+	}
+
+	void *GetTLSValue(uint64_t slot)
+	{
+		return TlsGetValue((DWORD)slot);
+	}
+
+	void SetTLSValue(uint64_t slot, void *value)
+	{
+		TlsSetValue((DWORD)slot, value);
+	}
 };
@@ -52,4 +52,5 @@ namespace OSUtility
 namespace Threading
 {
 	typedef CriticalSectionTemplate<CRITICAL_SECTION> CriticalSection;
+	typedef RWLockTemplate<SRWLOCK> RWLock;
 };
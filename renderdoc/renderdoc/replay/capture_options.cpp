@@ -23,6 +23,7 @@
  ******************************************************************************/
 
 #include <float.h>
+#include <string.h>
 
 #include "common/common.h"
 #include "core/core.h"
@@ -71,6 +72,24 @@ int RENDERDOC_CC SetCaptureOptionU32(RENDERDOC_CaptureOption opt, uint32_t val)
 		case eRENDERDOC_Option_DebugOutputMute:
 			opts.DebugOutputMute = (val != 0);
 			break;
+		case eRENDERDOC_Option_PeriodicCaptureFrames:
+			opts.PeriodicCaptureFrames = val;
+			break;
+		case eRENDERDOC_Option_PeriodicCaptureMS:
+			opts.PeriodicCaptureMS = val;
+			break;
+		case eRENDERDOC_Option_MaxPendingCaptures:
+			opts.MaxPendingCaptures = RDCMAX(val, 1U);
+			break;
+		case eRENDERDOC_Option_MinFreeDiskMB:
+			opts.MinFreeDiskMB = val;
+			break;
+		case eRENDERDOC_Option_SharedInitialContents:
+			opts.SharedInitialContents = (val != 0);
+			break;
+		case eRENDERDOC_Option_FramePointerCallstacks:
+			opts.FramePointerCallstacks = (val != 0);
+			break;
 		default:
 			RDCLOG("Unrecognised capture option '%d'", opt);
 			return 0;
@@ -122,6 +141,24 @@ int RENDERDOC_CC SetCaptureOptionF32(RENDERDOC_CaptureOption opt, float val)
 		case eRENDERDOC_Option_DebugOutputMute:
 			opts.DebugOutputMute = (val != 0.0f);
 			break;
+		case eRENDERDOC_Option_PeriodicCaptureFrames:
+			opts.PeriodicCaptureFrames = (uint32_t)val;
+			break;
+		case eRENDERDOC_Option_PeriodicCaptureMS:
+			opts.PeriodicCaptureMS = (uint32_t)val;
+			break;
+		case eRENDERDOC_Option_MaxPendingCaptures:
+			opts.MaxPendingCaptures = RDCMAX((uint32_t)val, 1U);
+			break;
+		case eRENDERDOC_Option_MinFreeDiskMB:
+			opts.MinFreeDiskMB = (uint32_t)val;
+			break;
+		case eRENDERDOC_Option_SharedInitialContents:
+			opts.SharedInitialContents = (val != 0.0f);
+			break;
+		case eRENDERDOC_Option_FramePointerCallstacks:
+			opts.FramePointerCallstacks = (val != 0.0f);
+			break;
 		default:
 			RDCLOG("Unrecognised capture option '%d'", opt);
 			return 0;
@@ -159,6 +196,18 @@ uint32_t RENDERDOC_CC GetCaptureOptionU32(RENDERDOC_CaptureOption opt)
 			return (RenderDoc::Inst().GetCaptureOptions().CaptureAllCmdLists ? 1 : 0);
 		case eRENDERDOC_Option_DebugOutputMute:
 			return (RenderDoc::Inst().GetCaptureOptions().DebugOutputMute ? 1 : 0);
+		case eRENDERDOC_Option_PeriodicCaptureFrames:
+			return (RenderDoc::Inst().GetCaptureOptions().PeriodicCaptureFrames);
+		case eRENDERDOC_Option_PeriodicCaptureMS:
+			return (RenderDoc::Inst().GetCaptureOptions().PeriodicCaptureMS);
+		case eRENDERDOC_Option_MaxPendingCaptures:
+			return (RenderDoc::Inst().GetCaptureOptions().MaxPendingCaptures);
+		case eRENDERDOC_Option_MinFreeDiskMB:
+			return (RenderDoc::Inst().GetCaptureOptions().MinFreeDiskMB);
+		case eRENDERDOC_Option_SharedInitialContents:
+			return (RenderDoc::Inst().GetCaptureOptions().SharedInitialContents ? 1 : 0);
+		case eRENDERDOC_Option_FramePointerCallstacks:
+			return (RenderDoc::Inst().GetCaptureOptions().FramePointerCallstacks ? 1 : 0);
 		default: break;
 	}
 
@@ -194,6 +243,18 @@ float RENDERDOC_CC GetCaptureOptionF32(RENDERDOC_CaptureOption opt)
 			return (RenderDoc::Inst().GetCaptureOptions().CaptureAllCmdLists ? 1.0f : 0.0f);
 		case eRENDERDOC_Option_DebugOutputMute:
 			return (RenderDoc::Inst().GetCaptureOptions().DebugOutputMute ? 1.0f : 0.0f);
+		case eRENDERDOC_Option_PeriodicCaptureFrames:
+			return (RenderDoc::Inst().GetCaptureOptions().PeriodicCaptureFrames * 1.0f);
+		case eRENDERDOC_Option_PeriodicCaptureMS:
+			return (RenderDoc::Inst().GetCaptureOptions().PeriodicCaptureMS * 1.0f);
+		case eRENDERDOC_Option_MaxPendingCaptures:
+			return (RenderDoc::Inst().GetCaptureOptions().MaxPendingCaptures * 1.0f);
+		case eRENDERDOC_Option_MinFreeDiskMB:
+			return (RenderDoc::Inst().GetCaptureOptions().MinFreeDiskMB * 1.0f);
+		case eRENDERDOC_Option_SharedInitialContents:
+			return (RenderDoc::Inst().GetCaptureOptions().SharedInitialContents ? 1.0f : 0.0f);
+		case eRENDERDOC_Option_FramePointerCallstacks:
+			return (RenderDoc::Inst().GetCaptureOptions().FramePointerCallstacks ? 1.0f : 0.0f);
 		default: break;
 	}
 
@@ -215,4 +276,11 @@ CaptureOptions::CaptureOptions()
 	SaveAllInitials = false;
 	CaptureAllCmdLists = false;
 	DebugOutputMute = true;
+	PeriodicCaptureFrames = 0;
+	PeriodicCaptureMS = 0;
+	MaxPendingCaptures = 2;
+	MinFreeDiskMB = 0;
+	SharedInitialContents = false;
+	FramePointerCallstacks = false;
+	RDCEraseEl(PeriodicCaptureFilename);
 }
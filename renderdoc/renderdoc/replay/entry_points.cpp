@@ -287,6 +287,12 @@ bool32 RENDERDOC_CC RENDERDOC_SupportLocalReplay(const char *logfile, rdctype::s
 	return RenderDoc::Inst().HasReplayDriver(driverType);
 }
 
+extern "C" RENDERDOC_API
+void RENDERDOC_CC RENDERDOC_SetInitialContentsBudget(uint32_t budgetMB)
+{
+	RenderDoc::Inst().SetInitialContentsBudget(uint64_t(budgetMB)*1024*1024);
+}
+
 extern "C" RENDERDOC_API
 ReplayCreateStatus RENDERDOC_CC RENDERDOC_CreateReplayRenderer(const char *logfile, float *progress, ReplayRenderer **rend)
 {
@@ -394,6 +400,123 @@ bool32 RENDERDOC_CC RENDERDOC_GetThumbnail(const char *filename, byte *buf, uint
 	return true;
 }
 
+struct RepackJobs
+{
+	const char **logfiles;
+	const char **outfiles;
+	uint32_t numFiles;
+	string storeDir;
+	RepackOptions opts;
+	RepackResult *results;
+
+	Threading::CriticalSection lock;
+	uint32_t nextFile;
+	uint64_t memoryInUse;
+	uint64_t memoryBudget;
+};
+
+static void RepackThread(void *data)
+{
+	RepackJobs *jobs = (RepackJobs *)data;
+
+	for(;;)
+	{
+		uint32_t idx = 0;
+
+		{
+			SCOPED_LOCK(jobs->lock);
+
+			if(jobs->nextFile >= jobs->numFiles)
+				break;
+
+			idx = jobs->nextFile++;
+		}
+
+		uint64_t memory = 0;
+
+		{
+			Serialiser ser(jobs->logfiles[idx], Serialiser::READING, false);
+
+			// the read window only grows to fit the largest chunk, but at worst that's the whole
+			// stream. Each chunk is also copied once on its way through, plus the lz4 pages.
+			memory = ser.GetFrameCaptureSize()*2 + jobs->opts.blockSize*4;
+		}
+
+		// wait for room in the budget. If this capture alone is over budget it still
+		// goes ahead once nothing else is in flight.
+		for(;;)
+		{
+			{
+				SCOPED_LOCK(jobs->lock);
+
+				if(jobs->memoryBudget == 0 || jobs->memoryInUse == 0 || jobs->memoryInUse + memory <= jobs->memoryBudget)
+				{
+					jobs->memoryInUse += memory;
+					break;
+				}
+			}
+
+			Threading::Sleep(10);
+		}
+
+		RDCLOG("Repacking '%s' to '%s'", jobs->logfiles[idx], jobs->outfiles[idx]);
+
+		Serialiser::Repack(jobs->logfiles[idx], jobs->outfiles[idx], jobs->storeDir, jobs->opts, jobs->results[idx]);
+
+		{
+			SCOPED_LOCK(jobs->lock);
+			jobs->memoryInUse -= memory;
+		}
+	}
+}
+
+extern "C" RENDERDOC_API
+bool32 RENDERDOC_CC RENDERDOC_RepackLogFiles(const char **logfiles, const char **outfiles, uint32_t numFiles,
+																	const char *storeDir, const RepackOptions *opts, RepackResult *results)
+{
+	if(logfiles == NULL || outfiles == NULL || opts == NULL || results == NULL)
+		return false;
+
+	RepackJobs jobs;
+	jobs.logfiles = logfiles;
+	jobs.outfiles = outfiles;
+	jobs.numFiles = numFiles;
+	jobs.opts = *opts;
+	if(jobs.opts.blockSize == 0)
+		jobs.opts.blockSize = 64*1024;
+	jobs.results = results;
+	jobs.nextFile = 0;
+	jobs.memoryInUse = 0;
+	jobs.memoryBudget = uint64_t(opts->memoryBudgetMB)*1024*1024;
+
+	if(storeDir && storeDir[0])
+		jobs.storeDir = string(storeDir) + "/" + Serialiser::ExternalStoreName;
+
+	uint32_t numThreads = RDCCLAMP(opts->numThreads, 1U, RDCMAX(numFiles, 1U));
+
+	vector<Threading::ThreadHandle> threads;
+
+	// this thread does its share of the work too
+	for(uint32_t i=1; i < numThreads; i++)
+		threads.push_back(Threading::CreateThread(RepackThread, &jobs));
+
+	RepackThread(&jobs);
+
+	for(size_t i=0; i < threads.size(); i++)
+	{
+		Threading::JoinThread(threads[i]);
+		Threading::CloseThread(threads[i]);
+	}
+
+	bool32 ret = true;
+
+	for(uint32_t i=0; i < numFiles; i++)
+		if(!results[i].success)
+			ret = false;
+
+	return ret;
+}
+
 extern "C" RENDERDOC_API
 void RENDERDOC_CC RENDERDOC_FreeArrayMem(const void *mem)
 {
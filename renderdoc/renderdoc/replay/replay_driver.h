@@ -75,9 +75,12 @@ class IRemoteDriver
 		virtual GLPipelineState GetGLPipelineState() = 0;
 
 		virtual vector<FetchFrameRecord> GetFrameRecord() = 0;
+		virtual LoadProfile GetLoadProfile() = 0;
 		
 		virtual void ReadLogInitialisation() = 0;
 		virtual void SetContextFilter(ResourceId id, uint32_t firstDefEv, uint32_t lastDefEv) = 0;
+		virtual void SetReplayCheckpoints(uint32_t eventInterval, uint64_t memoryBudget) = 0;
+		virtual ReplayCheckpointStats GetReplayCheckpointStats() = 0;
 		virtual void ReplayLog(uint32_t frameID, uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType) = 0;
 
 		virtual void InitPostVSBuffers(uint32_t frameID, uint32_t eventID) = 0;
@@ -162,6 +165,16 @@ class IReplayDriver : public IRemoteDriver
 		virtual void PickPixel(ResourceId texture, uint32_t x, uint32_t y, uint32_t sliceFace, uint32_t mip, uint32_t sample, float pixel[4]) = 0;
 		virtual uint32_t PickVertex(uint32_t frameID, uint32_t eventID, MeshDisplay cfg, uint32_t x, uint32_t y) = 0;
 
+		// batched readback. Queue* kicks off a GPU copy into CPU-readable memory and returns
+		// a ticket (0 on failure, e.g. multisampled textures - use GetTextureData for those).
+		// FetchReadback returns false if the copy hasn't completed yet (and wait is false),
+		// otherwise fills data in the same layout as GetBufferData/GetTextureData and releases
+		// the ticket.
+		virtual uint32_t QueueBufferReadback(ResourceId buff, uint32_t offset, uint32_t len) = 0;
+		virtual uint32_t QueueTextureReadback(ResourceId tex, uint32_t arrayIdx, uint32_t mip) = 0;
+		virtual bool FetchReadback(uint32_t ticket, bool wait, vector<byte> &data) = 0;
+		virtual void FreeReadbacks() = 0;
+
 		/* Added by Stephan Richter | BEGIN */
 		virtual void SetIDRenderingEvents(uint32_t frameID, uint32_t startEventID, uint32_t endEventID) = 0;
 		virtual void SetIDRendering(bool active, ResourceId shaderID) = 0;
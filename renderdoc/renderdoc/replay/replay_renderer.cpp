@@ -27,6 +27,7 @@
 
 #include <string.h>
 #include <time.h>
+#include <algorithm>
 
 #include "serialise/string_utils.h"
 #include "maths/formatpacking.h"
@@ -44,19 +45,10 @@
 /* Removed by Stephan Richter | END */
 
 #include "common/dds_readwrite.h"
+#include "common/exr_readwrite.h"
 
 /* Added by Stephan Richter | BEGIN */
-#include <ImfOutputFile.h>
-#include <ImfInputFile.h>
-#include <ImfChannelList.h>
-#include <ImfStringAttribute.h>
-#include <ImfMatrixAttribute.h>
-#include <ImfArray.h>
-#include <ImfNamespace.h>
-
 #include "replay/MurmurHash3.h"
-namespace IMF = OPENEXR_IMF_NAMESPACE;
-
 /* Added by Stephan Richter | END */
 
 float ConvertComponent(ResourceFormat fmt, byte *data)
@@ -157,9 +149,14 @@ ReplayRenderer::ReplayRenderer()
 	m_FrameID = 0;
 	m_EventID = 100000;
 
+	m_ReplayStateValid = false;
+	RDCEraseEl(m_ReplayStats);
+
 	m_DeferredCtx = ResourceId();
 	m_FirstDeferredEvent = 0;
 	m_LastDeferredEvent = 0;
+
+	m_NextDebugTraceID = 1;
 }
 
 ReplayRenderer::~ReplayRenderer()
@@ -195,6 +192,8 @@ bool ReplayRenderer::SetContextFilter(ResourceId id, uint32_t firstDefEv, uint32
 	m_FirstDeferredEvent = firstDefEv;
 	m_LastDeferredEvent = lastDefEv;
 
+	InvalidateReplayState();
+
 	for(size_t i=0; i < m_Outputs.size(); i++)
 		m_Outputs[i]->SetContextFilter(id, firstDefEv, lastDefEv);
 	
@@ -208,15 +207,24 @@ bool ReplayRenderer::SetFrameEvent(uint32_t frameID, uint32_t eventID)
 	return SetFrameEvent(frameID, eventID, false);
 }
 
+bool ReplayRenderer::SetReplayCheckpoints(uint32_t eventInterval, uint32_t memoryBudgetMB)
+{
+	m_pDevice->SetReplayCheckpoints(eventInterval, uint64_t(memoryBudgetMB)*1024*1024);
+
+	return true;
+}
+
 /* Added by Stephan Richter | BEGIN */
 void ReplayRenderer::SetIDRenderingEvents(uint32_t frameID, uint32_t startEventID, uint32_t endEventID)
 {
 	m_pDevice->SetIDRenderingEvents(frameID, startEventID, endEventID);
+	InvalidateReplayState();
 }
 
 void ReplayRenderer::SetIDRendering(bool active, ResourceId shaderID)
 {
 	m_pDevice->SetIDRendering(active, shaderID);
+	InvalidateReplayState();
 }
 /* Added by Stephan Richter | END */
 
@@ -224,10 +232,37 @@ bool ReplayRenderer::SetFrameEvent(uint32_t frameID, uint32_t eventID, bool forc
 {
 	if(m_FrameID != frameID || eventID != m_EventID || force)
 	{
+		uint32_t startEventID = 0;
+
+		// moving forward from an event we replayed exactly, we only need to replay the
+		// events in between. The partial replay must begin on an event with a file offset
+		// or the driver would start from the one before and execute it twice.
+		if(!force && m_ReplayStateValid && frameID == m_FrameID && eventID > m_EventID &&
+			 m_DeferredCtx == ResourceId() &&
+			 std::binary_search(m_APIEvents.begin(), m_APIEvents.end(), m_EventID))
+		{
+			auto it = std::upper_bound(m_APIEvents.begin(), m_APIEvents.end(), m_EventID);
+			if(it != m_APIEvents.end() && *it <= eventID)
+				startEventID = *it;
+		}
+
+		auto last = std::upper_bound(m_APIEvents.begin(), m_APIEvents.end(), eventID);
+
+		if(startEventID > 0)
+		{
+			m_ReplayStats.forwardReplays++;
+			m_ReplayStats.eventsReplayed += last - std::lower_bound(m_APIEvents.begin(), m_APIEvents.end(), startEventID);
+		}
+		else
+		{
+			m_ReplayStats.fullReplays++;
+			m_ReplayStats.eventsReplayed += last - m_APIEvents.begin();
+		}
+
 		m_FrameID = frameID;
 		m_EventID = eventID;
 
-		m_pDevice->ReplayLog(frameID, 0, eventID, eReplay_WithoutDraw);
+		m_pDevice->ReplayLog(frameID, startEventID, eventID, eReplay_WithoutDraw);
 
 		FetchPipelineState();
 
@@ -235,6 +270,8 @@ bool ReplayRenderer::SetFrameEvent(uint32_t frameID, uint32_t eventID, bool forc
 			m_Outputs[i]->SetFrameEvent(frameID, eventID);
 		
 		m_pDevice->ReplayLog(frameID, 0, eventID, eReplay_OnlyDraw);
+
+		m_ReplayStateValid = true;
 	}
 
 	return true;
@@ -292,6 +329,45 @@ bool ReplayRenderer::GetDrawcalls(uint32_t frameID, rdctype::array<FetchDrawcall
 	return true;
 }
 
+bool ReplayRenderer::GetDrawcallTable(uint32_t frameID, const FetchFlatDrawcall **draws, uint32_t *count, const char **strings)
+{
+	if(frameID >= (uint32_t)m_FrameRecord.size() || draws == NULL || count == NULL || strings == NULL)
+		return false;
+
+	const FrameRecord &frame = m_FrameRecord[frameID];
+
+	*draws = frame.m_DrawcallTable.empty() ? NULL : &frame.m_DrawcallTable[0];
+	*count = (uint32_t)frame.m_DrawcallTable.size();
+	*strings = &frame.m_DrawcallNames[0];
+	return true;
+}
+
+bool ReplayRenderer::GetRenderPasses(uint32_t frameID, rdctype::array<FetchRenderPass> *passes)
+{
+	if(frameID >= (uint32_t)m_FrameRecord.size() || passes == NULL)
+		return false;
+
+	*passes = m_FrameRecord[frameID].m_RenderPasses;
+	return true;
+}
+
+bool ReplayRenderer::FindRenderPasses(uint32_t frameID, uint32_t numOutputs, bool32 hasDepth, rdctype::array<FetchRenderPass> *passes)
+{
+	if(frameID >= (uint32_t)m_FrameRecord.size() || passes == NULL)
+		return false;
+
+	const vector<FetchRenderPass> &all = m_FrameRecord[frameID].m_RenderPasses;
+
+	vector<FetchRenderPass> ret;
+
+	for(size_t i=0; i < all.size(); i++)
+		if(all[i].numOutputs == numOutputs && (all[i].depthOut != ResourceId()) == (hasDepth != 0))
+			ret.push_back(all[i]);
+
+	*passes = ret;
+	return true;
+}
+
 bool ReplayRenderer::FetchCounters(uint32_t frameID, uint32_t minEventID, uint32_t maxEventID,
                                    uint32_t *counters, uint32_t numCounters, rdctype::array<CounterResult> *results)
 {
@@ -303,6 +379,8 @@ bool ReplayRenderer::FetchCounters(uint32_t frameID, uint32_t minEventID, uint32
 	for(uint32_t i=0; i < numCounters; i++)
 		counterArray.push_back(counters[i]);
 
+	InvalidateReplayState();
+
 	*results = m_pDevice->FetchCounters(frameID, minEventID, maxEventID, counterArray);
 	
 	return true;
@@ -430,6 +508,59 @@ bool ReplayRenderer::GetDebugMessages(rdctype::array<DebugMessage> *msgs)
 	return false;
 }
 
+bool ReplayRenderer::GetReplayStats(ReplayStats *stats)
+{
+	if(stats == NULL)
+		return false;
+
+	*stats = m_ReplayStats;
+	stats->checkpoints = m_pDevice->GetReplayCheckpointStats();
+	return true;
+}
+
+bool ReplayRenderer::GetLoadProfile(LoadProfile *profile)
+{
+	if(profile == NULL)
+		return false;
+
+	*profile = m_pDevice->GetLoadProfile();
+
+	// the driver records a timing per event, group them into ranges that end at
+	// each drawcall so they line up with the event browser.
+	vector<LoadEventTiming> ranges;
+	LoadEventTiming cur = { 0, 0, 0.0 };
+	bool open = false;
+
+	for(int32_t i=0; i < profile->events.count; i++)
+	{
+		const LoadEventTiming &ev = profile->events[i];
+
+		if(!open)
+		{
+			cur = ev;
+			open = true;
+		}
+		else
+		{
+			cur.endEventID = ev.endEventID;
+			cur.replayMS += ev.replayMS;
+		}
+
+		if(ev.endEventID < m_Drawcalls.size() && m_Drawcalls[ev.endEventID] != NULL)
+		{
+			ranges.push_back(cur);
+			open = false;
+		}
+	}
+
+	if(open)
+		ranges.push_back(cur);
+
+	profile->events = ranges;
+
+	return true;
+}
+
 bool ReplayRenderer::GetUsage(ResourceId id, rdctype::array<EventUsage> *usage)
 {
 	if(usage)
@@ -1056,151 +1187,78 @@ bool ReplayRenderer::SaveTexture(const TextureSave &saveData, const char *path)
 
 	if (sd.destType == eFileType_EXR)
 	{
-		IMF::Header header(td.width, td.height);
-		IMF::FrameBuffer frameBuffer;
-
-		if (td.format.special && td.format.specialFormat == eSpecial_D32S8)
-		{
-			float    *rdata = new float[td.width*td.height];
-			uint32_t *gdata = new uint32_t[td.width*td.height];
-			
-			byte *srcData = subdata[0];
+		exr_data exrData;
+		exrData.width = td.width;
+		exrData.height = td.height;
+		exrData.format = td.format;
+		exrData.compression = exr_compress_zip;
+		exrData.data = subdata[0];
 
-			for (uint32_t y = 0; y < td.height; y++)
-			{
-				for (uint32_t x = 0; x < td.width; x++)
-				{
-					float r    = *(float*)(srcData);
-					uint32_t g = (uint32_t)(*(srcData+4));
-			
-					rdata[y*td.width + x] = r;
-					gdata[y*td.width + x] = g;
+		float *fldata = NULL;
 
-					srcData += 8;
-				}
-			}
-
-			
-			header.channels().insert("D", IMF::Channel(IMF::FLOAT));
-			header.channels().insert("S", IMF::Channel(IMF::UINT));
-			
-			auto slice = IMF::Slice(IMF::FLOAT,			// type
-				(char *)rdata,		// base
-				sizeof(*rdata) * 1,		// xStride
-				sizeof(*rdata) * td.width);
-
-			frameBuffer.insert("D", slice);
-
-			frameBuffer.insert("S", IMF::Slice(IMF::UINT,			// type
-				(char *)gdata,		// base
-				sizeof(*gdata) * 1,		// xStride
-				sizeof(*gdata) * td.width));
-
-			IMF::OutputFile file(path, header);
-			file.setFrameBuffer(frameBuffer);
-			file.writePixels(td.height);
-		}
-		else
+		// half, float and uint data (and D32S8 as separate D and S channels) is written as it is,
+		// anything else is converted to float with the same channels
+		if (!is_exr_format(td.format))
 		{
-			float *rdata = new float[td.width*td.height];
-			float *gdata = new float[td.width*td.height];
-			float *bdata = new float[td.width*td.height];
-			float *adata = new float[td.width*td.height];
+			uint32_t numComps = td.format.compCount;
+			if (td.format.special && td.format.specialFormat == eSpecial_R10G10B10A2)
+				numComps = 4;
+			else if (td.format.special && td.format.specialFormat == eSpecial_R11G11B10)
+				numComps = 3;
+
+			fldata = new float[td.width*td.height*numComps];
 
 			byte *srcData = subdata[0];
+			float *dstData = fldata;
 
 			for (uint32_t y = 0; y < td.height; y++)
 			{
 				for (uint32_t x = 0; x < td.width; x++)
 				{
-					float r = 0.0f;
-					float g = 0.0f;
-					float b = 0.0f;
-					float a = 1.0f;
-
 					if (td.format.special && td.format.specialFormat == eSpecial_R10G10B10A2)
 					{
-						uint32_t *u32 = (uint32_t *)srcData;
-
-						Vec4f vec = ConvertFromR10G10B10A2(*u32);
+						Vec4f vec = ConvertFromR10G10B10A2(*(uint32_t *)srcData);
 
-						r = vec.x;
-						g = vec.y;
-						b = vec.z;
-						a = vec.w;
+						dstData[0] = vec.x;
+						dstData[1] = vec.y;
+						dstData[2] = vec.z;
+						dstData[3] = vec.w;
 
 						srcData += 4;
 					}
 					else if (td.format.special && td.format.specialFormat == eSpecial_R11G11B10)
 					{
-						uint32_t *u32 = (uint32_t *)srcData;
+						Vec3f vec = ConvertFromR11G11B10(*(uint32_t *)srcData);
 
-						Vec3f vec = ConvertFromR11G11B10(*u32);
-
-						r = vec.x;
-						g = vec.y;
-						b = vec.z;
-						a = 1.0f;
+						dstData[0] = vec.x;
+						dstData[1] = vec.y;
+						dstData[2] = vec.z;
 
 						srcData += 4;
 					}
 					else
 					{
-						if (td.format.compCount >= 1)
-							r = ConvertComponent(td.format, srcData + td.format.compByteWidth * 0);
-						if (td.format.compCount >= 2)
-							g = ConvertComponent(td.format, srcData + td.format.compByteWidth * 1);
-						if (td.format.compCount >= 3)
-							b = ConvertComponent(td.format, srcData + td.format.compByteWidth * 2);
-						if (td.format.compCount >= 4)
-							a = ConvertComponent(td.format, srcData + td.format.compByteWidth * 3);
+						for (uint32_t c = 0; c < numComps; c++)
+							dstData[c] = ConvertComponent(td.format, srcData + td.format.compByteWidth * c);
 
 						srcData += td.format.compCount * td.format.compByteWidth;
 					}
 
-					rdata[y*td.width + x] = r;
-					gdata[y*td.width + x] = g;
-					bdata[y*td.width + x] = b;
-					adata[y*td.width + x] = a;
+					dstData += numComps;
 				}
 			}
 
-			header.channels().insert("R", IMF::Channel(IMF::FLOAT));
-			header.channels().insert("G", IMF::Channel(IMF::FLOAT));
-			header.channels().insert("B", IMF::Channel(IMF::FLOAT));
-			header.channels().insert("A", IMF::Channel(IMF::FLOAT));
-
-			frameBuffer.insert("R", IMF::Slice(IMF::FLOAT,			// type
-				(char *)rdata,		// base
-				sizeof(*rdata) * 1,		// xStride
-				sizeof(*rdata) * td.width));
-
-			frameBuffer.insert("G", IMF::Slice(IMF::FLOAT,			// type
-				(char *)gdata,		// base
-				sizeof(*gdata) * 1,		// xStride
-				sizeof(*gdata) * td.width));
-
-			frameBuffer.insert("B", IMF::Slice(IMF::FLOAT,			// type
-				(char *)bdata,		// base
-				sizeof(*bdata) * 1,		// xStride
-				sizeof(*bdata) * td.width));
-
-			frameBuffer.insert("A", IMF::Slice(IMF::FLOAT,			// type
-				(char *)adata,		// base
-				sizeof(*adata) * 1,		// xStride
-				sizeof(*adata) * td.width));
-
-			IMF::OutputFile file(path, header);
-			file.setFrameBuffer(frameBuffer);
-			file.writePixels(td.height);
+			exrData.format.special = false;
+			exrData.format.specialFormat = eSpecial_Unknown;
+			exrData.format.compCount = numComps;
+			exrData.format.compByteWidth = 4;
+			exrData.format.compType = eCompType_Float;
+			exrData.data = (byte *)fldata;
 		}
 
-		success = true;
-		/*const char *err = NULL;
-		int ret = SaveEXRFP(fldata, (int)td.width, (int)td.height, f, &err);
-		success = (ret == 0);
-		if (!success)
-		RDCERR("Error saving EXR file %d: '%s'", ret, err);	*/
+		success = write_exr_to_file(path, exrData, ~0U);
+
+		SAFE_DELETE_ARRAY(fldata);
 	}
 	else
 	{
@@ -1360,14 +1418,6 @@ bool ReplayRenderer::SaveTexture(const TextureSave &saveData, const char *path)
 					int ret = stbi_write_hdr_to_file(f, td.width, td.height, 4, fldata);
 					success = (ret != 0);
 				}
-				/*else if(sd.destType == eFileType_EXR)
-				{
-				const char *err = NULL;
-				int ret = SaveEXRFP(fldata, (int)td.width, (int)td.height, f, &err);
-				success = (ret == 0);
-				if(!success)
-				RDCERR("Error saving EXR file %d: '%s'", ret, err);
-				}*/
 
 				delete[] fldata;
 			}
@@ -1634,6 +1684,18 @@ bool ReplayRenderer::HashTexture(const TextureSave &saveData, const char *path)
 		slicePitch = rowPitch * td.height;
 	}
 
+	// without a downcast or resolve we want the raw subresources, so queue all the
+	// copies up front and let them overlap instead of waiting on each in turn.
+	// Anything that can't be queued falls back to GetTextureData below.
+	vector<uint32_t> tickets;
+
+	if (!downcast && !multisampled && td.depth == 1)
+	{
+		for (uint32_t s = 0; s < numSlices; s++)
+			for (uint32_t m = 0; m < numMips; m++)
+				tickets.push_back(m_pDevice->QueueTextureReadback(liveid, s*sliceStride + sliceOffset, m + mipOffset));
+	}
+
 	// loop over fetching subresources
 	for (uint32_t s = 0; s < numSlices; s++)
 	{
@@ -1644,7 +1706,21 @@ bool ReplayRenderer::HashTexture(const TextureSave &saveData, const char *path)
 			uint32_t mip = m + mipOffset;
 
 			size_t datasize = 0;
-			byte *bytes = m_pDevice->GetTextureData(liveid, slice, mip, resolveSamples, downcast, sd.comp.blackPoint, sd.comp.whitePoint, datasize);
+			byte *bytes = NULL;
+
+			vector<byte> readback;
+			uint32_t ticket = tickets.empty() ? 0 : tickets[s*numMips + m];
+
+			if (ticket != 0 && m_pDevice->FetchReadback(ticket, true, readback) && !readback.empty())
+			{
+				datasize = readback.size();
+				bytes = new byte[datasize];
+				memcpy(bytes, &readback[0], datasize);
+			}
+			else
+			{
+				bytes = m_pDevice->GetTextureData(liveid, slice, mip, resolveSamples, downcast, sd.comp.blackPoint, sd.comp.whitePoint, datasize);
+			}
 
 			if (bytes == NULL)
 			{
@@ -1653,6 +1729,10 @@ bool ReplayRenderer::HashTexture(const TextureSave &saveData, const char *path)
 				for (size_t i = 0; i < subdata.size(); i++)
 					delete[] subdata[i];
 
+				// release any copies still queued
+				if (!tickets.empty())
+					m_pDevice->FreeReadbacks();
+
 				return false;
 			}
 
@@ -1926,7 +2006,7 @@ bool ReplayRenderer::HashTexture(const TextureSave &saveData, const char *path)
 	MurmurHash3_x64_128(subdata[0], len, 0, bigHash);
 
 	FILE* fid = fopen(path, "a");
-	fprintf(fid, "%I64d,%.16I64x.%.16I64x\n", sd.id, bigHash[0], bigHash[1]);
+	fprintf(fid, "%llu,%016llx.%016llx\n", (unsigned long long)sd.id.id, (unsigned long long)bigHash[0], (unsigned long long)bigHash[1]);
 	fclose(fid);
 		
 	success = true;
@@ -1945,7 +2025,47 @@ bool ReplayRenderer::HashBufferData(ResourceId buffer, const char *path)
 	MurmurHash3_x64_128(data.elems, data.count, 0, bigHash);
 
 	FILE* fid = fopen(path, "a");
-	fprintf(fid, "%I64d,%.16I64x.%.16I64x\n", buffer, bigHash[0], bigHash[1]);
+	fprintf(fid, "%llu,%016llx.%016llx\n", (unsigned long long)buffer.id, (unsigned long long)bigHash[0], (unsigned long long)bigHash[1]);
+	fclose(fid);
+
+	return true;
+}
+
+bool ReplayRenderer::HashBuffers(ResourceId *buffers, uint32_t numBuffers, const char *path)
+{
+	FILE* fid = fopen(path, "a");
+	if(fid == NULL)
+		return false;
+
+	// keep a window of readbacks in flight so the copies overlap with the
+	// hashing instead of each buffer waiting on its own round trip
+	const uint32_t maxInFlight = 32;
+
+	vector<ResourceId> liveids(numBuffers);
+	vector<uint32_t> tickets(numBuffers, 0);
+
+	for(uint32_t i=0; i < numBuffers; i++)
+		liveids[i] = m_pDevice->GetLiveID(buffers[i]);
+
+	for(uint32_t i=0; i < numBuffers && i < maxInFlight; i++)
+		tickets[i] = m_pDevice->QueueBufferReadback(liveids[i], 0, 0);
+
+	for(uint32_t i=0; i < numBuffers; i++)
+	{
+		vector<byte> data;
+
+		if(tickets[i] == 0 || !m_pDevice->FetchReadback(tickets[i], true, data))
+			data = m_pDevice->GetBufferData(liveids[i], 0, 0);
+
+		if(i + maxInFlight < numBuffers)
+			tickets[i + maxInFlight] = m_pDevice->QueueBufferReadback(liveids[i + maxInFlight], 0, 0);
+
+		uint64_t bigHash[2];
+		MurmurHash3_x64_128(data.empty() ? NULL : &data[0], (int)data.size(), 0, bigHash);
+
+		fprintf(fid, "%llu,%016llx.%016llx\n", (unsigned long long)buffers[i].id, (unsigned long long)bigHash[0], (unsigned long long)bigHash[1]);
+	}
+
 	fclose(fid);
 
 	return true;
@@ -1959,7 +2079,7 @@ bool ReplayRenderer::HashShader(ResourceId buffer, const char *path)
 	MurmurHash3_x64_128(data.elems, data.count, 0, bigHash);
 
 	FILE* fid = fopen(path, "a");
-	fprintf(fid, "%I64d,%.16I64x.%.16I64x\n", m_pDevice->GetOriginalID(buffer), bigHash[0], bigHash[1]);
+	fprintf(fid, "%llu,%016llx.%016llx\n", (unsigned long long)m_pDevice->GetOriginalID(buffer).id, (unsigned long long)bigHash[0], (unsigned long long)bigHash[1]);
 	fclose(fid);
 
 	return true;
@@ -2064,7 +2184,7 @@ bool ReplayRenderer::DebugVertex(uint32_t vertid, uint32_t instid, uint32_t idx,
 {
 	if(trace == NULL) return false;
 
-	*trace = m_pDevice->DebugVertex(m_FrameID, m_EventID, vertid, instid, idx, instOffset, vertOffset);
+	StoreDebugTrace(m_pDevice->DebugVertex(m_FrameID, m_EventID, vertid, instid, idx, instOffset, vertOffset), trace);
 
 	SetFrameEvent(m_FrameID, m_EventID, true);
 
@@ -2075,7 +2195,7 @@ bool ReplayRenderer::DebugPixel(uint32_t x, uint32_t y, uint32_t sample, uint32_
 {
 	if(trace == NULL) return false;
 
-	*trace = m_pDevice->DebugPixel(m_FrameID, m_EventID, x, y, sample, primitive);
+	StoreDebugTrace(m_pDevice->DebugPixel(m_FrameID, m_EventID, x, y, sample, primitive), trace);
 	
 	SetFrameEvent(m_FrameID, m_EventID, true);
 
@@ -2086,13 +2206,97 @@ bool ReplayRenderer::DebugThread(uint32_t groupid[3], uint32_t threadid[3], Shad
 {
 	if(trace == NULL) return false;
 
-	*trace = m_pDevice->DebugThread(m_FrameID, m_EventID, groupid, threadid);
+	StoreDebugTrace(m_pDevice->DebugThread(m_FrameID, m_EventID, groupid, threadid), trace);
 	
 	SetFrameEvent(m_FrameID, m_EventID, true);
 
 	return true;
 }
 
+void ReplayRenderer::StoreDebugTrace(const ShaderDebugTrace &full, ShaderDebugTrace *trace)
+{
+	// the client gets everything but the register contents past the first state
+	trace->inputs = full.inputs;
+	trace->cbuffers = full.cbuffers;
+	trace->keyframeInterval = full.keyframeInterval;
+	trace->keyframes.Delete();
+	trace->steps = full.steps;
+	trace->changes.Delete();
+	trace->traceID = 0;
+
+	if(full.keyframes.count == 0)
+		return;
+
+	create_array_uninit(trace->keyframes, 1);
+	trace->keyframes[0] = full.keyframes[0];
+
+	trace->traceID = m_NextDebugTraceID++;
+
+	DebugTraceRecord &record = m_DebugTraces[trace->traceID];
+	record.trace = full;
+	record.state = full.keyframes[0];
+	record.step = 0;
+}
+
+bool ReplayRenderer::GetDebugState(uint32_t traceID, uint32_t step, ShaderDebugState *state)
+{
+	if(state == NULL) return false;
+
+	auto it = m_DebugTraces.find(traceID);
+	if(it == m_DebugTraces.end())
+		return false;
+
+	DebugTraceRecord &record = it->second;
+	const ShaderDebugTrace &trace = record.trace;
+
+	if(step > (uint32_t)trace.steps.count)
+		return false;
+
+	// start from the nearest keyframe at or before the step, unless the state
+	// already built is between that keyframe and the step
+	uint32_t interval = RDCMAX(1U, trace.keyframeInterval);
+	uint32_t key = RDCMIN(step/interval, uint32_t(trace.keyframes.count-1));
+
+	if(record.step > step || record.step < key*interval)
+	{
+		record.state = trace.keyframes[key];
+		record.step = key*interval;
+	}
+
+	for(; record.step < step; record.step++)
+	{
+		const ShaderDebugStep &s = trace.steps[record.step];
+
+		for(uint32_t c=0; c < s.numChanges; c++)
+		{
+			const ShaderDebugChange &change = trace.changes[s.firstChange + c];
+
+			ShaderVariable *v = NULL;
+
+			if(change.type == eDebugReg_Temp)
+				v = &record.state.registers[change.index];
+			else if(change.type == eDebugReg_Output)
+				v = &record.state.outputs[change.index];
+			else if(change.type == eDebugReg_IndexableTemp)
+				v = &record.state.indexableTemps[change.index][change.element];
+
+			if(v)
+				memcpy(v->value.uv, change.value, sizeof(change.value));
+		}
+
+		record.state.nextInstruction = s.nextInstruction;
+	}
+
+	*state = record.state;
+
+	return true;
+}
+
+bool ReplayRenderer::FreeDebugTrace(uint32_t traceID)
+{
+	return m_DebugTraces.erase(traceID) > 0;
+}
+
 bool ReplayRenderer::GetCBufferVariableContents(ResourceId shader, uint32_t cbufslot, ResourceId buffer, uint32_t offs, rdctype::array<ShaderVariable> *vars)
 {
 	if(vars == NULL) return false;
@@ -2299,9 +2503,196 @@ ReplayCreateStatus ReplayRenderer::PostCreateInit(IReplayDriver *device)
 		SetupDrawcallPointers(fr[i].frameInfo, m_FrameRecord.back().m_DrawCallList, NULL, NULL);
 	}
 
+	for(size_t i=0; i < m_FrameRecord.size(); i++)
+	{
+		BuildRenderPasses((uint32_t)i);
+		BuildDrawcallTable((uint32_t)i);
+	}
+
+	std::sort(m_APIEvents.begin(), m_APIEvents.end());
+	m_APIEvents.erase(std::unique(m_APIEvents.begin(), m_APIEvents.end()), m_APIEvents.end());
+
 	return eReplayCreate_Success;
 }
 
+static void GatherPassDraws(const FetchFrameInfo &frame, const rdctype::array<FetchDrawcall> &draws, vector<const FetchDrawcall *> &out)
+{
+	for(int32_t i=0; i < draws.count; i++)
+	{
+		const FetchDrawcall *draw = &draws[i];
+
+		if(draw->children.count > 0)
+			GatherPassDraws(frame, draw->children, out);
+		else if(draw->context == frame.immContextId && (draw->flags & (eDraw_Drawcall|eDraw_Dispatch)))
+			out.push_back(draw);
+	}
+}
+
+static bool SameOutputs(const FetchDrawcall *a, const FetchRenderPass &pass)
+{
+	if(a->depthOut != pass.depthOut)
+		return false;
+
+	for(int i=0; i < 8; i++)
+		if(a->outputs[i] != pass.outputs[i])
+			return false;
+
+	return true;
+}
+
+void ReplayRenderer::BuildRenderPasses(uint32_t frameID)
+{
+	FrameRecord &frame = m_FrameRecord[frameID];
+
+	vector<const FetchDrawcall *> draws;
+	GatherPassDraws(frame.frameInfo, frame.m_DrawCallList, draws);
+
+	map<ResourceId, ResourceFormat> formats;
+
+	vector<FetchRenderPass> &passes = frame.m_RenderPasses;
+	passes.clear();
+
+	// dispatches split passes but aren't part of one
+	bool split = true;
+
+	for(size_t i=0; i < draws.size(); i++)
+	{
+		const FetchDrawcall *draw = draws[i];
+
+		if(draw->flags & eDraw_Dispatch)
+		{
+			split = true;
+			continue;
+		}
+
+		bool extend = !split && SameOutputs(draw, passes.back());
+
+		split = false;
+
+		if(extend)
+		{
+			passes.back().lastEventID = draw->eventID;
+			passes.back().numDraws++;
+			continue;
+		}
+
+		FetchRenderPass pass;
+		pass.passID = (uint32_t)passes.size();
+		pass.firstEventID = pass.lastEventID = draw->eventID;
+		pass.numDraws = 1;
+
+		for(int o=0; o < 8; o++)
+		{
+			pass.outputs[o] = draw->outputs[o];
+			if(draw->outputs[o] != ResourceId())
+				pass.numOutputs++;
+		}
+		pass.depthOut = draw->depthOut;
+
+		for(int o=0; o < 9; o++)
+		{
+			ResourceId id = o < 8 ? pass.outputs[o] : pass.depthOut;
+			if(id == ResourceId())
+				continue;
+
+			auto it = formats.find(id);
+			if(it == formats.end())
+				it = formats.insert(std::make_pair(id, m_pDevice->GetTexture(id).format)).first;
+
+			if(o < 8)
+				pass.outputFormats[o] = it->second;
+			else
+				pass.depthFormat = it->second;
+		}
+
+		passes.push_back(pass);
+	}
+}
+
+void ReplayRenderer::BuildDrawcallTable(uint32_t frameID)
+{
+	FrameRecord &frame = m_FrameRecord[frameID];
+
+	frame.m_DrawcallTable.clear();
+	frame.m_DrawcallNames.clear();
+
+	// offset 0 is always the empty string
+	frame.m_DrawcallNames.push_back(0);
+
+	map<string, uint32_t> names;
+	names[""] = 0;
+
+	FlattenDrawcalls(frameID, frame.m_DrawCallList, -1, names);
+}
+
+void ReplayRenderer::FlattenDrawcalls(uint32_t frameID, const rdctype::array<FetchDrawcall> &draws, int32_t parent, map<string, uint32_t> &names)
+{
+	vector<FetchFlatDrawcall> &table = m_FrameRecord[frameID].m_DrawcallTable;
+	vector<char> &pool = m_FrameRecord[frameID].m_DrawcallNames;
+
+	int32_t prevSibling = -1;
+
+	for(int32_t i=0; i < draws.count; i++)
+	{
+		const FetchDrawcall &draw = draws[i];
+
+		int32_t idx = (int32_t)table.size();
+
+		if(prevSibling >= 0)
+			table[prevSibling].nextSibling = idx;
+		prevSibling = idx;
+
+		string name = draw.name.elems ? string(draw.name.elems, draw.name.elems + draw.name.count) : string();
+
+		auto it = names.find(name);
+		if(it == names.end())
+		{
+			it = names.insert(std::make_pair(name, (uint32_t)pool.size())).first;
+			pool.insert(pool.end(), name.begin(), name.end());
+			pool.push_back(0);
+		}
+
+		FetchFlatDrawcall flat;
+		RDCEraseEl(flat);
+
+		flat.eventID = draw.eventID;
+		flat.drawcallID = draw.drawcallID;
+		flat.nameOffset = it->second;
+		flat.flags = draw.flags;
+		flat.numIndices = draw.numIndices;
+		flat.numInstances = draw.numInstances;
+		flat.indexOffset = draw.indexOffset;
+		flat.vertexOffset = draw.vertexOffset;
+		flat.instanceOffset = draw.instanceOffset;
+		for(int d=0; d < 3; d++)
+		{
+			flat.dispatchDimension[d] = draw.dispatchDimension[d];
+			flat.dispatchThreadsDimension[d] = draw.dispatchThreadsDimension[d];
+		}
+		flat.indexByteWidth = draw.indexByteWidth;
+		flat.topology = draw.topology;
+		flat.copySource = draw.copySource;
+		flat.copyDestination = draw.copyDestination;
+		flat.context = draw.context;
+		flat.parent = parent;
+		flat.nextSibling = -1;
+		flat.numChildren = (uint32_t)draw.children.count;
+		flat.previous = (uint32_t)draw.previous;
+		flat.next = (uint32_t)draw.next;
+		for(int o=0; o < 8; o++)
+			flat.outputs[o] = draw.outputs[o];
+		flat.depthOut = draw.depthOut;
+
+		table.push_back(flat);
+
+		if(draw.children.count > 0)
+			FlattenDrawcalls(frameID, draw.children, idx, names);
+
+		// table may have been reallocated by the recursion
+		table[idx].numDescendants = (uint32_t)table.size() - idx - 1;
+	}
+}
+
 FetchDrawcall *ReplayRenderer::SetupDrawcallPointers(FetchFrameInfo frame, rdctype::array<FetchDrawcall> &draws, FetchDrawcall *parent, FetchDrawcall *previous)
 {
 	FetchDrawcall *ret = NULL;
@@ -2312,6 +2703,9 @@ FetchDrawcall *ReplayRenderer::SetupDrawcallPointers(FetchFrameInfo frame, rdcty
 
 		draw->parent = parent ? parent->eventID : 0;
 
+		for(int32_t e=0; e < draw->events.count; e++)
+			m_APIEvents.push_back(draw->events[e].eventID);
+
 		if(draw->children.count > 0)
 		{
 			ret = previous = SetupDrawcallPointers(frame, draw->children, draw, previous);
@@ -2339,6 +2733,7 @@ FetchDrawcall *ReplayRenderer::SetupDrawcallPointers(FetchFrameInfo frame, rdcty
 
 void ReplayRenderer::FileChanged()
 {
+	InvalidateReplayState();
 	m_pDevice->FileChanged();
 }
 
@@ -2402,6 +2797,8 @@ extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_SetContextFilter(Rep
 { return rend->SetContextFilter(id, firstDefEv, lastDefEv); }
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_SetFrameEvent(ReplayRenderer *rend, uint32_t frameID, uint32_t eventID)
 { return rend->SetFrameEvent(frameID, eventID); }
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_SetReplayCheckpoints(ReplayRenderer *rend, uint32_t eventInterval, uint32_t memoryBudgetMB)
+{ return rend->SetReplayCheckpoints(eventInterval, memoryBudgetMB); }
 extern "C" RENDERDOC_API void RENDERDOC_CC ReplayRenderer_SetIDRenderingEvents(ReplayRenderer *rend, uint32_t frameID, uint32_t startEventID, uint32_t endEventID)
 { rend->SetIDRenderingEvents(frameID, startEventID, endEventID); }
 extern "C" RENDERDOC_API void RENDERDOC_CC ReplayRenderer_SetIDRendering(ReplayRenderer *rend, bool32 active, ResourceId shaderID)
@@ -2437,6 +2834,12 @@ extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetFrameInfo(ReplayR
 { return rend->GetFrameInfo(frame); }
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetDrawcalls(ReplayRenderer *rend, uint32_t frameID, rdctype::array<FetchDrawcall> *draws)
 { return rend->GetDrawcalls(frameID, draws); }
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetDrawcallTable(ReplayRenderer *rend, uint32_t frameID, const FetchFlatDrawcall **draws, uint32_t *count, const char **strings)
+{ return rend->GetDrawcallTable(frameID, draws, count, strings); }
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetRenderPasses(ReplayRenderer *rend, uint32_t frameID, rdctype::array<FetchRenderPass> *passes)
+{ return rend->GetRenderPasses(frameID, passes); }
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_FindRenderPasses(ReplayRenderer *rend, uint32_t frameID, uint32_t numOutputs, bool32 hasDepth, rdctype::array<FetchRenderPass> *passes)
+{ return rend->FindRenderPasses(frameID, numOutputs, hasDepth, passes); }
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_FetchCounters(ReplayRenderer *rend, uint32_t frameID, uint32_t minEventID, uint32_t maxEventID, uint32_t *counters, uint32_t numCounters, rdctype::array<CounterResult> *results)
 { return rend->FetchCounters(frameID, minEventID, maxEventID, counters, numCounters, results); }
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_EnumerateCounters(ReplayRenderer *rend, rdctype::array<uint32_t> *counters)
@@ -2457,6 +2860,10 @@ extern "C" RENDERDOC_API ShaderReflection* RENDERDOC_CC ReplayRenderer_GetShader
 { return rend->GetShaderDetails(shader); }
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetDebugMessages(ReplayRenderer *rend, rdctype::array<DebugMessage> *msgs)
 { return rend->GetDebugMessages(msgs); }
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetLoadProfile(ReplayRenderer *rend, LoadProfile *profile)
+{ return rend->GetLoadProfile(profile); }
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetReplayStats(ReplayRenderer *rend, ReplayStats *stats)
+{ return rend->GetReplayStats(stats); }
 
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_PixelHistory(ReplayRenderer *rend, ResourceId target, uint32_t x, uint32_t y, uint32_t slice, uint32_t mip, uint32_t sampleIdx, rdctype::array<PixelModification> *history)
 { return rend->PixelHistory(target, x, y, slice, mip, sampleIdx, history); }
@@ -2466,6 +2873,10 @@ extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_DebugPixel(ReplayRen
 { return rend->DebugPixel(x, y, sample, primitive, trace); }
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_DebugThread(ReplayRenderer *rend, uint32_t groupid[3], uint32_t threadid[3], ShaderDebugTrace *trace)
 { return rend->DebugThread(groupid, threadid, trace); }
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetDebugState(ReplayRenderer *rend, uint32_t traceID, uint32_t step, ShaderDebugState *state)
+{ return rend->GetDebugState(traceID, step, state); }
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_FreeDebugTrace(ReplayRenderer *rend, uint32_t traceID)
+{ return rend->FreeDebugTrace(traceID); }
 
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_GetUsage(ReplayRenderer *rend, ResourceId id, rdctype::array<EventUsage> *usage)
 { return rend->GetUsage(id, usage); }
@@ -2485,6 +2896,10 @@ extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_HashBufferData(Repla
 {
 	return rend->HashBufferData(buff, path);
 }
+extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_HashBuffers(ReplayRenderer *rend, ResourceId *buffers, uint32_t numBuffers, const char *path)
+{
+	return rend->HashBuffers(buffers, numBuffers, path);
+}
 extern "C" RENDERDOC_API bool32 RENDERDOC_CC ReplayRenderer_HashShader(ReplayRenderer *rend, ResourceId buff, const char *path)
 {
 	return rend->HashShader(buff, path);
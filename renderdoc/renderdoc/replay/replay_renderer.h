@@ -145,6 +145,7 @@ struct ReplayRenderer : public IReplayRenderer
 		bool SetContextFilter(ResourceId id, uint32_t firstDefEv, uint32_t lastDefEv);
 		bool SetFrameEvent(uint32_t frameID, uint32_t eventID);
 		bool SetFrameEvent(uint32_t frameID, uint32_t eventID, bool force);
+		bool SetReplayCheckpoints(uint32_t eventInterval, uint32_t memoryBudgetMB);
 
 		/* Added by Stephan Richter | BEGIN */
 		void SetIDRenderingEvents(uint32_t frameID, uint32_t startEventID, uint32_t endEventID);
@@ -166,6 +167,9 @@ struct ReplayRenderer : public IReplayRenderer
 		
 		bool GetFrameInfo(rdctype::array<FetchFrameInfo> *frame);
 		bool GetDrawcalls(uint32_t frameID, rdctype::array<FetchDrawcall> *draws);
+		bool GetDrawcallTable(uint32_t frameID, const FetchFlatDrawcall **draws, uint32_t *count, const char **strings);
+		bool GetRenderPasses(uint32_t frameID, rdctype::array<FetchRenderPass> *passes);
+		bool FindRenderPasses(uint32_t frameID, uint32_t numOutputs, bool32 hasDepth, rdctype::array<FetchRenderPass> *passes);
 		bool FetchCounters(uint32_t frameID, uint32_t minEventID, uint32_t maxEventID, uint32_t *counters, uint32_t numCounters, rdctype::array<CounterResult> *results);
 		bool EnumerateCounters(rdctype::array<uint32_t> *counters);
 		bool DescribeCounter(uint32_t counterID, CounterDescription *desc);
@@ -179,11 +183,15 @@ struct ReplayRenderer : public IReplayRenderer
 		bool GetResolve(uint64_t *callstack, uint32_t callstackLen, rdctype::array<rdctype::str> *trace);
 		ShaderReflection *GetShaderDetails(ResourceId shader);
 		bool GetDebugMessages(rdctype::array<DebugMessage> *msgs);
+		bool GetLoadProfile(LoadProfile *profile);
+		bool GetReplayStats(ReplayStats *stats);
 		
 		bool PixelHistory(ResourceId target, uint32_t x, uint32_t y, uint32_t slice, uint32_t mip, uint32_t sampleIdx, rdctype::array<PixelModification> *history);
 		bool DebugVertex(uint32_t vertid, uint32_t instid, uint32_t idx, uint32_t instOffset, uint32_t vertOffset, ShaderDebugTrace *trace);
 		bool DebugPixel(uint32_t x, uint32_t y, uint32_t sample, uint32_t primitive, ShaderDebugTrace *trace);
 		bool DebugThread(uint32_t groupid[3], uint32_t threadid[3], ShaderDebugTrace *trace);
+		bool GetDebugState(uint32_t traceID, uint32_t step, ShaderDebugState *state);
+		bool FreeDebugTrace(uint32_t traceID);
 
 		bool GetPostVSData(uint32_t instID, MeshDataStage stage, MeshFormat *data);
 		
@@ -204,6 +212,7 @@ struct ReplayRenderer : public IReplayRenderer
 		/* Added by Stephan Richter | BEGIN */
 		bool HashTexture(const TextureSave &saveData, const char *path);
 		bool HashBufferData(ResourceId buffer, const char *path);
+		bool HashBuffers(ResourceId *buffers, uint32_t numBuffers, const char *path);
 		bool HashShader(ResourceId buffer, const char *path);
 		/* Added by Stephan Richter | END */
 
@@ -218,6 +227,15 @@ struct ReplayRenderer : public IReplayRenderer
 		
 		FetchDrawcall *GetDrawcallByEID(uint32_t eventID, uint32_t defEventID);
 		FetchDrawcall *SetupDrawcallPointers(FetchFrameInfo frame, rdctype::array<FetchDrawcall> &draws, FetchDrawcall *parent, FetchDrawcall *previous);
+		void BuildRenderPasses(uint32_t frameID);
+		void BuildDrawcallTable(uint32_t frameID);
+		void FlattenDrawcalls(uint32_t frameID, const rdctype::array<FetchDrawcall> &draws, int32_t parent, map<string, uint32_t> &names);
+
+		void StoreDebugTrace(const ShaderDebugTrace &full, ShaderDebugTrace *trace);
+
+		// call whenever the device may have replayed or modified anything, so the next
+		// SetFrameEvent can't assume the state is still that after m_EventID.
+		void InvalidateReplayState() { m_ReplayStateValid = false; }
 	
 		IReplayDriver *GetDevice() { return m_pDevice; }
 		
@@ -226,10 +244,23 @@ struct ReplayRenderer : public IReplayRenderer
 			FetchFrameInfo frameInfo;
 
 			rdctype::array<FetchDrawcall> m_DrawCallList;
+			vector<FetchRenderPass> m_RenderPasses;
+
+			vector<FetchFlatDrawcall> m_DrawcallTable;
+			vector<char> m_DrawcallNames;
 		};
 		vector<FrameRecord> m_FrameRecord;
 		vector<FetchDrawcall*> m_Drawcalls;
 
+		// sorted IDs of every API event with a file offset, i.e. the events a partial
+		// replay can start from exactly.
+		vector<uint32_t> m_APIEvents;
+
+		// true while the device state is that after replaying up to and including
+		// m_EventID, so moving forward only needs the events in between.
+		bool m_ReplayStateValid;
+		ReplayStats m_ReplayStats;
+
 		uint32_t m_FrameID;
 		uint32_t m_EventID;
 		ResourceId m_DeferredCtx;
@@ -252,5 +283,17 @@ struct ReplayRenderer : public IReplayRenderer
 		std::set<ResourceId> m_TargetResources;
 		std::set<ResourceId> m_CustomShaders;
 
+		// full shader debug traces, keyed by the traceID handed back to the client.
+		// The last state rebuilt is kept so stepping forwards through a trace only
+		// has to apply one step's changes each time.
+		struct DebugTraceRecord
+		{
+			ShaderDebugTrace trace;
+			ShaderDebugState state;
+			uint32_t step;
+		};
+		std::map<uint32_t, DebugTraceRecord> m_DebugTraces;
+		uint32_t m_NextDebugTraceID;
+
 		friend struct ReplayOutput;
 };
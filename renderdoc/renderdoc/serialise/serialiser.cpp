@@ -30,8 +30,13 @@
 #include "serialise/string_utils.h"
 #include "common/timing.h"
 
+#include "replay/MurmurHash3.h"
+#include "api/replay/renderdoc_replay.h"
+
 #include "3rdparty/lz4/lz4.h"
 
+#include <deque>
+
 #ifdef _MSC_VER
 #pragma warning (disable : 4422) // warning C4422: 'snprintf' : too many arguments passed for format string
                                  // false positive as VS is trying to parse renderdoc's custom format strings
@@ -47,14 +52,37 @@ int64_t Chunk::m_MaxChunks = 0;
 
 const uint32_t Serialiser::MAGIC_HEADER = MAKE_FOURCC('R', 'D', 'O', 'C');
 const uint64_t Serialiser::BufferAlignment = 64;
+const char *Serialiser::ExternalStoreName = "rdcstore";
+
+// initial contents chunks at least this big are moved out to the external store, if enabled.
+// Smaller chunks aren't worth a separate file and a lookup.
+static const uint32_t ExternalChunkMinSize = 64*1024;
+
+// size of the reference written in place of an external chunk:
+// uint16_t chunk idx (0), uint8_t control byte (1), uint64_t hash[2], uint32_t length
+static const uint64_t ExternalChunkRefSize = sizeof(uint16_t) + sizeof(uint8_t) + sizeof(uint64_t)*2 + sizeof(uint32_t);
+
+// each blob in the store starts with this header, followed by the data as an lz4 block stream
+struct ExternalChunkHeader
+{
+	uint32_t magic;
+	uint32_t length; // uncompressed. Written last, so a 0 here means the blob is incomplete
+};
+
+static const uint32_t EXTERNAL_CHUNK_MAGIC = MAKE_FOURCC('R', 'D', 'C', 'B');
 
 // based on blockStreaming_doubleBuffer.c in lz4 examples
 struct CompressedFileIO
 {
-	// large block size
-	static const size_t BlockSize = 64 * 1024;
+	// large block size. Sections written with a different block size have
+	// eSectionFlag_LZ4BlockSize set and store it after the uncompressed length
+	static const size_t DefaultBlockSize = 64 * 1024;
 
-	CompressedFileIO(FILE *f)
+	// bounds on block sizes we'll write or read
+	static const size_t MinBlockSize = 4 * 1024;
+	static const size_t MaxBlockSize = 4 * 1024 * 1024;
+
+	CompressedFileIO(FILE *f, size_t blockSize = DefaultBlockSize)
 	{
 		m_F = f;
 		LZ4_resetStream(&m_LZ4Comp);
@@ -63,12 +91,18 @@ struct CompressedFileIO
 		m_PageIdx = m_PageOffset = 0;
 		m_PageData = 0;
 
-		m_CompressSize = LZ4_COMPRESSBOUND(BlockSize);
+		m_BlockSize = blockSize;
+		m_InPages[0] = new byte[m_BlockSize];
+		m_InPages[1] = new byte[m_BlockSize];
+
+		m_CompressSize = LZ4_COMPRESSBOUND(m_BlockSize);
 		m_CompressBuf = new byte[m_CompressSize];
 	}
 
 	~CompressedFileIO()
 	{
+		SAFE_DELETE_ARRAY(m_InPages[0]);
+		SAFE_DELETE_ARRAY(m_InPages[1]);
 		SAFE_DELETE_ARRAY(m_CompressBuf);
 	}
 
@@ -87,17 +121,17 @@ struct CompressedFileIO
 		
 		size_t remainder = 0;
 
-		// loop continually, writing up to BlockSize out of what remains of data
+		// loop continually, writing up to m_BlockSize out of what remains of data
 		do
 		{
 			remainder = 0;
 
 			// if we're about to copy more than the page, copy only
 			// what will fit, then copy the remainder after flushing
-			if(m_PageOffset + len > BlockSize)
+			if(m_PageOffset + len > m_BlockSize)
 			{
-				remainder = len - (BlockSize - m_PageOffset);
-				len = BlockSize - m_PageOffset;
+				remainder = len - (m_BlockSize - m_PageOffset);
+				len = m_BlockSize - m_PageOffset;
 			}
 
 			memcpy(m_InPages[m_PageIdx] + m_PageOffset, src, len);
@@ -116,7 +150,7 @@ struct CompressedFileIO
 	// flush out the current page to disk
 	void Flush()
 	{
-		// m_PageOffset is the amount written, usually equal to BlockSize except the last block.
+		// m_PageOffset is the amount written, usually equal to m_BlockSize except the last block.
 		int32_t compSize = LZ4_compress_fast_continue(&m_LZ4Comp, (const char *)m_InPages[m_PageIdx], (char *)m_CompressBuf, (int)m_PageOffset, (int)m_CompressSize, 1);
 
 		if(compSize < 0)
@@ -151,7 +185,7 @@ struct CompressedFileIO
 		
 		m_UncompressedSize += (uint32_t)len;
 		
-		// loop continually, writing up to BlockSize out of what remains of data
+		// loop continually, writing up to m_BlockSize out of what remains of data
 		do
 		{
 			size_t readamount = len;
@@ -188,7 +222,7 @@ struct CompressedFileIO
 		
 		m_PageIdx = 1 - m_PageIdx;
 
-		int32_t decompSize = LZ4_decompress_safe_continue(&m_LZ4Decomp, (const char *)m_CompressBuf, (char *)m_InPages[m_PageIdx], compSize, BlockSize);
+		int32_t decompSize = LZ4_decompress_safe_continue(&m_LZ4Decomp, (const char *)m_CompressBuf, (char *)m_InPages[m_PageIdx], compSize, (int)m_BlockSize);
 		
 		if(decompSize < 0)
 		{
@@ -200,7 +234,7 @@ struct CompressedFileIO
 		m_PageData = decompSize;
 	}
 
-	static void Decompress(byte *destBuf, const byte *srcBuf, size_t len)
+	static void Decompress(byte *destBuf, const byte *srcBuf, size_t len, size_t blockSize = DefaultBlockSize)
 	{
 		LZ4_streamDecode_t lz4;
 		LZ4_setStreamDecode(&lz4, NULL, 0);
@@ -215,7 +249,7 @@ struct CompressedFileIO
 			if(srcBuf + *compSize > srcBufEnd)
 				break;
 
-			int32_t decompSize = LZ4_decompress_safe_continue(&lz4, (const char *)srcBuf, (char *)destBuf, *compSize, BlockSize);
+			int32_t decompSize = LZ4_decompress_safe_continue(&lz4, (const char *)srcBuf, (char *)destBuf, *compSize, (int)blockSize);
 
 			if(decompSize < 0)
 				return;
@@ -230,13 +264,221 @@ struct CompressedFileIO
 	FILE *m_F;
 	uint32_t m_CompressedSize, m_UncompressedSize;
 
-	byte m_InPages[2][BlockSize];
+	size_t m_BlockSize;
+	byte *m_InPages[2];
 	size_t m_PageIdx, m_PageOffset, m_PageData;
 
 	byte *m_CompressBuf;
 	size_t m_CompressSize;
 };
 
+// writes the contents of a section either LZ4 compressed or stored as-is
+struct SectionWriter
+{
+	SectionWriter(FILE *f, bool compress, size_t blockSize = CompressedFileIO::DefaultBlockSize)
+	{
+		m_F = f;
+		m_Compressor = compress ? new CompressedFileIO(f, blockSize) : NULL;
+		m_Size = 0;
+	}
+
+	~SectionWriter()
+	{
+		SAFE_DELETE(m_Compressor);
+	}
+
+	void Write(const void *data, size_t len)
+	{
+		m_Size += len;
+
+		if(m_Compressor)
+			m_Compressor->Write(data, len);
+		else
+			FileIO::fwrite(data, 1, len, m_F);
+	}
+
+	void Flush()
+	{
+		if(m_Compressor)
+			m_Compressor->Flush();
+	}
+
+	uint64_t GetUncompressedSize() { return m_Size; }
+	uint32_t GetStoredSize() { return m_Compressor ? m_Compressor->GetCompressedSize() : (uint32_t)m_Size; }
+
+	FILE *m_F;
+	CompressedFileIO *m_Compressor;
+	uint64_t m_Size;
+};
+
+// the decode stage for reading a capture. A thread reads the frame capture section
+// sequentially, decompressing it if needed, into a bounded queue of blocks that
+// Serialiser::ReadFromFile copies out of. LZ4 blocks are chained so they can't be
+// decoded out of order, but this way the file IO and decompression for the next
+// chunks happens while the driver is busy creating resources from the current one.
+struct ReadAheadStream
+{
+	static const size_t BlockSize = 1024 * 1024;
+	static const size_t MaxQueuedBlocks = 16;
+
+	ReadAheadStream(FILE *f, CompressedFileIO *compressed, uint64_t size)
+	{
+		m_F = f;
+		m_Compressed = compressed;
+		m_Remaining = size;
+
+		m_Current = NULL;
+		m_CurrentOffset = 0;
+
+		m_Finished = false;
+		m_KillSignal = false;
+
+		m_Thread = Threading::CreateThread(&ReadAheadStream::ThreadEntry, this);
+	}
+
+	~ReadAheadStream()
+	{
+		m_KillSignal = true;
+
+		Threading::JoinThread(m_Thread);
+		Threading::CloseThread(m_Thread);
+
+		SAFE_DELETE(m_Current);
+
+		for(size_t i=0; i < m_Ready.size(); i++)
+			delete m_Ready[i];
+		for(size_t i=0; i < m_Free.size(); i++)
+			delete m_Free[i];
+	}
+
+	void Read(byte *data, size_t len)
+	{
+		while(len > 0)
+		{
+			if(m_Current == NULL || m_CurrentOffset == m_Current->size())
+			{
+				if(m_Current)
+				{
+					SCOPED_LOCK(m_Lock);
+					m_Free.push_back(m_Current);
+				}
+
+				m_Current = NextBlock();
+				m_CurrentOffset = 0;
+
+				if(m_Current == NULL)
+				{
+					RDCERR("Reading %llu bytes past the end of the frame capture", (uint64_t)len);
+					memset(data, 0, len);
+					return;
+				}
+			}
+
+			size_t readamount = RDCMIN(len, m_Current->size() - m_CurrentOffset);
+
+			memcpy(data, &(*m_Current)[m_CurrentOffset], readamount);
+
+			m_CurrentOffset += readamount;
+			data += readamount;
+			len -= readamount;
+		}
+	}
+
+private:
+	vector<byte> *NextBlock()
+	{
+		while(true)
+		{
+			{
+				SCOPED_LOCK(m_Lock);
+
+				if(!m_Ready.empty())
+				{
+					vector<byte> *ret = m_Ready.front();
+					m_Ready.pop_front();
+					return ret;
+				}
+
+				if(m_Finished)
+					return NULL;
+			}
+
+			Threading::Sleep(0);
+		}
+	}
+
+	static void ThreadEntry(void *param)
+	{
+		((ReadAheadStream *)param)->Decode();
+	}
+
+	void Decode()
+	{
+		while(m_Remaining > 0 && !m_KillSignal)
+		{
+			vector<byte> *block = NULL;
+
+			{
+				SCOPED_LOCK(m_Lock);
+
+				if(m_Ready.size() < MaxQueuedBlocks)
+				{
+					if(m_Free.empty())
+					{
+						block = new vector<byte>();
+					}
+					else
+					{
+						block = m_Free.back();
+						m_Free.pop_back();
+					}
+				}
+			}
+
+			// reader is far enough behind, wait for it
+			if(block == NULL)
+			{
+				Threading::Sleep(1);
+				continue;
+			}
+
+			size_t len = (size_t)RDCMIN(m_Remaining, (uint64_t)BlockSize);
+			block->resize(len);
+
+			if(m_Compressed)
+				m_Compressed->Read(&(*block)[0], len);
+			else
+				FileIO::fread(&(*block)[0], 1, len, m_F);
+
+			m_Remaining -= len;
+
+			SCOPED_LOCK(m_Lock);
+			m_Ready.push_back(block);
+		}
+
+		SCOPED_LOCK(m_Lock);
+		m_Finished = true;
+	}
+
+	FILE *m_F;
+	CompressedFileIO *m_Compressed;
+
+	// only touched by the thread
+	uint64_t m_Remaining;
+
+	// only touched by the reader
+	vector<byte> *m_Current;
+	size_t m_CurrentOffset;
+
+	Threading::CriticalSection m_Lock;
+	std::deque<vector<byte> *> m_Ready;
+	vector<vector<byte> *> m_Free;
+	bool m_Finished;
+
+	volatile bool m_KillSignal;
+	Threading::ThreadHandle m_Thread;
+};
+
 Chunk::Chunk(Serialiser *ser, uint32_t chunkType, bool temporary)
 {
 	m_Length = (uint32_t)ser->GetOffset();
@@ -277,6 +519,34 @@ Chunk::Chunk(Serialiser *ser, uint32_t chunkType, bool temporary)
 #endif
 }
 
+Chunk *Chunk::Duplicate(bool temporary)
+{
+	Chunk *ret = new Chunk();
+
+	ret->m_Length = m_Length;
+	ret->m_ChunkType = m_ChunkType;
+	ret->m_Temporary = temporary;
+	ret->m_AlignedData = m_AlignedData;
+
+	if(m_AlignedData)
+		ret->m_Data = Serialiser::AllocAlignedBuffer(m_Length);
+	else
+		ret->m_Data = new byte[m_Length];
+
+	memcpy(ret->m_Data, m_Data, m_Length);
+
+	ret->m_DebugStr = m_DebugStr;
+	
+#if !defined(RELEASE)
+	int64_t newval = Atomic::Inc64(&m_LiveChunks);
+	Atomic::ExchAdd64(&m_TotalMem, m_Length);
+
+	m_MaxChunks = RDCMAX(newval, m_MaxChunks);
+#endif
+
+	return ret;
+}
+
 Chunk::~Chunk()
 {
 #if !defined(RELEASE)
@@ -395,7 +665,7 @@ struct BinarySectionHeader
 #define RETURNCORRUPT(...) { RDCERR(__VA_ARGS__); m_ErrorCode = eSerError_Corrupt; m_HasError = true; return; }
 
 Serialiser::Serialiser(size_t length, const byte *memoryBuf, bool fileheader)
-	: m_pCallstack(NULL), m_pResolver(NULL), m_Buffer(NULL)
+	: m_pCallstack(NULL), m_pResolver(NULL), m_pCallstacks(NULL), m_Buffer(NULL)
 {
 	m_ResolverThread = 0; 
 
@@ -412,6 +682,9 @@ Serialiser::Serialiser(size_t length, const byte *memoryBuf, bool fileheader)
 
 	if(!fileheader)
 	{
+		// headerless buffers have no version to read, assume they are current
+		m_SerVer = SERIALISE_VERSION;
+
 		m_BufferSize = length;
 		m_CurrentBufferSize = (size_t)m_BufferSize;
 		m_BufferHead = m_Buffer = AllocAlignedBuffer(m_CurrentBufferSize);
@@ -445,6 +718,8 @@ Serialiser::Serialiser(size_t length, const byte *memoryBuf, bool fileheader)
 
 	const byte *memoryBufEnd = memoryBuf + length;
 
+	uint32_t memBlockSize = (uint32_t)CompressedFileIO::DefaultBlockSize;
+
 	m_SerVer = header->version;
 
 	if(header->version == 0x00000031) // backwards compatibility
@@ -488,10 +763,8 @@ Serialiser::Serialiser(size_t length, const byte *memoryBuf, bool fileheader)
 		m_Sections.push_back(frameCap);
 		m_KnownSections[eSectionType_FrameCapture] = frameCap;
 	}
-	else if(header->version == SERIALISE_VERSION)
+	else if(header->version == SERIALISE_VERSION || header->version == 0x00000032)
 	{
-		const byte *memoryBufEnd = memoryBuf + length;
-
 		memoryBuf += sizeof(FileHeader);
 
 		// when loading in-memory we only care about the first section, which should be binary
@@ -547,9 +820,29 @@ Serialiser::Serialiser(size_t length, const byte *memoryBuf, bool fileheader)
 		frameCap->type = sectionHeader->sectionType;
 		frameCap->flags = sectionHeader->sectionFlags;
 		
-		uint64_t *uncompLength = (uint64_t *)memoryBuf;
+		uint64_t uncompLength = sectionHeader->sectionLength;
 
-		memoryBuf += sizeof(uint64_t);
+		// compressed sections store the uncompressed length (and possibly block size) first
+		if(frameCap->flags & eSectionFlag_LZ4Compressed)
+		{
+			uncompLength = *(uint64_t *)memoryBuf;
+			memoryBuf += sizeof(uint64_t);
+
+			if(frameCap->flags & eSectionFlag_LZ4BlockSize)
+			{
+				memBlockSize = *(uint32_t *)memoryBuf;
+				memoryBuf += sizeof(uint32_t);
+
+				if(memBlockSize < CompressedFileIO::MinBlockSize || memBlockSize > CompressedFileIO::MaxBlockSize)
+				{
+					RDCERR("Invalid LZ4 block size %u", memBlockSize);
+
+					m_ErrorCode = eSerError_Corrupt;
+					m_HasError = true;
+					return;
+				}
+			}
+		}
 
 		if(memoryBuf >= memoryBufEnd)
 		{
@@ -560,10 +853,81 @@ Serialiser::Serialiser(size_t length, const byte *memoryBuf, bool fileheader)
 			return;
 		}
 
-		frameCap->size = *uncompLength;
+		frameCap->size = uncompLength;
 
 		m_KnownSections[eSectionType_FrameCapture] = frameCap;
 		m_Sections.push_back(frameCap);
+
+		// any other sections follow the frame capture's stored data. The only one we need is
+		// the callstacks that chunk headers refer to, the rest are skipped
+		const byte *next = memoryBuf + sectionHeader->sectionLength;
+
+		while(next + offsetof(BinarySectionHeader, name) < memoryBufEnd)
+		{
+			const BinarySectionHeader *nextHeader = (const BinarySectionHeader *)next;
+
+			// ASCII sections aren't walked when loading in-memory
+			if(nextHeader->isASCII != 0 ||
+				nextHeader->zero[0] != 0 ||
+				nextHeader->zero[1] != 0 ||
+				nextHeader->zero[2] != 0)
+				break;
+
+			const byte *data = next + offsetof(BinarySectionHeader, name) + nextHeader->sectionNameLength;
+
+			uint64_t size = nextHeader->sectionLength;
+			uint32_t blockSize = (uint32_t)CompressedFileIO::DefaultBlockSize;
+
+			if(nextHeader->sectionFlags & eSectionFlag_LZ4Compressed)
+			{
+				if(data + sizeof(uint64_t) > memoryBufEnd)
+					break;
+
+				size = *(uint64_t *)data;
+				data += sizeof(uint64_t);
+
+				if(nextHeader->sectionFlags & eSectionFlag_LZ4BlockSize)
+				{
+					if(data + sizeof(uint32_t) > memoryBufEnd)
+						break;
+
+					blockSize = *(uint32_t *)data;
+					data += sizeof(uint32_t);
+
+					if(blockSize < CompressedFileIO::MinBlockSize || blockSize > CompressedFileIO::MaxBlockSize)
+						break;
+				}
+			}
+
+			if(data + nextHeader->sectionLength > memoryBufEnd)
+				break;
+
+			if(nextHeader->sectionType == eSectionType_Callstacks)
+			{
+				vector<byte> stacks((size_t)size);
+
+				if(size > 0)
+				{
+					if(nextHeader->sectionFlags & eSectionFlag_LZ4Compressed)
+						CompressedFileIO::Decompress(&stacks[0], data, nextHeader->sectionLength, blockSize);
+					else
+						memcpy(&stacks[0], data, (size_t)size);
+				}
+
+				m_pCallstacks = new CallstackStore();
+
+				if(!m_pCallstacks->Read(stacks))
+					RDCWARN("Couldn't read callstacks section, callstacks will be unavailable");
+
+				break;
+			}
+
+			next = data + nextHeader->sectionLength;
+		}
+
+		// don't read past the frame capture into the sections after it
+		if(memoryBuf + sectionHeader->sectionLength < memoryBufEnd)
+			memoryBufEnd = memoryBuf + sectionHeader->sectionLength;
 	}
 	else
 	{
@@ -580,16 +944,17 @@ Serialiser::Serialiser(size_t length, const byte *memoryBuf, bool fileheader)
 
 	if(m_KnownSections[eSectionType_FrameCapture]->flags & eSectionFlag_LZ4Compressed)
 	{
-		CompressedFileIO::Decompress(m_Buffer, memoryBuf, memoryBufEnd - memoryBuf);
+		CompressedFileIO::Decompress(m_Buffer, memoryBuf, memoryBufEnd - memoryBuf, memBlockSize);
 	}
 	else
 	{
-		memcpy(m_Buffer, memoryBuf, m_CurrentBufferSize);
+		// the buffer might only contain the start of the capture
+		memcpy(m_Buffer, memoryBuf, RDCMIN(m_CurrentBufferSize, size_t(memoryBufEnd - memoryBuf)));
 	}
 }
 
 Serialiser::Serialiser(const char *path, Mode mode, bool debugMode)
-	: m_pCallstack(NULL), m_pResolver(NULL), m_Buffer(NULL)
+	: m_pCallstack(NULL), m_pResolver(NULL), m_pCallstacks(NULL), m_Buffer(NULL)
 {
 	m_ResolverThread = 0; 
 
@@ -684,7 +1049,7 @@ Serialiser::Serialiser(const char *path, Mode mode, bool debugMode)
 			m_Sections.push_back(frameCap);
 			m_KnownSections[eSectionType_FrameCapture] = frameCap;
 		}
-		else if(header.version == SERIALISE_VERSION)
+		else if(header.version == SERIALISE_VERSION || header.version == 0x00000032)
 		{
 			while(!FileIO::feof(m_ReadFileHandle))
 			{
@@ -795,10 +1160,21 @@ Serialiser::Serialiser(const char *path, Mode mode, bool debugMode)
 
 					if(sect->flags & eSectionFlag_LZ4Compressed)
 					{
-						sect->compressedReader = new CompressedFileIO(m_ReadFileHandle);
 						FileIO::fread(&sect->size, 1, sizeof(uint64_t), m_ReadFileHandle);
-
 						sect->fileoffset += sizeof(uint64_t);
+
+						uint32_t blockSize = (uint32_t)CompressedFileIO::DefaultBlockSize;
+
+						if(sect->flags & eSectionFlag_LZ4BlockSize)
+						{
+							FileIO::fread(&blockSize, 1, sizeof(uint32_t), m_ReadFileHandle);
+							sect->fileoffset += sizeof(uint32_t);
+
+							if(blockSize < CompressedFileIO::MinBlockSize || blockSize > CompressedFileIO::MaxBlockSize)
+								RETURNCORRUPT("Invalid LZ4 block size %u in section '%s'", blockSize, sect->name.c_str());
+						}
+
+						sect->compressedReader = new CompressedFileIO(m_ReadFileHandle, blockSize);
 					}
 
 					if(sect->type != eSectionType_Unknown && sect->type < eSectionType_Num)
@@ -808,8 +1184,16 @@ Serialiser::Serialiser(const char *path, Mode mode, bool debugMode)
 					// if section isn't frame capture data and is small enough, read it all into memory now, otherwise skip
 					if(sect->type != eSectionType_FrameCapture && sectionHeader.sectionLength < 4*1024*1024)
 					{
-						sect->data.resize(sectionHeader.sectionLength);
-						FileIO::fread(&sect->data[0], 1, sectionHeader.sectionLength, m_ReadFileHandle);
+						if(sect->compressedReader)
+						{
+							sect->data.resize((size_t)sect->size);
+							sect->compressedReader->Read(&sect->data[0], (size_t)sect->size);
+						}
+						else
+						{
+							sect->data.resize(sectionHeader.sectionLength);
+							FileIO::fread(&sect->data[0], 1, sectionHeader.sectionLength, m_ReadFileHandle);
+						}
 					}
 					else
 					{
@@ -833,6 +1217,15 @@ Serialiser::Serialiser(const char *path, Mode mode, bool debugMode)
 			return;
 		}
 		
+		if(m_KnownSections[eSectionType_Callstacks] != NULL)
+		{
+			vector<byte> data;
+			m_pCallstacks = new CallstackStore();
+
+			if(!GetSectionContents(m_KnownSections[eSectionType_Callstacks], data) || !m_pCallstacks->Read(data))
+				RDCWARN("Couldn't read callstacks section, callstacks will be unavailable");
+		}
+
 		if(m_KnownSections[eSectionType_FrameCapture] == NULL)
 		{
 			RDCERR("Capture file doesn't have a frame capture");
@@ -851,6 +1244,8 @@ Serialiser::Serialiser(const char *path, Mode mode, bool debugMode)
 
 		FileIO::fseek64(m_ReadFileHandle, m_KnownSections[eSectionType_FrameCapture]->fileoffset, SEEK_SET);
 
+		m_ReadAhead = new ReadAheadStream(m_ReadFileHandle, m_KnownSections[eSectionType_FrameCapture]->compressedReader, m_KnownSections[eSectionType_FrameCapture]->size);
+
 		// read initial buffer of data
 		ReadFromFile(0, m_CurrentBufferSize);
 	}
@@ -896,6 +1291,7 @@ void Serialiser::Reset()
 
 	SAFE_DELETE(m_pCallstack);
 	SAFE_DELETE(m_pResolver);
+	SAFE_DELETE(m_pCallstacks);
 	if(m_Buffer)
 	{
 		FreeAlignedBuffer(m_Buffer);
@@ -907,9 +1303,15 @@ void Serialiser::Reset()
 	m_AlignedData = false;
 	
 	m_ReadFileHandle = NULL;
+	m_ReadAhead = NULL;
 	
 	m_ReadOffset = 0;
 
+	m_WrittenSize = 0;
+	m_ExternalStore = "";
+	m_ExternalReferenced = 0;
+	m_ExternalWritten = 0;
+
 	m_BufferHead = m_Buffer = NULL;
 	m_CurrentBufferSize = 0;
 	m_BufferSize = 0;
@@ -925,6 +1327,8 @@ Serialiser::~Serialiser()
 		m_ResolverThread = 0;
 	}
 
+	SAFE_DELETE(m_ReadAhead);
+
 	if(m_ReadFileHandle)
 	{
 		FileIO::fclose(m_ReadFileHandle);
@@ -944,6 +1348,7 @@ Serialiser::~Serialiser()
 
 	SAFE_DELETE(m_pResolver);
 	SAFE_DELETE(m_pCallstack);
+	SAFE_DELETE(m_pCallstacks);
 	if(m_Buffer)
 	{
 		FreeAlignedBuffer(m_Buffer);
@@ -1059,6 +1464,12 @@ void Serialiser::ReadFromFile(uint64_t bufferOffs, size_t length)
 	if(m_ReadFileHandle == NULL)
 		return;
 
+	if(m_ReadAhead)
+	{
+		m_ReadAhead->Read(m_Buffer + bufferOffs, length);
+		return;
+	}
+
 	Section *s = m_KnownSections[eSectionType_FrameCapture];
 
 	RDCASSERT(s);
@@ -1158,6 +1569,9 @@ void Serialiser::SetPersistentBlock(uint64_t offs)
 	}
 
 	RDCASSERT(m_ReadFileHandle);
+
+	// everything's been read, stop the read-ahead before the handle goes away
+	SAFE_DELETE(m_ReadAhead);
 	
 	// close the file handle
 	FileIO::fclose(m_ReadFileHandle);
@@ -1181,15 +1595,23 @@ void Serialiser::SetOffset(uint64_t offs)
 
 		if(m_ReadFileHandle)
 		{
+			// stop the read-ahead before seeking, and start it again from the beginning
+			SAFE_DELETE(m_ReadAhead);
+
 			Section *s = m_KnownSections[eSectionType_FrameCapture];
 			RDCASSERT(s);
 			FileIO::fseek64(m_ReadFileHandle, s->fileoffset, SEEK_SET);
+
+			// any externally stored chunks will be spliced in again as they're read
+			m_BufferSize = s->size;
 			
 			if(s->flags & eSectionFlag_LZ4Compressed)
 			{
 				RDCASSERT(s->compressedReader);
 				s->compressedReader->Reset();
 			}
+
+			m_ReadAhead = new ReadAheadStream(m_ReadFileHandle, s->compressedReader, s->size);
 		}
 
 		FreeAlignedBuffer(m_Buffer);
@@ -1215,6 +1637,129 @@ void Serialiser::InitCallstackResolver()
 	}
 }
 
+uint64_t CallstackStore::Hash(const uint64_t *addrs, size_t numLevels)
+{
+	// FNV-1a over whole addresses, plenty for telling a few thousand stacks apart
+	uint64_t hash = 14695981039346656037ULL ^ numLevels;
+	for(size_t i=0; i < numLevels; i++)
+		hash = (hash ^ addrs[i]) * 1099511628211ULL;
+	return hash;
+}
+
+uint32_t CallstackStore::Intern(const uint64_t *addrs, size_t numLevels)
+{
+	uint64_t hash = Hash(addrs, numLevels);
+
+	SCOPED_LOCK(m_Lock);
+
+	typedef std::multimap<uint64_t, uint32_t>::iterator lookupIt;
+
+	std::pair<lookupIt, lookupIt> range = m_Lookup.equal_range(hash);
+	for(lookupIt it = range.first; it != range.second; ++it)
+	{
+		const uint64_t *existing = NULL;
+		size_t existingLevels = 0;
+		Get(it->second, existing, existingLevels);
+
+		if(existingLevels == numLevels && (numLevels == 0 || !memcmp(existing, addrs, numLevels*sizeof(uint64_t))))
+			return it->second;
+	}
+
+	m_Offsets.push_back((uint32_t)m_Addrs.size());
+	m_Addrs.insert(m_Addrs.end(), addrs, addrs + numLevels);
+
+	uint32_t id = (uint32_t)m_Offsets.size();
+	m_Lookup.insert(std::make_pair(hash, id));
+
+	return id;
+}
+
+bool CallstackStore::Get(uint32_t id, const uint64_t *&addrs, size_t &numLevels) const
+{
+	if(id == 0 || id > m_Offsets.size())
+		return false;
+
+	uint32_t idx = id - 1;
+
+	numLevels = (idx+1 < m_Offsets.size() ? m_Offsets[idx+1] : m_Addrs.size()) - m_Offsets[idx];
+	addrs = numLevels > 0 ? &m_Addrs[m_Offsets[idx]] : NULL;
+
+	return true;
+}
+
+void CallstackStore::Write(vector<byte> &data)
+{
+	SCOPED_LOCK(m_Lock);
+
+	data.clear();
+	data.reserve(sizeof(uint32_t)*(1 + m_Offsets.size()) + sizeof(uint64_t)*m_Addrs.size());
+
+	uint32_t count = (uint32_t)m_Offsets.size();
+	data.insert(data.end(), (byte *)&count, (byte *)(&count + 1));
+
+	for(uint32_t i=0; i < count; i++)
+	{
+		uint32_t start = m_Offsets[i];
+		uint32_t numLevels = (i+1 < count ? m_Offsets[i+1] : (uint32_t)m_Addrs.size()) - start;
+
+		data.insert(data.end(), (byte *)&numLevels, (byte *)(&numLevels + 1));
+		if(numLevels > 0)
+			data.insert(data.end(), (byte *)&m_Addrs[start], (byte *)(&m_Addrs[start] + numLevels));
+	}
+}
+
+bool CallstackStore::Read(const vector<byte> &data)
+{
+	SCOPED_LOCK(m_Lock);
+
+	m_Addrs.clear();
+	m_Offsets.clear();
+	m_Lookup.clear();
+
+	uint32_t count = 0;
+	if(data.size() < sizeof(count))
+		return false;
+
+	const byte *cur = &data[0];
+	const byte *end = cur + data.size();
+
+	memcpy(&count, cur, sizeof(count));
+	cur += sizeof(count);
+
+	for(uint32_t i=0; i < count; i++)
+	{
+		uint32_t numLevels = 0;
+		if(size_t(end - cur) < sizeof(numLevels))
+			return false;
+
+		memcpy(&numLevels, cur, sizeof(numLevels));
+		cur += sizeof(numLevels);
+
+		if(size_t(end - cur) / sizeof(uint64_t) < numLevels)
+			return false;
+
+		m_Offsets.push_back((uint32_t)m_Addrs.size());
+		m_Addrs.resize(m_Addrs.size() + numLevels);
+		if(numLevels > 0)
+			memcpy(&m_Addrs[m_Offsets.back()], cur, numLevels*sizeof(uint64_t));
+		cur += numLevels*sizeof(uint64_t);
+
+		const uint64_t *addrs = NULL;
+		size_t levels = 0;
+		Get((uint32_t)m_Offsets.size(), addrs, levels);
+
+		m_Lookup.insert(std::make_pair(Hash(addrs, levels), (uint32_t)m_Offsets.size()));
+	}
+
+	return true;
+}
+
+CallstackStore &Serialiser::GetCaptureCallstacks()
+{
+	static CallstackStore store;
+	return store;
+}
+
 void Serialiser::SetCallstack(uint64_t *levels, size_t numLevels)
 {
 	if(m_pCallstack == NULL)
@@ -1235,19 +1780,160 @@ void Serialiser::CreateResolver(void *ths)
 	ser->m_pResolver = Callstack::MakeResolver((char *)&s->data[0], s->data.size(), dir, &ser->m_ResolverThreadKillSignal);
 }
 
-void Serialiser::FlushToDisk()
+// writes a binary section header, followed by the uncompressed length (and block size if it's
+// not the default) for compressed sections. Returns the header's offset for EndBinarySection
+static uint64_t BeginBinarySection(FILE *f, const string &name, Serialiser::SectionType type, bool compress, size_t blockSize)
 {
-	SCOPED_TIMER("File writing");
+	uint64_t headerOffs = FileIO::ftell64(f);
 
-	if(m_Filename != "" && !m_HasError && m_Mode == WRITING)
+	BinarySectionHeader section = { 0 };
+	section.isASCII = 0; // redundant but explicit
+	section.sectionNameLength = uint32_t(name.length()+1); // includes null terminator
+	section.sectionType = type;
+	section.sectionFlags = Serialiser::eSectionFlag_None;
+	section.sectionLength = 0; // will be fixed up later, to avoid having to compress everything into memory
+
+	if(compress)
 	{
-		RDCDEBUG("writing capture files");
+		section.sectionFlags = Serialiser::eSectionFlag_LZ4Compressed;
 
-		if(m_DebugEnabled && !m_DebugText.empty())
-		{
-			FILE *dbgFile = FileIO::fopen((m_Filename + ".txt").c_str(), "wb");
+		if(blockSize != CompressedFileIO::DefaultBlockSize)
+			section.sectionFlags = Serialiser::SectionFlags(section.sectionFlags | Serialiser::eSectionFlag_LZ4BlockSize);
+	}
 
-			if(!dbgFile)
+	FileIO::fwrite(&section, 1, offsetof(BinarySectionHeader, name), f);
+	FileIO::fwrite(name.c_str(), 1, name.length()+1, f);
+
+	if(compress)
+	{
+		uint64_t len = 0; // will be fixed up later
+		FileIO::fwrite(&len, 1, sizeof(uint64_t), f);
+
+		if(section.sectionFlags & Serialiser::eSectionFlag_LZ4BlockSize)
+		{
+			uint32_t block = (uint32_t)blockSize;
+			FileIO::fwrite(&block, 1, sizeof(uint32_t), f);
+		}
+	}
+
+	return headerOffs;
+}
+
+// fills in the lengths of a section started with BeginBinarySection, once the writer has been flushed
+static void EndBinarySection(FILE *f, uint64_t headerOffs, SectionWriter &writer)
+{
+	uint64_t curoffs = FileIO::ftell64(f);
+
+	uint32_t storedSize = writer.GetStoredSize();
+	FileIO::fseek64(f, headerOffs + offsetof(BinarySectionHeader, sectionLength), SEEK_SET);
+	FileIO::fwrite(&storedSize, 1, sizeof(storedSize), f);
+
+	if(writer.m_Compressor)
+	{
+		uint32_t nameLength = 0;
+		FileIO::fseek64(f, headerOffs + offsetof(BinarySectionHeader, sectionNameLength), SEEK_SET);
+		FileIO::fread(&nameLength, 1, sizeof(nameLength), f);
+
+		uint64_t uncompSize = writer.GetUncompressedSize();
+		FileIO::fseek64(f, headerOffs + offsetof(BinarySectionHeader, name) + nameLength, SEEK_SET);
+		FileIO::fwrite(&uncompSize, 1, sizeof(uncompSize), f);
+	}
+
+	FileIO::fseek64(f, curoffs, SEEK_SET);
+}
+
+void Serialiser::WriteChunkToStream(SectionWriter &writer, const byte *data, uint32_t length, uint32_t chunkType, bool aligned, uint64_t &offs)
+{
+	static const byte padding[BufferAlignment] = {0};
+
+	uint64_t alignedoffs = 0;
+
+	bool external = false;
+	uint64_t hash[2] = { 0, 0 };
+
+	if(!m_ExternalStore.empty() && chunkType == INITIAL_CONTENTS && length >= ExternalChunkMinSize)
+	{
+		MurmurHash3_x64_128(data, (int)length, 0, hash);
+
+		bool written = false;
+		external = WriteExternalChunk(m_ExternalStore, hash, data, length, written);
+
+		if(external)
+		{
+			m_ExternalReferenced += length;
+			if(written)
+				m_ExternalWritten += length;
+		}
+	}
+
+	// an external chunk is spliced in after its reference when reading, so
+	// it's the offset after the reference that needs to be aligned
+	const uint64_t refSize = external ? ExternalChunkRefSize : 0;
+
+	alignedoffs = AlignUp(offs + refSize, BufferAlignment) - refSize;
+
+	if(offs != alignedoffs && aligned)
+	{
+		uint16_t chunkIdx = 0; // write a '0' chunk that indicates special behaviour
+		writer.Write(&chunkIdx, sizeof(chunkIdx));
+		offs += sizeof(chunkIdx);
+
+		uint8_t controlByte = 0; // control byte 0 indicates padding
+		writer.Write(&controlByte, sizeof(controlByte));
+		offs += sizeof(controlByte);
+
+		offs++; // we will have to write out a byte indicating how much padding exists, so add 1
+		alignedoffs = AlignUp(offs + refSize, BufferAlignment) - refSize;
+
+		RDCCOMPILE_ASSERT(BufferAlignment < 0x100, "Buffer alignment must be less than 256"); // with a byte at most indicating how many bytes to pad,
+		// this is our maximal representable alignment
+
+		uint8_t padLength = (alignedoffs-offs)&0xff;
+		writer.Write(&padLength, sizeof(padLength));
+
+		// we might have padded with the control bytes, so only write some bytes if we need to
+		if(padLength > 0)
+		{
+			writer.Write(padding, size_t(alignedoffs-offs));
+			offs += alignedoffs-offs;
+		}
+	}
+	
+	if(external)
+	{
+		uint16_t chunkIdx = 0;
+		writer.Write(&chunkIdx, sizeof(chunkIdx));
+
+		uint8_t controlByte = 1; // control byte 1 indicates a chunk in the external store
+		writer.Write(&controlByte, sizeof(controlByte));
+
+		writer.Write(hash, sizeof(hash));
+		writer.Write(&length, sizeof(length));
+
+		offs += refSize;
+	}
+	else
+	{
+		writer.Write(data, length);
+	}
+
+	// offsets are in the stream as seen by the reader, with external chunks spliced in
+	offs += length;
+}
+
+void Serialiser::FlushToDisk()
+{
+	SCOPED_TIMER("File writing");
+
+	if(m_Filename != "" && !m_HasError && m_Mode == WRITING)
+	{
+		RDCDEBUG("writing capture files");
+
+		if(m_DebugEnabled && !m_DebugText.empty())
+		{
+			FILE *dbgFile = FileIO::fopen((m_Filename + ".txt").c_str(), "wb");
+
+			if(!dbgFile)
 			{
 				RDCERR("Can't open debug capture file '%s'", (m_Filename + ".txt").c_str());
 			}
@@ -1276,106 +1962,38 @@ void Serialiser::FlushToDisk()
 		// write header
 		FileIO::fwrite(&header, 1, sizeof(FileHeader), binFile);
 
-		static const byte padding[BufferAlignment] = {0};
-		
-		uint64_t compressedSizeOffset = 0;
-		uint64_t uncompressedSizeOffset = 0;
-
-		// write frame capture section header
-		{
-			const char sectionName[] = "renderdoc/internal/framecapture";
-
-			BinarySectionHeader section = { 0 };
-			section.isASCII = 0; // redundant but explicit
-			section.sectionNameLength = sizeof(sectionName); // includes null terminator
-			section.sectionType = eSectionType_FrameCapture;
-			section.sectionFlags = eSectionFlag_LZ4Compressed;
-			section.sectionLength = 0; // will be fixed up later, to avoid having to compress everything into memory
-
-			compressedSizeOffset = FileIO::ftell64(binFile) + offsetof(BinarySectionHeader, sectionLength);
-
-			FileIO::fwrite(&section, 1, offsetof(BinarySectionHeader, name), binFile);
-			FileIO::fwrite(sectionName, 1, sizeof(sectionName), binFile);
-
-			uint64_t len = 0; // will be fixed up later
-			uncompressedSizeOffset = FileIO::ftell64(binFile);
-			FileIO::fwrite(&len, 1, sizeof(uint64_t), binFile);
-		}
+		uint64_t sectionOffs = BeginBinarySection(binFile, "renderdoc/internal/framecapture", eSectionType_FrameCapture, true, CompressedFileIO::DefaultBlockSize);
 
-		CompressedFileIO fwriter(binFile);
+		SectionWriter writer(binFile, true);
 
 		// track offset so we can add padding. The padding is relative
 		// to the start of the decompressed buffer, so we start it from 0
 		uint64_t offs = 0;
-		uint64_t alignedoffs = 0;
+
+		m_ExternalReferenced = m_ExternalWritten = 0;
 
 		// write frame capture contents
 		for(size_t i=0; i < m_Chunks.size(); i++)
 		{
 			Chunk *chunk = m_Chunks[i];
 
-			alignedoffs = AlignUp(offs, BufferAlignment);
-
-			if(offs != alignedoffs && chunk->IsAligned())
-			{
-				uint16_t chunkIdx = 0; // write a '0' chunk that indicates special behaviour
-				fwriter.Write(&chunkIdx, sizeof(chunkIdx));
-				offs += sizeof(chunkIdx);
-
-				uint8_t controlByte = 0; // control byte 0 indicates padding
-				fwriter.Write(&controlByte, sizeof(controlByte));
-				offs += sizeof(controlByte);
-
-				offs++; // we will have to write out a byte indicating how much padding exists, so add 1
-				alignedoffs = AlignUp(offs, BufferAlignment);
-
-				RDCCOMPILE_ASSERT(BufferAlignment < 0x100, "Buffer alignment must be less than 256"); // with a byte at most indicating how many bytes to pad,
-				// this is our maximal representable alignment
-
-				uint8_t padLength = (alignedoffs-offs)&0xff;
-				fwriter.Write(&padLength, sizeof(padLength));
-
-				// we might have padded with the control bytes, so only write some bytes if we need to
-				if(padLength > 0)
-				{
-					fwriter.Write(padding, size_t(alignedoffs-offs));
-					offs += alignedoffs-offs;
-				}
-			}
-			
-			fwriter.Write(chunk->GetData(), chunk->GetLength());
-
-			offs += chunk->GetLength();
+			WriteChunkToStream(writer, chunk->GetData(), chunk->GetLength(), chunk->GetChunkType(), chunk->IsAligned(), offs);
 
 			if(chunk->IsTemporary())
 				SAFE_DELETE(chunk);
 		}
 
-		fwriter.Flush();
+		writer.Flush();
 
 		m_Chunks.clear();
 
 		// fixup section size
-		{
-			uint32_t compsize = 0;
-			uint64_t uncompsize = 0;
-
-			uint64_t curoffs = FileIO::ftell64(binFile);
-
-			FileIO::fseek64(binFile, compressedSizeOffset, SEEK_SET);
-
-			compsize = fwriter.GetCompressedSize();
-			FileIO::fwrite(&compsize, 1, sizeof(compsize), binFile);
-			
-			FileIO::fseek64(binFile, uncompressedSizeOffset, SEEK_SET);
-
-			uncompsize = fwriter.GetUncompressedSize();
-			FileIO::fwrite(&uncompsize, 1, sizeof(uncompsize), binFile);
+		EndBinarySection(binFile, sectionOffs, writer);
 
-			FileIO::fseek64(binFile, curoffs, SEEK_SET);
+		RDCLOG("Compressed frame capture data from %llu to %u", writer.GetUncompressedSize(), writer.GetStoredSize());
 
-			RDCLOG("Compressed frame capture data from %u to %u", fwriter.GetUncompressedSize(), fwriter.GetCompressedSize());
-		}
+		if(m_ExternalReferenced > 0)
+			RDCLOG("Referenced %llu bytes of initial contents from store, %llu bytes newly written", m_ExternalReferenced, m_ExternalWritten);
 
 		char *symbolDB = NULL;
 		size_t symbolDBSize = 0;
@@ -1412,10 +2030,527 @@ void Serialiser::FlushToDisk()
 			SAFE_DELETE_ARRAY(symbolDB);
 		}
 
+		// write the callstacks that chunk headers refer to. This is every stack seen so far
+		// in the process, since chunks recorded before the capture keep their IDs
+		if(!GetCaptureCallstacks().IsEmpty())
+		{
+			vector<byte> stacks;
+			GetCaptureCallstacks().Write(stacks);
+
+			uint64_t stacksOffs = BeginBinarySection(binFile, "renderdoc/internal/callstacks", eSectionType_Callstacks, true, CompressedFileIO::DefaultBlockSize);
+
+			SectionWriter stacksWriter(binFile, true);
+			stacksWriter.Write(&stacks[0], stacks.size());
+			stacksWriter.Flush();
+
+			EndBinarySection(binFile, stacksOffs, stacksWriter);
+		}
+
+		m_WrittenSize = FileIO::ftell64(binFile);
+
 		FileIO::fclose(binFile);
 	}
 }
 
+static string ExternalChunkFilename(const string &storeDir, const uint64_t hash[2])
+{
+	return StringFormat::Fmt("%s/%016llx%016llx.blob", storeDir.c_str(), hash[0], hash[1]);
+}
+
+// returns the length of a complete blob in the store, or 0 if it's missing or incomplete
+static uint32_t ExternalChunkLength(const string &filename)
+{
+	FILE *f = FileIO::fopen(filename.c_str(), "rb");
+
+	if(f == NULL)
+		return 0;
+
+	ExternalChunkHeader header = { 0, 0 };
+	FileIO::fread(&header, 1, sizeof(header), f);
+
+	FileIO::fclose(f);
+
+	return header.magic == EXTERNAL_CHUNK_MAGIC ? header.length : 0;
+}
+
+bool Serialiser::WriteExternalChunk(const string &storeDir, const uint64_t hash[2], const byte *data, uint32_t length, bool &written)
+{
+	written = false;
+
+	string filename = ExternalChunkFilename(storeDir, hash);
+
+	// already stored by a previous capture
+	if(ExternalChunkLength(filename) == length)
+		return true;
+
+	FileIO::CreateParentDirectory(filename);
+
+	// write to a name no other process or thread is using, then move it into place below, so
+	// a crash or another capture/repack storing the same blob can't leave a truncated one
+	string tmpname = filename + StringFormat::Fmt(".%u.%llu.tmp", Process::GetCurrentPID(), Threading::GetCurrentID());
+
+	FILE *f = FileIO::fopen(tmpname.c_str(), "wb");
+
+	if(f == NULL)
+	{
+		RDCERR("Can't open store file '%s' for write, errno %d", tmpname.c_str(), errno);
+		return false;
+	}
+
+	ExternalChunkHeader header = { EXTERNAL_CHUNK_MAGIC, 0 };
+	FileIO::fwrite(&header, 1, sizeof(header), f);
+
+	{
+		CompressedFileIO fwriter(f);
+		fwriter.Write(data, length);
+		fwriter.Flush();
+	}
+
+	// fill in the length last so an interrupted write is never mistaken for a complete blob
+	header.length = length;
+	FileIO::fseek64(f, 0, SEEK_SET);
+	FileIO::fwrite(&header, 1, sizeof(header), f);
+
+	FileIO::fclose(f);
+
+	if(!FileIO::Move(tmpname.c_str(), filename.c_str(), false))
+	{
+		// someone else stored it first, the contents are the same so keep theirs. Only replace
+		// what's there if it's an incomplete blob left by an older build
+		if(ExternalChunkLength(filename) == length)
+		{
+			FileIO::Delete(tmpname.c_str());
+			return true;
+		}
+
+		if(!FileIO::Move(tmpname.c_str(), filename.c_str(), true))
+		{
+			RDCERR("Can't move store file '%s' into place, errno %d", tmpname.c_str(), errno);
+			FileIO::Delete(tmpname.c_str());
+			return false;
+		}
+	}
+
+	written = true;
+
+	return true;
+}
+
+void Serialiser::SpliceExternalChunk(const uint64_t hash[2], uint32_t length)
+{
+	FILE *f = NULL;
+
+	// look for the store next to the capture first, then walk up the parent
+	// directories so that a store shared by a whole tree of captures is found
+	if(!m_Filename.empty())
+	{
+		string dir = dirname(m_Filename);
+
+		for(int i=0; i < 16 && f == NULL; i++)
+		{
+			string filename = ExternalChunkFilename(dir + "/" + ExternalStoreName, hash);
+
+			if(ExternalChunkLength(filename) == length)
+			{
+				f = FileIO::fopen(filename.c_str(), "rb");
+				break;
+			}
+
+			string parent = dirname(dir);
+			if(parent.empty() || parent == dir)
+				break;
+
+			dir = parent;
+		}
+	}
+
+	if(f == NULL)
+	{
+		RDCERR("Can't find stored chunk %016llx%016llx (%u bytes) for '%s'. Is the '%s' directory missing?",
+		       hash[0], hash[1], length, m_Filename.c_str(), ExternalStoreName);
+		m_ErrorCode = eSerError_FileIO;
+		m_HasError = true;
+		return;
+	}
+
+	ExternalChunkHeader header;
+	FileIO::fread(&header, 1, sizeof(header), f);
+
+	// build a new window with the usual backwards window, then the stored chunk,
+	// then whatever was already read in after the reference
+	size_t headOffs = size_t(m_BufferHead - m_Buffer);
+	size_t backwardsWindow = RDCMIN((size_t)64, headOffs);
+
+	// near the end of the stream, not all of the window is valid data
+	size_t tail = (size_t)RDCMIN(uint64_t(m_CurrentBufferSize - headOffs), m_BufferSize - m_ReadOffset - headOffs);
+
+	size_t newSize = backwardsWindow + length + tail;
+	byte *newBuf = AllocAlignedBuffer(newSize);
+
+	memcpy(newBuf, m_BufferHead - backwardsWindow, backwardsWindow);
+
+	{
+		CompressedFileIO reader(f);
+		reader.Read(newBuf + backwardsWindow, length);
+	}
+
+	FileIO::fclose(f);
+
+	memcpy(newBuf + backwardsWindow + length, m_BufferHead, tail);
+
+	FreeAlignedBuffer(m_Buffer);
+
+	m_ReadOffset += headOffs - backwardsWindow;
+	m_Buffer = newBuf;
+	m_BufferHead = m_Buffer + backwardsWindow;
+	m_CurrentBufferSize = newSize;
+
+	// the stream is now longer by the spliced chunk. The file position still lines
+	// up with the end of the window, so reading continues as normal from here
+	m_BufferSize += length;
+}
+
+bool Serialiser::ReadRawChunk(vector<byte> &data, uint32_t &chunkType, bool &aligned)
+{
+	uint16_t c = ReadChunkIndex();
+
+	if(m_HasError)
+		return false;
+
+	// chunks that needed alignment were padded out to an aligned offset. A chunk that
+	// happens to land on one anyway is treated the same, which is harmless.
+	aligned = ((GetOffset() - sizeof(c)) % BufferAlignment) == 0;
+	chunkType = c&0x3fff;
+
+	data.clear();
+	data.insert(data.end(), (byte *)&c, (byte *)(&c + 1));
+
+	if(c & 0x8000)
+	{
+		uint32_t stackID = 0;
+
+		if(m_SerVer >= 0x00000033)
+		{
+			ReadInto(stackID);
+		}
+		else
+		{
+			// older captures stored the stack inline, intern it so the chunk comes out
+			// in the current format
+			uint8_t callLen = 0;
+			ReadInto(callLen);
+
+			uint64_t *calls = (uint64_t *)ReadBytes(callLen*sizeof(uint64_t));
+
+			if(m_pCallstacks == NULL)
+				m_pCallstacks = new CallstackStore();
+
+			if(calls)
+				stackID = m_pCallstacks->Intern(calls, callLen);
+		}
+
+		data.insert(data.end(), (byte *)&stackID, (byte *)(&stackID + 1));
+	}
+
+	uint32_t length = 0;
+
+	if(c & 0x4000)
+	{
+		uint16_t miniSize = 0;
+		ReadInto(miniSize);
+		data.insert(data.end(), (byte *)&miniSize, (byte *)(&miniSize + 1));
+
+		length = miniSize;
+	}
+	else
+	{
+		ReadInto(length);
+		data.insert(data.end(), (byte *)&length, (byte *)(&length + 1));
+	}
+
+	byte *contents = (byte *)ReadBytes(length);
+
+	if(contents == NULL || m_HasError)
+		return false;
+
+	data.insert(data.end(), contents, contents + length);
+
+	return true;
+}
+
+bool Serialiser::HashChunkStream(uint64_t hash[2], uint64_t &numChunks)
+{
+	hash[0] = hash[1] = 0;
+	numChunks = 0;
+
+	vector<byte> data;
+	uint32_t chunkType = 0;
+	bool aligned = false;
+
+	while(!AtEnd())
+	{
+		if(!ReadRawChunk(data, chunkType, aligned))
+			return false;
+
+		// chain each chunk's hash onto the running hash, so order matters
+		uint64_t combined[4] = { hash[0], hash[1], 0, 0 };
+		MurmurHash3_x64_128(&data[0], (int)data.size(), 0, &combined[2]);
+		MurmurHash3_x64_128(combined, sizeof(combined), 0, hash);
+
+		numChunks++;
+	}
+
+	return true;
+}
+
+bool Serialiser::GetSectionContents(Section *s, vector<byte> &data)
+{
+	// loaded up-front
+	if(!s->data.empty() || s->size == 0)
+	{
+		data = s->data;
+		return true;
+	}
+
+	// open our own handle so we don't disturb reading of the frame capture
+	FILE *f = FileIO::fopen(m_Filename.c_str(), "rb");
+
+	if(f == NULL)
+	{
+		RDCERR("Can't open '%s' to read section '%s'", m_Filename.c_str(), s->name.c_str());
+		return false;
+	}
+
+	FileIO::fseek64(f, s->fileoffset, SEEK_SET);
+
+	data.resize((size_t)s->size);
+
+	if(s->compressedReader)
+	{
+		CompressedFileIO reader(f, s->compressedReader->m_BlockSize);
+		reader.Read(&data[0], data.size());
+	}
+	else
+	{
+		FileIO::fread(&data[0], 1, data.size(), f);
+	}
+
+	FileIO::fclose(f);
+
+	return true;
+}
+
+bool Serialiser::Repack(const char *src, const char *dst, const string &storeDir, const RepackOptions &opts, RepackResult &result)
+{
+	// write beside dst and move it into place at the end. Opening dst directly would truncate
+	// src before it's read if they're the same file, and a failed repack would leave a broken dst.
+	// src is closed by the time RepackFile returns, so it can be replaced on any platform.
+	string tmp = string(dst) + ".tmp";
+
+	bool success = RepackFile(src, tmp.c_str(), storeDir, opts, result);
+
+	if(success && !FileIO::Move(tmp.c_str(), dst, true))
+	{
+		RDCERR("Couldn't move repacked '%s' into place at '%s'", tmp.c_str(), dst);
+		success = false;
+	}
+
+	if(!success)
+	{
+		FileIO::Delete(tmp.c_str());
+		result.success = false;
+	}
+
+	return success;
+}
+
+bool Serialiser::RepackFile(const char *src, const char *dst, const string &storeDir, const RepackOptions &opts, RepackResult &result)
+{
+	RDCEraseEl(result);
+
+	size_t blockSize = RDCCLAMP((size_t)opts.blockSize, CompressedFileIO::MinBlockSize, CompressedFileIO::MaxBlockSize);
+
+	Serialiser in(src, READING, false);
+
+	if(in.HasError())
+	{
+		RDCERR("Can't open '%s' to repack", src);
+		return false;
+	}
+
+	FileIO::CreateParentDirectory(dst);
+
+	FILE *f = FileIO::fopen(dst, "w+b");
+
+	if(f == NULL)
+	{
+		RDCERR("Can't open '%s' for write, errno %d", dst, errno);
+		return false;
+	}
+
+	FileHeader header;
+	FileIO::fwrite(&header, 1, sizeof(FileHeader), f);
+
+	// the writing serialiser isn't used to hold chunks, just to place them in the stream
+	Serialiser out(dst, WRITING, false);
+	out.SetExternalChunkStore(storeDir);
+
+	uint64_t srcHash[2] = { 0, 0 };
+	uint64_t numChunks = 0;
+
+	// frame capture must come first, the rest follow in their original order
+	{
+		uint64_t sectionOffs = BeginBinarySection(f, "renderdoc/internal/framecapture", eSectionType_FrameCapture, opts.compress != 0, blockSize);
+
+		SectionWriter writer(f, opts.compress != 0, blockSize);
+
+		uint64_t offs = 0;
+
+		vector<byte> data;
+		uint32_t chunkType = 0;
+		bool aligned = false;
+
+		while(!in.AtEnd())
+		{
+			if(!in.ReadRawChunk(data, chunkType, aligned))
+			{
+				RDCERR("Failed to read chunk %llu from '%s'", numChunks, src);
+				FileIO::fclose(f);
+				return false;
+			}
+
+			uint64_t combined[4] = { srcHash[0], srcHash[1], 0, 0 };
+			MurmurHash3_x64_128(&data[0], (int)data.size(), 0, &combined[2]);
+			MurmurHash3_x64_128(combined, sizeof(combined), 0, srcHash);
+
+			numChunks++;
+
+			out.WriteChunkToStream(writer, &data[0], (uint32_t)data.size(), chunkType, aligned, offs);
+		}
+
+		writer.Flush();
+
+		EndBinarySection(f, sectionOffs, writer);
+	}
+
+	for(size_t i=0; i < in.m_Sections.size(); i++)
+	{
+		Section *s = in.m_Sections[i];
+
+		// callstacks are written below, older captures only get the section after
+		// their chunks have been read
+		if(s->type == eSectionType_FrameCapture || s->type == eSectionType_Callstacks)
+			continue;
+
+		vector<byte> data;
+		if(!in.GetSectionContents(s, data))
+		{
+			FileIO::fclose(f);
+			return false;
+		}
+
+		if(s->flags & eSectionFlag_ASCIIStored)
+		{
+			// keep ASCII sections human-readable
+			string sectionHeader = StringFormat::Fmt("A\n%llu\n%u\n%s\n", (uint64_t)data.size(), (uint32_t)s->type, s->name.c_str());
+			FileIO::fwrite(sectionHeader.c_str(), 1, sectionHeader.length(), f);
+			if(!data.empty())
+				FileIO::fwrite(&data[0], 1, data.size(), f);
+		}
+		else
+		{
+			uint64_t sectionOffs = BeginBinarySection(f, s->name, s->type, opts.compress != 0, blockSize);
+
+			SectionWriter writer(f, opts.compress != 0, blockSize);
+			if(!data.empty())
+				writer.Write(&data[0], data.size());
+			writer.Flush();
+
+			EndBinarySection(f, sectionOffs, writer);
+		}
+	}
+
+	if(in.m_pCallstacks && !in.m_pCallstacks->IsEmpty())
+	{
+		vector<byte> stacks;
+		in.m_pCallstacks->Write(stacks);
+
+		uint64_t sectionOffs = BeginBinarySection(f, "renderdoc/internal/callstacks", eSectionType_Callstacks, opts.compress != 0, blockSize);
+
+		SectionWriter writer(f, opts.compress != 0, blockSize);
+		writer.Write(&stacks[0], stacks.size());
+		writer.Flush();
+
+		EndBinarySection(f, sectionOffs, writer);
+	}
+
+	result.repackedSize = FileIO::ftell64(f);
+
+	FileIO::fclose(f);
+
+	result.storeReferenced = out.GetExternalReferencedSize();
+	result.storeWritten = out.GetExternalWrittenSize();
+
+	{
+		FILE *srcFile = FileIO::fopen(src, "rb");
+		if(srcFile)
+		{
+			FileIO::fseek64(srcFile, 0, SEEK_END);
+			result.originalSize = FileIO::ftell64(srcFile);
+			FileIO::fclose(srcFile);
+		}
+	}
+
+	result.success = true;
+
+	if(opts.verify)
+	{
+		Serialiser check(dst, READING, false);
+
+		uint64_t dstHash[2] = { 0, 0 };
+		uint64_t dstChunks = 0;
+
+		bool match = !check.HasError() && check.HashChunkStream(dstHash, dstChunks) &&
+			dstChunks == numChunks && dstHash[0] == srcHash[0] && dstHash[1] == srcHash[1];
+
+		if(!match)
+			RDCERR("Repacked '%s' chunk stream doesn't match '%s' (%llu vs %llu chunks)", dst, src, dstChunks, numChunks);
+
+		// compare the other sections too. They're written in the same order, after the frame capture
+		vector<Section *> srcSections, dstSections;
+
+		for(size_t i=0; i < in.m_Sections.size(); i++)
+			if(in.m_Sections[i]->type != eSectionType_FrameCapture)
+				srcSections.push_back(in.m_Sections[i]);
+
+		for(size_t i=0; i < check.m_Sections.size(); i++)
+			if(check.m_Sections[i]->type != eSectionType_FrameCapture)
+				dstSections.push_back(check.m_Sections[i]);
+
+		if(match && srcSections.size() != dstSections.size())
+		{
+			RDCERR("Repacked '%s' has %u sections, expected %u", dst, (uint32_t)dstSections.size(), (uint32_t)srcSections.size());
+			match = false;
+		}
+
+		for(size_t i=0; match && i < srcSections.size(); i++)
+		{
+			vector<byte> a, b;
+
+			match = dstSections[i]->type == srcSections[i]->type && dstSections[i]->name == srcSections[i]->name &&
+				in.GetSectionContents(srcSections[i], a) && check.GetSectionContents(dstSections[i], b) && a == b;
+
+			if(!match)
+				RDCERR("Repacked '%s' section '%s' doesn't match original", dst, srcSections[i]->name.c_str());
+		}
+
+		result.verified = match;
+		result.success = match;
+	}
+
+	return result.success != 0;
+}
+
 void Serialiser::DebugPrint(const char *fmt, ...)
 {
 	if(m_HasError)
@@ -1447,6 +2582,52 @@ void Serialiser::DebugPrint(const char *fmt, ...)
 #endif
 }
 
+uint16_t Serialiser::ReadChunkIndex()
+{
+	uint16_t c = 0;
+	ReadInto(c);
+
+	// chunk index 0 is not allowed in normal situations.
+	// allows us to indicate some control bytes
+	while(c == 0 && !m_HasError)
+	{
+		uint8_t *controlByte = (uint8_t *)ReadBytes(1);
+
+		if(*controlByte == 0x0)
+		{
+			// padding
+			uint8_t *padLength = (uint8_t *)ReadBytes(1);
+
+			// might have padded with these 5 control bytes,
+			// so a pad length of 0 IS VALID.
+			if(*padLength > 0)
+			{
+				ReadBytes((size_t)*padLength);
+			}
+		}
+		else if(*controlByte == 0x1)
+		{
+			// chunk stored externally, splice it into the stream here
+			uint64_t hash[2] = { 0, 0 };
+			uint32_t length = 0;
+
+			ReadInto(hash[0]);
+			ReadInto(hash[1]);
+			ReadInto(length);
+
+			SpliceExternalChunk(hash, length);
+		}
+		else
+		{
+			RDCERR("Unexpected control byte: %x", (uint32_t)*controlByte);
+		}
+		
+		ReadInto(c);
+	}
+
+	return c;
+}
+
 uint32_t Serialiser::PushContext(const char *name, uint32_t chunkIdx, bool smallChunk)
 {
 	// if writing, and chunkidx isn't 0 (debug non-scope), then either we're nested
@@ -1473,7 +2654,7 @@ uint32_t Serialiser::PushContext(const char *name, uint32_t chunkIdx, bool small
 				if(RenderDoc::Inst().GetCaptureOptions().CaptureCallstacks &&
 					!RenderDoc::Inst().GetCaptureOptions().CaptureCallstacksOnlyDraws)
 				{			
-					call = Callstack::Collect();
+					call = RenderDoc::Inst().CollectCallstack();
 
 					RDCASSERT(call->NumLevels() < 0xff);
 				}
@@ -1488,13 +2669,8 @@ uint32_t Serialiser::PushContext(const char *name, uint32_t chunkIdx, bool small
 
 			if(call)
 			{
-				uint8_t numLevels = call->NumLevels()&0xff;
-				WriteFrom(numLevels);
-
-				if(call->NumLevels())
-				{
-					WriteBytes((byte *)call->GetAddrs(), sizeof(uint64_t)*numLevels);
-				}
+				uint32_t stackID = GetCaptureCallstacks().Intern(call->GetAddrs(), call->NumLevels());
+				WriteFrom(stackID);
 
 				SAFE_DELETE(call);
 			}
@@ -1527,35 +2703,8 @@ uint32_t Serialiser::PushContext(const char *name, uint32_t chunkIdx, bool small
 
 		if(chunkIdx > 0)
 		{
-			uint16_t c = 0;
-			ReadInto(c);
+			uint16_t c = ReadChunkIndex();
 
-			// chunk index 0 is not allowed in normal situations.
-			// allows us to indicate some control bytes
-			while(c == 0)
-			{
-				uint8_t *controlByte = (uint8_t *)ReadBytes(1);
-
-				if(*controlByte == 0x0)
-				{
-					// padding
-					uint8_t *padLength = (uint8_t *)ReadBytes(1);
-
-					// might have padded with these 5 control bytes,
-					// so a pad length of 0 IS VALID.
-					if(*padLength > 0)
-					{
-						ReadBytes((size_t)*padLength);
-					}
-				}
-				else
-				{
-					RDCERR("Unexpected control byte: %x", (uint32_t)*controlByte);
-				}
-				
-				ReadInto(c);
-			}
-		
 			chunkIdx = c&0x3fff;	
 			bool callstack = (c&0x8000) > 0;
 			bool smallchunk = (c&0x4000) > 0;
@@ -1564,7 +2713,20 @@ uint32_t Serialiser::PushContext(const char *name, uint32_t chunkIdx, bool small
 			
 			if(m_Indent == 0)
 			{
-				if(callstack)
+				if(callstack && m_SerVer >= 0x00000033)
+				{
+					uint32_t stackID = 0;
+					ReadInto(stackID);
+
+					const uint64_t *calls = NULL;
+					size_t callLen = 0;
+
+					if(m_pCallstacks && m_pCallstacks->Get(stackID, calls, callLen))
+						SetCallstack((uint64_t *)calls, callLen);
+					else
+						SetCallstack(NULL, 0);
+				}
+				else if(callstack)
 				{
 					uint8_t callLen = 0;
 					ReadInto(callLen);
@@ -1710,6 +2872,15 @@ void Serialiser::Insert(Chunk *chunk)
 	m_DebugText += chunk->GetDebugString();
 }
 
+void Serialiser::DetachChunks()
+{
+	for(size_t i=0; i < m_Chunks.size(); i++)
+	{
+		if(!m_Chunks[i]->IsTemporary())
+			m_Chunks[i] = m_Chunks[i]->Duplicate(true);
+	}
+}
+
 void Serialiser::AlignNextBuffer(const size_t alignment)
 {
 	// on new logs, we don't have to align. This code will be deleted once backwards-compat is dropped
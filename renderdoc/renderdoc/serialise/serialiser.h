@@ -39,6 +39,7 @@
 #include <list>
 #include <utility>
 #include <set>
+#include <map>
 using std::set;
 using std::string;
 
@@ -81,6 +82,10 @@ typedef const char *(*ChunkLookup)(uint32_t chunkType);
 class Serialiser;
 class ScopedContext;
 struct CompressedFileIO;
+struct ReadAheadStream;
+struct SectionWriter;
+struct RepackOptions;
+struct RepackResult;
 
 // holds the memory, length and type for a given chunk, so that it can be
 // passed around and moved between owners before being serialised out
@@ -108,7 +113,12 @@ class Chunk
 		// grab current contents of the serialiser into this chunk
 		Chunk(Serialiser *ser, uint32_t chunkType, bool temp); 
 
+		// make an independent copy of this chunk's data
+		Chunk *Duplicate(bool temp);
+
 	private:
+		Chunk() {}
+
 		// no copy semantics
 		Chunk(const Chunk &);
 		Chunk &operator =(const Chunk &);
@@ -129,6 +139,41 @@ class Chunk
 #endif
 };
 
+// interning table for callstacks. Most chunks are recorded from a handful of
+// distinct callstacks, so rather than storing the addresses in every chunk header
+// each unique stack is stored once and chunks refer to it by a 32-bit ID. IDs
+// start at 1 and stay valid for the lifetime of the store.
+class CallstackStore
+{
+	public:
+		// returns the ID for this stack, adding it if it hasn't been seen before
+		uint32_t Intern(const uint64_t *addrs, size_t numLevels);
+
+		// returns false for unknown IDs
+		bool Get(uint32_t id, const uint64_t *&addrs, size_t &numLevels) const;
+
+		bool IsEmpty() const { return m_Offsets.empty(); }
+
+		// the section contents: a uint32_t count, then per stack a uint32_t number
+		// of levels followed by that many uint64_t addresses
+		void Write(vector<byte> &data);
+		bool Read(const vector<byte> &data);
+
+	private:
+		static uint64_t Hash(const uint64_t *addrs, size_t numLevels);
+
+		// chunks are serialised from any thread during capture
+		Threading::CriticalSection m_Lock;
+
+		// all stacks' addresses back to back, with the start of stack N at m_Offsets[N-1]
+		// and its end at the next stack's start
+		vector<uint64_t> m_Addrs;
+		vector<uint32_t> m_Offsets;
+
+		// hash of a stack to the IDs with that hash
+		std::multimap<uint64_t, uint32_t> m_Lookup;
+};
+
 // this class has a few functions. It can be used to serialise chunks - on writing it enforces
 // that we only ever write a single chunk, then pull out the data into a Chunk class and erase
 // the contents of the serialiser ready to serialise the next (see the RDCASSERT at the start
@@ -168,6 +213,7 @@ class Serialiser
 			eSectionFlag_None          = 0x0,
 			eSectionFlag_ASCIIStored   = 0x1,
 			eSectionFlag_LZ4Compressed = 0x2,
+			eSectionFlag_LZ4BlockSize  = 0x4, // uint32_t block size follows the uncompressed length, otherwise 64KB
 		};
 
 		enum SectionType
@@ -177,15 +223,19 @@ class Serialiser
 			eSectionType_ResolveDatabase,   // renderdoc/internal/resolvedb
 			eSectionType_FrameBookmarks,    // renderdoc/ui/bookmarks
 			eSectionType_Notes,             // renderdoc/ui/notes
+			eSectionType_Callstacks,        // renderdoc/internal/callstacks
 			eSectionType_Num,
 		};
 
 		// version number of overall file format or chunk organisation. If the contents/meaning/order of
 		// chunks have changed this does not need to be bumped, there are version numbers within each
 		// API that interprets the stream that can be bumped.
-		static const uint64_t SERIALISE_VERSION = 0x00000032;
+		static const uint64_t SERIALISE_VERSION = 0x00000033;
 		static const uint32_t MAGIC_HEADER;
 
+		// serialised buffers are aligned to this, relative to the start of the stream
+		static const uint64_t BufferAlignment;
+
 		//////////////////////////////////////////
 		// Init and error handling
 
@@ -196,6 +246,11 @@ class Serialiser
 		bool HasError() { return m_HasError; }
 		SerialiserError ErrorCode() { return m_ErrorCode; }
 
+		const string &GetFilename() const { return m_Filename; }
+
+		// version of the log being read, or SERIALISE_VERSION when writing
+		uint64_t GetSerialiseVersion() const { return m_SerVer; }
+
 		//////////////////////////////////////////
 		// Utility functions
 
@@ -292,6 +347,12 @@ class Serialiser
 			ReadBytes(m_LastChunkLen);
 		}
 
+		// assumes buffer head is sitting in a chunk (ie. immediately after a pushcontext)
+		size_t GetCurrentChunkLength() const
+		{
+			return m_LastChunkLen;
+		}
+
 		void InitCallstackResolver();
 		bool HasCallstacks() { return m_KnownSections[eSectionType_ResolveDatabase] != NULL; }
 
@@ -319,6 +380,11 @@ class Serialiser
 		// Write a chunk to disk
 		void Insert(Chunk *el);
 
+		// replace any inserted chunks that are owned elsewhere (e.g. by resource
+		// records) with temporary copies, so that this serialiser no longer depends
+		// on them staying alive until FlushToDisk() is called.
+		void DetachChunks();
+
 		// serialise a fixed-size array.
 		template<int Num, class T>
 		void SerialisePODArray(const char *name, T *el)
@@ -559,6 +625,41 @@ class Serialiser
 
 		void FlushToDisk();
 
+		// size of the file written by the last FlushToDisk()
+		uint64_t GetWrittenSize() const { return m_WrittenSize; }
+
+		// when set, large initial contents chunks are written to a content-addressed
+		// store in this directory and the capture only references them by hash. This
+		// lets consecutive captures share unchanged data. Empty (default) disables it.
+		void SetExternalChunkStore(const string &dir) { m_ExternalStore = dir; }
+
+		// bytes of chunk data the last FlushToDisk() referenced from the store
+		// rather than writing into the capture, and how much of that was new
+		uint64_t GetExternalReferencedSize() const { return m_ExternalReferenced; }
+		uint64_t GetExternalWrittenSize() const { return m_ExternalWritten; }
+
+		// directory name of the store. When reading, it's searched for next to the
+		// capture and then in each parent directory
+		static const char *ExternalStoreName;
+
+		// write a blob into the store in storeDir, identified by its 128-bit hash. If a
+		// complete blob with this hash already exists, nothing is written. Returns false
+		// on failure, otherwise sets written to indicate whether the blob is new.
+		static bool WriteExternalChunk(const string &storeDir, const uint64_t hash[2], const byte *data, uint32_t length, bool &written);
+
+		// rewrite the capture at src into dst with the compression settings in opts, without
+		// interpreting any chunks. Large initial contents are moved into storeDir if it's not
+		// empty. Chunks are streamed through so memory use is bounded by the largest chunk.
+		// dst is only replaced once the repack is complete (and verified, if requested), so
+		// src and dst can be the same file.
+		static bool Repack(const char *src, const char *dst, const string &storeDir, const RepackOptions &opts, RepackResult &result);
+
+		// size of the frame capture chunk stream once decompressed
+		uint64_t GetFrameCaptureSize() const
+		{
+			return m_KnownSections[eSectionType_FrameCapture] ? m_KnownSections[eSectionType_FrameCapture]->size : 0;
+		}
+
 		// set a function used when serialising a text representation
 		// of the chunks
 		void SetChunkNameLookup(ChunkLookup lookup)
@@ -602,6 +703,25 @@ class Serialiser
 
 		void ReadFromFile(uint64_t bufferOffs, size_t length);
 
+		// inserts an externally stored chunk into the read window at the current head
+		void SpliceExternalChunk(const uint64_t hash[2], uint32_t length);
+
+		// reads the next chunk index, handling any control chunks before it
+		uint16_t ReadChunkIndex();
+
+		// reads the whole of the next chunk, including its header, without interpreting it
+		bool ReadRawChunk(vector<byte> &data, uint32_t &chunkType, bool &aligned);
+
+		// writes a chunk into a frame capture stream, with any padding needed for alignment or
+		// as a reference into the external store. offs tracks the offset the reader will see
+		void WriteChunkToStream(SectionWriter &writer, const byte *data, uint32_t length, uint32_t chunkType, bool aligned, uint64_t &offs);
+
+		// does the work of Repack, writing straight into dst
+		static bool RepackFile(const char *src, const char *dst, const string &storeDir, const RepackOptions &opts, RepackResult &result);
+
+		// hash of every chunk left in the stream, and the number of chunks
+		bool HashChunkStream(uint64_t hash[2], uint64_t &numChunks);
+
 		template<class T> void WriteFrom(const T &f)
 		{
 			WriteBytes((byte *)&f, sizeof(T));
@@ -635,10 +755,6 @@ class Serialiser
 			return string((size_t)m_Indent*4, ' ');
 		}
 
-		//////////////////////////////////////////
-		
-		static const uint64_t BufferAlignment;
-		
 		//////////////////////////////////////////
 
 		uint64_t m_SerVer;
@@ -653,6 +769,11 @@ class Serialiser
 
 		Callstack::Stackwalk *m_pCallstack;
 		Callstack::StackResolver *m_pResolver;
+
+		// callstacks that chunk headers refer to by ID, loaded from the file. When writing
+		// IDs come from the process-wide store in GetCaptureCallstacks() instead
+		CallstackStore *m_pCallstacks;
+		static CallstackStore &GetCaptureCallstacks();
 		Threading::ThreadHandle m_ResolverThread;
 		volatile bool m_ResolverThreadKillSignal;
 
@@ -670,7 +791,7 @@ class Serialiser
 
 		struct Section
 		{
-			Section() : type(eSectionType_Unknown), flags(eSectionFlag_None), fileoffset(0), compressedReader(NULL) {}
+			Section() : type(eSectionType_Unknown), flags(eSectionFlag_None), fileoffset(0), size(0), compressedReader(NULL) {}
 			string name;
 			SectionType type;
 			SectionFlags flags;
@@ -687,6 +808,10 @@ class Serialiser
 		// this lists known sections, some may be NULL
 		Section *m_KnownSections[eSectionType_Num];
 
+		// get the full contents of a section other than the frame capture, reading it from
+		// the file if it wasn't small enough to be loaded up-front
+		bool GetSectionContents(Section *s, vector<byte> &data);
+
 		// where does our in-memory window point to in the data stream. ie. m_pBuffer[0] is
 		// m_ReadOffset into the frame capture section
 		uint64_t m_ReadOffset;
@@ -697,8 +822,16 @@ class Serialiser
 		// the file pointer to read from
 		FILE *m_ReadFileHandle;
 
+		// reads and decompresses the frame capture section on a background thread, so that
+		// it overlaps with processing the chunks. Owns m_ReadFileHandle while it exists
+		ReadAheadStream *m_ReadAhead;
+
 		// writing to file
 		vector<Chunk *> m_Chunks;
+		uint64_t m_WrittenSize;
+		string m_ExternalStore;
+		uint64_t m_ExternalReferenced;
+		uint64_t m_ExternalWritten;
 
 		// a database of strings read from the file, useful when serialised structures
 		// expect a char* to return and point to static memory
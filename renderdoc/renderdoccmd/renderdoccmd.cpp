@@ -23,6 +23,7 @@
  ******************************************************************************/
 
 #include <string>
+#include <vector>
 
 #include <replay/renderdoc_replay.h>
 #include <app/renderdoc_app.h>
@@ -121,6 +122,188 @@ void DisplayRendererPreview(ReplayRenderer *renderer)
 	DisplayRendererPreview(renderer, d);
 }
 
+int repack(int argc, char **argv)
+{
+	RepackOptions opts;
+	opts.compress = true;
+	opts.blockSize = 64*1024;
+	opts.numThreads = 4;
+	opts.memoryBudgetMB = 2048;
+	opts.verify = true;
+
+	const char *outDir = NULL;
+	const char *storeDir = NULL;
+
+	std::vector<string> infiles;
+
+	for(int i=2; i < argc; i++)
+	{
+		if(argequal(argv[i], "--store") && i+1 < argc)
+			storeDir = argv[++i];
+		else if(argequal(argv[i], "--block-size") && i+1 < argc)
+			opts.blockSize = (uint32_t)atoi(argv[++i])*1024;
+		else if(argequal(argv[i], "--threads") && i+1 < argc)
+			opts.numThreads = (uint32_t)atoi(argv[++i]);
+		else if(argequal(argv[i], "--memory") && i+1 < argc)
+			opts.memoryBudgetMB = (uint32_t)atoi(argv[++i]);
+		else if(argequal(argv[i], "--no-compress"))
+			opts.compress = false;
+		else if(argequal(argv[i], "--no-verify"))
+			opts.verify = false;
+		else if(outDir == NULL)
+			outDir = argv[i];
+		else
+			infiles.push_back(argv[i]);
+	}
+
+	if(outDir == NULL || infiles.empty())
+	{
+		fprintf(stderr, "Not enough parameters to --repack\n");
+		return 1;
+	}
+
+	std::vector<string> outfiles;
+	std::vector<const char *> inptrs, outptrs;
+
+	for(size_t i=0; i < infiles.size(); i++)
+	{
+		size_t sep = infiles[i].find_last_of("/\\");
+		string base = (sep == string::npos) ? infiles[i] : infiles[i].substr(sep+1);
+
+		outfiles.push_back(string(outDir) + "/" + base);
+	}
+
+	for(size_t i=0; i < infiles.size(); i++)
+	{
+		inptrs.push_back(infiles[i].c_str());
+		outptrs.push_back(outfiles[i].c_str());
+	}
+
+	std::vector<RepackResult> results(infiles.size());
+
+	bool32 success = RENDERDOC_RepackLogFiles(&inptrs[0], &outptrs[0], (uint32_t)infiles.size(), storeDir, &opts, &results[0]);
+
+	uint64_t totalIn = 0, totalOut = 0, totalShared = 0;
+
+	for(size_t i=0; i < infiles.size(); i++)
+	{
+		const RepackResult &r = results[i];
+
+		if(!r.success)
+		{
+			fprintf(stderr, "%s: FAILED%s\n", infiles[i].c_str(), opts.verify ? " (or did not verify)" : "");
+			continue;
+		}
+
+		fprintf(stderr, "%s: %.2f MB -> %.2f MB%s", infiles[i].c_str(),
+			double(r.originalSize)/(1024.0*1024.0), double(r.repackedSize)/(1024.0*1024.0), r.verified ? ", verified" : "");
+
+		if(r.storeReferenced > 0)
+			fprintf(stderr, ", %.2f MB in store (%.2f MB new)", double(r.storeReferenced)/(1024.0*1024.0), double(r.storeWritten)/(1024.0*1024.0));
+
+		fprintf(stderr, "\n");
+
+		totalIn += r.originalSize;
+		totalOut += r.repackedSize + r.storeWritten;
+		totalShared += r.storeReferenced - r.storeWritten;
+	}
+
+	fprintf(stderr, "Total: %.2f MB -> %.2f MB including new store data, %.2f MB deduplicated\n",
+		double(totalIn)/(1024.0*1024.0), double(totalOut)/(1024.0*1024.0), double(totalShared)/(1024.0*1024.0));
+
+	return success ? 0 : 1;
+}
+
+static void writejsonstr(FILE *f, const rdctype::str &s)
+{
+	fputc('"', f);
+	for(int32_t i=0; i < s.count && s.elems[i]; i++)
+	{
+		char c = s.elems[i];
+		if(c == '"' || c == '\\')
+			fputc('\\', f);
+		if((unsigned char)c < 0x20)
+			c = ' ';
+		fputc(c, f);
+	}
+	fputc('"', f);
+}
+
+static void writechunkstats(FILE *f, const char *name, const rdctype::array<LoadChunkStats> &stats)
+{
+	fprintf(f, "  \"%s\": [\n", name);
+	for(int32_t i=0; i < stats.count; i++)
+	{
+		const LoadChunkStats &s = stats[i];
+
+		fprintf(f, "    { \"name\": ");
+		writejsonstr(f, s.name);
+		fprintf(f, ", \"count\": %u, \"size\": %llu, \"loadMS\": %.3f, \"maxMS\": %.3f, \"applyMS\": %.3f }%s\n",
+				s.count, (unsigned long long)s.totalSize, s.loadMS, s.maxMS, s.applyMS, i+1 < stats.count ? "," : "");
+	}
+	fprintf(f, "  ],\n");
+}
+
+int profileload(int argc, char **argv)
+{
+	if(argc < 3)
+	{
+		fprintf(stderr, "Not enough parameters to --profile-load\n");
+		return 1;
+	}
+
+	float progress = 0.0f;
+	ReplayRenderer *renderer = NULL;
+	auto status = RENDERDOC_CreateReplayRenderer(argv[2], &progress, &renderer);
+
+	if(renderer == NULL || status != eReplayCreate_Success)
+	{
+		fprintf(stderr, "Couldn't load '%s'\n", argv[2]);
+		ReplayRenderer_Shutdown(renderer);
+		return 1;
+	}
+
+	LoadProfile profile;
+	ReplayRenderer_GetLoadProfile(renderer, &profile);
+
+	FILE *f = stdout;
+	if(argc >= 4)
+	{
+		f = fopen(argv[3], "w");
+		if(f == NULL)
+		{
+			fprintf(stderr, "Couldn't open '%s' for writing\n", argv[3]);
+			ReplayRenderer_Shutdown(renderer);
+			return 1;
+		}
+	}
+
+	fprintf(f, "{\n");
+	fprintf(f, "  \"totalMS\": %.3f,\n", profile.totalMS);
+	fprintf(f, "  \"chunkReadMS\": %.3f,\n", profile.chunkReadMS);
+	fprintf(f, "  \"initialContentsApplyMS\": %.3f,\n", profile.initialContentsApplyMS);
+	fprintf(f, "  \"frameReplayMS\": %.3f,\n", profile.frameReplayMS);
+
+	writechunkstats(f, "chunks", profile.chunks);
+	writechunkstats(f, "resources", profile.resources);
+
+	fprintf(f, "  \"events\": [\n");
+	for(int32_t i=0; i < profile.events.count; i++)
+	{
+		const LoadEventTiming &e = profile.events[i];
+		fprintf(f, "    { \"start\": %u, \"end\": %u, \"replayMS\": %.3f }%s\n",
+				e.startEventID, e.endEventID, e.replayMS, i+1 < profile.events.count ? "," : "");
+	}
+	fprintf(f, "  ]\n");
+	fprintf(f, "}\n");
+
+	if(f != stdout)
+		fclose(f);
+
+	ReplayRenderer_Shutdown(renderer);
+	return 0;
+}
+
 int renderdoccmd(int argc, char **argv)
 {
 	CaptureOptions opts;
@@ -275,6 +458,14 @@ int renderdoccmd(int argc, char **argv)
 				fprintf(stderr, "Not enough parameters to --remotereplay");
 			}
 		}
+		else if(argequal(argv[1], "--repack"))
+		{
+			return repack(argc, argv);
+		}
+		else if(argequal(argv[1], "--profile-load"))
+		{
+			return profileload(argc, argv);
+		}
 		// not documented/useful for manual use on the cmd line, used internally
 		else if(argequal(argv[1], "--cap32for64"))
 		{
@@ -316,6 +507,16 @@ int renderdoccmd(int argc, char **argv)
 	fprintf(stderr, "                                    replay logfiles from another machine.\n");
 	fprintf(stderr, "  -rr, --remotereplay HOST LOGFILE  Launch a replay of the logfile and display a preview\n");
 	fprintf(stderr, "                                    window. Use the remote host to replay all commands.\n");
+	fprintf(stderr, "       --repack OUTDIR LOGFILE...   Rewrite logfiles into OUTDIR without replaying them. Options:\n");
+	fprintf(stderr, "         --block-size KB            LZ4 block size, default 64.\n");
+	fprintf(stderr, "         --no-compress              Store sections uncompressed.\n");
+	fprintf(stderr, "         --store DIR                Move large initial contents into a store shared by all\n");
+	fprintf(stderr, "                                    logfiles under DIR. DIR must contain OUTDIR.\n");
+	fprintf(stderr, "         --threads N                Logfiles to repack at once, default 4.\n");
+	fprintf(stderr, "         --memory MB                Memory budget across all threads, default 2048.\n");
+	fprintf(stderr, "         --no-verify                Don't re-read and compare each repacked logfile.\n");
+	fprintf(stderr, "       --profile-load LOGFILE [OUT] Load the logfile and write a JSON breakdown of where the\n");
+	fprintf(stderr, "                                    load time went, to OUT or stdout.\n");
 
 	return 1;
 }
@@ -619,6 +619,12 @@ int WINAPI wWinMain(_In_ HINSTANCE hInst,
 		cmdopts.RefAllResources = false;
 		cmdopts.SaveAllInitials = true;
 		cmdopts.VerifyMapWrites = true;
+		cmdopts.PeriodicCaptureFrames = 0;
+		cmdopts.PeriodicCaptureMS = 0;
+		cmdopts.MaxPendingCaptures = 2;
+		cmdopts.MinFreeDiskMB = 0;
+		cmdopts.SharedInitialContents = false;
+		memset(cmdopts.PeriodicCaptureFilename, 0, sizeof(cmdopts.PeriodicCaptureFilename));
 		//readCapOpts(argv[4], &cmdopts);
 		/* Added by Stephan Richter | END */
 
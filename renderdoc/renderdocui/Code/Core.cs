@@ -74,6 +74,7 @@ public class Core
 
         private FetchFrameInfo[] m_FrameInfo = null;
         private FetchDrawcall[][] m_DrawCalls = null;
+        private FetchRenderPass[][] m_RenderPasses = null;
         private FetchBuffer[] m_Buffers = null;
         private FetchTexture[] m_Textures = null;
         /* Added by Stephan Richter | BEGIN */
@@ -493,6 +494,8 @@ public void LoadLogfile(int proxyRenderer, string replayHost, string logFile, bo
             // fetch initial data like drawcalls, textures and buffers
             m_Renderer.Invoke((ReplayRenderer r) =>
             {
+                r.SetReplayCheckpoints((UInt32)m_Config.ReplayCheckpointInterval, (UInt32)m_Config.ReplayCheckpointMemoryMB);
+
                 m_FrameInfo = r.GetFrameInfo();
 
                 m_APIProperties = r.GetAPIProperties();
@@ -506,6 +509,11 @@ public void LoadLogfile(int proxyRenderer, string replayHost, string logFile, bo
                 for (int i = 0; i < m_FrameInfo.Length; i++)
                     m_DrawCalls[i] = FakeProfileMarkers(i, r.GetDrawcalls((UInt32)i));
 
+                m_RenderPasses = new FetchRenderPass[m_FrameInfo.Length][];
+
+                for (int i = 0; i < m_FrameInfo.Length; i++)
+                    m_RenderPasses[i] = r.GetRenderPasses((UInt32)i);
+
                 postloadProgress = 0.7f;
 
                 /* Added by Stephan Richter | BEGIN */
@@ -618,6 +626,7 @@ public void CloseLogfile()
             m_APIProperties = null;
             m_FrameInfo = null;
             m_DrawCalls = null;
+            m_RenderPasses = null;
             m_Buffers = null;
             m_Textures = null;
 
@@ -670,6 +679,46 @@ public FetchDrawcall[] GetDrawcalls(UInt32 frameIdx)
             return m_DrawCalls[frameIdx];
         }
 
+        public UInt32 GetDrawcallTableSize(UInt32 frameIdx)
+        {
+            UInt32 ret = 0;
+
+            m_Renderer.Invoke((ReplayRenderer r) => { ret = r.GetDrawcallTableSize(frameIdx); });
+
+            return ret;
+        }
+
+        // a page of the flattened drawcall list, in pre-order. Cheaper than GetDrawcalls for
+        // scripts that only need to scan part of a large frame.
+        public FetchFlatDrawcall[] GetDrawcallTable(UInt32 frameIdx, UInt32 first, UInt32 count)
+        {
+            FetchFlatDrawcall[] ret = null;
+
+            m_Renderer.Invoke((ReplayRenderer r) => { ret = r.GetDrawcallTable(frameIdx, first, count); });
+
+            return ret;
+        }
+
+        public FetchRenderPass[] GetRenderPasses(UInt32 frameIdx)
+        {
+            if (m_RenderPasses == null) return null;
+            return m_RenderPasses[frameIdx];
+        }
+
+        // passes with exactly numOutputs colour targets, and a depth target or not
+        public FetchRenderPass[] FindRenderPasses(UInt32 frameIdx, UInt32 numOutputs, bool hasDepth)
+        {
+            if (m_RenderPasses == null) return null;
+
+            var ret = new List<FetchRenderPass>();
+
+            foreach (var p in m_RenderPasses[frameIdx])
+                if (p.numOutputs == numOutputs && (p.depthOut != ResourceId.Null) == hasDepth)
+                    ret.Add(p);
+
+            return ret.ToArray();
+        }
+
         private FetchDrawcall GetDrawcall(FetchDrawcall[] draws, UInt32 eventID)
         {
             foreach (var d in draws)
@@ -981,15 +1030,16 @@ public void HashTextures(string filename)
         }
 
         public void HashBuffers(string filename)
-        {            
-            foreach (var buf in m_Buffers)
+        {
+            // hash all buffers in one batch so the readbacks can overlap
+            ResourceId[] ids = new ResourceId[m_Buffers.Length];
+            for (int i = 0; i < m_Buffers.Length; i++)
+                ids[i] = m_Buffers[i].ID;
+
+            Renderer.Invoke((ReplayRenderer r) =>
             {
-                bool ret = false;
-                Renderer.Invoke((ReplayRenderer r) =>
-                {
-                    ret = r.HashBuffer(buf.ID, filename);
-                });
-            }            
+                r.HashBuffers(ids, filename);
+            });
         }
 
         public void HashShaders(string filename)
@@ -1117,12 +1167,15 @@ public void SetIDRenderingEvents(UInt32 frameID, UInt32 startEventID, UInt32 end
 
         public void SetIDRendering(bool active)
         {
-            if (m_ShaderID == ResourceId.Null)
+            bool isGL = m_APIProperties != null && m_APIProperties.pipelineType == APIPipelineStateType.OpenGL;
+
+            // OpenGL replay uses its own built-in ID fragment program
+            if (m_ShaderID == ResourceId.Null && !isGL)
             {
                 m_ShaderID = CreateIDShader();
             }
 
-            if (m_ShaderID != ResourceId.Null)
+            if (m_ShaderID != ResourceId.Null || isGL)
             {
                 ResourceId shaderID = m_ShaderID;
                 m_Renderer.Invoke((ReplayRenderer r) => { r.SetContextFilter(ResourceId.Null, 0, 0); });
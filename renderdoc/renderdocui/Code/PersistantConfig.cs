@@ -63,6 +63,9 @@ public class PersistantConfig
 
         public int LocalProxy = 0;
 
+        public int ReplayCheckpointInterval = 1000;
+        public int ReplayCheckpointMemoryMB = 256;
+
         [XmlIgnore] // not directly serializable
         public Dictionary<string, string> ReplayHosts = new Dictionary<string, string>();
         public List<SerializableKeyValuePair<string, string>> ReplayHostKeyValues = new List<SerializableKeyValuePair<string, string>>();
@@ -79,5 +79,13 @@ public class CaptureOptions
         public bool SaveAllInitials;
         public bool CaptureAllCmdLists;
         public bool DebugOutputMute;
+        public UInt32 PeriodicCaptureFrames;
+        public UInt32 PeriodicCaptureMS;
+        public UInt32 MaxPendingCaptures;
+        public UInt32 MinFreeDiskMB;
+        public bool SharedInitialContents;
+        public bool FramePointerCallstacks;
+        [MarshalAs(UnmanagedType.ByValTStr, SizeConst = 256)]
+        public string PeriodicCaptureFilename;
     };
 };
@@ -273,7 +273,7 @@ private static void AddFieldSize(FieldInfo field, ref long size)
 
         // return the size of the C++ equivalent of this type (so that we can allocate enough)
         // space to pass a pointer for example.
-        private static int SizeOf(Type structureType)
+        public static int SizeOf(Type structureType)
         {
             if (structureType.IsPrimitive ||
                 (structureType.IsArray && structureType.GetElementType().IsPrimitive))
@@ -36,6 +36,13 @@ public enum VarType
         Double,
     };
 
+    public enum ShaderDebugRegType
+    {
+        Temp = 0,
+        Output,
+        IndexableTemp,
+    };
+
     public enum FormatComponentType
     {
         None = 0,
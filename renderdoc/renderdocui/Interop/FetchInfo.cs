@@ -378,6 +378,72 @@ public class FetchDrawcall
         public FetchDrawcall[] children;
     };
 
+    [StructLayout(LayoutKind.Sequential)]
+    public class FetchFlatDrawcall
+    {
+        public UInt32 eventID, drawcallID;
+
+        public UInt32 nameOffset;
+
+        public DrawcallFlags flags;
+
+        public UInt32 numIndices;
+        public UInt32 numInstances;
+        public UInt32 indexOffset;
+        public UInt32 vertexOffset;
+        public UInt32 instanceOffset;
+
+        [CustomMarshalAs(CustomUnmanagedType.FixedArray, FixedLength = 3)]
+        public UInt32[] dispatchDimension;
+        [CustomMarshalAs(CustomUnmanagedType.FixedArray, FixedLength = 3)]
+        public UInt32[] dispatchThreadsDimension;
+
+        public UInt32 indexByteWidth;
+        public PrimitiveTopology topology;
+
+        public ResourceId copySource;
+        public ResourceId copyDestination;
+
+        public ResourceId context;
+
+        public Int32 parent;
+        public Int32 nextSibling;
+
+        public UInt32 numChildren;
+        public UInt32 numDescendants;
+
+        public UInt32 previous;
+        public UInt32 next;
+
+        [CustomMarshalAs(CustomUnmanagedType.FixedArray, FixedLength = 8)]
+        public ResourceId[] outputs;
+        public ResourceId depthOut;
+
+        // looked up from nameOffset in the table's string pool
+        [CustomMarshalAs(CustomUnmanagedType.Skip)]
+        public string name;
+    };
+
+    [StructLayout(LayoutKind.Sequential)]
+    public class FetchRenderPass
+    {
+        public UInt32 passID;
+
+        public UInt32 firstEventID;
+        public UInt32 lastEventID;
+        public UInt32 numDraws;
+
+        public UInt32 numOutputs;
+        [CustomMarshalAs(CustomUnmanagedType.FixedArray, FixedLength = 8)]
+        public ResourceId[] outputs;
+        public ResourceId depthOut;
+
+        [CustomMarshalAs(CustomUnmanagedType.FixedArray, FixedLength = 8)]
+        public ResourceFormat[] outputFormats;
+        [CustomMarshalAs(CustomUnmanagedType.CustomClass)]
+        public ResourceFormat depthFormat;
+    };
+
     [StructLayout(LayoutKind.Sequential)]
     public struct MeshFormat
     {
@@ -210,6 +210,8 @@ public class ReplayRenderer
         [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
         private static extern bool ReplayRenderer_SetFrameEvent(IntPtr real, UInt32 frameID, UInt32 eventID);
         [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern bool ReplayRenderer_SetReplayCheckpoints(IntPtr real, UInt32 eventInterval, UInt32 memoryBudgetMB);
+        [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
         
         /* Added by Stephan Richter | BEGIN */
         private static extern bool ReplayRenderer_SetIDRenderingEvents(IntPtr real, UInt32 frameID, UInt32 startEventID, UInt32 endEventID);
@@ -241,6 +243,12 @@ public class ReplayRenderer
         [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
         private static extern bool ReplayRenderer_GetDrawcalls(IntPtr real, UInt32 frameID, IntPtr outdraws);
         [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern bool ReplayRenderer_GetDrawcallTable(IntPtr real, UInt32 frameID, ref IntPtr draws, ref UInt32 count, ref IntPtr strings);
+        [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern bool ReplayRenderer_GetRenderPasses(IntPtr real, UInt32 frameID, IntPtr outpasses);
+        [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern bool ReplayRenderer_FindRenderPasses(IntPtr real, UInt32 frameID, UInt32 numOutputs, bool hasDepth, IntPtr outpasses);
+        [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
         private static extern bool ReplayRenderer_FetchCounters(IntPtr real, UInt32 frameID, UInt32 minEventID, UInt32 maxEventID, IntPtr counters, UInt32 numCounters, IntPtr outresults);
         [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
         private static extern bool ReplayRenderer_EnumerateCounters(IntPtr real, IntPtr outcounters);
@@ -271,6 +279,10 @@ public class ReplayRenderer
         private static extern bool ReplayRenderer_DebugPixel(IntPtr real, UInt32 x, UInt32 y, UInt32 sample, UInt32 primitive, IntPtr outtrace);
         [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
         private static extern bool ReplayRenderer_DebugThread(IntPtr real, UInt32[] groupid, UInt32[] threadid, IntPtr outtrace);
+        [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern bool ReplayRenderer_GetDebugState(IntPtr real, UInt32 traceID, UInt32 step, IntPtr outstate);
+        [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern bool ReplayRenderer_FreeDebugTrace(IntPtr real, UInt32 traceID);
 
         [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
         private static extern bool ReplayRenderer_GetUsage(IntPtr real, ResourceId id, IntPtr outusage);
@@ -289,6 +301,9 @@ public class ReplayRenderer
         [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
         private static extern bool ReplayRenderer_HashBufferData(IntPtr real, ResourceId buff, IntPtr path);
         
+        [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
+        private static extern bool ReplayRenderer_HashBuffers(IntPtr real, ResourceId[] buffs, UInt32 numBuffs, IntPtr path);
+        
         [DllImport("renderdoc.dll", CharSet = CharSet.Unicode, CallingConvention = CallingConvention.Cdecl)]
         private static extern bool ReplayRenderer_HashShader(IntPtr real, ResourceId buff, IntPtr path);
         /* Added by Stephan Richter | END */
@@ -355,6 +370,8 @@ public bool SetContextFilter(ResourceId id, UInt32 firstDefEv, UInt32 lastDefEv)
         { return ReplayRenderer_SetContextFilter(m_Real, id, firstDefEv, lastDefEv); }
         public bool SetFrameEvent(UInt32 frameID, UInt32 eventID)
         { return ReplayRenderer_SetFrameEvent(m_Real, frameID, eventID); }
+        public bool SetReplayCheckpoints(UInt32 eventInterval, UInt32 memoryBudgetMB)
+        { return ReplayRenderer_SetReplayCheckpoints(m_Real, eventInterval, memoryBudgetMB); }
 
         /* Added by Stephan Richter | BEGIN */
         public void SetIDRenderingEvents(UInt32 frameID, UInt32 startEvent, UInt32 endEvent)
@@ -584,6 +601,81 @@ public FetchDrawcall[] GetDrawcalls(UInt32 frameID)
             return ret;
         }
 
+        public UInt32 GetDrawcallTableSize(UInt32 frameID)
+        {
+            IntPtr draws = IntPtr.Zero;
+            IntPtr strings = IntPtr.Zero;
+            UInt32 count = 0;
+
+            if (!ReplayRenderer_GetDrawcallTable(m_Real, frameID, ref draws, ref count, ref strings))
+                return 0;
+
+            return count;
+        }
+
+        // reads entries [first, first+count) straight out of the renderer's table, nothing
+        // else is copied or marshalled.
+        public FetchFlatDrawcall[] GetDrawcallTable(UInt32 frameID, UInt32 first, UInt32 count)
+        {
+            IntPtr draws = IntPtr.Zero;
+            IntPtr strings = IntPtr.Zero;
+            UInt32 total = 0;
+
+            if (!ReplayRenderer_GetDrawcallTable(m_Real, frameID, ref draws, ref total, ref strings))
+                return null;
+
+            if (first >= total)
+                return new FetchFlatDrawcall[0];
+
+            count = Math.Min(count, total - first);
+
+            var ret = new FetchFlatDrawcall[count];
+
+            int sizeInBytes = CustomMarshal.SizeOf(typeof(FetchFlatDrawcall));
+
+            for (int i = 0; i < ret.Length; i++)
+            {
+                IntPtr p = new IntPtr(draws.ToInt64() + (first + i) * sizeInBytes);
+
+                ret[i] = (FetchFlatDrawcall)CustomMarshal.PtrToStructure(p, typeof(FetchFlatDrawcall), false);
+                ret[i].name = CustomMarshal.PtrToStringUTF8(new IntPtr(strings.ToInt64() + ret[i].nameOffset));
+            }
+
+            return ret;
+        }
+
+        public FetchRenderPass[] GetRenderPasses(UInt32 frameID)
+        {
+            IntPtr mem = CustomMarshal.Alloc(typeof(templated_array));
+
+            bool success = ReplayRenderer_GetRenderPasses(m_Real, frameID, mem);
+
+            FetchRenderPass[] ret = null;
+
+            if (success)
+                ret = (FetchRenderPass[])CustomMarshal.GetTemplatedArray(mem, typeof(FetchRenderPass), true);
+
+            CustomMarshal.Free(mem);
+
+            return ret;
+        }
+
+        public FetchRenderPass[] FindRenderPasses(UInt32 frameID, UInt32 numOutputs, bool hasDepth)
+        {
+            IntPtr mem = CustomMarshal.Alloc(typeof(templated_array));
+
+            bool success = ReplayRenderer_FindRenderPasses(m_Real, frameID, numOutputs, hasDepth, mem);
+
+            FetchRenderPass[] ret = null;
+
+            if (success)
+                ret = (FetchRenderPass[])CustomMarshal.GetTemplatedArray(mem, typeof(FetchRenderPass), true);
+
+            CustomMarshal.Free(mem);
+
+            return ret;
+        }
+
         public FetchTexture[] GetTextures()
         {
             IntPtr mem = CustomMarshal.Alloc(typeof(templated_array));
@@ -744,6 +836,27 @@ public ShaderDebugTrace DebugThread(UInt32[] groupid, UInt32[] threadid)
             return ret;
         }
 
+        public ShaderDebugState GetDebugState(UInt32 traceID, UInt32 step)
+        {
+            IntPtr mem = CustomMarshal.Alloc(typeof(ShaderDebugState));
+
+            bool success = ReplayRenderer_GetDebugState(m_Real, traceID, step, mem);
+
+            ShaderDebugState ret = null;
+
+            if (success)
+                ret = (ShaderDebugState)CustomMarshal.PtrToStructure(mem, typeof(ShaderDebugState), true);
+
+            CustomMarshal.Free(mem);
+
+            return ret;
+        }
+
+        public bool FreeDebugTrace(UInt32 traceID)
+        {
+            return ReplayRenderer_FreeDebugTrace(m_Real, traceID);
+        }
+
         public EventUsage[] GetUsage(ResourceId id)
         {
             IntPtr mem = CustomMarshal.Alloc(typeof(templated_array));
@@ -807,6 +920,14 @@ public bool HashBuffer(ResourceId buff, string path)
             return success;
         }
 
+        public bool HashBuffers(ResourceId[] buffs, string path)
+        {
+            IntPtr path_mem = CustomMarshal.MakeUTF8String(path);
+            bool success = ReplayRenderer_HashBuffers(m_Real, buffs, (UInt32)buffs.Length, path_mem);
+            CustomMarshal.Free(path_mem);
+            return success;
+        }
+
         public bool HashShader(ResourceId buff, string path)
         {
             IntPtr path_mem = CustomMarshal.MakeUTF8String(path);
@@ -196,8 +196,54 @@ public struct CBuffer
         [CustomMarshalAs(CustomUnmanagedType.TemplatedArray)]
         public CBuffer[] cbuffers;
 
+        public UInt32 keyframeInterval;
         [CustomMarshalAs(CustomUnmanagedType.TemplatedArray)]
-        public ShaderDebugState[] states;
+        public ShaderDebugState[] keyframes;
+        [CustomMarshalAs(CustomUnmanagedType.TemplatedArray)]
+        public ShaderDebugStep[] steps;
+        [CustomMarshalAs(CustomUnmanagedType.TemplatedArray)]
+        public ShaderDebugChange[] changes;
+
+        // the replay renderer only returns the first keyframe and the steps,
+        // other states are fetched with ReplayRenderer.GetDebugState
+        public UInt32 traceID;
+
+        public int NumStates
+        {
+            get
+            {
+                if (keyframes == null || keyframes.Length == 0)
+                    return 0;
+
+                return steps.Length + 1;
+            }
+        }
+
+        public UInt32 GetNextInstruction(int step)
+        {
+            if (step == 0)
+                return keyframes[0].nextInstruction;
+
+            return steps[step - 1].nextInstruction;
+        }
+    };
+
+    [StructLayout(LayoutKind.Sequential)]
+    public class ShaderDebugChange
+    {
+        public ShaderDebugRegType type;
+        public UInt32 index;
+        public UInt32 element;
+        [CustomMarshalAs(CustomUnmanagedType.FixedArray, FixedLength = 4, FixedType = CustomFixedType.UInt32)]
+        public UInt32[] value;
+    };
+
+    [StructLayout(LayoutKind.Sequential)]
+    public class ShaderDebugStep
+    {
+        public UInt32 nextInstruction;
+        public UInt32 firstChange;
+        public UInt32 numChanges;
     };
     
     [StructLayout(LayoutKind.Sequential)]
@@ -125,9 +125,9 @@ public int CurrentStep
             }
             set
             {
-                if (m_Trace != null && m_Trace.states != null && m_Trace.states.Length > 0)
+                if (m_Trace != null && m_Trace.NumStates > 0)
                 {
-                    CurrentStep_ = Helpers.Clamp(value, 0, m_Trace.states.Length - 1);
+                    CurrentStep_ = Helpers.Clamp(value, 0, m_Trace.NumStates - 1);
                 }
                 else
                 {
@@ -138,6 +138,33 @@ public int CurrentStep
             }
         }
 
+        // the replay renderer holds the full trace and rebuilds the state for a
+        // step on request. The last state fetched is kept for hovering registers.
+        private ShaderDebugState m_CurrentState = null;
+        private int m_CurrentStateStep = -1;
+
+        private ShaderDebugState GetDebugState(int step)
+        {
+            if (m_CurrentState != null && m_CurrentStateStep == step)
+                return m_CurrentState;
+
+            ShaderDebugState state = null;
+            UInt32 traceID = m_Trace.traceID;
+
+            m_Core.Renderer.Invoke((ReplayRenderer r) =>
+            {
+                state = r.GetDebugState(traceID, (UInt32)step);
+            });
+
+            if (state == null)
+                return m_Trace.keyframes[0];
+
+            m_CurrentState = state;
+            m_CurrentStateStep = step;
+
+            return state;
+        }
+
         ScintillaNET.Scintilla CurrentScintilla
         {
             get
@@ -1041,7 +1068,7 @@ void scintilla1_Click(object sender, EventArgs e)
 
         void scintilla1_MouseMove(object sender, MouseEventArgs e)
         {
-            if (m_Trace == null || m_Trace.states.Length == 0) return;
+            if (m_Trace == null || m_Trace.NumStates == 0) return;
 
             ScintillaNET.Scintilla scintilla1 = sender as ScintillaNET.Scintilla;
 
@@ -1099,7 +1126,7 @@ private void regsList_Leave(object sender, EventArgs e)
 
         private void regsList_MouseMove(object sender, MouseEventArgs e)
         {
-            if (m_Trace == null || m_Trace.states.Length == 0) return;
+            if (m_Trace == null || m_Trace.NumStates == 0) return;
 
             // ignore mousemove events that are identical to the last we saw
             if (prevSender == sender && prevPoint.X == e.X && prevPoint.Y == e.Y)
@@ -1150,7 +1177,7 @@ private void regsList_MouseMove(object sender, MouseEventArgs e)
 
         private void hoverTimer_Tick(object sender, EventArgs e)
         {
-            if (m_Trace == null || m_Trace.states.Length == 0) return;
+            if (m_Trace == null || m_Trace.NumStates == 0) return;
 
             hoverTimer.Enabled = false;
 
@@ -1168,7 +1195,7 @@ private void hoverTimer_Tick(object sender, EventArgs e)
                 hoverPoint = new Point(m_HoverScintilla.ClientRectangle.Left + pt.X + 10, m_HoverScintilla.ClientRectangle.Top + pt.Y + 10);
                 hoverWin = m_HoverScintilla;
 
-                var state = m_Trace.states[CurrentStep];
+                var state = GetDebugState(CurrentStep);
 
                 string regtype = m_HoverReg.Substring(0, 1);
                 string regidx = m_HoverReg.Substring(1);
@@ -1286,7 +1313,7 @@ public string StringRep(ShaderVariable var, bool useType)
 
         public void UpdateDebugging()
         {
-            if (m_Trace == null || m_Trace.states == null || m_Trace.states.Length == 0)
+            if (m_Trace == null || m_Trace.NumStates == 0)
             {
                 //curInstruction.Text = "0";
 
@@ -1299,14 +1326,14 @@ public void UpdateDebugging()
                 return;
             }
 
-            var state = m_Trace.states[CurrentStep];
+            var state = GetDebugState(CurrentStep);
 
             //curInstruction.Text = CurrentStep.ToString();
 
             UInt32 nextInst = state.nextInstruction;
             bool done = false;
 
-            if (CurrentStep == m_Trace.states.Length - 1)
+            if (CurrentStep == m_Trace.NumStates - 1)
             {
                 nextInst--;
                 done = true;
@@ -1657,7 +1684,7 @@ public void OnEventSelected(UInt32 frameID, UInt32 eventID)
 
         void m_DisassemblyView_KeyDown(object sender, KeyEventArgs e)
         {
-            if (m_Trace == null || m_Trace.states == null)
+            if (m_Trace == null || m_Trace.NumStates == 0)
                 return;
 
             DebugKeys_KeyDown(sender, e);
@@ -1665,7 +1692,7 @@ void m_DisassemblyView_KeyDown(object sender, KeyEventArgs e)
 
         void DebugKeys_KeyDown(object sender, KeyEventArgs e)
         {
-            if (m_Trace == null || m_Trace.states == null)
+            if (m_Trace == null || m_Trace.NumStates == 0)
                 return;
 
             if (e.KeyCode == Keys.F10)
@@ -1698,7 +1725,7 @@ void DebugKeys_KeyDown(object sender, KeyEventArgs e)
 
         private void runBack_Click(object sender, EventArgs e)
         {
-            if (m_Trace == null || m_Trace.states == null)
+            if (m_Trace == null || m_Trace.NumStates == 0)
                 return;
 
             RunBack();
@@ -1706,7 +1733,7 @@ private void runBack_Click(object sender, EventArgs e)
 
         private void run_Click(object sender, EventArgs e)
         {
-            if (m_Trace == null || m_Trace.states == null)
+            if (m_Trace == null || m_Trace.NumStates == 0)
                 return;
 
             Run();
@@ -1714,7 +1741,7 @@ private void run_Click(object sender, EventArgs e)
 
         private void stepBack_Click(object sender, EventArgs e)
         {
-            if (m_Trace == null || m_Trace.states == null)
+            if (m_Trace == null || m_Trace.NumStates == 0)
                 return;
 
             StepBack();
@@ -1722,7 +1749,7 @@ private void stepBack_Click(object sender, EventArgs e)
 
         private void stepNext_Click(object sender, EventArgs e)
         {
-            if (m_Trace == null || m_Trace.states == null)
+            if (m_Trace == null || m_Trace.NumStates == 0)
                 return;
 
             StepNext();
@@ -1730,7 +1757,7 @@ private void stepNext_Click(object sender, EventArgs e)
 
         private void runToCursor_Click(object sender, EventArgs e)
         {
-            if (m_Trace == null || m_Trace.states == null)
+            if (m_Trace == null || m_Trace.NumStates == 0)
                 return;
 
             RunToCursor();
@@ -1738,7 +1765,7 @@ private void runToCursor_Click(object sender, EventArgs e)
 
         private bool StepBack()
         {
-            if (m_Trace == null || m_Trace.states == null)
+            if (m_Trace == null || m_Trace.NumStates == 0)
                 return false;
 
             if (CurrentStep == 0)
@@ -1751,9 +1778,9 @@ private bool StepBack()
 
         private bool StepNext()
         {
-            if (m_Trace == null || m_Trace.states == null) return false;
+            if (m_Trace == null || m_Trace.NumStates == 0) return false;
 
-            if (CurrentStep + 1 >= m_Trace.states.Length)
+            if (CurrentStep + 1 >= m_Trace.NumStates)
                 return false;
 
             CurrentStep++;
@@ -1763,7 +1790,7 @@ private bool StepNext()
 
         private void RunTo(int runToInstruction, bool forward)
         {
-            if (m_Trace == null || m_Trace.states == null)
+            if (m_Trace == null || m_Trace.NumStates == 0)
                 return;
 
             int step = CurrentStep;
@@ -1772,17 +1799,17 @@ private void RunTo(int runToInstruction, bool forward)
 
             bool firstStep = true;
 
-            while (step < m_Trace.states.Length)
+            while (step < m_Trace.NumStates)
             {
-                if (m_Trace.states[step].nextInstruction == runToInstruction)
+                if (m_Trace.GetNextInstruction(step) == runToInstruction)
                     break;
 
-                if (!firstStep && m_Breakpoints.Contains((int)m_Trace.states[step].nextInstruction))
+                if (!firstStep && m_Breakpoints.Contains((int)m_Trace.GetNextInstruction(step)))
                     break;
 
                 firstStep = false;
 
-                if (step + inc < 0 || step + inc >= m_Trace.states.Length)
+                if (step + inc < 0 || step + inc >= m_Trace.NumStates)
                     break;
 
                 step += inc;
@@ -2127,6 +2154,12 @@ private void watchRegs_KeyUp(object sender, KeyEventArgs e)
 
         private void ShaderViewer_FormClosed(object sender, FormClosedEventArgs e)
         {
+            if (m_Trace != null && m_Trace.traceID != 0 && m_Core.LogLoaded)
+            {
+                UInt32 traceID = m_Trace.traceID;
+                m_Core.Renderer.BeginInvoke((ReplayRenderer r) => { r.FreeDebugTrace(traceID); });
+            }
+
             m_Core.RemoveLogViewer(this);
         }
 
@@ -11,7 +11,7 @@ config['file_prefix'] = lambda logFilename : basename(logFilename)[:-4] + '_'
 # By 'G-buffer' pass we mean the pass that renders all objects of interest. Hence, this pass will reference
 # all meshes, shaders, and textures.
 # We identify the G-buffer pass by its render targets (number of color targets, whether there is depth)
-# If multiple passes fulfil the specified conditions, we only process the first one. 
+# If no pass or more than one pass fulfils the specified conditions, extraction stops. 
 # You need to change this behaviour for some games.
 config['gbufferpass_colortargets'] = None # number of color targets that identify the G-buffer pass, most probably 4 as games want to use all available render targets
 config['gbufferpass_hasdepth']     = None # whether G-buffer pass has a depth target
@@ -49,40 +49,30 @@ print 'File prefix is %s' % filePrefix
 drawcalls = renderdoc.GetDrawcalls(frameId)
 print 'Found %d drawcalls.' % len(drawcalls)
 
-def containsTargets(drawcallName, numColorTargets, hasDepthTarget):
-	""" Determines if drawcall has multiple render targets by checking its name. 
-	    The name is defined by renderdoc and contains information about render targets."""	
-	if hasDepthTarget:
-		return drawcallName.find('(%d Targets + Depth)' % numColorTargets) >= 0		
-	else:		
-		return drawcallName.find('(%d Targets)' % numColorTargets) >= 0		
-	pass
+def findPasses(numColorTargets, hasDepthTarget):
+	""" Looks up passes by their render targets in the pass index renderdoc builds when loading the log.
+	    Does not need to replay the frame."""
+	return renderdoc.FindRenderPasses(frameId, numColorTargets, hasDepthTarget)
 
 def findGbufferPass(numColorTargets, hasDepthTarget):
 	""" Identifies the G-buffer pass. """
-	gbufferEnd = 0
-	gbufferIds = [i for i,call in enumerate(drawcalls) if containsTargets(call.name, numColorTargets, hasDepthTarget)]
-	if len(gbufferIds) == 1:
-		gbufferId    = gbufferIds[0]
-		gbufferCalls = drawcalls[gbufferId].children
-		print 'G-buffer pass has %d drawcalls.' % len(gbufferCalls)
-		gbufferEnd   = drawcalls[gbufferId].children[-1].eventID # last drawcall of the G-buffer pass
-		pass
-	
-	assert(gbufferEnd > 0, 'Did not find any drawcall with the specified G-buffer settings.')
-	return gbufferId, gbufferEnd
+	passes = findPasses(numColorTargets, hasDepthTarget)
+	assert len(passes) == 1, 'Expected exactly one pass with the specified G-buffer settings, found %d.' % len(passes)
+	gbufferPass = passes[0]
+	print 'G-buffer pass has %d drawcalls.' % gbufferPass.numDraws
+	return gbufferPass
 	
 def findFinalPass(numColorTargets, hasDepthTarget, drawCallName):
 	""" Returns the EventID of the pass that draws the final image (before HUD). """
 
 	# Find last drawcall before HUD
-	potentialHudIds = [i for i,call in enumerate(drawcalls) if containsTargets(call.name, numColorTargets, hasDepthTarget)]
-	print 'Found %d potential HUD passes.' % len(potentialHudIds)
+	potentialHudPasses = findPasses(numColorTargets, hasDepthTarget)
+	print 'Found %d potential HUD passes.' % len(potentialHudPasses)
 
-	colorpassIds = [i for i,call in enumerate(drawcalls) if containsTargets(call.name, 1, False)]
+	colorPasses = findPasses(1, False)
 
-	a = colorpassIds[:]
-	a.extend(potentialHudIds[:-3])
+	a = [p.passID for p in colorPasses]
+	a.extend([p.passID for p in potentialHudPasses[:-3]])
 	assert(len(a) > 0, 'Found not enough potential final passes.')
 	firstPotentialFinalId = max(a)
 
@@ -96,16 +86,18 @@ def getColorBuffers(frameId, eventId):
 	outputTargets = commonState.GetOutputTargets()
 	return [t for t in outputTargets if str(t) <> '0']
 
-def initIDRendering(frameId, gbufferId, gbufferEnd):
+def initIDRendering(frameId, gbufferPass):
 	""" Initializes ID rendering. """
-	gbufferStart = drawcalls[gbufferId].children[0].eventID
+	gbufferStart = gbufferPass.firstEventID
+	gbufferEnd   = gbufferPass.lastEventID
 	renderdoc.SetEventID(None, frameId, gbufferStart)
 	renderdoc.SetIDRenderingEvents(frameId, gbufferStart, gbufferEnd)
 	renderdoc.SetIDRendering(True)
 	pass
 
 	
-gbufferId, gbufferEnd = findGbufferPass(config['gbufferpass_colortargets'], config['gbufferpass_hasdepth'])
+gbufferPass = findGbufferPass(config['gbufferpass_colortargets'], config['gbufferpass_hasdepth'])
+gbufferEnd  = gbufferPass.lastEventID
 print 'G-buffer pass is done at EID %d.' % gbufferEnd
 bufferIds = getColorBuffers(frameId, gbufferEnd)
 
@@ -126,7 +118,7 @@ renderdoc.SaveTexture(bufferIds[0], '{0}/{1}_final.png'.format(saveDir, filePref
 
 # now do the id rendering
 print 'Rendering ids...',
-initIDRendering(frameId, gbufferId, gbufferEnd)
+initIDRendering(frameId, gbufferPass)
 bufferIds   = getColorBuffers(frameId, gbufferEnd)
 bufferNames = ['texture', 'mesh', 'shader', 'overflow']
 